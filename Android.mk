@@ -34,6 +34,7 @@ LOCAL_SRC_FILES :=  \
 	generic/tkCanvEllipse.c \
 	generic/tkCanvGradient.c \
 	generic/tkCanvGroup.c \
+	generic/tkCanvLite.c \
 	generic/tkCanvPath.c \
 	generic/tkCanvPathUtil.c \
 	generic/tkCanvPimage.c \
@@ -41,6 +42,7 @@ LOCAL_SRC_FILES :=  \
 	generic/tkCanvPpoly.c \
 	generic/tkCanvPrect.c \
 	generic/tkCanvPtext.c \
+	generic/tkCanvPtiles.c \
 	generic/tkCanvStyle.c \
 	generic/tkPath.c \
 	generic/tkPathGradient.c \
@@ -53,6 +55,9 @@ LOCAL_SRC_FILES :=  \
 	generic/tkpCanvImg.c \
 	generic/tkpCanvLine.c \
 	generic/tkpCanvPoly.c \
+	generic/tkpCanvPdf.c \
+	generic/tkpCanvSvg.c \
+	generic/tkpCanvSvgLoad.c \
 	generic/tkpCanvPs.c \
 	generic/tkpCanvText.c \
 	generic/tkpCanvUtil.c \
@@ -103,15 +103,20 @@ int Tkpath_Init(Tcl_Interp *interp)		/* Tcl interpreter. */
 	return TCL_ERROR;
     }
 
-    if (TkPathSetup(interp) == TCL_ERROR) {
-        return TCL_ERROR;
-    }
-
     if (Tcl_CreateNamespace(interp, "::tkp", NULL, NULL) == NULL) {
 	Tcl_ResetResult(interp);
     }
+
+    /*
+     * The backend sets ::tkp::backend to the name of the graphics
+     * library it draws with.
+     */
+    if (TkPathSetup(interp) == TCL_ERROR) {
+        return TCL_ERROR;
+    }
     Tcl_CreateObjCommand(interp, "::tkp::canvas", Tk_PathCanvasObjCmd,
 	    (ClientData) Tk_MainWindow(interp), NULL);
+    Tcl_RegisterObjType(&tkPathDataObjType);
 
     /*
      * Link the ::tkp::antialias variable to control antialiasing.
@@ -144,6 +149,11 @@ int Tkpath_Init(Tcl_Interp *interp)		/* Tcl interpreter. */
     PathGradientInit(interp);
     SurfaceInit(interp);
 
+    /*
+     * Matrix commands, see also tkpath.tcl.
+     */
+    PathMatrixInit(interp);
+
     /*
      * Style object.
      */
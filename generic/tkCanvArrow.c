@@ -15,89 +15,133 @@
 #include "tkPathStyle.h"
 #include <math.h>
 
-PathAtom *
-MakePathAtomsFromArrow(ArrowDescr *arrowDescr)
+/*
+ * The points and the atoms of an arrowhead share one allocation.
+ */
+
+typedef struct ArrowStorage {
+    PathPoint points[PTS_IN_ARROW];
+    LineToAtom atoms[DRAWABLE_PTS_IN_ARROW];
+} ArrowStorage;
+
+/*
+ * Links the packed atoms along the drawable arrow points, skipping the
+ * NAN points of unfilled arrowheads. Must be called after every change of
+ * arrowPointsPtr.
+ */
+
+static void
+ArrowUpdateAtoms(ArrowDescr *arrowDescr)
 {
     PathPoint *coords = arrowDescr->arrowPointsPtr;
-    PathAtom *atomPtr = NULL, *ret = NULL;
-    if (coords)
-    {
-        int i = 0;
-        if (isnan(coords[0].x) || isnan(coords[0].y)) {
-            i = 1;
+    LineToAtom *atoms = ((ArrowStorage *) coords)->atoms;
+    int i, n = 0;
+
+    for (i = 0; i < DRAWABLE_PTS_IN_ARROW; i++) {
+        if (isnan(coords[i].x) || isnan(coords[i].y)) {
+            continue;
         }
-        ret = atomPtr = NewMoveToAtom(coords[i].x, coords[i].y);
-        for (i++ ; i < DRAWABLE_PTS_IN_ARROW; i++) {
-            if (isnan(coords[i].x) || isnan(coords[i].y))
-                continue;
-            atomPtr->nextPtr = NewLineToAtom(coords[i].x, coords[i].y);
-            atomPtr = atomPtr->nextPtr;
+        atoms[n].pathAtom.type = (n == 0) ? PATH_ATOM_M : PATH_ATOM_L;
+        atoms[n].pathAtom.nextPtr = NULL;
+        atoms[n].x = coords[i].x;
+        atoms[n].y = coords[i].y;
+        if (n > 0) {
+            atoms[n-1].pathAtom.nextPtr = &atoms[n].pathAtom;
         }
+        n++;
+    }
+    arrowDescr->arrowAtomsPtr = (n > 0) ? &atoms[0].pathAtom : NULL;
+}
+
+/*
+ * Returns the cached outline of the arrowhead, owned by arrowDescr.
+ */
+
+PathAtom *
+TkPathArrowAtoms(ArrowDescr *arrowDescr)
+{
+    return arrowDescr->arrowAtomsPtr;
+}
+
+/*
+ * Sets up the style an arrowhead is drawn, hit tested and exported with:
+ * filled with the stroke color, or stroked only. fcPtr must live as long
+ * as the style is used.
+ */
+
+void
+TkPathArrowStyle(ArrowDescr *arrowDescr, Tk_PathStyle *arrowStylePtr,
+	TkPathColor *fcPtr)
+{
+    if (arrowDescr->arrowFillRatio > 0.0 &&
+	arrowDescr->arrowLength != 0.0) {
+        arrowStylePtr->strokeWidth = 0.0;
+        fcPtr->color = arrowStylePtr->strokeColor;
+        fcPtr->gradientInstPtr = NULL;
+        arrowStylePtr->fill = fcPtr;
+        arrowStylePtr->fillOpacity = arrowStylePtr->strokeOpacity;
+#if !defined(_WIN32) && !defined(PLATFORM_SDL) && !defined(MAC_OSX_TK)
+        arrowStylePtr->dashPtr = NULL;
+#endif
+    } else {
+        arrowStylePtr->fill = NULL;
+        arrowStylePtr->fillOpacity = 1.0;
+        arrowStylePtr->joinStyle = 1;
+        arrowStylePtr->dashPtr = NULL;
     }
-    return ret;
 }
 
 void
 DisplayArrow(Tk_PathCanvas canvas, ArrowDescr *arrowDescr,
         Tk_PathStyle *const style, TMatrix *mPtr, PathRect *bboxPtr)
 {
-    if (arrowDescr->arrowEnabled && arrowDescr->arrowPointsPtr != NULL) {
+    if (arrowDescr->arrowEnabled && arrowDescr->arrowAtomsPtr != NULL) {
         Tk_PathStyle arrowStyle = *style;
         TkPathColor fc;
-        PathAtom *atomPtr;
 
 	TkPathResetTMatrix(ContextOfCanvas(canvas));
-        if (arrowDescr->arrowFillRatio > 0.0 &&
-	    arrowDescr->arrowLength != 0.0) {
-            arrowStyle.strokeWidth = 0.0;
-            fc.color = arrowStyle.strokeColor;
-            fc.gradientInstPtr = NULL;
-            arrowStyle.fill = &fc;
-            arrowStyle.fillOpacity = arrowStyle.strokeOpacity;
-#if !defined(_WIN32) && !defined(PLATFORM_SDL) && !defined(MAC_OSX_TK)
-            arrowStyle.dashPtr = NULL;
-#endif
-        } else {
-            arrowStyle.fill = NULL;
-            arrowStyle.fillOpacity = 1.0;
-            arrowStyle.joinStyle = 1;
-            arrowStyle.dashPtr = NULL;
-        }
-        atomPtr = MakePathAtomsFromArrow(arrowDescr);
-        TkPathDrawPath(ContextOfCanvas(canvas), atomPtr, &arrowStyle,
-		mPtr, bboxPtr);
-        TkPathFreeAtoms(atomPtr);
+        TkPathArrowStyle(arrowDescr, &arrowStyle, &fc);
+        TkPathDrawPath(ContextOfCanvas(canvas), arrowDescr->arrowAtomsPtr,
+		&arrowStyle, mPtr, bboxPtr);
+    }
+}
+
+/*
+ * Distance from the point to the arrowhead, for the pointProc of items
+ * with arrows.
+ */
+
+double
+TkPathArrowToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+	ArrowDescr *arrowDescr, Tk_PathStyle *const style, double *pointPtr)
+{
+    if (arrowDescr->arrowEnabled && arrowDescr->arrowAtomsPtr != NULL) {
+        Tk_PathStyle arrowStyle = *style;
+        TkPathColor fc;
+
+        TkPathArrowStyle(arrowDescr, &arrowStyle, &fc);
+        return GenericPathToPoint(canvas, itemPtr, &arrowStyle,
+		arrowDescr->arrowAtomsPtr, DRAWABLE_PTS_IN_ARROW + 1,
+		pointPtr);
     }
+    return 1.0e36;
 }
 
 void
 PaintArrow(TkPathContext context, ArrowDescr *arrowDescr,
 	   Tk_PathStyle *const style, PathRect *bboxPtr)
 {
-    if (arrowDescr->arrowEnabled && arrowDescr->arrowPointsPtr != NULL) {
+    if (arrowDescr->arrowEnabled && arrowDescr->arrowAtomsPtr != NULL) {
         Tk_PathStyle arrowStyle = *style;
         TkPathColor fc;
         PathAtom *atomPtr;
 
         arrowStyle.matrixPtr = NULL;
-        if (arrowDescr->arrowFillRatio > 0.0 &&
-	    arrowDescr->arrowLength != 0.0) {
-            arrowStyle.strokeWidth = 0.0;
-            fc.color = arrowStyle.strokeColor;
-            fc.gradientInstPtr = NULL;
-            arrowStyle.fill = &fc;
-            arrowStyle.fillOpacity = arrowStyle.strokeOpacity;
-        } else {
-            arrowStyle.fill = NULL;
-            arrowStyle.fillOpacity = 1.0;
-            arrowStyle.joinStyle = 1;
-            arrowStyle.dashPtr = NULL;
-        }
-        atomPtr = MakePathAtomsFromArrow(arrowDescr);
+        TkPathArrowStyle(arrowDescr, &arrowStyle, &fc);
+        atomPtr = arrowDescr->arrowAtomsPtr;
 	if (TkPathMakePath(context, atomPtr, &arrowStyle) == TCL_OK) {
 	    TkPathPaintPath(context, atomPtr, &arrowStyle, bboxPtr);
 	}
-        TkPathFreeAtoms(atomPtr);
     }
 }
 
@@ -109,6 +153,7 @@ TkPathArrowDescrInit(ArrowDescr *descrPtr)
     descrPtr->arrowWidth = (float)4.0;
     descrPtr->arrowFillRatio = (float)1.0;
     descrPtr->arrowPointsPtr = NULL;
+    descrPtr->arrowAtomsPtr = NULL;
 }
 
 void
@@ -144,10 +189,11 @@ TkPathPreconfigureArrow(PathPoint *pf, ArrowDescr *arrowDescr)
 {
     if (arrowDescr->arrowPointsPtr == NULL) {
         if (arrowDescr->arrowEnabled) {
-            arrowDescr->arrowPointsPtr = (PathPoint *)
-		ckalloc((unsigned)(PTS_IN_ARROW * sizeof(PathPoint)));
+            arrowDescr->arrowPointsPtr = ((ArrowStorage *)
+		ckalloc(sizeof(ArrowStorage)))->points;
             arrowDescr->arrowPointsPtr[LINE_PT_IN_ARROW] = *pf;
             arrowDescr->arrowPointsPtr[ORIG_PT_IN_ARROW] = *pf;
+            arrowDescr->arrowAtomsPtr = NULL;
         }
     } else {
         if (pf->x == arrowDescr->arrowPointsPtr[LINE_PT_IN_ARROW].x &&
@@ -155,8 +201,7 @@ TkPathPreconfigureArrow(PathPoint *pf, ArrowDescr *arrowDescr)
             *pf = arrowDescr->arrowPointsPtr[ORIG_PT_IN_ARROW];
         }
         if (!arrowDescr->arrowEnabled) {
-            ckfree((char *)arrowDescr->arrowPointsPtr);
-            arrowDescr->arrowPointsPtr = NULL;
+            TkPathFreeArrow(arrowDescr);
         }
     }
 }
@@ -233,6 +278,7 @@ TkPathConfigureArrow(PathPoint pf, PathPoint pl, ArrowDescr *arrowDescr,
             poly[LINE_PT_IN_ARROW].x -= backup*cosTheta;
             poly[LINE_PT_IN_ARROW].y -= backup*sinTheta;
         }
+        ArrowUpdateAtoms(arrowDescr);
 
         return poly[LINE_PT_IN_ARROW];
     }
@@ -248,6 +294,7 @@ TkPathTranslateArrow(ArrowDescr *arrowDescr, double deltaX, double deltaY)
             arrowDescr->arrowPointsPtr[i].x += deltaX;
             arrowDescr->arrowPointsPtr[i].y += deltaY;
         }
+        ArrowUpdateAtoms(arrowDescr);
     }
 }
 
@@ -263,6 +310,7 @@ TkPathScaleArrow(ArrowDescr *arrowDescr, double originX, double originY,
             pt->x = originX + scaleX*(pt->x - originX);
             pt->y = originX + scaleX*(pt->y - originX);
         }
+        ArrowUpdateAtoms(arrowDescr);
     }
 }
 
@@ -272,6 +320,7 @@ TkPathFreeArrow(ArrowDescr *arrowDescr)
     if (arrowDescr->arrowPointsPtr != NULL) {
         ckfree((char *)arrowDescr->arrowPointsPtr);
         arrowDescr->arrowPointsPtr = NULL;
+        arrowDescr->arrowAtomsPtr = NULL;
     }
 }
 
@@ -38,6 +38,10 @@ typedef struct ArrowDescr
     PathPoint *arrowPointsPtr;  /* Points to array of PTS_IN_ARROW points
                                  * describing polygon for arrowhead in line.
                                  * NULL means no arrowhead at current point. */
+    PathAtom *arrowAtomsPtr;    /* Outline of arrowPointsPtr as a linked list
+                                 * of atoms, packed in one block allocated
+                                 * together with arrowPointsPtr and updated
+                                 * whenever those points change. */
 } ArrowDescr;
 
 MODULE_SCOPE void	TkPathArrowDescrInit(ArrowDescr *descr);
@@ -64,7 +68,12 @@ MODULE_SCOPE void	TkPathFreeArrow(ArrowDescr *arrowDescr);
 MODULE_SCOPE int	GetSegmentsFromPathAtomList(PathAtom *firstAtom,
 			    PathPoint **firstPt, PathPoint *secondPt,
 			    PathPoint *penultPt, PathPoint **lastPt);
-MODULE_SCOPE PathAtom *	MakePathAtomsFromArrow(ArrowDescr *arrowDescr);
+MODULE_SCOPE PathAtom *	TkPathArrowAtoms(ArrowDescr *arrowDescr);
+MODULE_SCOPE void	TkPathArrowStyle(ArrowDescr *arrowDescr,
+			    Tk_PathStyle *arrowStylePtr, TkPathColor *fcPtr);
+MODULE_SCOPE double	TkPathArrowToPoint(Tk_PathCanvas canvas,
+			    Tk_PathItem *itemPtr, ArrowDescr *arrowDescr,
+			    Tk_PathStyle *const style, double *pointPtr);
 MODULE_SCOPE void	DisplayArrow(Tk_PathCanvas canvas, ArrowDescr *arrowDescr,
 			    Tk_PathStyle *const style, TMatrix *mPtr,
 			    PathRect *bboxPtr);
@@ -24,6 +24,10 @@ typedef struct EllipseItem  {
     double center[2];	    /* Center coord. */
     double rx;		    /* Radius. Circle uses rx for overall radius. */
     double ry;
+    int numShapes;	    /* Number of ovals in this item. */
+    double *shapesPtr;	    /* Center coords for each oval if more than
+                             * one, else NULL and center is used. All
+                             * share the same radius. */
 } EllipseItem;
 
 enum {
@@ -57,6 +61,14 @@ static void	EllipseBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 static int	EllipseCoords(Tcl_Interp *interp,
 		    Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 		    Tcl_Size objc, Tcl_Obj *const objv[]);
+static int	EllipseIndex(Tcl_Interp *interp, Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, Tcl_Obj *obj, int *indexPtr);
+static int	EllipseShapeToArea(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, Tk_PathStyle *stylePtr, int shape,
+		    double *areaPtr);
+static double	EllipseShapeToPoint(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, Tk_PathStyle *stylePtr, int shape,
+		    double *pointPtr);
 static int	EllipseToArea(Tk_PathCanvas canvas,
 		    Tk_PathItem *itemPtr, double *rectPtr);
 static int	EllipseToPdf(Tcl_Interp *interp,
@@ -73,6 +85,11 @@ static void	ScaleEllipse(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 		    double scaleX, double scaleY);
 static void	TranslateEllipse(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 		    int compensate, double deltaX, double deltaY);
+static double *	GetEllipseCenter(EllipseItem *ellPtr, int shape);
+static PathAtom * MakePathAtoms(EllipseItem *ellPtr, EllipseAtom *staticAtomPtr);
+static int	ProcessCoords(Tcl_Interp *interp, Tk_PathCanvas canvas,
+		    EllipseItem *ellPtr, Tcl_Size objc, Tcl_Obj *const objv[]);
+static void	FreePathAtoms(PathAtom *atomPtr, EllipseAtom *staticAtomPtr);
 
 
 enum {
@@ -147,7 +164,7 @@ Tk_PathItemType tkpCircleType = {
     EllipseToPdf,			/* pdfProc */
     ScaleEllipse,			/* scaleProc */
     TranslateEllipse,			/* translateProc */
-    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemIndexProc *) EllipseIndex,/* indexProc */
     (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
     (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
@@ -175,7 +192,7 @@ Tk_PathItemType tkpEllipseType = {
     EllipseToPdf,			/* pdfProc */
     ScaleEllipse,			/* scaleProc */
     TranslateEllipse,			/* translateProc */
-    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemIndexProc *) EllipseIndex,/* indexProc */
     (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
     (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
@@ -223,6 +240,8 @@ CreateAny(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
     itemPtr->bbox = NewEmptyPathRect();
     itemPtr->totalBbox = NewEmptyPathRect();
     ellPtr->type = type;
+    ellPtr->numShapes = 1;
+    ellPtr->shapesPtr = NULL;
 
     if (ellPtr->type == kOvalTypeCircle) {
 	optionTable = Tk_CreateOptionTable(interp, optionSpecsCircle);
@@ -241,7 +260,7 @@ CreateAny(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
             break;
         }
     }
-    if (CoordsForPointItems(interp, canvas, ellPtr->center, i, objv) != TCL_OK) {
+    if (ProcessCoords(interp, canvas, ellPtr, i, objv) != TCL_OK) {
         goto error;
     }
     if (ConfigureEllipse(interp, canvas, itemPtr, objc-i, objv+i, 0) == TCL_OK) {
@@ -265,25 +284,142 @@ EllipseCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
     EllipseItem *ellPtr = (EllipseItem *) itemPtr;
     int result;
 
-    result = CoordsForPointItems(interp, canvas, ellPtr->center, objc, objv);
-    if ((result == TCL_OK) && ((objc == 1) || (objc == 2))) {
+    result = ProcessCoords(interp, canvas, ellPtr, objc, objv);
+    if ((result == TCL_OK) && (objc > 0)) {
         ComputeEllipseBbox(canvas, ellPtr);
     }
     return result;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * ProcessCoords --
+ *
+ *	Sets or gets the center coords of a circle or ellipse. Any
+ *	number of center points is accepted and gives that many
+ *	ovals sharing the options of the item.
+ *
+ * Results:
+ *	Standard tcl result.
+ *
+ * Side effects:
+ *	May replace the centers of the item.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+ProcessCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, EllipseItem *ellPtr,
+        Tcl_Size objc, Tcl_Obj *const objv[])
+{
+    double *coordsPtr;
+    int numShapes;
+
+    if (objc == 0) {
+        if (ellPtr->shapesPtr != NULL) {
+            Tcl_SetObjResult(interp, MultiShapeCoordsObj(ellPtr->shapesPtr,
+                    2*ellPtr->numShapes));
+            return TCL_OK;
+        }
+        return CoordsForPointItems(interp, canvas, ellPtr->center, objc, objv);
+    }
+    if (CoordsForMultiShapeItems(interp, canvas, 2, objc, objv,
+            &coordsPtr, &numShapes) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (ellPtr->shapesPtr != NULL) {
+        ckfree((char *) ellPtr->shapesPtr);
+        ellPtr->shapesPtr = NULL;
+    }
+    if (numShapes == 1) {
+        ellPtr->center[0] = coordsPtr[0];
+        ellPtr->center[1] = coordsPtr[1];
+        ckfree((char *) coordsPtr);
+    } else {
+        ellPtr->shapesPtr = coordsPtr;
+    }
+    ellPtr->numShapes = numShapes;
+    return TCL_OK;
+}
+
+static double *
+GetEllipseCenter(EllipseItem *ellPtr, int shape)
+{
+    if (ellPtr->shapesPtr != NULL) {
+        return ellPtr->shapesPtr + 2*shape;
+    }
+    return ellPtr->center;
+}
+
 static PathRect
 GetBareBbox(EllipseItem *ellPtr)
 {
     PathRect bbox;
-
-    bbox.x1 = ellPtr->center[0] - ellPtr->rx;
-    bbox.y1 = ellPtr->center[1] - ellPtr->ry;
-    bbox.x2 = ellPtr->center[0] + ellPtr->rx;
-    bbox.y2 = ellPtr->center[1] + ellPtr->ry;
+    double *p;
+    int i;
+
+    bbox = NewEmptyPathRect();
+    for (i = 0; i < ellPtr->numShapes; i++) {
+        p = GetEllipseCenter(ellPtr, i);
+        IncludePointInRect(&bbox, p[0] - ellPtr->rx, p[1] - ellPtr->ry);
+        IncludePointInRect(&bbox, p[0] + ellPtr->rx, p[1] + ellPtr->ry);
+    }
     return bbox;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * MakePathAtoms --
+ *
+ *	Makes the ellipse atoms for all ovals of the item.
+ *	A single oval uses the atom provided by the caller, and
+ *	many ovals are put in one array, to save some memory.
+ *
+ * Results:
+ *	The first atom of the chain.
+ *
+ * Side effects:
+ *	May allocate memory; free using FreePathAtoms().
+ *
+ *--------------------------------------------------------------
+ */
+
+static PathAtom *
+MakePathAtoms(EllipseItem *ellPtr, EllipseAtom *staticAtomPtr)
+{
+    EllipseAtom *ellAtomPtr = staticAtomPtr;
+    PathAtom *atomPtr;
+    double *p;
+    int i;
+
+    if (ellPtr->numShapes > 1) {
+        ellAtomPtr = (EllipseAtom *) ckalloc((unsigned)
+                (ellPtr->numShapes * sizeof(EllipseAtom)));
+    }
+    for (i = 0; i < ellPtr->numShapes; i++) {
+        p = GetEllipseCenter(ellPtr, i);
+        atomPtr = (PathAtom *) (ellAtomPtr + i);
+        atomPtr->type = PATH_ATOM_ELLIPSE;
+        atomPtr->nextPtr = (i < ellPtr->numShapes-1) ?
+                (PathAtom *) (ellAtomPtr + i + 1) : NULL;
+        ellAtomPtr[i].cx = p[0];
+        ellAtomPtr[i].cy = p[1];
+        ellAtomPtr[i].rx = ellPtr->rx;
+        ellAtomPtr[i].ry = ellPtr->ry;
+    }
+    return (PathAtom *) ellAtomPtr;
+}
+
+static void
+FreePathAtoms(PathAtom *atomPtr, EllipseAtom *staticAtomPtr)
+{
+    if (atomPtr != (PathAtom *) staticAtomPtr) {
+        ckfree((char *) atomPtr);
+    }
+}
+
 static void
 ComputeEllipseBbox(Tk_PathCanvas canvas, EllipseItem *ellPtr)
 {
@@ -376,6 +512,9 @@ DeleteEllipse(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display)
     if (itemExPtr->styleInst != NULL) {
 	TkPathFreeStyle(itemExPtr->styleInst);
     }
+    if (ellPtr->shapesPtr != NULL) {
+	ckfree((char *) ellPtr->shapesPtr);
+    }
     Tk_FreeConfigOptions((char *) itemPtr, itemPtr->optionTable,
 			 Tk_PathCanvasTkwin(canvas));
 }
@@ -396,18 +535,13 @@ DisplayEllipse(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display, Dra
     /*
      * We create the atom on the fly to save some memory.
      */
-    atomPtr = (PathAtom *)&ellAtom;
-    atomPtr->nextPtr = NULL;
-    atomPtr->type = PATH_ATOM_ELLIPSE;
-    ellAtom.cx = ellPtr->center[0];
-    ellAtom.cy = ellPtr->center[1];
-    ellAtom.rx = ellPtr->rx;
-    ellAtom.ry = ellPtr->ry;
+    atomPtr = MakePathAtoms(ellPtr, &ellAtom);
 
     itemPtr->bbox = GetBareBbox(ellPtr);
     style = TkPathCanvasInheritStyle(itemPtr, 0);
     TkPathDrawPath(ContextOfCanvas(canvas), atomPtr, &style,
 	    &m, &itemPtr->bbox);
+    FreePathAtoms(atomPtr, &ellAtom);
     TkPathCanvasFreeInheritedStyle(&style);
 }
 
@@ -423,30 +557,45 @@ EllipseToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
 {
     EllipseItem *ellPtr = (EllipseItem *) itemPtr;
     Tk_PathStyle style;
+    double dist;
+
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    dist = MultiShapeToPoint(canvas, itemPtr, &style, ellPtr->numShapes,
+            EllipseShapeToPoint, pointPtr, NULL);
+    TkPathCanvasFreeInheritedStyle(&style);
+    return dist;
+}
+
+static double
+EllipseShapeToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        Tk_PathStyle *stylePtr, int shape, double *pointPtr)
+{
+    EllipseItem *ellPtr = (EllipseItem *) itemPtr;
     TMatrix *mPtr;
+    double *centerPtr;
     double bareOval[4];
     double width, dist;
     int rectiLinear = 0;
     int haveDist = 0;
     int filled;
 
-    style = TkPathCanvasInheritStyle(itemPtr, 0);
-    filled = HaveAnyFillFromPathColor(style.fill);
+    filled = HaveAnyFillFromPathColor(stylePtr->fill);
     width = 0.0;
-    if (style.strokeColor != NULL) {
-        width = style.strokeWidth;
+    if (stylePtr->strokeColor != NULL) {
+        width = stylePtr->strokeWidth;
     }
-    mPtr = style.matrixPtr;
+    mPtr = stylePtr->matrixPtr;
+    centerPtr = GetEllipseCenter(ellPtr, shape);
     if (mPtr == NULL) {
         rectiLinear = 1;
-        bareOval[0] = ellPtr->center[0] - ellPtr->rx;
-        bareOval[1] = ellPtr->center[1] - ellPtr->ry;
-        bareOval[2] = ellPtr->center[0] + ellPtr->rx;
-        bareOval[3] = ellPtr->center[1] + ellPtr->ry;
+        bareOval[0] = centerPtr[0] - ellPtr->rx;
+        bareOval[1] = centerPtr[1] - ellPtr->ry;
+        bareOval[2] = centerPtr[0] + ellPtr->rx;
+        bareOval[3] = centerPtr[1] + ellPtr->ry;
 
         /* For tiny points make it simple. */
         if ((ellPtr->rx <= 2.0) && (ellPtr->ry <= 2.0)) {
-            dist = hypot(ellPtr->center[0] - pointPtr[0], ellPtr->center[1] - pointPtr[1]);
+            dist = hypot(centerPtr[0] - pointPtr[0], centerPtr[1] - pointPtr[1]);
             dist = MAX(0.0, dist - (ellPtr->rx + ellPtr->ry)/2.0);
             haveDist = 1;
         }
@@ -455,10 +604,10 @@ EllipseToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
 
         /* This is a situation we can treat in a simplified way. Apply the transform here. */
         rectiLinear = 1;
-        bareOval[0] = mPtr->a * (ellPtr->center[0] - ellPtr->rx) + mPtr->tx;
-        bareOval[1] = mPtr->d * (ellPtr->center[1] - ellPtr->ry) + mPtr->ty;
-        bareOval[2] = mPtr->a * (ellPtr->center[0] + ellPtr->rx) + mPtr->tx;
-        bareOval[3] = mPtr->d * (ellPtr->center[1] + ellPtr->ry) + mPtr->ty;
+        bareOval[0] = mPtr->a * (centerPtr[0] - ellPtr->rx) + mPtr->tx;
+        bareOval[1] = mPtr->d * (centerPtr[1] - ellPtr->ry) + mPtr->ty;
+        bareOval[2] = mPtr->a * (centerPtr[0] + ellPtr->rx) + mPtr->tx;
+        bareOval[3] = mPtr->d * (centerPtr[1] + ellPtr->ry) + mPtr->ty;
 
         /* For tiny points make it simple. */
         rx = fabs(bareOval[0] - bareOval[2])/2.0;
@@ -483,15 +632,14 @@ EllipseToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
             atomPtr = (PathAtom *)&ellAtom;
             atomPtr->nextPtr = NULL;
             atomPtr->type = PATH_ATOM_ELLIPSE;
-            ellAtom.cx = ellPtr->center[0];
-            ellAtom.cy = ellPtr->center[1];
+            ellAtom.cx = centerPtr[0];
+            ellAtom.cy = centerPtr[1];
             ellAtom.rx = ellPtr->rx;
             ellAtom.ry = ellPtr->ry;
-            dist = GenericPathToPoint(canvas, itemPtr, &style, atomPtr,
+            dist = GenericPathToPoint(canvas, itemPtr, stylePtr, atomPtr,
                     kPathNumSegmentsEllipse+1, pointPtr);
         }
     }
-    TkPathCanvasFreeInheritedStyle(&style);
     return dist;
 }
 
@@ -500,19 +648,32 @@ EllipseToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
 {
     EllipseItem *ellPtr = (EllipseItem *) itemPtr;
     Tk_PathStyle style;
+    int result;
+
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    result = MultiShapeToArea(canvas, itemPtr, &style, ellPtr->numShapes,
+            EllipseShapeToArea, areaPtr);
+    TkPathCanvasFreeInheritedStyle(&style);
+    return result;
+}
+
+static int
+EllipseShapeToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        Tk_PathStyle *stylePtr, int shape, double *areaPtr)
+{
+    EllipseItem *ellPtr = (EllipseItem *) itemPtr;
     TMatrix *mPtr;
     double center[2], bareOval[4], halfWidth;
     int rectiLinear = 0;
     int result;
 
-    style = TkPathCanvasInheritStyle(itemPtr, 0);
     halfWidth = 0.0;
-    center[0] = ellPtr->center[0];
-    center[1] = ellPtr->center[1];
-    if (style.strokeColor != NULL) {
-        halfWidth = style.strokeWidth/2.0;
+    center[0] = GetEllipseCenter(ellPtr, shape)[0];
+    center[1] = GetEllipseCenter(ellPtr, shape)[1];
+    if (stylePtr->strokeColor != NULL) {
+        halfWidth = stylePtr->strokeWidth/2.0;
     }
-    mPtr = style.matrixPtr;
+    mPtr = stylePtr->matrixPtr;
     if (mPtr == NULL) {
         rectiLinear = 1;
         bareOval[0] = center[0] - ellPtr->rx;
@@ -550,8 +711,8 @@ EllipseToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
          * of the rectangle's corners are totally inside the oval's
          * unfilled center, in which case we should return "outside".
          */
-        if ((result == 0) && (style.strokeColor != NULL)
-                && !HaveAnyFillFromPathColor(style.fill)) {
+        if ((result == 0) && (stylePtr->strokeColor != NULL)
+                && !HaveAnyFillFromPathColor(stylePtr->fill)) {
             double width, height;
             double xDelta1, yDelta1, xDelta2, yDelta2;
 
@@ -585,13 +746,44 @@ EllipseToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
         atomPtr = (PathAtom *)&ellAtom;
         atomPtr->nextPtr = NULL;
         atomPtr->type = PATH_ATOM_ELLIPSE;
-        ellAtom.cx = ellPtr->center[0];
-        ellAtom.cy = ellPtr->center[1];
+        ellAtom.cx = GetEllipseCenter(ellPtr, shape)[0];
+        ellAtom.cy = GetEllipseCenter(ellPtr, shape)[1];
         ellAtom.rx = ellPtr->rx;
         ellAtom.ry = ellPtr->ry;
-        result = GenericPathToArea(canvas, itemPtr, &style, atomPtr,
+        result = GenericPathToArea(canvas, itemPtr, stylePtr, atomPtr,
                 kPathNumSegmentsEllipse+1, areaPtr);
     }
+    return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * EllipseIndex --
+ *
+ *	Returns the index of an oval of a circle or ellipse item
+ *	holding many of them, see GetMultiShapeIndex().
+ *
+ * Results:
+ *	Standard tcl result.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+EllipseIndex(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+    Tcl_Obj *obj, int *indexPtr)
+{
+    EllipseItem *ellPtr = (EllipseItem *) itemPtr;
+    Tk_PathStyle style;
+    int result;
+
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    result = GetMultiShapeIndex(interp, canvas, itemPtr, &style,
+            ellPtr->numShapes, EllipseShapeToPoint, obj, indexPtr);
     TkPathCanvasFreeInheritedStyle(&style);
     return result;
 }
@@ -614,15 +806,10 @@ EllipseToPdf(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 	return TCL_OK;
     }
     /* We create the atom on the fly to save some memory.  */
-    atomPtr = (PathAtom *)&atom;
-    atomPtr->nextPtr = NULL;
-    atomPtr->type = PATH_ATOM_ELLIPSE;
-    atom.cx = ellPtr->center[0];
-    atom.cy = ellPtr->center[1];
-    atom.rx = ellPtr->rx;
-    atom.ry = ellPtr->ry;
+    atomPtr = MakePathAtoms(ellPtr, &atom);
     style = TkPathCanvasInheritStyle(itemPtr, 0);
     result = TkPathPdf(interp, atomPtr, &style, &itemPtr->bbox, objc, objv);
+    FreePathAtoms(atomPtr, &atom);
     TkPathCanvasFreeInheritedStyle(&style);
     return result;
 }
@@ -641,11 +828,16 @@ ScaleEllipse(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int compensate,
     double originX, double originY, double scaleX, double scaleY)
 {
     EllipseItem *ellPtr = (EllipseItem *) itemPtr;
+    double *p;
+    int i;
 
     CompensateScale(itemPtr, compensate, &originX, &originY, &scaleX, &scaleY);
 
-    ellPtr->center[0] = originX + scaleX*(ellPtr->center[0] - originX);
-    ellPtr->center[1] = originY + scaleY*(ellPtr->center[1] - originY);
+    for (i = 0; i < ellPtr->numShapes; i++) {
+        p = GetEllipseCenter(ellPtr, i);
+        p[0] = originX + scaleX*(p[0] - originX);
+        p[1] = originY + scaleY*(p[1] - originY);
+    }
     ellPtr->rx *= scaleX;
     ellPtr->ry *= scaleY;
     ScalePathRect(&itemPtr->bbox, originX, originY, scaleX, scaleY);
@@ -657,11 +849,16 @@ TranslateEllipse(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int compensate,
     double deltaX, double deltaY)
 {
     EllipseItem *ellPtr = (EllipseItem *) itemPtr;
+    double *p;
+    int i;
 
     CompensateTranslate(itemPtr, compensate, &deltaX, &deltaY);
 
-    ellPtr->center[0] += deltaX;
-    ellPtr->center[1] += deltaY;
+    for (i = 0; i < ellPtr->numShapes; i++) {
+        p = GetEllipseCenter(ellPtr, i);
+        p[0] += deltaX;
+        p[1] += deltaY;
+    }
 #if 0
     TranslatePathAtoms(ellPtr->atomPtr, deltaX, deltaY);
 #endif
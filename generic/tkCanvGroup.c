@@ -18,7 +18,20 @@ enum {
     /* When childs update themself so they set all
      * its ancestors dirty bbox flag so they know
      * when they need to recompute its bbox. */
-    GROUP_FLAG_DIRTY_BBOX	    = (1L << 0)
+    GROUP_FLAG_DIRTY_BBOX	    = (1L << 0),
+    /* The same, telling that the layer no longer shows
+     * the current content. */
+    GROUP_FLAG_DIRTY_LAYER	    = (1L << 1),
+    /* The same, telling that it must be checked again
+     * whether all descendants are path items. */
+    GROUP_FLAG_DIRTY_KIND	    = (1L << 2)
+};
+
+enum {
+    GROUP_OPTION_INDEX_CACHE =
+	(1L << (PATH_STYLE_OPTION_INDEX_END + 1)),
+    GROUP_OPTION_INDEX_OPACITY =
+	(1L << (PATH_STYLE_OPTION_INDEX_END + 2))
 };
 
 /*
@@ -31,6 +44,15 @@ typedef struct GroupItem  {
     PathRect totalBbox;		/* Bounding box including stroke.
 				 * Untransformed coordinates. */
     long flags;			/* Various flags, see enum. */
+    int cache;			/* Keep the rendered descendants in a
+				 * layer. */
+    double opacity;		/* Opacity the layer is drawn with. */
+    int pathOnly;		/* All descendants are path items, which
+				 * is required for a layer. */
+    TkPathContext layer;	/* Offscreen surface holding the rendered
+				 * descendants, or NULL if there is none. */
+    int layerX1, layerY1;	/* Area of the canvas held by the layer, */
+    int layerX2, layerY2;	/* in canvas coordinates. */
 } GroupItem;
 
 
@@ -51,6 +73,10 @@ static void	DisplayGroup(Tk_PathCanvas canvas,
 		    Tk_PathItem *itemPtr, Display *display, Drawable drawable,
 		    int x, int y, int width, int height);
 static void	GroupBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int flags);
+static void	GroupFreeLayer(GroupItem *groupPtr);
+static int	GroupPathOnly(Tk_PathItem *itemPtr);
+static int	GroupRenderLayer(Tk_PathCanvas canvas, GroupItem *groupPtr,
+		    int x1, int y1, int x2, int y2);
 static int	GroupCoords(Tcl_Interp *interp,
 		    Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 		    Tcl_Size objc, Tcl_Obj *const objv[]);
@@ -78,9 +104,21 @@ PATH_OPTION_STRING_TABLES_FILL
 PATH_OPTION_STRING_TABLES_STROKE
 PATH_OPTION_STRING_TABLES_STATE
 
+#define PATH_OPTION_SPEC_CACHE				    \
+    {TK_OPTION_BOOLEAN, "-cache", NULL, NULL,		    \
+        "0", -1, offsetof(GroupItem, cache),		    \
+	0, 0, GROUP_OPTION_INDEX_CACHE}
+
+#define PATH_OPTION_SPEC_OPACITY			    \
+    {TK_OPTION_DOUBLE, "-opacity", NULL, NULL,		    \
+        "1.0", -1, offsetof(GroupItem, opacity),	    \
+	0, 0, GROUP_OPTION_INDEX_OPACITY}
+
 static Tk_OptionSpec optionSpecs[] = {
     PATH_OPTION_SPEC_CORE(Tk_PathItemEx),
     PATH_OPTION_SPEC_PARENT,
+    PATH_OPTION_SPEC_CACHE,
+    PATH_OPTION_SPEC_OPACITY,
     PATH_OPTION_SPEC_STYLE_FILL(Tk_PathItemEx, ""),
     PATH_OPTION_SPEC_STYLE_MATRIX(Tk_PathItemEx),
     PATH_OPTION_SPEC_STYLE_STROKE(Tk_PathItemEx, "black"),
@@ -141,6 +179,8 @@ CreateGroup(Tcl_Interp *interp,
     itemExPtr->styleInst = NULL;
     groupPtr->totalBbox = NewEmptyPathRect();
     groupPtr->flags = 0L;
+    groupPtr->pathOnly = 1;
+    groupPtr->layer = NULL;
     itemExPtr->header.x1 = itemExPtr->header.x2 =
     itemExPtr->header.y1 = itemExPtr->header.y2 = -1;
 
@@ -220,6 +260,11 @@ ConfigureGroup(Tcl_Interp *interp, Tk_PathCanvas canvas,
     }
     stylePtr->strokeOpacity = MAX(0.0, MIN(1.0, stylePtr->strokeOpacity));
     stylePtr->fillOpacity   = MAX(0.0, MIN(1.0, stylePtr->fillOpacity));
+    groupPtr->opacity = MAX(0.0, MIN(1.0, groupPtr->opacity));
+    if (!groupPtr->cache && (groupPtr->opacity >= 1.0)) {
+	GroupFreeLayer(groupPtr);
+    }
+    groupPtr->flags |= GROUP_FLAG_DIRTY_LAYER;
 
     /*
      * We must notify all children to update themself
@@ -251,16 +296,72 @@ DeleteGroup(Tk_PathCanvas canvas,
     if (itemExPtr->styleInst != NULL) {
 	TkPathFreeStyle(itemExPtr->styleInst);
     }
+    GroupFreeLayer(groupPtr);
     Tk_FreeConfigOptions((char *) itemPtr, itemPtr->optionTable,
 			 Tk_PathCanvasTkwin(canvas));
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayGroup --
+ *
+ *	Groups have nothing to draw themselves, except if they are drawn
+ *	from a layer, see TkPathCanvasGroupLayer. The layer is rendered
+ *	again if it is out of date or doesn't hold the area to be drawn,
+ *	and is then drawn with the -opacity of the group.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Group drawn, layer rendered.
+ *
+ *----------------------------------------------------------------------
+ */
+
 static void
 DisplayGroup(Tk_PathCanvas canvas,
     Tk_PathItem *itemPtr, Display *display, Drawable drawable,
     int x, int y, int width, int height)
 {
-    /* Empty. */
+    GroupItem *groupPtr = (GroupItem *) itemPtr;
+    TkPathContext ctx = ContextOfCanvas(canvas);
+    TMatrix m;
+    int x1, y1, x2, y2;
+
+    if (!TkPathCanvasGroupLayer(canvas, itemPtr)) {
+	return;
+    }
+
+    /*
+     * The bbox counts x2 and y2 as inside.
+     */
+    x1 = MAX(x, itemPtr->x1);
+    y1 = MAX(y, itemPtr->y1);
+    x2 = MIN(x + width, itemPtr->x2 + 1);
+    y2 = MIN(y + height, itemPtr->y2 + 1);
+    if ((x1 >= x2) || (y1 >= y2)) {
+	return;
+    }
+    if ((groupPtr->flags & GROUP_FLAG_DIRTY_LAYER)
+	    || (groupPtr->layer == NULL)
+	    || (x1 < groupPtr->layerX1) || (y1 < groupPtr->layerY1)
+	    || (x2 > groupPtr->layerX2) || (y2 > groupPtr->layerY2)) {
+	if (GroupRenderLayer(canvas, groupPtr, x1, y1, x2, y2) != TCL_OK) {
+	    /*
+	     * Not even a surface for the area drawn could be had, so the
+	     * descendants are drawn one by one, which loses the -opacity.
+	     */
+	    TkPathCanvasDisplayGroupItems(canvas, itemPtr, NULL,
+		    x, y, width, height);
+	    return;
+	}
+    }
+    m = GetCanvasTMatrix(canvas);
+    TkPathPushTMatrix(ctx, &m);
+    TkPathSurfaceDraw(ctx, groupPtr->layer, groupPtr->layerX1,
+	    groupPtr->layerY1, groupPtr->opacity);
 }
 
 static void
@@ -303,7 +404,19 @@ static int
 GroupToPdf(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 	Tcl_Size objc, Tcl_Obj *const objv[], int prepass)
 {
-    return TCL_OK;
+    GroupItem *groupPtr = (GroupItem *) itemPtr;
+    TkPathPdfContext *contextPtr;
+
+    /*
+     * Only the canvas pdf command can draw the descendants; the callbacks
+     * of itempdf convert items one by one, the group having no content
+     * of its own.
+     */
+    contextPtr = TkPathPdfGetContext((objc > 0) ? objv[0] : NULL);
+    if (contextPtr == NULL) {
+	return TCL_OK;
+    }
+    return TkPathPdfGroup(interp, contextPtr, itemPtr, groupPtr->opacity);
 }
 
 #ifndef TKP_NO_POSTSCRIPT
@@ -341,7 +454,7 @@ TranslateGroup(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
  *	This function is invoked by canvas code to tell us that one or
  *	more of our childrens have changed somehow so that our bbox
  *	need to be recomputed next time TkPathCanvasUpdateGroupBbox
- *	is called.
+ *	is called, and that our layer, if any, is out of date.
  *
  * Results:
  *	None.
@@ -356,7 +469,8 @@ void
 TkPathCanvasSetGroupDirtyBbox(Tk_PathItem *itemPtr)
 {
     GroupItem *groupPtr = (GroupItem *) itemPtr;
-    groupPtr->flags &= GROUP_FLAG_DIRTY_BBOX;
+    groupPtr->flags |= GROUP_FLAG_DIRTY_BBOX | GROUP_FLAG_DIRTY_LAYER
+	    | GROUP_FLAG_DIRTY_KIND;
 }
 
 void
@@ -370,7 +484,145 @@ TkPathCanvasUpdateGroupBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr)
 	groupPtr->flags &= ~GROUP_FLAG_DIRTY_BBOX;
     }
 }
-
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkPathCanvasGroupLayer --
+ *
+ *	Tells whether a group is drawn from a layer: its descendants are
+ *	rendered once into an offscreen surface, which is kept and drawn
+ *	by the group in place of them. This is asked for by
+ *	-cache or an -opacity below 1, and requires that all descendants
+ *	are path items. A hidden group doesn't hide its descendants, so
+ *	it is then drawn as usual.
+ *
+ * Results:
+ *	1 if the canvas should draw the group instead of its descendants,
+ *	else 0.
+ *
+ * Side effects:
+ *	The bbox of a layered group is brought up to date.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkPathCanvasGroupLayer(Tk_PathCanvas canvas, Tk_PathItem *itemPtr)
+{
+    GroupItem *groupPtr = (GroupItem *) itemPtr;
+    Tk_PathState state = itemPtr->state;
+
+    if ((itemPtr->typePtr != &tkpGroupType)
+	    || (!groupPtr->cache && (groupPtr->opacity >= 1.0))) {
+	return 0;
+    }
+    if (state == TK_PATHSTATE_NULL) {
+	state = TkPathCanvasState(canvas);
+    }
+    if (state == TK_PATHSTATE_HIDDEN) {
+	return 0;
+    }
+    if (groupPtr->flags & GROUP_FLAG_DIRTY_KIND) {
+	groupPtr->pathOnly = GroupPathOnly(itemPtr);
+	groupPtr->flags &= ~GROUP_FLAG_DIRTY_KIND;
+    }
+    if (!groupPtr->pathOnly) {
+	return 0;
+    }
+    TkPathCanvasUpdateGroupBbox(canvas, itemPtr);
+    return 1;
+}
+
+static int
+GroupPathOnly(Tk_PathItem *itemPtr)
+{
+    Tk_PathItem *walkPtr;
+
+    for (walkPtr = itemPtr->firstChildPtr; walkPtr != NULL;
+	    walkPtr = walkPtr->nextPtr) {
+	if (!walkPtr->typePtr->isPathType
+		|| ((walkPtr->firstChildPtr != NULL)
+		    && !GroupPathOnly(walkPtr))) {
+	    return 0;
+	}
+    }
+    return 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * GroupRenderLayer --
+ *
+ *	Renders the descendants of a group into its layer. Besides the
+ *	area asked for, the layer holds the part of the group that is
+ *	visible or within half a window of it, so that redraws nearby and
+ *	scrolling can still use it. If there is no memory for that, the
+ *	layer holds just the area asked for. The surface of the layer is
+ *	reused while its size stays the same.
+ *
+ * Results:
+ *	TCL_OK if the layer could be rendered, else TCL_ERROR.
+ *
+ * Side effects:
+ *	The surface of the layer is created or changed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+GroupRenderLayer(Tk_PathCanvas canvas, GroupItem *groupPtr,
+    int x1, int y1, int x2, int y2)
+{
+    TkPathCanvas *canvasPtr = (TkPathCanvas *) canvas;
+    Tk_PathItem *itemPtr = &groupPtr->headerEx.header;
+    Tk_Window tkwin = canvasPtr->tkwin;
+    int width = Tk_Width(tkwin), height = Tk_Height(tkwin);
+    int lx1, ly1, lx2, ly2;
+
+    lx1 = MAX(itemPtr->x1, MIN(x1, canvasPtr->xOrigin - width/2));
+    ly1 = MAX(itemPtr->y1, MIN(y1, canvasPtr->yOrigin - height/2));
+    lx2 = MIN(itemPtr->x2 + 1, MAX(x2, canvasPtr->xOrigin + width + width/2));
+    ly2 = MIN(itemPtr->y2 + 1, MAX(y2, canvasPtr->yOrigin + height + height/2));
+    if ((groupPtr->layer != NULL)
+	    && (lx2 - lx1 == groupPtr->layerX2 - groupPtr->layerX1)
+	    && (ly2 - ly1 == groupPtr->layerY2 - groupPtr->layerY1)) {
+	TkPathSurfaceErase(groupPtr->layer, 0.0, 0.0,
+		(double) (lx2 - lx1), (double) (ly2 - ly1));
+    } else {
+	GroupFreeLayer(groupPtr);
+	groupPtr->layer = TkPathInitSurface(canvasPtr->display,
+		lx2 - lx1, ly2 - ly1);
+	if (groupPtr->layer == NULL) {
+	    lx1 = x1, ly1 = y1, lx2 = x2, ly2 = y2;
+	    groupPtr->layer = TkPathInitSurface(canvasPtr->display,
+		    lx2 - lx1, ly2 - ly1);
+	    if (groupPtr->layer == NULL) {
+		return TCL_ERROR;
+	    }
+	}
+    }
+    TkPathCanvasDisplayGroupItems(canvas, itemPtr, groupPtr->layer,
+	    lx1, ly1, lx2 - lx1, ly2 - ly1);
+    groupPtr->layerX1 = lx1;
+    groupPtr->layerY1 = ly1;
+    groupPtr->layerX2 = lx2;
+    groupPtr->layerY2 = ly2;
+    groupPtr->flags &= ~GROUP_FLAG_DIRTY_LAYER;
+    canvasPtr->numLayersRendered++;
+    return TCL_OK;
+}
+
+static void
+GroupFreeLayer(GroupItem *groupPtr)
+{
+    if (groupPtr->layer != NULL) {
+	TkPathFree(groupPtr->layer);
+	groupPtr->layer = NULL;
+    }
+}
+
 /*
  * Local Variables:
  * mode: c
@@ -0,0 +1,602 @@
+/*
+ * tkCanvLite.c --
+ *
+ *	This file implements the lightweight lrect, lcircle and lellipse
+ *	canvas items. They have no drawing options of their own but
+ *	take them all from the named style set with -style, similar to
+ *	how TreeCtrl does it. This saves most of the per item memory
+ *	when there are very many items which look the same.
+ *
+ */
+
+#include "tkIntPath.h"
+#include "tkpCanvas.h"
+#include "tkCanvPathUtil.h"
+#include "tkPathStyle.h"
+
+/*
+ * The shape is kept in the bare bbox of the item header; the bounding
+ * rectangle of the ovals. Nothing more is needed.
+ */
+
+typedef struct LiteItem  {
+    Tk_PathItemLite headerLite;	/* Generic stuff that's the same for all
+				 * lightweight types.  MUST BE FIRST IN
+				 * STRUCTURE. */
+} LiteItem;
+
+#define LiteIsRect(itemPtr) ((itemPtr)->typePtr == &tkpLrectType)
+
+/*
+ * Prototypes for procedures defined in this file:
+ */
+
+static void	ComputeLiteBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr);
+static int	ConfigureLite(Tcl_Interp *interp, Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, Tcl_Size objc,
+			Tcl_Obj *const objv[], int flags);
+static int	CreateLite(Tcl_Interp *interp,
+			Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+			Tcl_Size objc, Tcl_Obj *const objv[]);
+static void	DeleteLite(Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, Display *display);
+static void	DisplayLite(Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, Display *display, Drawable drawable,
+			int x, int y, int width, int height);
+static void	LiteBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+			int mask);
+static int	LiteCoords(Tcl_Interp *interp,
+			Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+			Tcl_Size objc, Tcl_Obj *const objv[]);
+static int	LiteToArea(Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, double *rectPtr);
+static int	LiteToPdf(Tcl_Interp *interp,
+			Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+			Tcl_Size objc, Tcl_Obj *const objv[], int prepass);
+static double	LiteToPoint(Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, double *coordPtr);
+#ifndef TKP_NO_POSTSCRIPT
+static int	LiteToPostscript(Tcl_Interp *interp,
+			Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+			int prepass);
+#endif
+static void	ScaleLite(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+			int compensate, double originX, double originY,
+			double scaleX, double scaleY);
+static void	TranslateLite(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+			int compensate, double deltaX, double deltaY);
+static PathAtom * MakePathAtom(Tk_PathItem *itemPtr, PathRect *rectPtr,
+			RectAtom *rectAtomPtr, EllipseAtom *ellAtomPtr);
+static int	ProcessCoords(Tcl_Interp *interp, Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, Tcl_Size objc,
+			Tcl_Obj *const objv[]);
+
+PATH_CUSTOM_OPTION_TAGS
+PATH_OPTION_STRING_TABLES_STATE
+
+static Tk_OptionSpec optionSpecs[] = {
+    PATH_OPTION_SPEC_CORE(Tk_PathItemLite),
+    PATH_OPTION_SPEC_PARENT,
+    PATH_OPTION_SPEC_END
+};
+
+/*
+ * The structures below define the 'lrect', 'lcircle' and 'lellipse'
+ * item types by means of procedures that can be invoked by generic
+ * item code.
+ */
+
+Tk_PathItemType tkpLrectType = {
+    "lrect",				/* name */
+    sizeof(LiteItem),			/* itemSize */
+    CreateLite,				/* createProc */
+    optionSpecs,			/* optionSpecs */
+    ConfigureLite,			/* configureProc */
+    LiteCoords,				/* coordProc */
+    DeleteLite,				/* deleteProc */
+    DisplayLite,			/* displayProc */
+    0,					/* flags */
+    LiteBbox,				/* bboxProc */
+    LiteToPoint,			/* pointProc */
+    LiteToArea,				/* areaProc */
+#ifndef TKP_NO_POSTSCRIPT
+    LiteToPostscript,			/* postscriptProc */
+#endif
+    LiteToPdf,				/* pdfProc */
+    ScaleLite,				/* scaleProc */
+    TranslateLite,			/* translateProc */
+    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
+    (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
+    (Tk_PathItemInsertProc *) NULL,	/* insertProc */
+    (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
+    (Tk_PathItemType *) NULL,		/* nextPtr */
+    TK_PATH_TYPE_LITE,			/* isPathType */
+};
+
+Tk_PathItemType tkpLcircleType = {
+    "lcircle",				/* name */
+    sizeof(LiteItem),			/* itemSize */
+    CreateLite,				/* createProc */
+    optionSpecs,			/* optionSpecs */
+    ConfigureLite,			/* configureProc */
+    LiteCoords,				/* coordProc */
+    DeleteLite,				/* deleteProc */
+    DisplayLite,			/* displayProc */
+    0,					/* flags */
+    LiteBbox,				/* bboxProc */
+    LiteToPoint,			/* pointProc */
+    LiteToArea,				/* areaProc */
+#ifndef TKP_NO_POSTSCRIPT
+    LiteToPostscript,			/* postscriptProc */
+#endif
+    LiteToPdf,				/* pdfProc */
+    ScaleLite,				/* scaleProc */
+    TranslateLite,			/* translateProc */
+    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
+    (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
+    (Tk_PathItemInsertProc *) NULL,	/* insertProc */
+    (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
+    (Tk_PathItemType *) NULL,		/* nextPtr */
+    TK_PATH_TYPE_LITE,			/* isPathType */
+};
+
+Tk_PathItemType tkpLellipseType = {
+    "lellipse",				/* name */
+    sizeof(LiteItem),			/* itemSize */
+    CreateLite,				/* createProc */
+    optionSpecs,			/* optionSpecs */
+    ConfigureLite,			/* configureProc */
+    LiteCoords,				/* coordProc */
+    DeleteLite,				/* deleteProc */
+    DisplayLite,			/* displayProc */
+    0,					/* flags */
+    LiteBbox,				/* bboxProc */
+    LiteToPoint,			/* pointProc */
+    LiteToArea,				/* areaProc */
+#ifndef TKP_NO_POSTSCRIPT
+    LiteToPostscript,			/* postscriptProc */
+#endif
+    LiteToPdf,				/* pdfProc */
+    ScaleLite,				/* scaleProc */
+    TranslateLite,			/* translateProc */
+    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
+    (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
+    (Tk_PathItemInsertProc *) NULL,	/* insertProc */
+    (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
+    (Tk_PathItemType *) NULL,		/* nextPtr */
+    TK_PATH_TYPE_LITE,			/* isPathType */
+};
+
+static int
+CreateLite(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+        Tcl_Size objc, Tcl_Obj *const objv[])
+{
+    LiteItem *litePtr = (LiteItem *) itemPtr;
+    Tk_PathItemLite *itemLitePtr = &litePtr->headerLite;
+    Tk_OptionTable optionTable;
+    Tcl_Size	i;
+
+    if (objc == 0) {
+        Tcl_Panic("canvas did not pass any coords\n");
+    }
+
+    /*
+     * Carry out initialization that is needed to set defaults and to
+     * allow proper cleanup after errors during the the remainder of
+     * this procedure.
+     */
+    itemLitePtr->canvas = canvas;
+    itemLitePtr->styleObj = NULL;
+    itemLitePtr->styleInst = NULL;
+    itemPtr->bbox = NewEmptyPathRect();
+    itemPtr->totalBbox = NewEmptyPathRect();
+
+    optionTable = Tk_CreateOptionTable(interp, optionSpecs);
+    itemPtr->optionTable = optionTable;
+    if (Tk_InitOptions(interp, (char *) litePtr, optionTable,
+	    Tk_PathCanvasTkwin(canvas)) != TCL_OK) {
+        goto error;
+    }
+
+    for (i = 1; i < objc; i++) {
+        char *arg = Tcl_GetString(objv[i]);
+        if ((arg[0] == '-') && (arg[1] >= 'a') && (arg[1] <= 'z')) {
+            break;
+        }
+    }
+    if (ProcessCoords(interp, canvas, itemPtr, i, objv) != TCL_OK) {
+        goto error;
+    }
+    if (ConfigureLite(interp, canvas, itemPtr, objc-i, objv+i, 0) == TCL_OK) {
+        return TCL_OK;
+    }
+
+    error:
+    /*
+     * NB: We must unlink the item here since the TkPathCanvasItemExConfigure()
+     *     link it to the root by default.
+     */
+    TkPathCanvasItemDetach(itemPtr);
+    DeleteLite(canvas, itemPtr, Tk_Display(Tk_PathCanvasTkwin(canvas)));
+    return TCL_ERROR;
+}
+
+static int
+LiteCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        Tcl_Size objc, Tcl_Obj *const objv[])
+{
+    int result;
+
+    result = ProcessCoords(interp, canvas, itemPtr, objc, objv);
+    if ((result == TCL_OK) && (objc > 0)) {
+        ComputeLiteBbox(canvas, itemPtr);
+    }
+    return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * ProcessCoords --
+ *
+ *	Sets or gets the coords of a lightweight item. These are
+ *	x1 y1 x2 y2 for lrect, cx cy r for lcircle and cx cy rx ry
+ *	for lellipse. The shape is stored as the bare bbox.
+ *
+ * Results:
+ *	Standard tcl result.
+ *
+ * Side effects:
+ *	May set the bare bbox of the item.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+ProcessCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        Tcl_Size objc, Tcl_Obj *const objv[])
+{
+    PathRect *bboxPtr = &itemPtr->bbox;
+    double c[4];
+    int i, numCoords;
+
+    if (LiteIsRect(itemPtr)) {
+        return CoordsForRectangularItems(interp, canvas, bboxPtr, objc, objv);
+    }
+    numCoords = (itemPtr->typePtr == &tkpLcircleType) ? 3 : 4;
+    if (objc == 0) {
+        Tcl_Obj *obj = Tcl_NewObj();
+
+        c[0] = (bboxPtr->x1 + bboxPtr->x2)/2.0;
+        c[1] = (bboxPtr->y1 + bboxPtr->y2)/2.0;
+        c[2] = (bboxPtr->x2 - bboxPtr->x1)/2.0;
+        c[3] = (bboxPtr->y2 - bboxPtr->y1)/2.0;
+        for (i = 0; i < numCoords; i++) {
+            Tcl_ListObjAppendElement(interp, obj, Tcl_NewDoubleObj(c[i]));
+        }
+        Tcl_SetObjResult(interp, obj);
+        return TCL_OK;
+    }
+    if (objc == 1) {
+        if (Tcl_ListObjGetElements(interp, objv[0], &objc,
+                (Tcl_Obj ***) &objv) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    if (objc != numCoords) {
+        return TkpWrongNumberOfCoordinates(interp, 0, numCoords, objc);
+    }
+    for (i = 0; i < numCoords; i++) {
+        if (Tk_PathCanvasGetCoordFromObj(interp, canvas, objv[i], &c[i]) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    if (numCoords == 3) {
+        c[3] = c[2];
+    }
+    c[2] = MAX(0.0, c[2]);
+    c[3] = MAX(0.0, c[3]);
+    bboxPtr->x1 = c[0] - c[2];
+    bboxPtr->y1 = c[1] - c[3];
+    bboxPtr->x2 = c[0] + c[2];
+    bboxPtr->y2 = c[1] + c[3];
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * MakePathAtom --
+ *
+ *	Makes the single atom of a lightweight item in the memory
+ *	provided by the caller.
+ *
+ * Results:
+ *	The atom.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static PathAtom *
+MakePathAtom(Tk_PathItem *itemPtr, PathRect *rectPtr,
+        RectAtom *rectAtomPtr, EllipseAtom *ellAtomPtr)
+{
+    PathAtom *atomPtr;
+
+    if (LiteIsRect(itemPtr)) {
+        atomPtr = (PathAtom *) rectAtomPtr;
+        atomPtr->type = PATH_ATOM_RECT;
+        rectAtomPtr->x = rectPtr->x1;
+        rectAtomPtr->y = rectPtr->y1;
+        rectAtomPtr->width = rectPtr->x2 - rectPtr->x1;
+        rectAtomPtr->height = rectPtr->y2 - rectPtr->y1;
+    } else {
+        atomPtr = (PathAtom *) ellAtomPtr;
+        atomPtr->type = PATH_ATOM_ELLIPSE;
+        ellAtomPtr->cx = (rectPtr->x1 + rectPtr->x2)/2.0;
+        ellAtomPtr->cy = (rectPtr->y1 + rectPtr->y2)/2.0;
+        ellAtomPtr->rx = (rectPtr->x2 - rectPtr->x1)/2.0;
+        ellAtomPtr->ry = (rectPtr->y2 - rectPtr->y1)/2.0;
+    }
+    atomPtr->nextPtr = NULL;
+    return atomPtr;
+}
+
+static void
+ComputeLiteBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr)
+{
+    Tk_PathStyle style;
+    Tk_PathState state = itemPtr->state;
+
+    if (state == TK_PATHSTATE_NULL) {
+	state = TkPathCanvasState(canvas);
+    }
+    if (state == TK_PATHSTATE_HIDDEN) {
+        itemPtr->x1 = itemPtr->x2 = itemPtr->y1 = itemPtr->y2 = -1;
+        return;
+    }
+    style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
+    itemPtr->totalBbox = GetGenericPathTotalBboxFromBare(NULL, &style, &itemPtr->bbox);
+    SetGenericPathHeaderBbox(itemPtr, style.matrixPtr, &itemPtr->totalBbox);
+    TkPathCanvasFreeInheritedStyle(&style);
+}
+
+static int
+ConfigureLite(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        Tcl_Size objc, Tcl_Obj *const objv[], int flags)
+{
+    LiteItem *litePtr = (LiteItem *) itemPtr;
+    Tk_Window tkwin;
+    Tk_SavedOptions savedOptions;
+    Tcl_Obj *errorResult = NULL;
+    int mask, error;
+
+    tkwin = Tk_PathCanvasTkwin(canvas);
+    for (error = 0; error <= 1; error++) {
+	if (!error) {
+	    if (Tk_SetOptions(interp, (char *) litePtr, itemPtr->optionTable,
+		    objc, objv, tkwin, &savedOptions, &mask) != TCL_OK) {
+		continue;
+	    }
+	} else {
+	    errorResult = Tcl_GetObjResult(interp);
+	    Tcl_IncrRefCount(errorResult);
+	    Tk_RestoreSavedOptions(&savedOptions);
+	}
+
+	/*
+	 * There is no -fill option so the Tk_PathStyle part of
+	 * Tk_PathItemEx, which we don't have, is never touched.
+	 */
+	if (TkPathCanvasItemExConfigure(interp, canvas,
+		(Tk_PathItemEx *) litePtr, mask) != TCL_OK) {
+	    continue;
+	}
+
+	/*
+	 * If we reach this on the first pass we are OK and continue below.
+	 */
+	break;
+    }
+    if (!error) {
+	Tk_FreeSavedOptions(&savedOptions);
+    }
+    if (error) {
+	Tcl_SetObjResult(interp, errorResult);
+	Tcl_DecrRefCount(errorResult);
+	return TCL_ERROR;
+    } else {
+	ComputeLiteBbox(canvas, itemPtr);
+	return TCL_OK;
+    }
+}
+
+static void
+DeleteLite(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display)
+{
+    Tk_PathItemLite *itemLitePtr = (Tk_PathItemLite *) itemPtr;
+
+    if (itemLitePtr->styleInst != NULL) {
+	TkPathFreeStyle(itemLitePtr->styleInst);
+    }
+    Tk_FreeConfigOptions((char *) itemPtr, itemPtr->optionTable,
+			 Tk_PathCanvasTkwin(canvas));
+}
+
+static void
+DisplayLite(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display, Drawable drawable,
+        int x, int y, int width, int height)
+{
+    TMatrix m = GetCanvasTMatrix(canvas);
+    PathAtom *atomPtr;
+    RectAtom rectAtom;
+    EllipseAtom ellAtom;
+    Tk_PathStyle style;
+
+    /*
+     * We create the atom on the fly to save some memory.
+     */
+    atomPtr = MakePathAtom(itemPtr, &itemPtr->bbox, &rectAtom, &ellAtom);
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    TkPathDrawPath(ContextOfCanvas(canvas), atomPtr, &style,
+	    &m, &itemPtr->bbox);
+    TkPathCanvasFreeInheritedStyle(&style);
+}
+
+static void
+LiteBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int mask)
+{
+    ComputeLiteBbox(canvas, itemPtr);
+}
+
+static double
+LiteToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
+{
+    Tk_PathStyle style;
+    TMatrix *mPtr;
+    double bare[4], width, dist;
+    int filled;
+
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    filled = HaveAnyFillFromPathColor(style.fill);
+    width = 0.0;
+    if (style.strokeColor != NULL) {
+        width = style.strokeWidth;
+    }
+    mPtr = style.matrixPtr;
+    bare[0] = itemPtr->bbox.x1;
+    bare[1] = itemPtr->bbox.y1;
+    bare[2] = itemPtr->bbox.x2;
+    bare[3] = itemPtr->bbox.y2;
+    if ((mPtr == NULL) || (TMATRIX_IS_RECTILINEAR(mPtr))) {
+        if (mPtr != NULL) {
+            bare[0] = mPtr->a * bare[0] + mPtr->tx;
+            bare[1] = mPtr->d * bare[1] + mPtr->ty;
+            bare[2] = mPtr->a * bare[2] + mPtr->tx;
+            bare[3] = mPtr->d * bare[3] + mPtr->ty;
+        }
+        if (LiteIsRect(itemPtr)) {
+            dist = PathRectToPoint(bare, width, filled, pointPtr);
+        } else {
+            dist = TkOvalToPoint(bare, width, filled, pointPtr);
+        }
+    } else {
+        PathAtom *atomPtr;
+        RectAtom rectAtom;
+        EllipseAtom ellAtom;
+
+        atomPtr = MakePathAtom(itemPtr, &itemPtr->bbox, &rectAtom, &ellAtom);
+        dist = GenericPathToPoint(canvas, itemPtr, &style, atomPtr,
+                kPathNumSegmentsEllipse+1, pointPtr);
+    }
+    TkPathCanvasFreeInheritedStyle(&style);
+    return dist;
+}
+
+static int
+LiteToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
+{
+    Tk_PathStyle style;
+    TMatrix *mPtr;
+    double bare[4], width;
+    int filled, result;
+
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    filled = HaveAnyFillFromPathColor(style.fill);
+    width = 0.0;
+    if (style.strokeColor != NULL) {
+        width = style.strokeWidth;
+    }
+    mPtr = style.matrixPtr;
+    if (LiteIsRect(itemPtr)
+            && ((mPtr == NULL) || (TMATRIX_IS_RECTILINEAR(mPtr)))) {
+        bare[0] = itemPtr->bbox.x1;
+        bare[1] = itemPtr->bbox.y1;
+        bare[2] = itemPtr->bbox.x2;
+        bare[3] = itemPtr->bbox.y2;
+        if (mPtr != NULL) {
+            bare[0] = mPtr->a * bare[0] + mPtr->tx;
+            bare[1] = mPtr->d * bare[1] + mPtr->ty;
+            bare[2] = mPtr->a * bare[2] + mPtr->tx;
+            bare[3] = mPtr->d * bare[3] + mPtr->ty;
+        }
+        result = PathRectToArea(bare, width, filled, areaPtr);
+    } else {
+        PathAtom *atomPtr;
+        RectAtom rectAtom;
+        EllipseAtom ellAtom;
+
+        atomPtr = MakePathAtom(itemPtr, &itemPtr->bbox, &rectAtom, &ellAtom);
+        result = GenericPathToArea(canvas, itemPtr, &style, atomPtr,
+                kPathNumSegmentsEllipse+1, areaPtr);
+    }
+    TkPathCanvasFreeInheritedStyle(&style);
+    return result;
+}
+
+static int
+LiteToPdf(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+    Tcl_Size objc, Tcl_Obj *const objv[], int prepass)
+{
+    Tk_PathStyle style;
+    PathAtom *atomPtr;
+    RectAtom rectAtom;
+    EllipseAtom ellAtom;
+    Tk_PathState state = itemPtr->state;
+    int result;
+
+    if (state == TK_PATHSTATE_NULL) {
+	state = TkPathCanvasState(canvas);
+    }
+    if (state == TK_PATHSTATE_HIDDEN) {
+	return TCL_OK;
+    }
+    atomPtr = MakePathAtom(itemPtr, &itemPtr->bbox, &rectAtom, &ellAtom);
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    result = TkPathPdf(interp, atomPtr, &style, &itemPtr->bbox, objc, objv);
+    TkPathCanvasFreeInheritedStyle(&style);
+    return result;
+}
+
+#ifndef TKP_NO_POSTSCRIPT
+static int
+LiteToPostscript(Tcl_Interp *interp, Tk_PathCanvas canvas,
+    Tk_PathItem *itemPtr, int prepass)
+{
+    return TCL_ERROR;
+}
+#endif
+
+static void
+ScaleLite(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int compensate,
+    double originX, double originY, double scaleX, double scaleY)
+{
+    CompensateScale(itemPtr, compensate, &originX, &originY, &scaleX, &scaleY);
+
+    ScalePathRect(&itemPtr->bbox, originX, originY, scaleX, scaleY);
+    ScaleItemHeader(itemPtr, originX, originY, scaleX, scaleY);
+}
+
+static void
+TranslateLite(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int compensate,
+    double deltaX, double deltaY)
+{
+    CompensateTranslate(itemPtr, compensate, &deltaX, &deltaY);
+
+    TranslatePathRect(&itemPtr->bbox, deltaX, deltaY);
+    TranslateItemHeader(itemPtr, deltaX, deltaY);
+}
+
+/*
+ * Local Variables:
+ * mode: c
+ * c-basic-offset: 4
+ * fill-column: 78
+ * End:
+ */
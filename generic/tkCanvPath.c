@@ -30,7 +30,9 @@ typedef struct PathItem  {
     Tcl_Obj *pathObjPtr;    /* The object containing the path definition. */
     int pathLen;
     Tcl_Obj *normPathObjPtr;/* The object containing the normalized path. */
-    PathAtom *atomPtr;
+    TkPathData *dataPtr;    /* Parsed path shared with pathObjPtr, or NULL
+                             * if atomPtr is a private copy. */
+    PathAtom *atomPtr;      /* Either dataPtr->atomPtr or our own atoms. */
     int maxNumSegments;     /* Max number of straight segments (for subpath)
                              * needed for Area and Point functions. */
     ArrowDescr startarrow;
@@ -85,6 +87,8 @@ static int      ConfigureArrows(Tk_PathCanvas canvas, PathItem *pathPtr);
 /* Support functions. */
 
 static int		GetSubpathMaxNumSegments(PathAtom *atomPtr);
+static void		MakePathAtomsPrivate(PathItem *pathPtr);
+static void		FreePathAtoms(PathItem *pathPtr);
 
 
 PATH_STYLE_CUSTOM_OPTION_RECORDS
@@ -205,6 +209,7 @@ CreatePath(
     pathPtr->pathObjPtr = NULL;
     pathPtr->pathLen = 0;
     pathPtr->normPathObjPtr = NULL;
+    pathPtr->dataPtr = NULL;
     pathPtr->atomPtr = NULL;
     itemPtr->bbox = NewEmptyPathRect();
     itemPtr->totalBbox = NewEmptyPathRect();
@@ -273,8 +278,7 @@ ProcessPath(
     Tcl_Obj *const objv[])  /*  */
 {
     PathItem *pathPtr = (PathItem *) itemPtr;
-    PathAtom *atomPtr = NULL;
-    Tcl_Size len;
+    TkPathData *dataPtr;
     int result;
 
     if (objc == 0) {
@@ -295,20 +299,24 @@ ProcessPath(
         Tcl_SetObjResult(interp, pathPtr->normPathObjPtr);
         return TCL_OK;
     } else if (objc == 1) {
-        result = TkPathParseToAtoms(interp, objv[0], &atomPtr, &len);
+        /*
+         * The parsed atoms are cached in objv[0] and shared until
+         * the item needs to modify them, see MakePathAtomsPrivate.
+         */
+        result = TkPathGetDataFromObj(interp, objv[0], &dataPtr);
         if (result == TCL_OK) {
 
             /* Free any old atoms. */
-            if (pathPtr->atomPtr != NULL) {
-                TkPathFreeAtoms(pathPtr->atomPtr);
-            }
-            pathPtr->atomPtr = atomPtr;
-            pathPtr->pathLen = len;
+            FreePathAtoms(pathPtr);
+            pathPtr->dataPtr = dataPtr;
+            pathPtr->atomPtr = dataPtr->atomPtr;
+            pathPtr->pathLen = dataPtr->len;
             if (pathPtr->pathObjPtr != NULL) {
 		Tcl_DecrRefCount(pathPtr->pathObjPtr);
 	    }
             pathPtr->pathObjPtr = objv[0];
-            pathPtr->maxNumSegments = GetSubpathMaxNumSegments(atomPtr);
+            pathPtr->maxNumSegments =
+		    GetSubpathMaxNumSegments(pathPtr->atomPtr);
             Tcl_IncrRefCount(pathPtr->pathObjPtr);
             pathPtr->flags |= kPathItemNeedNewNormalizedPath;
         }
@@ -400,7 +408,11 @@ ComputePathBbox(
      * Get an approximation of the path's bounding box
      * assuming zero stroke width.
      */
-    itemPtr->bbox = GetGenericBarePathBbox(pathPtr->atomPtr);
+    if (pathPtr->dataPtr != NULL) {
+	itemPtr->bbox = pathPtr->dataPtr->bbox;
+    } else {
+	itemPtr->bbox = GetGenericBarePathBbox(pathPtr->atomPtr);
+    }
     IncludeArrowPointsInRect(&itemPtr->bbox, &pathPtr->startarrow);
     IncludeArrowPointsInRect(&itemPtr->bbox, &pathPtr->endarrow);
     itemPtr->totalBbox = GetGenericPathTotalBboxFromBare(pathPtr->atomPtr,
@@ -417,8 +429,17 @@ ConfigureArrows(
     PathPoint psecond;
     PathPoint ppenult;
     PathPoint *plastp;
+    int error;
 
-    int error = GetSegmentsFromPathAtomList(pathPtr->atomPtr, &pfirstp,
+    /*
+     * Arrows move the end points, which must not be done on shared atoms.
+     */
+    if (pathPtr->startarrow.arrowEnabled || pathPtr->endarrow.arrowEnabled
+	    || (pathPtr->startarrow.arrowPointsPtr != NULL)
+	    || (pathPtr->endarrow.arrowPointsPtr != NULL)) {
+	MakePathAtomsPrivate(pathPtr);
+    }
+    error = GetSegmentsFromPathAtomList(pathPtr->atomPtr, &pfirstp,
 			&psecond, &ppenult, &plastp);
 
     if (error == TCL_OK) {
@@ -563,10 +584,7 @@ DeletePath(
     if (pathPtr->normPathObjPtr != NULL) {
         Tcl_DecrRefCount(pathPtr->normPathObjPtr);
     }
-    if (pathPtr->atomPtr != NULL) {
-        TkPathFreeAtoms(pathPtr->atomPtr);
-        pathPtr->atomPtr = NULL;
-    }
+    FreePathAtoms(pathPtr);
     TkPathFreeArrow(&pathPtr->startarrow);
     TkPathFreeArrow(&pathPtr->endarrow);
     Tk_FreeConfigOptions((char *) pathPtr, itemPtr->optionTable,
@@ -664,11 +682,25 @@ PathToPoint(
     PathItem        *pathPtr = (PathItem *) itemPtr;
     PathAtom        *atomPtr = pathPtr->atomPtr;
     Tk_PathStyle style;
-    double dist;
+    double dist, d;
 
     style = TkPathCanvasInheritStyle(itemPtr, 0);
     dist = GenericPathToPoint(canvas, itemPtr, &style, atomPtr,
             pathPtr->maxNumSegments, pointPtr);
+
+    /*
+     * Arrowheads are part of the item for picking.
+     */
+    d = TkPathArrowToPoint(canvas, itemPtr, &pathPtr->startarrow, &style,
+	    pointPtr);
+    if (d < dist) {
+	dist = d;
+    }
+    d = TkPathArrowToPoint(canvas, itemPtr, &pathPtr->endarrow, &style,
+	    pointPtr);
+    if (d < dist) {
+	dist = d;
+    }
     TkPathCanvasFreeInheritedStyle(&style);
     return dist;
 }
@@ -772,6 +804,46 @@ GetArcNumSegments(double currentX, double currentY, ArcAtom *arc)
     return numSteps;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * MakePathAtomsPrivate --
+ *
+ *	Replaces the atoms shared with the path object by a copy
+ *	owned by the item. Must be called before the atoms are
+ *	modified.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The reference to the shared path data is released.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+MakePathAtomsPrivate(PathItem *pathPtr)
+{
+    if (pathPtr->dataPtr != NULL) {
+	pathPtr->atomPtr = TkPathCopyAtoms(pathPtr->dataPtr->atomPtr);
+	TkPathReleaseData(pathPtr->dataPtr);
+	pathPtr->dataPtr = NULL;
+    }
+}
+
+static void
+FreePathAtoms(PathItem *pathPtr)
+{
+    if (pathPtr->dataPtr != NULL) {
+	TkPathReleaseData(pathPtr->dataPtr);
+	pathPtr->dataPtr = NULL;
+    } else if (pathPtr->atomPtr != NULL) {
+	TkPathFreeAtoms(pathPtr->atomPtr);
+    }
+    pathPtr->atomPtr = NULL;
+}
+
 static int
 GetSubpathMaxNumSegments(PathAtom *atomPtr)
 {
@@ -920,9 +992,11 @@ ScalePath(
     double scaleY)                  /* Amount to scale in Y direction. */
 {
     PathItem *pathPtr = (PathItem *) itemPtr;
-    PathAtom *atomPtr = pathPtr->atomPtr;
+    PathAtom *atomPtr;
 
     CompensateScale(itemPtr, compensate, &originX, &originY, &scaleX, &scaleY);
+    MakePathAtomsPrivate(pathPtr);
+    atomPtr = pathPtr->atomPtr;
 
     /* @@@ TODO: Arc atoms with nonzero rotation angle is WRONG! */
 
@@ -971,9 +1045,11 @@ TranslatePath(
     double deltaY)              /* moved. */
 {
     PathItem *pathPtr = (PathItem *) itemPtr;
-    PathAtom *atomPtr = pathPtr->atomPtr;
+    PathAtom *atomPtr;
 
     CompensateTranslate(itemPtr, compensate, &deltaX, &deltaY);
+    MakePathAtomsPrivate(pathPtr);
+    atomPtr = pathPtr->atomPtr;
 
     TranslatePathAtoms(atomPtr, deltaX, deltaY);
 
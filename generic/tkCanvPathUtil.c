@@ -20,6 +20,17 @@
 
 #define MAX_NUM_STATIC_SEGMENTS  2000
 
+/*
+ * Antialiased edges may touch the pixels just outside the geometry.
+ * The integer header bbox is grown by this many pixels on each side.
+ */
+#define kPathAntialiasOutset	1
+
+/*
+ * Limit for integer header coordinates, keeps the conversion well defined.
+ */
+#define kPathMaxHeaderCoord	1.0e9
+
 static void		MakeSubPathSegments(PathAtom **atomPtrPtr, double *polyPtr,
                         int *numPointsPtr, int *numStrokesPtr, TMatrix *matrixPtr);
 static int		SubPathToArea(Tk_PathStyle *stylePtr, double *polyPtr, int numPoints,
@@ -148,6 +159,229 @@ CoordsForRectangularItems(
     return TCL_OK;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * CoordsForMultiShapeItems --
+ *
+ *	Parses the coords for items that may hold many shapes of
+ *	the same kind, numPerShape coordinates each, on a single item.
+ *	Accepts either a flat list or the coordinates as separate
+ *	arguments.
+ *
+ * Results:
+ *	Standard tcl result.
+ *
+ * Side effects:
+ *	On success, *coordsPtrPtr points to a newly allocated array
+ *	of numPerShape * *numShapesPtr doubles which the caller owns.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+CoordsForMultiShapeItems(
+        Tcl_Interp *interp,
+        Tk_PathCanvas canvas,
+        int numPerShape,		/* Number of coords for each shape. */
+        Tcl_Size objc,
+        Tcl_Obj *const objv[],
+        double **coordsPtrPtr,		/* Returns the allocated coords. */
+        int *numShapesPtr)		/* Returns the number of shapes. */
+{
+    double *coordsPtr;
+    Tcl_Size i;
+
+    if (objc == 1) {
+        if (Tcl_ListObjGetElements(interp, objv[0], &objc,
+                (Tcl_Obj ***) &objv) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    if ((objc == 0) || (objc % numPerShape != 0)) {
+        Tcl_SetObjResult(interp,
+            Tcl_ObjPrintf("wrong # coordinates: expected a multiple of %d, got %"
+                          TCL_SIZE_MODIFIER "d", numPerShape, objc));
+        return TCL_ERROR;
+    }
+    coordsPtr = (double *) ckalloc((unsigned) (objc * sizeof(double)));
+    for (i = 0; i < objc; i++) {
+        if (Tk_PathCanvasGetCoordFromObj(interp, canvas, objv[i],
+                coordsPtr + i) != TCL_OK) {
+            ckfree((char *) coordsPtr);
+            return TCL_ERROR;
+        }
+    }
+    *coordsPtrPtr = coordsPtr;
+    *numShapesPtr = (int) (objc / numPerShape);
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * MultiShapeCoordsObj --
+ *
+ *	Makes a flat list object of the coords of a multi shape item.
+ *
+ * Results:
+ *	A Tcl_Obj list with zero reference count.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+Tcl_Obj *
+MultiShapeCoordsObj(double *coordsPtr, int numCoords)
+{
+    Tcl_Obj *obj = Tcl_NewObj();
+    int i;
+
+    for (i = 0; i < numCoords; i++) {
+        Tcl_ListObjAppendElement(NULL, obj, Tcl_NewDoubleObj(coordsPtr[i]));
+    }
+    return obj;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * MultiShapeToPoint, MultiShapeToArea --
+ *
+ *	Hit testing for items holding many shapes. The shapes are
+ *	tested in turn from the topmost (last) one using the item
+ *	specific proc.
+ *
+ * Results:
+ *	MultiShapeToPoint returns the smallest distance and the
+ *	index of the closest shape in *shapePtr, if not NULL.
+ *	MultiShapeToArea returns -1, 0 or 1 as for any areaProc.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+double
+MultiShapeToPoint(
+    Tk_PathCanvas canvas,
+    Tk_PathItem *itemPtr,
+    Tk_PathStyle *stylePtr,	/* The items inherited style. */
+    int numShapes,
+    PathShapeToPointProc *proc,
+    double *pointPtr,
+    int *shapePtr)		/* Returns the closest shape, or NULL. */
+{
+    double dist, bestDist = 1.0e36;
+    int i, best = 0;
+
+    for (i = numShapes-1; i >= 0; i--) {
+        dist = (*proc)(canvas, itemPtr, stylePtr, i, pointPtr);
+        if (dist < bestDist) {
+            bestDist = dist;
+            best = i;
+            if (bestDist <= 0.0) {
+                break;
+            }
+        }
+    }
+    if (shapePtr != NULL) {
+        *shapePtr = best;
+    }
+    return bestDist;
+}
+
+int
+MultiShapeToArea(
+    Tk_PathCanvas canvas,
+    Tk_PathItem *itemPtr,
+    Tk_PathStyle *stylePtr,	/* The items inherited style. */
+    int numShapes,
+    PathShapeToAreaProc *proc,
+    double *areaPtr)
+{
+    int i, area, inside;
+
+    inside = (*proc)(canvas, itemPtr, stylePtr, 0, areaPtr);
+    for (i = 1; (i < numShapes) && (inside != 0); i++) {
+        area = (*proc)(canvas, itemPtr, stylePtr, i, areaPtr);
+        if (area != inside) {
+            inside = 0;
+        }
+    }
+    return inside;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * GetMultiShapeIndex --
+ *
+ *	Used as indexProc for items holding many shapes. The index
+ *	is either an integer, "end", or "@x,y" which picks the
+ *	topmost shape closest to that point.
+ *
+ * Results:
+ *	Standard tcl result.
+ *
+ * Side effects:
+ *	The shape index is stored in *indexPtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+GetMultiShapeIndex(
+    Tcl_Interp *interp,
+    Tk_PathCanvas canvas,
+    Tk_PathItem *itemPtr,
+    Tk_PathStyle *stylePtr,	/* The items inherited style. */
+    int numShapes,
+    PathShapeToPointProc *proc,
+    Tcl_Obj *obj,		/* Index specification. */
+    int *indexPtr)		/* Where to store converted index. */
+{
+    Tcl_Size length;
+    char *string = Tcl_GetStringFromObj(obj, &length);
+
+    if (string[0] == 'e') {
+        if (strncmp(string, "end", (unsigned) length) != 0) {
+            goto badIndex;
+        }
+        *indexPtr = numShapes-1;
+    } else if (string[0] == '@') {
+        double point[2];
+        char *end, *p;
+
+        p = string+1;
+        point[0] = strtod(p, &end);
+        if ((end == p) || (*end != ',')) {
+            goto badIndex;
+        }
+        p = end+1;
+        point[1] = strtod(p, &end);
+        if ((end == p) || (*end != 0)) {
+            goto badIndex;
+        }
+        MultiShapeToPoint(canvas, itemPtr, stylePtr, numShapes, proc,
+                point, indexPtr);
+    } else {
+        if (Tcl_GetIntFromObj(interp, obj, indexPtr) != TCL_OK) {
+            goto badIndex;
+        }
+        *indexPtr = MAX(0, MIN(numShapes-1, *indexPtr));
+    }
+    return TCL_OK;
+
+badIndex:
+    Tcl_SetResult(interp, NULL, TCL_STATIC);
+    Tcl_AppendResult(interp, "bad index \"", string, "\"", NULL);
+    return TCL_ERROR;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -729,7 +963,11 @@ GetGenericPathTotalBboxFromBare(PathAtom *atomPtr, Tk_PathStyle *stylePtr, PathR
  * SetGenericPathHeaderBbox --
  *
  *	This procedure sets the (transformed) bbox in the items header.
- *	It is a (too?) conservative measure.
+ *	It is a (too?) conservative measure. The integer header is
+ *	always derived from the double precision totalBbox, rounded
+ *	outwards and grown by kPathAntialiasOutset, so that it covers
+ *	every pixel the item touches and never drifts when the item is
+ *	moved in small steps.
  *
  * Results:
  *	None.
@@ -750,6 +988,11 @@ SetGenericPathHeaderBbox(
     PathRect rect;
 
     rect = *totalBboxPtr;
+    if ((rect.x1 > rect.x2) && (rect.x1 > kPathMaxHeaderCoord)) {
+	/* Empty, see NewEmptyPathRect. Nothing to draw or pick. */
+	headerPtr->x1 = headerPtr->x2 = headerPtr->y1 = headerPtr->y2 = -1;
+	return;
+    }
 
     if (mPtr != NULL) {
         double x, y;
@@ -773,10 +1016,56 @@ SetGenericPathHeaderBbox(
         IncludePointInRect(&r, x, y);
         rect = r;
     }
-    headerPtr->x1 = (int) rect.x1;
-    headerPtr->x2 = (int) rect.x2;
-    headerPtr->y1 = (int) rect.y1;
-    headerPtr->y2 = (int) rect.y2;
+    if (rect.x1 > rect.x2) {
+	double tmp = rect.x1;
+	rect.x1 = rect.x2, rect.x2 = tmp;
+    }
+    if (rect.y1 > rect.y2) {
+	double tmp = rect.y1;
+	rect.y1 = rect.y2, rect.y2 = tmp;
+    }
+    rect.x1 = MAX(-kPathMaxHeaderCoord, MIN(kPathMaxHeaderCoord, rect.x1));
+    rect.y1 = MAX(-kPathMaxHeaderCoord, MIN(kPathMaxHeaderCoord, rect.y1));
+    rect.x2 = MAX(-kPathMaxHeaderCoord, MIN(kPathMaxHeaderCoord, rect.x2));
+    rect.y2 = MAX(-kPathMaxHeaderCoord, MIN(kPathMaxHeaderCoord, rect.y2));
+    headerPtr->x1 = (int) floor(rect.x1) - kPathAntialiasOutset;
+    headerPtr->y1 = (int) floor(rect.y1) - kPathAntialiasOutset;
+    headerPtr->x2 = (int) ceil(rect.x2) + kPathAntialiasOutset;
+    headerPtr->y2 = (int) ceil(rect.y2) + kPathAntialiasOutset;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * EventuallyRedrawPathRect --
+ *
+ *	Schedules a redraw of part of an item given as an untransformed
+ *	total bbox. Used by items that repaint only the region touched
+ *	by an edit and then set TK_ITEM_DONT_REDRAW.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The area covered by rectPtr, after mPtr, is damaged with the
+ *	same rounding as SetGenericPathHeaderBbox.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+EventuallyRedrawPathRect(
+        Tk_PathCanvas canvas,
+        TMatrix *mPtr,
+        PathRect *rectPtr)
+{
+    Tk_PathItem header;
+
+    SetGenericPathHeaderBbox(&header, mPtr, rectPtr);
+    if (header.x1 < header.x2) {
+	Tk_PathCanvasEventuallyRedraw(canvas, header.x1, header.y1,
+		header.x2, header.y2);
+    }
 }
 
 /*
@@ -1941,8 +2230,11 @@ TranslateItemHeader(Tk_PathItem *itemPtr, double deltaX, double deltaY)
 {
     TranslatePathRect(&itemPtr->totalBbox, deltaX, deltaY);
 
-    /* @@@ TODO: Beware for cumulated round-off errors! */
-    /* If all coords == -1 the item is hidden. */
+    /*
+     * The header is recomputed from the translated totalBbox
+     * and not translated itself, which would cumulate round-off errors.
+     * If all coords == -1 the item is hidden.
+     */
     if ((itemPtr->x1 != -1) || (itemPtr->x2 != -1) ||
 	    (itemPtr->y1 != -1) || (itemPtr->y2 != -1)) {
 	Tk_PathStyle style;
@@ -1959,25 +2251,18 @@ ScaleItemHeader(Tk_PathItem *itemPtr, double originX, double originY,
 {
     ScalePathRect(&itemPtr->totalBbox, originX, originY, scaleX, scaleY);
 
-    /* @@@ TODO: Beware for cumulated round-off errors! */
-    /* If all coords == -1 the item is hidden. */
+    /*
+     * As for TranslateItemHeader. A negative scale is normalized
+     * by SetGenericPathHeaderBbox.
+     * If all coords == -1 the item is hidden.
+     */
     if ((itemPtr->x1 != -1) || (itemPtr->x2 != -1) ||
 	    (itemPtr->y1 != -1) || (itemPtr->y2 != -1)) {
-	int min, max;
 	Tk_PathStyle style;
 
 	style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
 	SetGenericPathHeaderBbox(itemPtr, style.matrixPtr, &itemPtr->totalBbox);
 	TkPathCanvasFreeInheritedStyle(&style);
-
-	min = MIN(itemPtr->x1, itemPtr->x2);
-	max = MAX(itemPtr->x1, itemPtr->x2);
-	itemPtr->x1 = min;
-	itemPtr->x2 = max;
-	min = MIN(itemPtr->y1, itemPtr->y2);
-	max = MAX(itemPtr->y1, itemPtr->y2);
-	itemPtr->y1 = min;
-	itemPtr->y2 = max;
     }
 }
 
@@ -2620,7 +2905,8 @@ PathRectToPointWithMatrix(PathRect bbox, TMatrix *mPtr, double *pointPtr)
  * TkPathCanvasItemExConfigure --
  *
  *      Takes care of the custom item configuration of the Tk_PathItemEx
- *	part of any item with style.
+ *	part of any item with style. Lightweight items may be passed
+ *	here too as long as they don't have any -fill option.
  *
  * Results:
  *	Standard Tcl result.
@@ -2637,7 +2923,6 @@ TkPathCanvasItemExConfigure(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathIte
     Tk_Window tkwin;
     Tk_PathItem *parentPtr;
     Tk_PathItem *itemPtr = (Tk_PathItem *) itemExPtr;
-    Tk_PathStyle *stylePtr = &itemExPtr->style;
 
     tkwin = Tk_PathCanvasTkwin(canvas);
     if (mask & PATH_CORE_OPTION_PARENT) {
@@ -2681,6 +2966,7 @@ TkPathCanvasItemExConfigure(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathIte
      * We MUST have this last in the chain of custom option checks!
      */
     if (mask & PATH_STYLE_OPTION_FILL) {
+	Tk_PathStyle *stylePtr = &itemExPtr->style;
 	TkPathColor *fillPtr = NULL;
 
 	if (stylePtr->fillObj != NULL) {
@@ -2720,6 +3006,7 @@ PathGradientChangedProc(ClientData clientData, int flags)
 	    GroupItemConfigured(itemExPtr->canvas, itemPtr,
 		    PATH_STYLE_OPTION_FILL);
 	} else {
+	    SetAncestorsDirtyBbox(itemPtr);
 	    Tk_PathCanvasEventuallyRedraw(itemExPtr->canvas,
 		    itemExPtr->header.x1, itemExPtr->header.y1,
 		    itemExPtr->header.x2, itemExPtr->header.y2);
@@ -2745,6 +3032,7 @@ PathStyleChangedProc(ClientData clientData, int flags)
 		    PATH_CORE_OPTION_STYLENAME);
 	    /* Not completely correct... */
 	} else {
+	    SetAncestorsDirtyBbox(itemPtr);
 	    Tk_PathCanvasEventuallyRedraw(itemExPtr->canvas,
 		    itemExPtr->header.x1, itemExPtr->header.y1,
 		    itemExPtr->header.x2, itemExPtr->header.y2);
@@ -16,17 +16,48 @@
 extern "C" {
 #endif
 
+/*
+ * Hit test procs for a single shape of an item holding many shapes.
+ */
+
+typedef double	(PathShapeToPointProc)(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, Tk_PathStyle *stylePtr, int shape,
+		    double *pointPtr);
+typedef int	(PathShapeToAreaProc)(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, Tk_PathStyle *stylePtr, int shape,
+		    double *areaPtr);
+
 MODULE_SCOPE int	CoordsForPointItems(Tcl_Interp *interp,
 			    Tk_PathCanvas canvas,
 			    double *pointPtr, Tcl_Size objc, Tcl_Obj *const objv[]);
 MODULE_SCOPE int	CoordsForRectangularItems(Tcl_Interp *interp,
 			    Tk_PathCanvas canvas,
 			    PathRect *rectPtr, Tcl_Size objc, Tcl_Obj *const objv[]);
+MODULE_SCOPE int	CoordsForMultiShapeItems(Tcl_Interp *interp,
+			    Tk_PathCanvas canvas, int numPerShape,
+			    Tcl_Size objc, Tcl_Obj *const objv[],
+			    double **coordsPtrPtr, int *numShapesPtr);
+MODULE_SCOPE Tcl_Obj *	MultiShapeCoordsObj(double *coordsPtr, int numCoords);
+MODULE_SCOPE double	MultiShapeToPoint(Tk_PathCanvas canvas,
+			    Tk_PathItem *itemPtr, Tk_PathStyle *stylePtr,
+			    int numShapes, PathShapeToPointProc *proc,
+			    double *pointPtr, int *shapePtr);
+MODULE_SCOPE int	MultiShapeToArea(Tk_PathCanvas canvas,
+			    Tk_PathItem *itemPtr, Tk_PathStyle *stylePtr,
+			    int numShapes, PathShapeToAreaProc *proc,
+			    double *areaPtr);
+MODULE_SCOPE int	GetMultiShapeIndex(Tcl_Interp *interp,
+			    Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+			    Tk_PathStyle *stylePtr, int numShapes,
+			    PathShapeToPointProc *proc, Tcl_Obj *obj,
+			    int *indexPtr);
 MODULE_SCOPE PathRect	GetGenericBarePathBbox(PathAtom *atomPtr);
 MODULE_SCOPE PathRect	GetGenericPathTotalBboxFromBare(PathAtom *atomPtr,
 			    Tk_PathStyle *stylePtr, PathRect *bboxPtr);
 MODULE_SCOPE void	SetGenericPathHeaderBbox(Tk_PathItem *headerPtr,
 			    TMatrix *mPtr, PathRect *totalBboxPtr);
+MODULE_SCOPE void	EventuallyRedrawPathRect(Tk_PathCanvas canvas,
+			    TMatrix *mPtr, PathRect *rectPtr);
 MODULE_SCOPE TMatrix	GetCanvasTMatrix(Tk_PathCanvas canvas);
 MODULE_SCOPE PathRect	NewEmptyPathRect(void);
 MODULE_SCOPE int	IsPathRectEmpty(PathRect *r);
@@ -38,6 +38,12 @@ typedef struct PimageItem  {
 			     * NULL means no image right now. */
     Tk_Image image;	    /* Image to display in window, or NULL if
                              * no image at present. */
+    Tk_PhotoHandle photo;   /* The photo of image, looked up when the
+			     * image is set or changes. */
+    void *custom;	    /* The photo as converted by TkPathImage,
+			     * kept until it changes. */
+    int opaque;		    /* 1 if all pixels of the photo are opaque,
+			     * 0 if not, -1 if not known yet. */
     double width;	    /* If 0 use natural width or height. */
     double height;
     Tk_Anchor anchor;       /* Where to anchor image relative to (x,y). */
@@ -70,6 +76,11 @@ static int	PimageCoords(Tcl_Interp *interp,
 		    Tcl_Size objc, Tcl_Obj *const objv[]);
 static int	PimageToArea(Tk_PathCanvas canvas,
 		    Tk_PathItem *itemPtr, double *rectPtr);
+static int	PimagePdfImage(Tcl_Interp *interp, PimageItem *pimagePtr,
+		    Tk_PhotoImageBlock *blockPtr, Tcl_Obj *mkimage,
+		    Tcl_Obj **namePtrPtr);
+static Tcl_Obj *PimagePdfStream(Tcl_Interp *interp, const char *dict,
+		    Tcl_Obj *pixObj);
 static int	PimageToPdf(Tcl_Interp *interp, Tk_PathCanvas canvas,
 		    Tk_PathItem *item, Tcl_Size objc, Tcl_Obj *const objv[],
 		    int prepass);
@@ -88,6 +99,8 @@ static void	ImageChangedProc(ClientData clientData,
 		    int x, int y, int width, int height, int imgWidth,
 		    int imgHeight);
 static void	PimageStyleChangedProc(ClientData clientData, int flags);
+static int	PhotoIsOpaque(Tk_PhotoHandle photo, int x, int y,
+		    int width, int height);
 
 enum {
     PIMAGE_OPTION_INDEX_FILLOPACITY =
@@ -268,6 +281,9 @@ CreatePimage(Tcl_Interp *interp, Tk_PathCanvas canvas,
     pimagePtr->matrixPtr = NULL;
     pimagePtr->imageObj = NULL;
     pimagePtr->image = NULL;
+    pimagePtr->photo = NULL;
+    pimagePtr->custom = NULL;
+    pimagePtr->opaque = -1;
     pimagePtr->height = 0;
     pimagePtr->width = 0;
     pimagePtr->anchor = TK_ANCHOR_NW;
@@ -537,11 +553,16 @@ ConfigurePimage(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 		}
 	    } else {
 		image = NULL;
+		photo = NULL;
 	    }
 	    if (pimagePtr->image != NULL) {
 		Tk_FreeImage(pimagePtr->image);
 	    }
 	    pimagePtr->image = image;
+	    pimagePtr->photo = photo;
+	    TkPathImageFree(pimagePtr->custom);
+	    pimagePtr->custom = NULL;
+	    pimagePtr->opaque = -1;
 	}
 
 	/*
@@ -578,6 +599,7 @@ DeletePimage(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display)
     if (pimagePtr->image != NULL) {
         Tk_FreeImage(pimagePtr->image);
     }
+    TkPathImageFree(pimagePtr->custom);
     Tk_FreeConfigOptions((char *) pimagePtr, itemPtr->optionTable,
 			 Tk_PathCanvasTkwin(canvas));
 }
@@ -590,24 +612,21 @@ DisplayPimage(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display,
     PimageItem *pimagePtr = (PimageItem *) itemPtr;
     TMatrix m = GetCanvasTMatrix(canvas);
     TkPathContext ctx;
-    Tk_PhotoHandle photo;
 
+    if (pimagePtr->photo == NULL) {
+	return;
+    }
     ctx = ContextOfCanvas(canvas);
     TkPathPushTMatrix(ctx, &m);
     m = GetTMatrix(pimagePtr);
     TkPathPushTMatrix(ctx, &m);
     /* @@@ Maybe we should taking care of x, y etc.? */
-    photo = Tk_FindPhoto(((TkPathCanvas *)canvas)->interp,
-                         Tcl_GetString(pimagePtr->imageObj));
-    if (photo == NULL) {
-	Tcl_ResetResult(((TkPathCanvas *)canvas)->interp);
-	return;
-    }
-    TkPathImage(ctx, pimagePtr->image, photo,
+    TkPathImage(ctx, pimagePtr->image, pimagePtr->photo,
             itemPtr->bbox.x1+BBOX_OUT, itemPtr->bbox.y1+BBOX_OUT,
             pimagePtr->width, pimagePtr->height, pimagePtr->fillOpacity,
             pimagePtr->tintColor, pimagePtr->tintAmount,
-	    pimagePtr->interpolation, pimagePtr->srcRegionPtr);
+	    pimagePtr->interpolation, pimagePtr->srcRegionPtr,
+	    &pimagePtr->custom);
 }
 
 static void
@@ -633,6 +652,212 @@ PimageToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
     return PathRectToAreaWithMatrix(itemPtr->bbox, &m, areaPtr);
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * PimagePdfStream --
+ *
+ *	Makes an image XObject of the image dictionary entries dict and
+ *	the pixel data in pixObj, which is deflated if zlib is available.
+ *
+ * Results:
+ *	The object as a byte array.
+ *
+ * Side effects:
+ *	pixObj is freed if nothing else refers to it.
+ *
+ *--------------------------------------------------------------
+ */
+
+static Tcl_Obj *
+PimagePdfStream(Tcl_Interp *interp, const char *dict, Tcl_Obj *pixObj)
+{
+    Tcl_Obj *obj, *dataObj = pixObj;
+    const unsigned char *data;
+    unsigned char *p;
+    Tcl_Size len, dictLen, headLen;
+    char head[64];
+    int zipped = 0;
+
+    Tcl_IncrRefCount(pixObj);
+#if ZLIB_SUPPORT
+    if (gCanZlib) {
+	if (Tcl_ZlibDeflate(interp, TCL_ZLIB_FORMAT_ZLIB,
+			    pixObj, 9, NULL) == TCL_OK) {
+	    Tcl_GetByteArrayFromObj(Tcl_GetObjResult(interp), &len);
+	    if (len > 0) {
+		dataObj = Tcl_GetObjResult(interp);
+		Tcl_IncrRefCount(dataObj);
+		zipped = 1;
+	    }
+	}
+	Tcl_ResetResult(interp);
+    }
+#endif
+    data = Tcl_GetByteArrayFromObj(dataObj, &len);
+    sprintf(head, "%s/Length %ld\n>>\nstream\n",
+	    zipped ? "/Filter /FlateDecode\n" : "", (long) len);
+    dictLen = strlen(dict);
+    headLen = strlen(head);
+    obj = Tcl_NewByteArrayObj(NULL, 0);
+    p = Tcl_SetByteArrayLength(obj, dictLen + headLen + len + 11);
+    memcpy(p, dict, dictLen);
+    memcpy(p + dictLen, head, headLen);
+    memcpy(p + dictLen + headLen, data, len);
+    memcpy(p + dictLen + headLen + len, "\nendstream\n", 11);
+    if (zipped) {
+	Tcl_DecrRefCount(dataObj);
+    }
+    Tcl_DecrRefCount(pixObj);
+    return obj;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PimagePdfImage --
+ *
+ *	Makes the RGB image XObject of the photo, tinted, with an alpha
+ *	mask for its transparency and -fillopacity. The writer of the
+ *	canvas "pdf" command keeps it, so all items showing the photo
+ *	alike share it.
+ *
+ * Results:
+ *	A standard Tcl result. The name of the image is stored in
+ *	*namePtrPtr with its reference count incremented.
+ *
+ * Side effects:
+ *	Objects are written to the document.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PimagePdfImage(Tcl_Interp *interp, PimageItem *pimagePtr,
+    Tk_PhotoImageBlock *blockPtr, Tcl_Obj *mkimage, Tcl_Obj **namePtrPtr)
+{
+    TkPathPdfKey key;
+    TkPathPdfResource res;
+    Tk_PhotoImageBlock block = *blockPtr;
+    Tcl_Obj *pixObj, *obj;
+    unsigned char *p;
+    char dict[200];
+    double tintR, tintG, tintB, tintAmount;
+    int x, y, opacity, interpolate;
+    long id;
+
+    opacity = pimagePtr->fillOpacity * 256;
+    if (opacity > 256) {
+	opacity = 256;
+    } else if (opacity < 0) {
+	opacity = 0;
+    }
+    tintAmount = pimagePtr->tintAmount;
+    if ((pimagePtr->tintColor != NULL) && (tintAmount > 0.0)) {
+	if (tintAmount > 1.0) {
+	    tintAmount = 1.0;
+	}
+	tintR = (double) (pimagePtr->tintColor->red >> 8) / 0xff;
+	tintG = (double) (pimagePtr->tintColor->green >> 8) / 0xff;
+	tintB = (double) (pimagePtr->tintColor->blue >> 8) / 0xff;
+    } else {
+	tintAmount = 0.0;
+	tintR = 0.0;
+	tintG = 0.0;
+	tintB = 0.0;
+    }
+    interpolate =
+	(pimagePtr->interpolation == kPathImageInterpolationFast) ||
+	(pimagePtr->interpolation == kPathImageInterpolationBest);
+    memset(&key, 0, sizeof(key));
+    key.ptr = pimagePtr->photo;
+    key.params[0] = opacity;
+    key.params[1] = interpolate;
+    key.params[2] = tintAmount;
+    key.params[3] = tintR;
+    key.params[4] = tintG;
+    key.params[5] = tintB;
+    if (TkPathPdfFindResource(mkimage, &key, &res)) {
+	*namePtrPtr = res.nameObj;
+	return TCL_OK;
+    }
+
+    /*
+     * First make alpha mask.
+     */
+    pixObj = Tcl_NewObj();
+    p = Tcl_SetByteArrayLength(pixObj, block.width * block.height);
+    for (y = 0; y < block.height; y++) {
+	unsigned char *q = block.pixelPtr + y * block.pitch;
+
+	for (x = 0; x < block.width; x++) {
+	    *p++ = ((int) q[block.offset[3]] * opacity) >> 8;
+	    q += block.pixelSize;
+	}
+    }
+    sprintf(dict, "<<\n/Type /XObject\n/Subtype /Image\n"
+	    "/ColorSpace /DeviceGray\n/BitsPerComponent 8\n"
+	    "/Width %d\n/Height %d\n", block.width, block.height);
+    obj = PimagePdfStream(interp, dict, pixObj);
+    if (TkPathPdfAddImage(interp, mkimage, block.width, block.height,
+			  obj, &id, NULL) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    /*
+     * Make RGB image.
+     */
+    pixObj = Tcl_NewObj();
+    p = Tcl_SetByteArrayLength(pixObj, block.width * block.height * 3);
+    for (y = 0; y < block.height; y++) {
+	unsigned char R, G, B;
+	unsigned char *q = block.pixelPtr + y * block.pitch;
+
+	for (x = 0; x < block.width; x++) {
+	    R = q[block.offset[0]];
+	    G = q[block.offset[1]];
+	    B = q[block.offset[2]];
+	    if (tintAmount > 0.0) {
+		int RR, GG, BB;
+
+		RR = (1.0 - tintAmount) * R +
+		    (tintAmount * tintR * 0.2126 * R +
+		     tintAmount * tintR * 0.7152 * G +
+		     tintAmount * tintR * 0.0722 * B);
+		GG = (1.0 - tintAmount) * G +
+		    (tintAmount * tintG * 0.2126 * R +
+		     tintAmount * tintG * 0.7152 * G +
+		     tintAmount * tintG * 0.0722 * B);
+		BB = (1.0 - tintAmount) * B +
+		    (tintAmount * tintB * 0.2126 * R +
+		     tintAmount * tintB * 0.7152 * G +
+		     tintAmount * tintB * 0.0722 * B);
+		R = (RR > 0xff) ? 0xff : RR;
+		G = (GG > 0xff) ? 0xff : GG;
+		B = (BB > 0xff) ? 0xff : BB;
+	    }
+	    *p++ = R;
+	    *p++ = G;
+	    *p++ = B;
+	    q += block.pixelSize;
+	}
+    }
+    sprintf(dict, "<<\n/Type /XObject\n/Subtype /Image\n"
+	    "/ColorSpace /DeviceRGB\n/BitsPerComponent 8\n"
+	    "/Width %d\n/Height %d\n/SMask %ld 0 R\n%s",
+	    block.width, block.height, id,
+	    interpolate ? "/Interpolate true\n" : "");
+    obj = PimagePdfStream(interp, dict, pixObj);
+    memset(&res, 0, sizeof(res));
+    if (TkPathPdfAddImage(interp, mkimage, block.width, block.height,
+			  obj, &res.id, &res.nameObj) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    TkPathPdfKeepResource(mkimage, &key, &res);
+    *namePtrPtr = res.nameObj;
+    return TCL_OK;
+}
+
 static int
 PimageToPdf(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
     Tcl_Size objc, Tcl_Obj *const objv[], int prepass)
@@ -652,10 +877,7 @@ PimageToPdf(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
     if (state == TK_PATHSTATE_NULL) {
 	state = TkPathCanvasState(canvas);
     }
-    photo = Tk_FindPhoto(interp, Tcl_GetString(pimagePtr->imageObj));
-    if (photo == NULL) {
-	Tcl_ResetResult(interp);
-    }
+    photo = pimagePtr->photo;
     if ((photo == NULL) || (state == TK_PATHSTATE_HIDDEN)) {
 	return TCL_OK;	/* nothing to display */
     }
@@ -679,221 +901,17 @@ PimageToPdf(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
     bbox.y2 -= BBOX_OUT + 1;
 
     if (objc > 0) {
-	long id;
-	Tcl_Size retc;
-	int opacity, tx, ty;
-#if ZLIB_SUPPORT
-	Tcl_Size zLen;
-#endif
+	int tx, ty;
 	double scaleX, scaleY, dx, dy;
-	Tcl_Obj *pixObj, *nameObj, **retv;
-
-	/*
-	 * Callback provided, first make alpha mask.
-	 */
-	opacity = pimagePtr->fillOpacity * 256;
-	if (opacity > 256) {
-	    opacity = 256;
-	} else if (opacity < 0) {
-	    opacity = 0;
-	}
-	pixObj = Tcl_NewObj();
-	p = Tcl_SetByteArrayLength(pixObj, block.width * block.height);
-	for (y = 0; y < block.height; y++) {
-	    unsigned char *q = block.pixelPtr + y * block.pitch;
-
-	    for (x = 0; x < block.width; x++) {
-		*p++ = ((int) q[block.offset[3]] * opacity) >> 8;
-		q += block.pixelSize;
-	    }
-	}
-#if ZLIB_SUPPORT
-	zLen = 0;
-	if (gCanZlib) {
-	    if (Tcl_ZlibDeflate(interp, TCL_ZLIB_FORMAT_ZLIB,
-				pixObj, 9, NULL) == TCL_OK) {
-		p = Tcl_GetByteArrayFromObj(Tcl_GetObjResult(interp), &zLen);
-		if (zLen > 0) {
-		    Tcl_DecrRefCount(pixObj);
-		    pixObj = Tcl_GetObjResult(interp);
-		}
-		Tcl_IncrRefCount(pixObj);
-	    }
-	    Tcl_ResetResult(interp);
-	} else {
-	    Tcl_IncrRefCount(pixObj);
-	}
-#else
-	Tcl_IncrRefCount(pixObj);
-#endif
-	obj = Tcl_NewObj();
-	Tcl_AppendPrintfToObj(obj, "<<\n/Type /XObject\n/Subtype /Image\n"
-			      "/ColorSpace /DeviceGray\n/BitsPerComponent 8\n"
-			      "/Width %d\n/Height %d\n",
-			      block.width, block.height);
-#if ZLIB_SUPPORT
-	if (zLen > 0) {
-	    Tcl_AppendPrintfToObj(obj, "/Filter /FlateDecode\n"
-				  "/Length %ld\n>>\nstream\n", (long int) zLen);
-	} else
-#endif
-	{
-	    Tcl_AppendPrintfToObj(obj, "/Length %d\n>>\nstream\n",
-				  block.width * block.height);
-	}
-	Tcl_AppendObjToObj(obj, pixObj);
-	Tcl_DecrRefCount(pixObj);
-	Tcl_AppendToObj(obj, "\nendstream\n", 11);
-	ret = Tcl_DuplicateObj(objv[0]);
-	Tcl_IncrRefCount(ret);
-	if ((Tcl_ListObjAppendElement(interp, ret,
-				      Tcl_NewIntObj(block.width)) != TCL_OK) ||
-	    (Tcl_ListObjAppendElement(interp, ret,
-				      Tcl_NewIntObj(block.height)) != TCL_OK) ||
-	    (Tcl_ListObjAppendElement(interp, ret, obj) != TCL_OK)) {
-	    Tcl_DecrRefCount(ret);
-	    Tcl_DecrRefCount(obj);
-	    return TCL_ERROR;
-	}
-	if (Tcl_EvalObjEx(interp, ret, TCL_EVAL_DIRECT) != TCL_OK) {
-	    Tcl_DecrRefCount(ret);
-	    return TCL_ERROR;
-	}
-	Tcl_DecrRefCount(ret);
-	/*
-	 * Remember result information (object id of alpha channel).
-	 */
-	if (Tcl_ListObjGetElements(interp, Tcl_GetObjResult(interp),
-				   &retc, &retv) != TCL_OK) {
-	    return TCL_ERROR;
-	}
-	if (retc < 1) {
-	    Tcl_SetResult(interp, (char *) "missing PDF id", TCL_STATIC);
-	    return TCL_ERROR;
-	}
-	Tcl_GetLongFromObj(NULL, retv[0], &id);
-	/*
-	 * Make RGB image.
-	 */
-	tintAmount = pimagePtr->tintAmount;
-	if ((pimagePtr->tintColor != NULL) && (tintAmount > 0.0)) {
-	    if (tintAmount > 1.0) {
-		tintAmount = 1.0;
-	    }
-	    tintR = (double) (pimagePtr->tintColor->red >> 8) / 0xff;
-	    tintG = (double) (pimagePtr->tintColor->green >> 8) / 0xff;
-	    tintB = (double) (pimagePtr->tintColor->blue >> 8) / 0xff;
-	} else {
-	    tintAmount = 0.0;
-	    tintR = 0.0;
-	    tintG = 0.0;
-	    tintB = 0.0;
-	}
-	pixObj = Tcl_NewObj();
-	p = Tcl_SetByteArrayLength(pixObj, block.width * block.height * 3);
-	for (y = 0; y < block.height; y++) {
-	    unsigned char R, G, B;
-	    unsigned char *q = block.pixelPtr + y * block.pitch;
+	Tcl_Obj *nameObj;
 
-	    for (x = 0; x < block.width; x++) {
-		R = q[block.offset[0]];
-		G = q[block.offset[1]];
-		B = q[block.offset[2]];
-		if (tintAmount > 0.0) {
-		    int RR, GG, BB;
-
-		    RR = (1.0 - tintAmount) * R +
-			(tintAmount * tintR * 0.2126 * R +
-			 tintAmount * tintR * 0.7152 * G +
-			 tintAmount * tintR * 0.0722 * B);
-		    GG = (1.0 - tintAmount) * G +
-			(tintAmount * tintG * 0.2126 * R +
-			 tintAmount * tintG * 0.7152 * G +
-			 tintAmount * tintG * 0.0722 * B);
-		    BB = (1.0 - tintAmount) * B +
-			(tintAmount * tintB * 0.2126 * R +
-			 tintAmount * tintB * 0.7152 * G +
-			 tintAmount * tintB * 0.0722 * B);
-		    R = (RR > 0xff) ? 0xff : RR;
-		    G = (GG > 0xff) ? 0xff : GG;
-		    B = (BB > 0xff) ? 0xff : BB;
-		}
-		*p++ = R;
-		*p++ = G;
-		*p++ = B;
-		q += block.pixelSize;
-	    }
-	}
-#if ZLIB_SUPPORT
-	zLen = 0;
-	if (gCanZlib) {
-	    if (Tcl_ZlibDeflate(interp, TCL_ZLIB_FORMAT_ZLIB,
-				pixObj, 9, NULL) == TCL_OK) {
-		p = Tcl_GetByteArrayFromObj(Tcl_GetObjResult(interp), &zLen);
-		if (zLen > 0) {
-		    Tcl_DecrRefCount(pixObj);
-		    pixObj = Tcl_GetObjResult(interp);
-		}
-		Tcl_IncrRefCount(pixObj);
-	    }
-	    Tcl_ResetResult(interp);
-	} else {
-	    Tcl_IncrRefCount(pixObj);
-	}
-#else
-	Tcl_IncrRefCount(pixObj);
-#endif
-	obj = Tcl_NewObj();
-	Tcl_AppendPrintfToObj(obj, "<<\n/Type /XObject\n/Subtype /Image\n"
-			      "/ColorSpace /DeviceRGB\n/BitsPerComponent 8\n"
-			      "/Width %d\n/Height %d\n/SMask %ld 0 R\n",
-			      block.width, block.height, id);
-	if ((pimagePtr->interpolation == kPathImageInterpolationFast) ||
-	    (pimagePtr->interpolation == kPathImageInterpolationBest)) {
-	    Tcl_AppendToObj(obj, "/Interpolate true\n", 18);
-	}
-#if ZLIB_SUPPORT
-	if (zLen > 0) {
-	    Tcl_AppendPrintfToObj(obj, "/Filter /FlateDecode\n"
-				  "/Length %ld\n>>\nstream\n", (long int) zLen);
-	} else
-#endif
-	{
-	    Tcl_AppendPrintfToObj(obj, "/Length %d\n>>\nstream\n",
-				  block.width * block.height * 3);
-	}
-	Tcl_AppendObjToObj(obj, pixObj);
-	Tcl_DecrRefCount(pixObj);
-	Tcl_AppendToObj(obj, "\nendstream\n", 11);
-	ret = Tcl_DuplicateObj(objv[0]);
-	Tcl_IncrRefCount(ret);
-	if ((Tcl_ListObjAppendElement(interp, ret,
-				      Tcl_NewIntObj(block.width)) != TCL_OK) ||
-	    (Tcl_ListObjAppendElement(interp, ret,
-				      Tcl_NewIntObj(block.height)) != TCL_OK) ||
-	    (Tcl_ListObjAppendElement(interp, ret, obj) != TCL_OK)) {
-	    Tcl_DecrRefCount(ret);
-	    Tcl_DecrRefCount(obj);
-	    return TCL_ERROR;
-	}
-	if (Tcl_EvalObjEx(interp, ret, TCL_EVAL_DIRECT) != TCL_OK) {
-	    Tcl_DecrRefCount(ret);
-	    return TCL_ERROR;
-	}
-	Tcl_DecrRefCount(ret);
 	/*
-	 * Remember result information (name of RGB image).
+	 * Callback provided, make the image with its alpha mask.
 	 */
-	if (Tcl_ListObjGetElements(interp, Tcl_GetObjResult(interp),
-				   &retc, &retv) != TCL_OK) {
+	if (PimagePdfImage(interp, pimagePtr, &block, objv[0], &nameObj)
+	    != TCL_OK) {
 	    return TCL_ERROR;
 	}
-	if (retc < 2) {
-	    Tcl_SetResult(interp, (char *) "missing PDF id/name", TCL_STATIC);
-	    return TCL_ERROR;
-	}
-	nameObj = retv[1];
-	Tcl_IncrRefCount(nameObj);
 	/*
 	 * Print image object(s).
 	 */
@@ -1101,33 +1119,87 @@ ImageChangedProc(
     int imgWidth, int imgHeight)/* New dimensions of image. */
 {
     PimageItem *pimagePtr = (PimageItem *) clientData;
+    Tk_PathItem *itemPtr = (Tk_PathItem *) pimagePtr;
+    Tk_PathCanvas canvas = pimagePtr->headerEx.canvas;
+    Tcl_Interp *interp = ((TkPathCanvas *) canvas)->interp;
+    Tk_PhotoHandle photo = NULL;
+    int x1, y1, x2, y2;
+    double xscale, yscale, px, py;
+    TMatrix matrix;
+    PathRect r;
 
     /*
-     * If the image's size changed and it's not anchored at its
-     * northwest corner then just redisplay the entire area of the
-     * image.  This is a bit over-conservative, but we need to do
-     * something because a size change also means a position change.
+     * The photo may have been deleted or recreated. If it is the same
+     * photo at the same size, the pixels converted for drawing are
+     * patched in place; otherwise they are stale.
      */
+    if (pimagePtr->imageObj != NULL) {
+	photo = Tk_FindPhoto(interp, Tcl_GetString(pimagePtr->imageObj));
+    }
+    if ((photo == NULL) || (photo != pimagePtr->photo)
+	    || !TkPathImageChanged(pimagePtr->custom, photo,
+		    x, y, width, height)) {
+	TkPathImageFree(pimagePtr->custom);
+	pimagePtr->custom = NULL;
+    }
+    if ((photo != NULL) && (photo == pimagePtr->photo)
+	    && (pimagePtr->opaque == 1) && (width > 0) && (height > 0)) {
+	pimagePtr->opaque = PhotoIsOpaque(photo, x, y, width, height);
+    } else {
+	pimagePtr->opaque = -1;
+    }
+    pimagePtr->photo = photo;
+    SetAncestorsDirtyBbox(itemPtr);
 
-    /* @@@ MUST consider our own width and height settings as well and TMatrix. */
-
-    if (((pimagePtr->headerEx.header.x2 - pimagePtr->headerEx.header.x1) !=
-	 imgWidth)
-        || ((pimagePtr->headerEx.header.y2 - pimagePtr->headerEx.header.y1) !=
-	    imgHeight)) {
-        x = y = 0;
-        width = imgWidth;
-        height = imgHeight;
-        Tk_PathCanvasEventuallyRedraw(pimagePtr->headerEx.canvas,
-		pimagePtr->headerEx.header.x1, pimagePtr->headerEx.header.y1,
-		pimagePtr->headerEx.header.x2, pimagePtr->headerEx.header.y2);
+    /*
+     * If the image's size changed the item moves as well, so redisplay
+     * both its old and new area. The same goes for a -srcregion, which
+     * may repeat the changed pixels anywhere.
+     */
+    x1 = itemPtr->x1, y1 = itemPtr->y1, x2 = itemPtr->x2, y2 = itemPtr->y2;
+    ComputePimageBbox(canvas, pimagePtr);
+    if ((x1 != itemPtr->x1) || (y1 != itemPtr->y1) || (x2 != itemPtr->x2)
+	    || (y2 != itemPtr->y2) || (pimagePtr->srcRegionPtr != NULL)) {
+	Tk_PathCanvasEventuallyRedraw(canvas, x1, y1, x2, y2);
+	Tk_PathCanvasEventuallyRedraw(canvas, itemPtr->x1, itemPtr->y1,
+		itemPtr->x2, itemPtr->y2);
+	return;
+    }
+    if ((width <= 0) || (height <= 0) || (imgWidth <= 0) || (imgHeight <= 0)) {
+	return;
     }
-    ComputePimageBbox(pimagePtr->headerEx.canvas, pimagePtr);
-    Tk_PathCanvasEventuallyRedraw(pimagePtr->headerEx.canvas,
-	    pimagePtr->headerEx.header.x1 + x,
-	    pimagePtr->headerEx.header.y1 + y,
-	    (int) (pimagePtr->headerEx.header.x1 + x + width),
-            (int) (pimagePtr->headerEx.header.y1 + y + height));
+
+    /*
+     * Otherwise redisplay only the changed rectangle, mapped the way
+     * DisplayPimage draws the image.
+     */
+    xscale = (pimagePtr->width > 0.0) ? pimagePtr->width / imgWidth : 1.0;
+    yscale = (pimagePtr->height > 0.0) ? pimagePtr->height / imgHeight : 1.0;
+    matrix = GetTMatrix(pimagePtr);
+    r = NewEmptyPathRect();
+    px = itemPtr->bbox.x1 + BBOX_OUT + x * xscale;
+    py = itemPtr->bbox.y1 + BBOX_OUT + y * yscale;
+    PathApplyTMatrix(&matrix, &px, &py);
+    IncludePointInRect(&r, px, py);
+    px = itemPtr->bbox.x1 + BBOX_OUT + (x + width) * xscale;
+    py = itemPtr->bbox.y1 + BBOX_OUT + y * yscale;
+    PathApplyTMatrix(&matrix, &px, &py);
+    IncludePointInRect(&r, px, py);
+    px = itemPtr->bbox.x1 + BBOX_OUT + x * xscale;
+    py = itemPtr->bbox.y1 + BBOX_OUT + (y + height) * yscale;
+    PathApplyTMatrix(&matrix, &px, &py);
+    IncludePointInRect(&r, px, py);
+    px = itemPtr->bbox.x1 + BBOX_OUT + (x + width) * xscale;
+    py = itemPtr->bbox.y1 + BBOX_OUT + (y + height) * yscale;
+    PathApplyTMatrix(&matrix, &px, &py);
+    IncludePointInRect(&r, px, py);
+
+    /* One extra pixel for the filter reaching into the neighbours. */
+    Tk_PathCanvasEventuallyRedraw(canvas,
+	    MAX(itemPtr->x1, (int) floor(r.x1) - 1),
+	    MAX(itemPtr->y1, (int) floor(r.y1) - 1),
+	    MIN(itemPtr->x2, (int) ceil(r.x2) + 1),
+	    MIN(itemPtr->y2, (int) ceil(r.y2) + 1));
 }
 
 static void
@@ -1143,6 +1215,7 @@ PimageStyleChangedProc(ClientData clientData, int flags)
 	    Tcl_DecrRefCount(pimagePtr->headerEx.styleObj);
 	    pimagePtr->headerEx.styleObj = NULL;
 	}
+	SetAncestorsDirtyBbox(itemPtr);
 	Tk_PathCanvasEventuallyRedraw(pimagePtr->headerEx.canvas,
 		itemPtr->x1, itemPtr->y1,
 		itemPtr->x2, itemPtr->y2);
@@ -1310,6 +1383,99 @@ PathRectFreeOption(
     }
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * PhotoIsOpaque --
+ *
+ *	Checks the alpha of the given part of a photo.
+ *
+ * Results:
+ *	1 if all its pixels are opaque, else 0.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PhotoIsOpaque(Tk_PhotoHandle photo, int x, int y, int width, int height)
+{
+    Tk_PhotoImageBlock block;
+    unsigned char *rowPtr;
+    int i, j;
+
+    Tk_PhotoGetImage(photo, &block);
+    if (block.offset[3] >= block.pixelSize) {
+	return 1;
+    }
+    width = MIN(x + width, block.width) - MAX(x, 0);
+    height = MIN(y + height, block.height) - MAX(y, 0);
+    x = MAX(x, 0);
+    y = MAX(y, 0);
+    for (j = 0; j < height; j++) {
+	rowPtr = block.pixelPtr + (y + j) * block.pitch
+		+ x * block.pixelSize + block.offset[3];
+	for (i = 0; i < width; i++, rowPtr += block.pixelSize) {
+	    if (*rowPtr != 255) {
+		return 0;
+	    }
+	}
+    }
+    return 1;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathPimageOpaqueArea --
+ *
+ *	Tells the canvas redraw whether the item paints an opaque
+ *	rectangle, that hides whatever is below it. This needs a photo
+ *	without transparent pixels, drawn without -srcregion and with
+ *	-fillopacity 1. Filtered edges are left out.
+ *
+ * Results:
+ *	1 if so with the rectangle, before the transformation, and the
+ *	transformation filled in, else 0.
+ *
+ * Side effects:
+ *	The photo may be checked for transparency.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathPimageOpaqueArea(Tk_PathItem *itemPtr, double *rectPtr,
+	TMatrix *matrixPtr)
+{
+    PimageItem *pimagePtr = (PimageItem *) itemPtr;
+    int iwidth = 0, iheight = 0;
+    double width, height;
+
+    if ((pimagePtr->photo == NULL) || (pimagePtr->srcRegionPtr != NULL)
+	    || (pimagePtr->fillOpacity < 1.0)) {
+	return 0;
+    }
+    Tk_PhotoGetSize(pimagePtr->photo, &iwidth, &iheight);
+    if (pimagePtr->opaque < 0) {
+	pimagePtr->opaque = PhotoIsOpaque(pimagePtr->photo, 0, 0,
+		iwidth, iheight);
+    }
+    if (!pimagePtr->opaque) {
+	return 0;
+    }
+    width = (pimagePtr->width > 0.0) ? pimagePtr->width : iwidth;
+    height = (pimagePtr->height > 0.0) ? pimagePtr->height : iheight;
+    rectPtr[0] = itemPtr->bbox.x1 + BBOX_OUT + 1.0;
+    rectPtr[1] = itemPtr->bbox.y1 + BBOX_OUT + 1.0;
+    rectPtr[2] = itemPtr->bbox.x1 + BBOX_OUT + width - 1.0;
+    rectPtr[3] = itemPtr->bbox.y1 + BBOX_OUT + height - 1.0;
+    *matrixPtr = GetTMatrix(pimagePtr);
+    return (rectPtr[2] > rectPtr[0]) && (rectPtr[3] > rectPtr[1]);
+}
+
 /*
  * Local Variables:
  * mode: c
@@ -24,6 +24,10 @@ typedef struct PlineItem  {
     PathRect coords;		/* Coordinates (unorders bare bbox). */
     ArrowDescr startarrow;
     ArrowDescr endarrow;
+    int numShapes;		/* Number of line segments in this item. */
+    double *shapesPtr;		/* x1 y1 x2 y2 for each segment if more than
+				 * one, else NULL and coords is used. Arrows
+				 * are only drawn for a single segment. */
 } PlineItem;
 
 
@@ -49,6 +53,14 @@ static int	ProcessCoords(Tcl_Interp *interp, Tk_PathCanvas canvas,
 static int	PlineCoords(Tcl_Interp *interp,
 		    Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 		    Tcl_Size objc, Tcl_Obj *const objv[]);
+static int	PlineIndex(Tcl_Interp *interp, Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, Tcl_Obj *obj, int *indexPtr);
+static int	PlineShapeToArea(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, Tk_PathStyle *stylePtr, int shape,
+		    double *areaPtr);
+static double	PlineShapeToPoint(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, Tk_PathStyle *stylePtr, int shape,
+		    double *pointPtr);
 static int	PlineToArea(Tk_PathCanvas canvas,
 		    Tk_PathItem *itemPtr, double *rectPtr);
 static int	PlineToPdf(Tcl_Interp *interp,
@@ -66,6 +78,7 @@ static void	ScalePline(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 static void	TranslatePline(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 		    int compensate, double deltaX, double deltaY);
 static PathAtom * MakePathAtoms(PlineItem *plinePtr);
+static PathRect	GetBareBbox(PlineItem *plinePtr);
 static int      ConfigureArrows(Tk_PathCanvas canvas, PlineItem *linePtr);
 
 
@@ -109,7 +122,7 @@ Tk_PathItemType tkpPlineType = {
     PlineToPdf,				/* pdfProc */
     ScalePline,				/* scaleProc */
     TranslatePline,			/* translateProc */
-    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemIndexProc *) PlineIndex,/* indexProc */
     (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
     (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
@@ -143,6 +156,8 @@ CreatePline(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPt
     itemPtr->totalBbox = NewEmptyPathRect();
     TkPathArrowDescrInit(&plinePtr->startarrow);
     TkPathArrowDescrInit(&plinePtr->endarrow);
+    plinePtr->numShapes = 1;
+    plinePtr->shapesPtr = NULL;
 
     optionTable = Tk_CreateOptionTable(interp, optionSpecs);
     itemPtr->optionTable = optionTable;
@@ -174,16 +189,43 @@ CreatePline(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPt
     return TCL_ERROR;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * ProcessCoords --
+ *
+ *	Sets or gets the coords of a pline. Any multiple of four
+ *	coordinates is accepted and gives that many line segments
+ *	sharing the options of the item.
+ *
+ * Results:
+ *	Standard tcl result.
+ *
+ * Side effects:
+ *	May replace the segments of the item.
+ *
+ *--------------------------------------------------------------
+ */
+
 static int
 ProcessCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
         Tcl_Size objc, Tcl_Obj *const objv[])
 {
     PlineItem *plinePtr = (PlineItem *) itemPtr;
     PathRect *p = &plinePtr->coords;
+    double *coordsPtr;
+    int numShapes;
 
     if (objc == 0) {
-        Tcl_Obj *obj = Tcl_NewObj();
-        Tcl_Obj *subobj = Tcl_NewDoubleObj(p->x1);
+        Tcl_Obj *obj, *subobj;
+
+        if (plinePtr->shapesPtr != NULL) {
+            Tcl_SetObjResult(interp, MultiShapeCoordsObj(plinePtr->shapesPtr,
+                    4*plinePtr->numShapes));
+            return TCL_OK;
+        }
+        obj = Tcl_NewObj();
+        subobj = Tcl_NewDoubleObj(p->x1);
         Tcl_ListObjAppendElement(interp, obj, subobj);
         subobj = Tcl_NewDoubleObj(p->y1);
         Tcl_ListObjAppendElement(interp, obj, subobj);
@@ -192,27 +234,62 @@ ProcessCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
         subobj = Tcl_NewDoubleObj(p->y2);
         Tcl_ListObjAppendElement(interp, obj, subobj);
         Tcl_SetObjResult(interp, obj);
-    } else if ((objc == 1) || (objc == 4)) {
-        if (objc==1) {
-            if (Tcl_ListObjGetElements(interp, objv[0], &objc,
-                    (Tcl_Obj ***) &objv) != TCL_OK) {
-                return TCL_ERROR;
-            } else if (objc != 4) {
-                return TkpWrongNumberOfCoordinates(interp, 0, 4, objc);
-            }
-        }
-        if ((Tk_PathCanvasGetCoordFromObj(interp, canvas, objv[0], &p->x1) != TCL_OK)
-            || (Tk_PathCanvasGetCoordFromObj(interp, canvas, objv[1], &p->y1) != TCL_OK)
-            || (Tk_PathCanvasGetCoordFromObj(interp, canvas, objv[2], &p->x2) != TCL_OK)
-            || (Tk_PathCanvasGetCoordFromObj(interp, canvas, objv[3], &p->y2) != TCL_OK)) {
-            return TCL_ERROR;
-        }
+        return TCL_OK;
+    }
+    if (CoordsForMultiShapeItems(interp, canvas, 4, objc, objv,
+            &coordsPtr, &numShapes) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (plinePtr->shapesPtr != NULL) {
+        ckfree((char *) plinePtr->shapesPtr);
+        plinePtr->shapesPtr = NULL;
+    }
+    if (numShapes == 1) {
+        p->x1 = coordsPtr[0];
+        p->y1 = coordsPtr[1];
+        p->x2 = coordsPtr[2];
+        p->y2 = coordsPtr[3];
+        ckfree((char *) coordsPtr);
     } else {
-        return TkpWrongNumberOfCoordinates(interp, 0, 4, objc);
+        plinePtr->shapesPtr = coordsPtr;
     }
+    plinePtr->numShapes = numShapes;
     return TCL_OK;
 }
 
+static double *
+GetPlineShape(PlineItem *plinePtr, int shape, double *pointsPtr)
+{
+    if (plinePtr->shapesPtr != NULL) {
+        return plinePtr->shapesPtr + 4*shape;
+    }
+    pointsPtr[0] = plinePtr->coords.x1;
+    pointsPtr[1] = plinePtr->coords.y1;
+    pointsPtr[2] = plinePtr->coords.x2;
+    pointsPtr[3] = plinePtr->coords.y2;
+    return pointsPtr;
+}
+
+static PathRect
+GetBareBbox(PlineItem *plinePtr)
+{
+    PathRect r;
+    double points[4], *p;
+    int i;
+
+    r = NewEmptyPathRect();
+    for (i = 0; i < plinePtr->numShapes; i++) {
+        p = GetPlineShape(plinePtr, i, points);
+        IncludePointInRect(&r, p[0], p[1]);
+        IncludePointInRect(&r, p[2], p[3]);
+    }
+    if (plinePtr->shapesPtr == NULL) {
+        IncludeArrowPointsInRect(&r, &plinePtr->startarrow);
+        IncludeArrowPointsInRect(&r, &plinePtr->endarrow);
+    }
+    return r;
+}
+
 static int
 PlineCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
         Tcl_Size objc, Tcl_Obj *const objv[])
@@ -221,7 +298,7 @@ PlineCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
     int result;
 
     result = ProcessCoords(interp, canvas, itemPtr, objc, objv);
-    if ((result == TCL_OK) && ((objc == 1) || (objc == 4))) {
+    if ((result == TCL_OK) && (objc > 0)) {
         ConfigureArrows(canvas, plinePtr);
 	ComputePlineBbox(canvas, plinePtr);
     }
@@ -235,7 +312,6 @@ ComputePlineBbox(Tk_PathCanvas canvas, PlineItem *plinePtr)
     Tk_PathItem *itemPtr = &itemExPtr->header;
     Tk_PathStyle style;
     Tk_PathState state = itemExPtr->header.state;
-    PathRect r;
 
     if (state == TK_PATHSTATE_NULL) {
 	state = TkPathCanvasState(canvas);
@@ -246,14 +322,9 @@ ComputePlineBbox(Tk_PathCanvas canvas, PlineItem *plinePtr)
         return;
     }
     style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
-    r.x1 = MIN(plinePtr->coords.x1, plinePtr->coords.x2);
-    r.x2 = MAX(plinePtr->coords.x1, plinePtr->coords.x2);
-    r.y1 = MIN(plinePtr->coords.y1, plinePtr->coords.y2);
-    r.y2 = MAX(plinePtr->coords.y1, plinePtr->coords.y2);
-    IncludeArrowPointsInRect(&r, &plinePtr->startarrow);
-    IncludeArrowPointsInRect(&r, &plinePtr->endarrow);
-    itemPtr->bbox = r;
-    itemPtr->totalBbox = GetGenericPathTotalBboxFromBare(NULL, &style, &r);
+    itemPtr->bbox = GetBareBbox(plinePtr);
+    itemPtr->totalBbox = GetGenericPathTotalBboxFromBare(NULL, &style,
+	    &itemPtr->bbox);
     SetGenericPathHeaderBbox(&itemExPtr->header, style.matrixPtr, &itemPtr->totalBbox);
     TkPathCanvasFreeInheritedStyle(&style);
 }
@@ -316,11 +387,25 @@ ConfigurePline(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 static PathAtom *
 MakePathAtoms(PlineItem *plinePtr)
 {
-    PathAtom *atomPtr;
+    PathAtom *atomPtr, *firstAtomPtr = NULL, *lastAtomPtr = NULL;
+    double points[4], *p;
+    int i;
 
-    atomPtr = NewMoveToAtom(plinePtr->coords.x1, plinePtr->coords.y1);
-    atomPtr->nextPtr = NewLineToAtom(plinePtr->coords.x2, plinePtr->coords.y2);
-    return atomPtr;
+    /*
+     * All segments go into a single path which is stroked in one go.
+     */
+    for (i = 0; i < plinePtr->numShapes; i++) {
+        p = GetPlineShape(plinePtr, i, points);
+        atomPtr = NewMoveToAtom(p[0], p[1]);
+        atomPtr->nextPtr = NewLineToAtom(p[2], p[3]);
+        if (lastAtomPtr == NULL) {
+            firstAtomPtr = atomPtr;
+        } else {
+            lastAtomPtr->nextPtr = atomPtr;
+        }
+        lastAtomPtr = atomPtr->nextPtr;
+    }
+    return firstAtomPtr;
 }
 
 static void
@@ -334,6 +419,9 @@ DeletePline(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display)
     }
     TkPathFreeArrow(&plinePtr->startarrow);
     TkPathFreeArrow(&plinePtr->endarrow);
+    if (plinePtr->shapesPtr != NULL) {
+	ckfree((char *) plinePtr->shapesPtr);
+    }
     Tk_FreeConfigOptions((char *) itemPtr, itemPtr->optionTable,
 			 Tk_PathCanvasTkwin(canvas));
 }
@@ -348,13 +436,7 @@ DisplayPline(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display, Drawa
     PathAtom *atomPtr;
     Tk_PathStyle style;
 
-    r.x1 = MIN(plinePtr->coords.x1, plinePtr->coords.x2);
-    r.x2 = MAX(plinePtr->coords.x1, plinePtr->coords.x2);
-    r.y1 = MIN(plinePtr->coords.y1, plinePtr->coords.y2);
-    r.y2 = MAX(plinePtr->coords.y1, plinePtr->coords.y2);
-    IncludeArrowPointsInRect(&r, &plinePtr->startarrow);
-    IncludeArrowPointsInRect(&r, &plinePtr->endarrow);
-
+    r = GetBareBbox(plinePtr);
     atomPtr = MakePathAtoms(plinePtr);
     style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
     TkPathDrawPath(ContextOfCanvas(canvas), atomPtr, &style, &m, &r);
@@ -363,8 +445,10 @@ DisplayPline(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display, Drawa
     /*
      * Display arrowheads, if they are wanted.
      */
-    DisplayArrow(canvas, &plinePtr->startarrow, &style, &m, &r);
-    DisplayArrow(canvas, &plinePtr->endarrow, &style, &m, &r);
+    if (plinePtr->shapesPtr == NULL) {
+	DisplayArrow(canvas, &plinePtr->startarrow, &style, &m, &r);
+	DisplayArrow(canvas, &plinePtr->endarrow, &style, &m, &r);
+    }
 
     TkPathCanvasFreeInheritedStyle(&style);
 }
@@ -381,37 +465,119 @@ PlineToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
 {
     PlineItem *plinePtr = (PlineItem *) itemPtr;
     Tk_PathStyle style;
-    PathAtom *atomPtr;
-    double point;
+    double point, d;
 
     style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
+    point = MultiShapeToPoint(canvas, itemPtr, &style, plinePtr->numShapes,
+            PlineShapeToPoint, pointPtr, NULL);
 
-    /* @@@ Perhaps we should do a simplified treatment here instead of the generic. */
-    atomPtr = MakePathAtoms(plinePtr);
-    point = GenericPathToPoint(canvas, itemPtr, &style,
-            atomPtr, 2, pointPtr);
-    TkPathFreeAtoms(atomPtr);
+    /*
+     * Arrowheads are part of the item for picking.
+     */
+    d = TkPathArrowToPoint(canvas, itemPtr, &plinePtr->startarrow, &style,
+	    pointPtr);
+    if (d < point) {
+	point = d;
+    }
+    d = TkPathArrowToPoint(canvas, itemPtr, &plinePtr->endarrow, &style,
+	    pointPtr);
+    if (d < point) {
+	point = d;
+    }
     TkPathCanvasFreeInheritedStyle(&style);
     return point;
 }
 
+/*
+ * We create the atoms of a single segment on the fly to save some memory.
+ */
+
+#define PLINE_SEGMENT_ATOMS(p)				\
+    moveAtom.pathAtom.type = PATH_ATOM_M;		\
+    moveAtom.pathAtom.nextPtr = (PathAtom *) &lineAtom;	\
+    moveAtom.x = (p)[0];				\
+    moveAtom.y = (p)[1];				\
+    lineAtom.pathAtom.type = PATH_ATOM_L;		\
+    lineAtom.pathAtom.nextPtr = NULL;			\
+    lineAtom.x = (p)[2];				\
+    lineAtom.y = (p)[3]
+
+static double
+PlineShapeToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        Tk_PathStyle *stylePtr, int shape, double *pointPtr)
+{
+    PlineItem *plinePtr = (PlineItem *) itemPtr;
+    MoveToAtom moveAtom;
+    LineToAtom lineAtom;
+    double points[4], *p;
+
+    /* @@@ Perhaps we should do a simplified treatment here instead of the generic. */
+    p = GetPlineShape(plinePtr, shape, points);
+    PLINE_SEGMENT_ATOMS(p);
+    return GenericPathToPoint(canvas, itemPtr, stylePtr,
+            (PathAtom *) &moveAtom, 2, pointPtr);
+}
+
 static int
 PlineToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
 {
     PlineItem *plinePtr = (PlineItem *) itemPtr;
     Tk_PathStyle style;
-    PathAtom *atomPtr;
     int area;
 
     style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
+    area = MultiShapeToArea(canvas, itemPtr, &style, plinePtr->numShapes,
+            PlineShapeToArea, areaPtr);
+    TkPathCanvasFreeInheritedStyle(&style);
+    return area;
+}
+
+static int
+PlineShapeToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        Tk_PathStyle *stylePtr, int shape, double *areaPtr)
+{
+    PlineItem *plinePtr = (PlineItem *) itemPtr;
+    MoveToAtom moveAtom;
+    LineToAtom lineAtom;
+    double points[4], *p;
 
     /* @@@ Perhaps we should do a simplified treatment here instead of the generic. */
-    atomPtr = MakePathAtoms(plinePtr);
-    area = GenericPathToArea(canvas, itemPtr, &style,
-            atomPtr, 2, areaPtr);
-    TkPathFreeAtoms(atomPtr);
+    p = GetPlineShape(plinePtr, shape, points);
+    PLINE_SEGMENT_ATOMS(p);
+    return GenericPathToArea(canvas, itemPtr, stylePtr,
+            (PathAtom *) &moveAtom, 2, areaPtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PlineIndex --
+ *
+ *	Returns the index of a segment of a pline item holding
+ *	many of them, see GetMultiShapeIndex().
+ *
+ * Results:
+ *	Standard tcl result.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PlineIndex(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+    Tcl_Obj *obj, int *indexPtr)
+{
+    PlineItem *plinePtr = (PlineItem *) itemPtr;
+    Tk_PathStyle style;
+    int result;
+
+    style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
+    result = GetMultiShapeIndex(interp, canvas, itemPtr, &style,
+            plinePtr->numShapes, PlineShapeToPoint, obj, indexPtr);
     TkPathCanvasFreeInheritedStyle(&style);
-    return area;
+    return result;
 }
 
 static int
@@ -431,10 +597,9 @@ PlineToPdf(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 	return TCL_OK;
     }
     style = TkPathCanvasInheritStyle(itemPtr, 0);
-    atomPtr = NewMoveToAtom(plinePtr->coords.x1, plinePtr->coords.y1);
-    atomPtr->nextPtr = NewLineToAtom(plinePtr->coords.x2, plinePtr->coords.y2);
+    atomPtr = MakePathAtoms(plinePtr);
     result = TkPathPdf(interp, atomPtr, &style, &itemPtr->bbox, objc, objv);
-    if (result == TCL_OK) {
+    if ((result == TCL_OK) && (plinePtr->shapesPtr == NULL)) {
 	result = TkPathPdfArrow(interp, &plinePtr->startarrow, &style);
 	if (result == TCL_OK) {
 	    result = TkPathPdfArrow(interp, &plinePtr->endarrow, &style);
@@ -459,9 +624,17 @@ ScalePline(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int compensate,
     double originX, double originY, double scaleX, double scaleY)
 {
     PlineItem *plinePtr = (PlineItem *) itemPtr;
+    double *p;
+    int i;
 
     CompensateScale(itemPtr, compensate, &originX, &originY, &scaleX, &scaleY);
 
+    if (plinePtr->shapesPtr != NULL) {
+	for (i = 0, p = plinePtr->shapesPtr; i < 2*plinePtr->numShapes; i++, p += 2) {
+	    p[0] = originX + scaleX*(p[0] - originX);
+	    p[1] = originY + scaleY*(p[1] - originY);
+	}
+    }
     ScalePathRect(&itemPtr->bbox, originX, originY, scaleX, scaleY);
     ScalePathRect(&plinePtr->coords, originX, originY, scaleX, scaleY);
     TkPathScaleArrow(&plinePtr->startarrow, originX, originY, scaleX, scaleY);
@@ -475,9 +648,18 @@ TranslatePline(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int compensate,
     double deltaX, double deltaY)
 {
     PlineItem *plinePtr = (PlineItem *) itemPtr;
+    double *p;
+    int i;
 
     CompensateTranslate(itemPtr, compensate, &deltaX, &deltaY);
 
+    if (plinePtr->shapesPtr != NULL) {
+	for (i = 0, p = plinePtr->shapesPtr; i < 2*plinePtr->numShapes; i++, p += 2) {
+	    p[0] += deltaX;
+	    p[1] += deltaY;
+	}
+    }
+
     /* Just translate the bbox as well. */
     TranslatePathRect(&itemPtr->bbox, deltaX, deltaY);
     TranslatePathRect(&plinePtr->coords, deltaX, deltaY);
@@ -520,6 +702,13 @@ ConfigureArrows(
         state = ((TkPathCanvas *)canvas)->canvas_state;
     }
 
+    /*
+     * Arrows are only supported for single segment plines.
+     */
+    if (linePtr->shapesPtr != NULL) {
+        return TCL_OK;
+    }
+
     pf.x = linePtr->coords.x1;
     pf.y = linePtr->coords.y1;
     pl.x = linePtr->coords.x2;
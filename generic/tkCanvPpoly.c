@@ -25,6 +25,9 @@ typedef struct PpolyItem  {
     PathAtom *atomPtr;
     int maxNumSegments;	    /* Max number of straight segments (for subpath)
 			     * needed for Area and Point functions. */
+    int numPoints;	    /* Number of vertices in atomPtr. */
+    PathAtom *lastAtomPtr;  /* Last M or L atom, so that points can be
+			     * appended without walking the list. */
     ArrowDescr startarrow;
     ArrowDescr endarrow;
 } PpolyItem;
@@ -80,6 +83,13 @@ static void	ScalePpoly(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 static void	TranslatePpoly(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 			int compensate, double deltaX, double deltaY);
 static int      ConfigureArrows(Tk_PathCanvas canvas, PpolyItem *ppolyPtr);
+static void	FindPpolyLastAtom(PpolyItem *ppolyPtr);
+static int	GetPpolyIndex(Tcl_Interp *interp, Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, Tcl_Obj *obj, int *indexPtr);
+static void	PpolyDeleteCoords(Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, int first, int last);
+static void	PpolyInsert(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+			int beforeThis, Tcl_Obj *obj);
 
 PATH_STYLE_CUSTOM_OPTION_RECORDS
 PATH_CUSTOM_OPTION_TAGS
@@ -121,7 +131,7 @@ Tk_PathItemType tkpPolylineType = {
     PpolyCoords,			/* coordProc */
     DeletePpoly,			/* deleteProc */
     DisplayPpoly,			/* displayProc */
-    0,					/* flags */
+    TK_MOVABLE_POINTS,			/* flags */
     PpolyBbox,				/* bboxProc */
     PpolyToPoint,			/* pointProc */
     PpolyToArea,			/* areaProc */
@@ -131,11 +141,11 @@ Tk_PathItemType tkpPolylineType = {
     PpolyToPdf,				/* pdfProc */
     ScalePpoly,				/* scaleProc */
     TranslatePpoly,			/* translateProc */
-    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemIndexProc *) GetPpolyIndex, /* indexProc */
     (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
     (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
-    (Tk_PathItemInsertProc *) NULL,	/* insertProc */
-    (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
+    (Tk_PathItemInsertProc *) PpolyInsert, /* insertProc */
+    PpolyDeleteCoords,			/* dTextProc */
     (Tk_PathItemType *) NULL,		/* nextPtr */
     1,					/* isPathType */
 };
@@ -149,7 +159,7 @@ Tk_PathItemType tkpPpolygonType = {
     PpolyCoords,			/* coordProc */
     DeletePpoly,			/* deleteProc */
     DisplayPpoly,			/* displayProc */
-    0,					/* flags */
+    TK_MOVABLE_POINTS,			/* flags */
     PpolyBbox,				/* bboxProc */
     PpolyToPoint,			/* pointProc */
     PpolyToArea,			/* areaProc */
@@ -159,11 +169,11 @@ Tk_PathItemType tkpPpolygonType = {
     PpolyToPdf,				/* pdfProc */
     ScalePpoly,				/* scaleProc */
     TranslatePpoly,			/* translateProc */
-    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemIndexProc *) GetPpolyIndex, /* indexProc */
     (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
     (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
-    (Tk_PathItemInsertProc *) NULL,	/* insertProc */
-    (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
+    (Tk_PathItemInsertProc *) PpolyInsert, /* insertProc */
+    PpolyDeleteCoords,			/* dTextProc */
     (Tk_PathItemType *) NULL,		/* nextPtr */
     1,					/* isPathType */
 };
@@ -209,6 +219,8 @@ CreateAny(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
     itemPtr->bbox = NewEmptyPathRect();
     itemPtr->totalBbox = NewEmptyPathRect();
     ppolyPtr->maxNumSegments = 0;
+    ppolyPtr->numPoints = 0;
+    ppolyPtr->lastAtomPtr = NULL;
     TkPathArrowDescrInit(&ppolyPtr->startarrow);
     TkPathArrowDescrInit(&ppolyPtr->endarrow);
 
@@ -235,6 +247,7 @@ CreateAny(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
         goto error;
     }
     ppolyPtr->maxNumSegments = len;
+    FindPpolyLastAtom(ppolyPtr);
 
     if (ConfigurePpoly(interp, canvas, itemPtr, objc-i, objv+i, 0) == TCL_OK) {
         return TCL_OK;
@@ -265,6 +278,7 @@ PpolyCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
     }
     if (objc > 0) {
         ppolyPtr->maxNumSegments = len;
+        FindPpolyLastAtom(ppolyPtr);
         ConfigureArrows(canvas, ppolyPtr);
         ComputePpolyBbox(canvas, ppolyPtr);
     }
@@ -434,6 +448,9 @@ DisplayPpoly(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display,
     TMatrix m = GetCanvasTMatrix(canvas);
     Tk_PathStyle style;
 
+    if (ppolyPtr->atomPtr == NULL) {
+	return;
+    }
     style = TkPathCanvasInheritStyle(itemPtr, 0);
     TkPathDrawPath(ContextOfCanvas(canvas), ppolyPtr->atomPtr, &style,
 	    &m, &itemPtr->bbox);
@@ -457,7 +474,7 @@ PpolyToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
 {
     PpolyItem *ppolyPtr = (PpolyItem *) itemPtr;
     Tk_PathStyle style;
-    double dist;
+    double dist, d;
     long flags;
 
     flags = (ppolyPtr->type == kPpolyTypePolyline) ?
@@ -465,6 +482,20 @@ PpolyToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
     style = TkPathCanvasInheritStyle(itemPtr, flags);
     dist = GenericPathToPoint(canvas, itemPtr, &style, ppolyPtr->atomPtr,
             ppolyPtr->maxNumSegments, pointPtr);
+
+    /*
+     * Arrowheads are part of the item for picking.
+     */
+    d = TkPathArrowToPoint(canvas, itemPtr, &ppolyPtr->startarrow, &style,
+	    pointPtr);
+    if (d < dist) {
+	dist = d;
+    }
+    d = TkPathArrowToPoint(canvas, itemPtr, &ppolyPtr->endarrow, &style,
+	    pointPtr);
+    if (d < dist) {
+	dist = d;
+    }
     TkPathCanvasFreeInheritedStyle(&style);
     return dist;
 }
@@ -554,6 +585,506 @@ TranslatePpoly(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int compensate,
     TranslateItemHeader(itemPtr, deltaX, deltaY);
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * FindPpolyLastAtom --
+ *
+ *	Counts the vertices of a freshly parsed atom list and
+ *	remembers the last of them.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	numPoints and lastAtomPtr are set in ppolyPtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+FindPpolyLastAtom(PpolyItem *ppolyPtr)
+{
+    PathAtom *atomPtr;
+
+    ppolyPtr->numPoints = 0;
+    ppolyPtr->lastAtomPtr = NULL;
+    for (atomPtr = ppolyPtr->atomPtr; atomPtr != NULL;
+	    atomPtr = atomPtr->nextPtr) {
+	if (atomPtr->type != PATH_ATOM_Z) {
+	    ppolyPtr->numPoints++;
+	    ppolyPtr->lastAtomPtr = atomPtr;
+	}
+    }
+}
+
+/*
+ * The M, L and Z atoms share the same layout, see tkIntPath.h.
+ */
+
+#define PpolyAtomPoint(atomPtr)	((PathPoint *) &((LineToAtom *) (atomPtr))->x)
+
+static PathAtom *
+GetPpolyVertex(PpolyItem *ppolyPtr, int i)
+{
+    PathAtom *atomPtr;
+
+    if (i == ppolyPtr->numPoints - 1) {
+	return ppolyPtr->lastAtomPtr;
+    }
+    for (atomPtr = ppolyPtr->atomPtr; i > 0; i--) {
+	atomPtr = atomPtr->nextPtr;
+    }
+    return atomPtr;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * RestoreArrowEnds --
+ *
+ *	Undoes the shortening of the end points done by
+ *	ConfigureArrows before the vertex list is edited.
+ *
+ * Results:
+ *	1 if the item has arrowheads, else 0.
+ *
+ * Side effects:
+ *	The first and last vertex may be reset to their original
+ *	values.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+RestoreArrowEnds(PpolyItem *ppolyPtr)
+{
+    if ((ppolyPtr->startarrow.arrowPointsPtr == NULL)
+	    && (ppolyPtr->endarrow.arrowPointsPtr == NULL)
+	    && !ppolyPtr->startarrow.arrowEnabled
+	    && !ppolyPtr->endarrow.arrowEnabled) {
+	return 0;
+    }
+    if (ppolyPtr->numPoints > 0) {
+	TkPathPreconfigureArrow(PpolyAtomPoint(ppolyPtr->atomPtr),
+		&ppolyPtr->startarrow);
+	TkPathPreconfigureArrow(PpolyAtomPoint(ppolyPtr->lastAtomPtr),
+		&ppolyPtr->endarrow);
+    }
+    return 1;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * GetPpolyDamageBbox --
+ *
+ *	Computes the area affected by an edit from the bare bbox of
+ *	the vertices next to it. Like GetGenericPathTotalBboxFromBare
+ *	but with a conservative miter outset instead of walking the
+ *	whole atom list.
+ *
+ * Results:
+ *	PathRect, untransformed.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static PathRect
+GetPpolyDamageBbox(Tk_PathStyle *stylePtr, PathRect *barePtr)
+{
+    PathRect rect;
+    double outset;
+
+    rect = GetGenericPathTotalBboxFromBare(NULL, stylePtr, barePtr);
+    if ((stylePtr->strokeColor != NULL) && (stylePtr->joinStyle == JoinMiter)
+	    && (stylePtr->strokeWidth > 1.0)) {
+	outset = stylePtr->strokeWidth * (0.5*stylePtr->miterLimit - 1.0);
+	if (outset > 0.0) {
+	    rect.x1 -= outset;
+	    rect.y1 -= outset;
+	    rect.x2 += outset;
+	    rect.y2 += outset;
+	}
+    }
+    return rect;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * FinishPpolyEdit --
+ *
+ *	Common tail of PpolyInsert and PpolyDeleteCoords. Updates the
+ *	bboxes and damages only the region affected by the edit.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	If the partial redraw could be scheduled TK_ITEM_DONT_REDRAW
+ *	is set in itemPtr, else the canvas redraws the whole item.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+FinishPpolyEdit(
+    Tk_PathCanvas canvas,
+    PpolyItem *ppolyPtr,
+    int hasArrows,		/* Arrowheads must be set up again. */
+    int recompute,		/* The bare bbox may have shrunk. */
+    PathRect *newPtr,		/* Bare bbox of inserted vertices. */
+    PathRect *damagePtr)	/* Bare bbox of affected vertices. */
+{
+    Tk_PathItem *itemPtr = &ppolyPtr->headerEx.header;
+    Tk_PathStyle style;
+    Tk_PathState state = itemPtr->state;
+    PathRect damage;
+
+    ppolyPtr->maxNumSegments = ppolyPtr->numPoints + 2;
+    if (state == TK_PATHSTATE_NULL) {
+	state = TkPathCanvasState(canvas);
+    }
+    if (hasArrows) {
+	ConfigureArrows(canvas, ppolyPtr);
+    }
+    if (hasArrows || (state == TK_PATHSTATE_HIDDEN)
+	    || (ppolyPtr->numPoints == 0)) {
+	ComputePpolyBbox(canvas, ppolyPtr);
+	return;
+    }
+    style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
+    damage = GetPpolyDamageBbox(&style, damagePtr);
+    if (recompute) {
+	ComputePpolyBbox(canvas, ppolyPtr);
+    } else if (newPtr != NULL) {
+	IncludePointInRect(&itemPtr->bbox, newPtr->x1, newPtr->y1);
+	IncludePointInRect(&itemPtr->bbox, newPtr->x2, newPtr->y2);
+	IncludePointInRect(&itemPtr->totalBbox, damage.x1, damage.y1);
+	IncludePointInRect(&itemPtr->totalBbox, damage.x2, damage.y2);
+	SetGenericPathHeaderBbox(itemPtr, style.matrixPtr,
+		&itemPtr->totalBbox);
+    }
+    EventuallyRedrawPathRect(canvas, style.matrixPtr, &damage);
+    SetAncestorsDirtyBbox(itemPtr);
+    itemPtr->redraw_flags |= TK_ITEM_DONT_REDRAW;
+    TkPathCanvasFreeInheritedStyle(&style);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PpolyInsert --
+ *
+ *	Insert coords into a polyline or ppolygon item at a given
+ *	index. Only the atoms around the index are touched so that
+ *	appending to the end is O(1).
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The coords in the given item is modified.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+PpolyInsert(
+    Tk_PathCanvas canvas,	/* Canvas containing item. */
+    Tk_PathItem *itemPtr,	/* Item to be modified. */
+    int beforeThis,		/* Index before which new coordinates are to
+				 * be inserted. */
+    Tcl_Obj *obj)		/* New coordinates to be inserted. */
+{
+    PpolyItem *ppolyPtr = (PpolyItem *) itemPtr;
+    PathAtom *headPtr = NULL, *tailPtr = NULL, *prevPtr, *nextPtr;
+    PathRect newRect, damage;
+    PathPoint *pt;
+    Tcl_Obj **objv;
+    Tcl_Size objc, i;
+    double x, y;
+    int k, hasArrows, wasEmpty = (ppolyPtr->numPoints == 0);
+
+    if (!obj || (Tcl_ListObjGetElements(NULL, obj, &objc, &objv) != TCL_OK)
+	    || !objc || objc&1) {
+	return;
+    }
+    newRect = NewEmptyPathRect();
+    for (i = 0; i < objc; i += 2) {
+	PathAtom *atomPtr;
+
+	if ((Tcl_GetDoubleFromObj(NULL, objv[i], &x) != TCL_OK)
+		|| (Tcl_GetDoubleFromObj(NULL, objv[i+1], &y) != TCL_OK)) {
+	    if (headPtr != NULL) {
+		TkPathFreeAtoms(headPtr);
+	    }
+	    return;
+	}
+	atomPtr = NewLineToAtom(x, y);
+	IncludePointInRect(&newRect, x, y);
+	if (headPtr == NULL) {
+	    headPtr = atomPtr;
+	} else {
+	    tailPtr->nextPtr = atomPtr;
+	}
+	tailPtr = atomPtr;
+    }
+    k = beforeThis/2;
+    if (k < 0) {
+	k = 0;
+    } else if (k > ppolyPtr->numPoints) {
+	k = ppolyPtr->numPoints;
+    }
+    hasArrows = RestoreArrowEnds(ppolyPtr);
+
+    /*
+     * Splice the new atoms in after vertex k-1.
+     */
+
+    prevPtr = (k > 0) ? GetPpolyVertex(ppolyPtr, k-1) : NULL;
+    if (prevPtr == NULL) {
+	nextPtr = ppolyPtr->atomPtr;
+	if (nextPtr != NULL) {
+	    nextPtr->type = PATH_ATOM_L;
+	} else if (ppolyPtr->type == kPpolyTypePolygon) {
+	    nextPtr = NewCloseAtom(0.0, 0.0);
+	}
+	headPtr->type = PATH_ATOM_M;
+	ppolyPtr->atomPtr = headPtr;
+    } else {
+	nextPtr = prevPtr->nextPtr;
+	prevPtr->nextPtr = headPtr;
+    }
+    tailPtr->nextPtr = nextPtr;
+    if (k == ppolyPtr->numPoints) {
+	ppolyPtr->lastAtomPtr = tailPtr;
+    }
+    ppolyPtr->numPoints += objc/2;
+    if ((ppolyPtr->type == kPpolyTypePolygon) && (prevPtr == NULL)) {
+	PathAtom *closePtr = ppolyPtr->lastAtomPtr->nextPtr;
+
+	*PpolyAtomPoint(closePtr) = *PpolyAtomPoint(headPtr);
+    }
+
+    /*
+     * The segments that changed all lie between the vertex before and
+     * the vertex after the new ones, plus the closing segment.
+     */
+
+    damage = newRect;
+    if (prevPtr != NULL) {
+	pt = PpolyAtomPoint(prevPtr);
+	IncludePointInRect(&damage, pt->x, pt->y);
+    }
+    if ((nextPtr != NULL) && (nextPtr->type != PATH_ATOM_Z)) {
+	pt = PpolyAtomPoint(nextPtr);
+	IncludePointInRect(&damage, pt->x, pt->y);
+    }
+    if ((ppolyPtr->type == kPpolyTypePolygon)
+	    && ((prevPtr == NULL) || (tailPtr == ppolyPtr->lastAtomPtr))) {
+	pt = PpolyAtomPoint(ppolyPtr->atomPtr);
+	IncludePointInRect(&damage, pt->x, pt->y);
+	pt = PpolyAtomPoint(ppolyPtr->lastAtomPtr);
+	IncludePointInRect(&damage, pt->x, pt->y);
+    }
+    FinishPpolyEdit(canvas, ppolyPtr, hasArrows, wasEmpty, &newRect, &damage);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PpolyDeleteCoords --
+ *
+ *	Delete one or more coordinates from a polyline or ppolygon
+ *	item.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Coordinates between "first" and "last", inclusive, get deleted
+ *	from itemPtr. The bbox is only recomputed in full if one of
+ *	the deleted vertices was on its edge.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+PpolyDeleteCoords(
+    Tk_PathCanvas canvas,	/* Canvas containing itemPtr. */
+    Tk_PathItem *itemPtr,	/* Item in which to delete coordinates. */
+    int first,			/* Index of first coordinate to delete. */
+    int last)			/* Index of last coordinate to delete. */
+{
+    PpolyItem *ppolyPtr = (PpolyItem *) itemPtr;
+    PathAtom *prevPtr, *nextPtr, *delPtr, *atomPtr;
+    PathRect damage = NewEmptyPathRect();
+    PathRect *bboxPtr = &itemPtr->bbox;
+    PathPoint *pt;
+    int i, count, hasArrows, onEdge = 0;
+
+    first &= -2;
+    last &= -2;
+    if (first < 0) {
+	first = 0;
+    }
+    if (last >= 2*ppolyPtr->numPoints) {
+	last = 2*ppolyPtr->numPoints - 2;
+    }
+    if (first > last) {
+	return;
+    }
+    count = (last - first)/2 + 1;
+    hasArrows = RestoreArrowEnds(ppolyPtr);
+
+    prevPtr = (first > 0) ? GetPpolyVertex(ppolyPtr, first/2 - 1) : NULL;
+    delPtr = (prevPtr != NULL) ? prevPtr->nextPtr : ppolyPtr->atomPtr;
+    for (i = 0, atomPtr = delPtr; ; atomPtr = atomPtr->nextPtr) {
+	pt = PpolyAtomPoint(atomPtr);
+	IncludePointInRect(&damage, pt->x, pt->y);
+	if ((pt->x <= bboxPtr->x1) || (pt->x >= bboxPtr->x2)
+		|| (pt->y <= bboxPtr->y1) || (pt->y >= bboxPtr->y2)) {
+	    onEdge = 1;
+	}
+	if (++i == count) {
+	    break;
+	}
+    }
+    nextPtr = atomPtr->nextPtr;
+    atomPtr->nextPtr = NULL;
+    if (prevPtr != NULL) {
+	pt = PpolyAtomPoint(prevPtr);
+	IncludePointInRect(&damage, pt->x, pt->y);
+    }
+    if ((nextPtr != NULL) && (nextPtr->type != PATH_ATOM_Z)) {
+	pt = PpolyAtomPoint(nextPtr);
+	IncludePointInRect(&damage, pt->x, pt->y);
+    }
+    if ((ppolyPtr->type == kPpolyTypePolygon)
+	    && ((prevPtr == NULL) || (atomPtr == ppolyPtr->lastAtomPtr))) {
+	pt = PpolyAtomPoint(ppolyPtr->atomPtr);
+	IncludePointInRect(&damage, pt->x, pt->y);
+	pt = PpolyAtomPoint(ppolyPtr->lastAtomPtr);
+	IncludePointInRect(&damage, pt->x, pt->y);
+    }
+
+    /*
+     * Unlink and free the deleted atoms.
+     */
+
+    if (atomPtr == ppolyPtr->lastAtomPtr) {
+	ppolyPtr->lastAtomPtr = prevPtr;
+    }
+    ppolyPtr->numPoints -= count;
+    if (prevPtr != NULL) {
+	prevPtr->nextPtr = nextPtr;
+    } else if (ppolyPtr->numPoints == 0) {
+	if (nextPtr != NULL) {
+	    TkPathFreeAtoms(nextPtr);
+	}
+	ppolyPtr->atomPtr = NULL;
+    } else {
+	nextPtr->type = PATH_ATOM_M;
+	ppolyPtr->atomPtr = nextPtr;
+	if (ppolyPtr->type == kPpolyTypePolygon) {
+	    *PpolyAtomPoint(ppolyPtr->lastAtomPtr->nextPtr) =
+		    *PpolyAtomPoint(nextPtr);
+	}
+    }
+    TkPathFreeAtoms(delPtr);
+    FinishPpolyEdit(canvas, ppolyPtr, hasArrows, onEdge, NULL, &damage);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * GetPpolyIndex --
+ *
+ *	Parse an index into a polyline or ppolygon item and return
+ *	either its value or an error. Indices count coordinates, as
+ *	for the line item.
+ *
+ * Results:
+ *	A standard Tcl result. If all went well, then *indexPtr is
+ *	filled in with the index (into itemPtr) corresponding to
+ *	obj. Otherwise an error message is left in interp->result.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+GetPpolyIndex(
+    Tcl_Interp *interp,		/* Used for error reporting. */
+    Tk_PathCanvas canvas,	/* Canvas containing item. */
+    Tk_PathItem *itemPtr,	/* Item for which the index is being
+				 * specified. */
+    Tcl_Obj *obj,		/* Specification of a particular coord in
+				 * itemPtr's vertex list. */
+    int *indexPtr)		/* Where to store converted index. */
+{
+    PpolyItem *ppolyPtr = (PpolyItem *) itemPtr;
+    Tcl_Size length;
+    char *string = Tcl_GetStringFromObj(obj, &length);
+
+    if (string[0] == 'e') {
+	if (strncmp(string, "end", (unsigned) length) == 0) {
+	    *indexPtr = 2*ppolyPtr->numPoints;
+	} else {
+	badIndex:
+	    Tcl_SetResult(interp, NULL, TCL_STATIC);
+	    Tcl_AppendResult(interp, "bad index \"", string, "\"", NULL);
+	    return TCL_ERROR;
+	}
+    } else if (string[0] == '@') {
+	PathAtom *atomPtr;
+	PathPoint *pt;
+	double x, y, bestDist, dist;
+	char *end, *p;
+	int i;
+
+	p = string+1;
+	x = strtod(p, &end);
+	if ((end == p) || (*end != ',')) {
+	    goto badIndex;
+	}
+	p = end+1;
+	y = strtod(p, &end);
+	if ((end == p) || (*end != 0)) {
+	    goto badIndex;
+	}
+	bestDist = 1.0e36;
+	*indexPtr = 0;
+	for (i = 0, atomPtr = ppolyPtr->atomPtr; i < ppolyPtr->numPoints;
+		i++, atomPtr = atomPtr->nextPtr) {
+	    pt = PpolyAtomPoint(atomPtr);
+	    dist = hypot(pt->x - x, pt->y - y);
+	    if (dist < bestDist) {
+		bestDist = dist;
+		*indexPtr = 2*i;
+	    }
+	}
+    } else {
+	if (Tcl_GetIntFromObj(interp, obj, indexPtr) != TCL_OK) {
+	    goto badIndex;
+	}
+	*indexPtr &= -2;
+	if (*indexPtr < 0) {
+	    *indexPtr = 0;
+	} else if (*indexPtr > 2*ppolyPtr->numPoints) {
+	    *indexPtr = 2*ppolyPtr->numPoints;
+	}
+    }
+    return TCL_OK;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -24,6 +24,10 @@ typedef struct PrectItem  {
     double ry;
     int maxNumSegments;	    /* Max number of straight segments (for subpath)
                              * needed for Area and Point functions. */
+    int numShapes;	    /* Number of rectangles in this item. */
+    double *shapesPtr;	    /* x1 y1 x2 y2 for each rectangle if more
+                             * than one, else NULL and the rectangle is
+                             * kept in header.bbox. */
 } PrectItem;
 
 /*
@@ -31,6 +35,8 @@ typedef struct PrectItem  {
  */
 
 static void	ComputePrectBbox(Tk_PathCanvas canvas, PrectItem *prectPtr);
+static void	GetPrectShape(PrectItem *prectPtr, int shape,
+                        double *pointsPtr);
 static int	ConfigurePrect(Tcl_Interp *interp, Tk_PathCanvas canvas,
                         Tk_PathItem *itemPtr, Tcl_Size objc,
                         Tcl_Obj *const objv[], int flags);
@@ -46,6 +52,12 @@ static void	PrectBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int mask);
 static int	PrectCoords(Tcl_Interp *interp,
                         Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
                         Tcl_Size objc, Tcl_Obj *const objv[]);
+static int	PrectIndex(Tcl_Interp *interp, Tk_PathCanvas canvas,
+                        Tk_PathItem *itemPtr, Tcl_Obj *obj, int *indexPtr);
+static int	PrectShapeToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+                        Tk_PathStyle *stylePtr, int shape, double *areaPtr);
+static double	PrectShapeToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+                        Tk_PathStyle *stylePtr, int shape, double *pointPtr);
 static int	PrectToArea(Tk_PathCanvas canvas,
                         Tk_PathItem *itemPtr, double *rectPtr);
 static int	PrectToPdf(Tcl_Interp *interp,
@@ -61,8 +73,12 @@ static int	PrectToPostscript(Tcl_Interp *interp,
 static void	ScalePrect(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 			int compensate, double originX, double originY,
 			double scaleX, double scaleY);
+static void	SetMultiShapeBbox(PrectItem *prectPtr);
 static void	TranslatePrect(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 			int compensate, double deltaX, double deltaY);
+static int	ProcessCoords(Tcl_Interp *interp, Tk_PathCanvas canvas,
+			PrectItem *prectPtr, Tcl_Size objc,
+			Tcl_Obj *const objv[]);
 static PathAtom * MakePathAtoms(PrectItem *prectPtr, int needPath);
 
 
@@ -122,7 +138,7 @@ Tk_PathItemType tkpPrectType = {
     PrectToPdf,				/* pdfProc */
     ScalePrect,				/* scaleProc */
     TranslatePrect,			/* translateProc */
-    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemIndexProc *) PrectIndex,/* indexProc */
     (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
     (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
@@ -157,6 +173,8 @@ CreatePrect(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
     itemPtr->bbox = NewEmptyPathRect();
     itemPtr->totalBbox = NewEmptyPathRect();
     prectPtr->maxNumSegments = 100;		/* Crude overestimate. */
+    prectPtr->numShapes = 1;
+    prectPtr->shapesPtr = NULL;
 
     optionTable = Tk_CreateOptionTable(interp, optionSpecs);
     itemPtr->optionTable = optionTable;
@@ -171,7 +189,7 @@ CreatePrect(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
             break;
         }
     }
-    if (CoordsForRectangularItems(interp, canvas, &itemPtr->bbox, i, objv) != TCL_OK) {
+    if (ProcessCoords(interp, canvas, prectPtr, i, objv) != TCL_OK) {
         goto error;
     }
     if (ConfigurePrect(interp, canvas, itemPtr, objc-i, objv+i, 0) == TCL_OK) {
@@ -195,13 +213,116 @@ PrectCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
     PrectItem *prectPtr = (PrectItem *) itemPtr;
     int result;
 
-    result = CoordsForRectangularItems(interp, canvas, &itemPtr->bbox, objc, objv);
-    if ((result == TCL_OK) && ((objc == 1) || (objc == 4))) {
+    result = ProcessCoords(interp, canvas, prectPtr, objc, objv);
+    if ((result == TCL_OK) && (objc > 0)) {
 	ComputePrectBbox(canvas, prectPtr);
     }
     return result;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * ProcessCoords --
+ *
+ *	Sets or gets the coords of a prect. Any multiple of four
+ *	coordinates is accepted and gives that many rectangles
+ *	sharing the options of the item.
+ *
+ * Results:
+ *	Standard tcl result.
+ *
+ * Side effects:
+ *	May replace the rectangles of the item.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+ProcessCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, PrectItem *prectPtr,
+        Tcl_Size objc, Tcl_Obj *const objv[])
+{
+    Tk_PathItem *itemPtr = (Tk_PathItem *) prectPtr;
+    double *coordsPtr, *p, x1, y1;
+    int i, numShapes;
+
+    if (objc == 0) {
+        if (prectPtr->shapesPtr != NULL) {
+            Tcl_SetObjResult(interp, MultiShapeCoordsObj(prectPtr->shapesPtr,
+                    4*prectPtr->numShapes));
+            return TCL_OK;
+        }
+        return CoordsForRectangularItems(interp, canvas, &itemPtr->bbox,
+                objc, objv);
+    }
+    if (CoordsForMultiShapeItems(interp, canvas, 4, objc, objv,
+            &coordsPtr, &numShapes) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
+    /*
+     * Normalize the corners!
+     */
+    for (i = 0, p = coordsPtr; i < numShapes; i++, p += 4) {
+        x1 = p[0];
+        y1 = p[1];
+        p[0] = MIN(x1, p[2]);
+        p[1] = MIN(y1, p[3]);
+        p[2] = MAX(x1, p[2]);
+        p[3] = MAX(y1, p[3]);
+    }
+    if (prectPtr->shapesPtr != NULL) {
+        ckfree((char *) prectPtr->shapesPtr);
+        prectPtr->shapesPtr = NULL;
+    }
+    if (numShapes == 1) {
+        itemPtr->bbox.x1 = coordsPtr[0];
+        itemPtr->bbox.y1 = coordsPtr[1];
+        itemPtr->bbox.x2 = coordsPtr[2];
+        itemPtr->bbox.y2 = coordsPtr[3];
+        ckfree((char *) coordsPtr);
+    } else {
+        prectPtr->shapesPtr = coordsPtr;
+    }
+    prectPtr->numShapes = numShapes;
+    return TCL_OK;
+}
+
+static void
+GetPrectShape(PrectItem *prectPtr, int shape, double *pointsPtr)
+{
+    Tk_PathItem *itemPtr = (Tk_PathItem *) prectPtr;
+
+    if (prectPtr->shapesPtr != NULL) {
+        memcpy(pointsPtr, prectPtr->shapesPtr + 4*shape, 4*sizeof(double));
+    } else {
+        pointsPtr[0] = itemPtr->bbox.x1;
+        pointsPtr[1] = itemPtr->bbox.y1;
+        pointsPtr[2] = itemPtr->bbox.x2;
+        pointsPtr[3] = itemPtr->bbox.y2;
+    }
+}
+
+/*
+ * For multiple rectangles the header bbox is their union.
+ */
+
+static void
+SetMultiShapeBbox(PrectItem *prectPtr)
+{
+    Tk_PathItem *itemPtr = (Tk_PathItem *) prectPtr;
+    double *p = prectPtr->shapesPtr;
+    int i;
+
+    if (p != NULL) {
+        itemPtr->bbox = NewEmptyPathRect();
+        for (i = 0; i < prectPtr->numShapes; i++, p += 4) {
+            IncludePointInRect(&itemPtr->bbox, p[0], p[1]);
+            IncludePointInRect(&itemPtr->bbox, p[2], p[3]);
+        }
+    }
+}
+
 void
 ComputePrectBbox(Tk_PathCanvas canvas, PrectItem *prectPtr)
 {
@@ -210,6 +331,7 @@ ComputePrectBbox(Tk_PathCanvas canvas, PrectItem *prectPtr)
     Tk_PathStyle style;
     Tk_PathState state = itemExPtr->header.state;
 
+    SetMultiShapeBbox(prectPtr);
     if (state == TK_PATHSTATE_NULL) {
 	state = TkPathCanvasState(canvas);
     }
@@ -282,16 +404,28 @@ ConfigurePrect(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 static PathAtom *
 MakePathAtoms(PrectItem *prectPtr, int needPath)
 {
-    Tk_PathItem *itemPtr = (Tk_PathItem *) prectPtr;
-    PathAtom *atomPtr;
+    PathAtom *atomPtr, *firstAtomPtr = NULL, *lastAtomPtr = NULL;
     double points[4];
+    int i;
 
-    points[0] = itemPtr->bbox.x1;
-    points[1] = itemPtr->bbox.y1;
-    points[2] = itemPtr->bbox.x2;
-    points[3] = itemPtr->bbox.y2;
-    TkPathMakePrectAtoms(points, prectPtr->rx, prectPtr->ry, needPath, &atomPtr);
-    return atomPtr;
+    /*
+     * All rectangles go into a single path which is drawn in one go.
+     */
+    for (i = 0; i < prectPtr->numShapes; i++) {
+        GetPrectShape(prectPtr, i, points);
+        TkPathMakePrectAtoms(points, prectPtr->rx, prectPtr->ry, needPath,
+                &atomPtr);
+        if (lastAtomPtr == NULL) {
+            firstAtomPtr = atomPtr;
+        } else {
+            lastAtomPtr->nextPtr = atomPtr;
+        }
+        for (lastAtomPtr = atomPtr; lastAtomPtr->nextPtr != NULL;
+                lastAtomPtr = lastAtomPtr->nextPtr) {
+            /* empty */
+        }
+    }
+    return firstAtomPtr;
 }
 
 static void
@@ -307,6 +441,9 @@ DeletePrect(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display)
     if (itemExPtr->styleInst != NULL) {
 	TkPathFreeStyle(itemExPtr->styleInst);
     }
+    if (prectPtr->shapesPtr != NULL) {
+	ckfree((char *) prectPtr->shapesPtr);
+    }
     Tk_FreeConfigOptions((char *) itemPtr, itemPtr->optionTable,
 			 Tk_PathCanvasTkwin(canvas));
 }
@@ -340,48 +477,63 @@ PrectToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
 {
     PrectItem *prectPtr = (PrectItem *) itemPtr;
     Tk_PathStyle style;
+    double dist;
+
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    dist = MultiShapeToPoint(canvas, itemPtr, &style, prectPtr->numShapes,
+            PrectShapeToPoint, pointPtr, NULL);
+    TkPathCanvasFreeInheritedStyle(&style);
+    return dist;
+}
+
+static double
+PrectShapeToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        Tk_PathStyle *stylePtr, int shape, double *pointPtr)
+{
+    PrectItem *prectPtr = (PrectItem *) itemPtr;
     TMatrix *mPtr;
-    PathRect *rectPtr = &itemPtr->bbox;
+    double rect[4];
     double bareRect[4];
     double width, dist;
     int rectiLinear = 0;
     int filled;
 
-    style = TkPathCanvasInheritStyle(itemPtr, 0);
-    filled = HaveAnyFillFromPathColor(style.fill);
+    filled = HaveAnyFillFromPathColor(stylePtr->fill);
     width = 0.0;
-    if (style.strokeColor != NULL) {
-        width = style.strokeWidth;
+    if (stylePtr->strokeColor != NULL) {
+        width = stylePtr->strokeWidth;
     }
-    mPtr = style.matrixPtr;
+    mPtr = stylePtr->matrixPtr;
+    GetPrectShape(prectPtr, shape, rect);
 
     /* Try to be economical about this for pure rectangles. */
     if ((prectPtr->rx <= 1.0) && (prectPtr->ry <= 1.0)) {
         if (mPtr == NULL) {
             rectiLinear = 1;
-            bareRect[0] = rectPtr->x1;
-            bareRect[1] = rectPtr->y1;
-            bareRect[2] = rectPtr->x2;
-            bareRect[3] = rectPtr->y2;
+            bareRect[0] = rect[0];
+            bareRect[1] = rect[1];
+            bareRect[2] = rect[2];
+            bareRect[3] = rect[3];
         } else if (TMATRIX_IS_RECTILINEAR(mPtr)) {
 
             /* This is a situation we can treat in a simplified way. Apply the transform here. */
             rectiLinear = 1;
-            bareRect[0] = mPtr->a * rectPtr->x1 + mPtr->tx;
-            bareRect[1] = mPtr->d * rectPtr->y1 + mPtr->ty;
-            bareRect[2] = mPtr->a * rectPtr->x2 + mPtr->tx;
-            bareRect[3] = mPtr->d * rectPtr->y2 + mPtr->ty;
+            bareRect[0] = mPtr->a * rect[0] + mPtr->tx;
+            bareRect[1] = mPtr->d * rect[1] + mPtr->ty;
+            bareRect[2] = mPtr->a * rect[2] + mPtr->tx;
+            bareRect[3] = mPtr->d * rect[3] + mPtr->ty;
         }
     }
     if (rectiLinear) {
         dist = PathRectToPoint(bareRect, width, filled, pointPtr);
     } else {
-	PathAtom *atomPtr = MakePathAtoms(prectPtr, 1);
-        dist = GenericPathToPoint(canvas, itemPtr, &style, atomPtr,
+	PathAtom *atomPtr;
+
+	TkPathMakePrectAtoms(rect, prectPtr->rx, prectPtr->ry, 1, &atomPtr);
+        dist = GenericPathToPoint(canvas, itemPtr, stylePtr, atomPtr,
             prectPtr->maxNumSegments, pointPtr);
 	TkPathFreeAtoms(atomPtr);
     }
-    TkPathCanvasFreeInheritedStyle(&style);
     return dist;
 }
 
@@ -389,53 +541,99 @@ static int
 PrectToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
 {
     PrectItem *prectPtr = (PrectItem *) itemPtr;
-    Tk_PathItemEx *itemExPtr = &prectPtr->headerEx;
-    Tk_PathStyle style = itemExPtr->style;  /* NB: We *copy* the style for temp usage. */
+    Tk_PathStyle style;
+    int area;
+
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    area = MultiShapeToArea(canvas, itemPtr, &style, prectPtr->numShapes,
+            PrectShapeToArea, areaPtr);
+    TkPathCanvasFreeInheritedStyle(&style);
+    return area;
+}
+
+static int
+PrectShapeToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        Tk_PathStyle *stylePtr, int shape, double *areaPtr)
+{
+    PrectItem *prectPtr = (PrectItem *) itemPtr;
     TMatrix *mPtr;
-    PathRect *rectPtr = &(itemPtr->bbox);
+    double rect[4];
     double bareRect[4];
     double width;
     int rectiLinear = 0;
     int filled, area;
 
-    style = TkPathCanvasInheritStyle(itemPtr, 0);
-    filled = HaveAnyFillFromPathColor(style.fill);
+    filled = HaveAnyFillFromPathColor(stylePtr->fill);
     width = 0.0;
-    if (style.strokeColor != NULL) {
-        width = style.strokeWidth;
+    if (stylePtr->strokeColor != NULL) {
+        width = stylePtr->strokeWidth;
     }
-    mPtr = style.matrixPtr;
+    mPtr = stylePtr->matrixPtr;
+    GetPrectShape(prectPtr, shape, rect);
 
     /* Try to be economical about this for pure rectangles. */
     if ((prectPtr->rx <= 1.0) && (prectPtr->ry <= 1.0)) {
         if (mPtr == NULL) {
             rectiLinear = 1;
-            bareRect[0] = rectPtr->x1;
-            bareRect[1] = rectPtr->y1;
-            bareRect[2] = rectPtr->x2;
-            bareRect[3] = rectPtr->y2;
+            bareRect[0] = rect[0];
+            bareRect[1] = rect[1];
+            bareRect[2] = rect[2];
+            bareRect[3] = rect[3];
         } else if (TMATRIX_IS_RECTILINEAR(mPtr)) {
 
             /* This is a situation we can treat in a simplified way. Apply the transform here. */
             rectiLinear = 1;
-            bareRect[0] = mPtr->a * rectPtr->x1 + mPtr->tx;
-            bareRect[1] = mPtr->d * rectPtr->y1 + mPtr->ty;
-            bareRect[2] = mPtr->a * rectPtr->x2 + mPtr->tx;
-            bareRect[3] = mPtr->d * rectPtr->y2 + mPtr->ty;
+            bareRect[0] = mPtr->a * rect[0] + mPtr->tx;
+            bareRect[1] = mPtr->d * rect[1] + mPtr->ty;
+            bareRect[2] = mPtr->a * rect[2] + mPtr->tx;
+            bareRect[3] = mPtr->d * rect[3] + mPtr->ty;
         }
     }
     if (rectiLinear) {
         area = PathRectToArea(bareRect, width, filled, areaPtr);
     } else {
-	PathAtom *atomPtr = MakePathAtoms(prectPtr, 1);
-        area = GenericPathToArea(canvas, itemPtr, &style,
+	PathAtom *atomPtr;
+
+	TkPathMakePrectAtoms(rect, prectPtr->rx, prectPtr->ry, 1, &atomPtr);
+        area = GenericPathToArea(canvas, itemPtr, stylePtr,
                 atomPtr, prectPtr->maxNumSegments, areaPtr);
 	TkPathFreeAtoms(atomPtr);
     }
-    TkPathCanvasFreeInheritedStyle(&style);
     return area;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * PrectIndex --
+ *
+ *	Returns the index of a rectangle of a prect item holding
+ *	many of them, see GetMultiShapeIndex().
+ *
+ * Results:
+ *	Standard tcl result.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PrectIndex(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+    Tcl_Obj *obj, int *indexPtr)
+{
+    PrectItem *prectPtr = (PrectItem *) itemPtr;
+    Tk_PathStyle style;
+    int result;
+
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    result = GetMultiShapeIndex(interp, canvas, itemPtr, &style,
+            prectPtr->numShapes, PrectShapeToPoint, obj, indexPtr);
+    TkPathCanvasFreeInheritedStyle(&style);
+    return result;
+}
+
 static int
 PrectToPdf(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
     Tcl_Size objc, Tcl_Obj *const objv[], int prepass)
@@ -443,7 +641,6 @@ PrectToPdf(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
     Tk_PathStyle style;
     PathAtom *atomPtr;
     PrectItem *prectPtr = (PrectItem *) itemPtr;
-    double points[4];
     Tk_PathState state = itemPtr->state;
     int result;
 
@@ -454,11 +651,7 @@ PrectToPdf(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 	return TCL_OK;
     }
     style = TkPathCanvasInheritStyle(itemPtr, 0);
-    points[0] = itemPtr->bbox.x1;
-    points[1] = itemPtr->bbox.y1;
-    points[2] = itemPtr->bbox.x2;
-    points[3] = itemPtr->bbox.y2;
-    TkPathMakePrectAtoms(points, prectPtr->rx, prectPtr->ry, 0, &atomPtr);
+    atomPtr = MakePathAtoms(prectPtr, 0);
     result = TkPathPdf(interp, atomPtr, &style, &itemPtr->bbox, objc, objv);
     TkPathFreeAtoms(atomPtr);
     TkPathCanvasFreeInheritedStyle(&style);
@@ -478,9 +671,27 @@ static void
 ScalePrect(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int compensate,
     double originX, double originY, double scaleX, double scaleY)
 {
+    PrectItem *prectPtr = (PrectItem *) itemPtr;
+    double *p, x1, y1;
+    int i;
+
     CompensateScale(itemPtr, compensate, &originX, &originY, &scaleX, &scaleY);
 
-    ScalePathRect(&itemPtr->bbox, originX, originY, scaleX, scaleY);
+    if (prectPtr->shapesPtr != NULL) {
+        for (i = 0, p = prectPtr->shapesPtr; i < prectPtr->numShapes; i++, p += 4) {
+            x1 = originX + scaleX*(p[0] - originX);
+            y1 = originY + scaleY*(p[1] - originY);
+            p[2] = originX + scaleX*(p[2] - originX);
+            p[3] = originY + scaleY*(p[3] - originY);
+            p[0] = MIN(x1, p[2]);
+            p[1] = MIN(y1, p[3]);
+            p[2] = MAX(x1, p[2]);
+            p[3] = MAX(y1, p[3]);
+        }
+        SetMultiShapeBbox(prectPtr);
+    } else {
+        ScalePathRect(&itemPtr->bbox, originX, originY, scaleX, scaleY);
+    }
     ScaleItemHeader(itemPtr, originX, originY, scaleX, scaleY);
 }
 
@@ -488,13 +699,85 @@ static void
 TranslatePrect(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int compensate,
     double deltaX, double deltaY)
 {
+    PrectItem *prectPtr = (PrectItem *) itemPtr;
+    double *p;
+    int i;
+
     CompensateTranslate(itemPtr, compensate, &deltaX, &deltaY);
 
+    if (prectPtr->shapesPtr != NULL) {
+        for (i = 0, p = prectPtr->shapesPtr; i < 2*prectPtr->numShapes; i++, p += 2) {
+            p[0] += deltaX;
+            p[1] += deltaY;
+        }
+    }
+
     /* Just translate the bbox'es as well. */
     TranslatePathRect(&itemPtr->bbox, deltaX, deltaY);
     TranslateItemHeader(itemPtr, deltaX, deltaY);
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathPrectOpaqueArea --
+ *
+ *	Tells the canvas redraw whether the item paints an opaque
+ *	rectangle, that hides whatever is below it. Only a solid fill
+ *	without transparency qualifies; rounded corners are cut off with
+ *	the larger radius, and of several rectangles the largest is used.
+ *
+ * Results:
+ *	1 if so with the rectangle, before the transformation, and the
+ *	transformation filled in, else 0.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathPrectOpaqueArea(Tk_PathItem *itemPtr, double *rectPtr,
+	TMatrix *matrixPtr)
+{
+    PrectItem *prectPtr = (PrectItem *) itemPtr;
+    Tk_PathStyle style;
+    double rect[4], area, maxArea = 0.0;
+    double inset = MAX(prectPtr->rx, prectPtr->ry);
+    int i, opaque;
+
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    opaque = (style.fill != NULL) && (style.fill->color != NULL)
+	    && (style.fill->gradientInstPtr == NULL)
+	    && (style.fillOpacity >= 1.0);
+    if (opaque) {
+	if (style.matrixPtr != NULL) {
+	    *matrixPtr = *style.matrixPtr;
+	} else {
+	    TMatrix unit = kPathUnitTMatrix;
+	    *matrixPtr = unit;
+	}
+    }
+    TkPathCanvasFreeInheritedStyle(&style);
+    if (!opaque) {
+	return 0;
+    }
+    for (i = 0; i < prectPtr->numShapes; i++) {
+	GetPrectShape(prectPtr, i, rect);
+	rect[0] += inset;
+	rect[1] += inset;
+	rect[2] -= inset;
+	rect[3] -= inset;
+	area = (rect[2] - rect[0]) * (rect[3] - rect[1]);
+	if ((rect[2] > rect[0]) && (rect[3] > rect[1]) && (area > maxArea)) {
+	    memcpy(rectPtr, rect, 4*sizeof(double));
+	    maxArea = area;
+	}
+    }
+    return (maxArea > 0.0);
+}
+
 /*
  * Local Variables:
  * mode: c
@@ -665,27 +665,14 @@ drawptext(Tcl_Interp *interp, PtextItem *ptextPtr, Tcl_Obj *ret, Tcl_Obj *cmdl)
     for (token = linebreak(utf8, &savep); token != NULL;
 	 token = linebreak(NULL, &savep)) {
 	if (cmdl != NULL) {
-	    Tcl_Obj *cmd;
-
 	    /*
 	     * Use provided callback for formatting/encoding text.
 	     */
-	    cmd = Tcl_DuplicateObj(cmdl);
-	    Tcl_IncrRefCount(cmd);
-	    if (Tcl_ListObjAppendElement(interp, cmd,
-			Tcl_NewStringObj(token, strlen(token))) != TCL_OK) {
-		Tcl_DecrRefCount(cmd);
-		result = TCL_ERROR;
-		break;
-	    }		
-	    if (Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT) != TCL_OK) {
-		Tcl_DecrRefCount(cmd);
+	    Tcl_AppendToObj(ret, "(", 1);
+	    if (TkPathPdfAddText(interp, cmdl, token, ret) != TCL_OK) {
 		result = TCL_ERROR;
 		break;
 	    }
-	    Tcl_DecrRefCount(cmd);
-	    Tcl_AppendToObj(ret, "(", 1);
-	    Tcl_AppendObjToObj(ret, Tcl_GetObjResult(interp));
 	    Tcl_AppendToObj(ret, ") Tj\nT*\n", 8);
 	} else {
 	    Tcl_DStringSetLength(&ds, 0);
@@ -776,40 +763,17 @@ PtextToPdf(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 	style.strokeColor = ptextPtr->headerEx.style.strokeColor;
     }
     if (objc > 0) {
-	Tcl_Size retc;
-	Tcl_Obj *gs, *cmd, **retv;
+	Tcl_Obj *gs, *gsName;
 
 	gs = TkPathExtGS(&style, NULL);
 	if (gs != NULL) {
-	    cmd = Tcl_DuplicateObj(objv[0]);
-	    Tcl_IncrRefCount(cmd);
-	    if (Tcl_ListObjAppendElement(interp, cmd, gs) != TCL_OK) {
-		Tcl_DecrRefCount(cmd);
-		Tcl_DecrRefCount(gs);
-		result = TCL_ERROR;
-		goto done;
-	    }		
-	    if (Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT) != TCL_OK) {
-		Tcl_DecrRefCount(cmd);
-		result = TCL_ERROR;
-		goto done;
-	    }
-	    Tcl_DecrRefCount(cmd);
-	    /*
-	     * Get name of extended graphics state.
-	     */
-	    if (Tcl_ListObjGetElements(interp, Tcl_GetObjResult(interp),
-				       &retc, &retv) != TCL_OK) {
-		result = TCL_ERROR;
-		goto done;
-	    }
-	    if (retc < 2) {
-		Tcl_SetResult(interp, (char *) "missing PDF id/name",
-			      TCL_STATIC);
+	    if (TkPathPdfAddExtGState(interp, objv[0], gs, 0, &gsName)
+		!= TCL_OK) {
 		result = TCL_ERROR;
 		goto done;
 	    }
-	    Tcl_AppendPrintfToObj(ret, "/%s gs\n", Tcl_GetString(retv[1]));
+	    Tcl_AppendPrintfToObj(ret, "/%s gs\n", Tcl_GetString(gsName));
+	    Tcl_DecrRefCount(gsName);
 	}
     }
     hasStroke = (style.strokeColor != NULL);
@@ -0,0 +1,1195 @@
+/*
+ * tkCanvPtiles.c --
+ *
+ *	This file implements the ptiles canvas item, an image too large
+ *	to keep in one photo. The image is split into square tiles at
+ *	several levels of detail, each level half the size of the one
+ *	before, and a Tcl command serves them on demand. Only the tiles
+ *	visible at the current scale are ever asked for, and the most
+ *	recently drawn ones are kept up to a memory budget.
+ *
+ */
+
+#include "tkIntPath.h"
+#include "tkpCanvas.h"
+#include "tkCanvPathUtil.h"
+#include "tkPathStyle.h"
+
+#define BBOX_OUT 2.0
+#define PTILES_MAX_LEVELS 24
+
+/*
+ * States of a tile. A tile is created queued when it is first needed
+ * for drawing; the next time the application is idle it gets a photo
+ * and the command is asked to fill it. It is ready once the photo has
+ * any pixels, whenever the command gets around to that.
+ */
+
+enum {
+    PTILE_QUEUED,
+    PTILE_REQUESTED,
+    PTILE_READY
+};
+
+struct PtilesItem;
+
+typedef struct PtilesTile {
+    struct PtilesItem *ptilesPtr;
+    Tcl_HashEntry *hPtr;	/* Entry in the tile table; its key is
+				 * {level col row}. */
+    int state;			/* One of the PTILE_* states. */
+    Tcl_Obj *nameObj;		/* Name of the photo, once requested. */
+    Tk_Image image;
+    Tk_PhotoHandle photo;
+    Tk_PhotoHandle ownPhoto;	/* The photo created for the tile. It is
+				 * deleted with the tile only if nameObj
+				 * still refers to it. */
+    void *custom;		/* The photo as converted by TkPathImage. */
+    long size;			/* Bytes of the photo and of custom
+				 * counted against -cachesize. */
+    unsigned long stamp;	/* Display pass the tile was last
+				 * needed in. */
+    struct PtilesTile *prevPtr;	/* Tiles in least recently used order, */
+    struct PtilesTile *nextPtr;	/* the most recent first. */
+    struct PtilesTile *queuePtr;/* Next tile waiting to be requested. */
+} PtilesTile;
+
+/*
+ * The structure below defines the record for each ptiles item.
+ */
+
+typedef struct PtilesItem  {
+    Tk_PathItemEx headerEx; /* Generic stuff that's the same for all
+                             * types.  MUST BE FIRST IN STRUCTURE. */
+    double fillOpacity;
+    TMatrix *matrixPtr;	    /*  a  b   default (NULL): 1 0
+				c  d		   0 1
+				tx ty 		   0 0 */
+    double coord[2];	    /* Anchor coord. */
+    Tcl_Obj *commandObj;    /* Command serving the tiles. */
+    int imageWidth;	    /* Size of the full resolution image. */
+    int imageHeight;
+    int tileSize;	    /* Tiles are this many pixels square, except
+			     * at the right and bottom edges. */
+    int levels;		    /* The -levels option, 0 for as many as it
+			     * takes to fit the image in one tile. */
+    int numLevels;	    /* Levels actually used. */
+    int cacheSize;	    /* Memory budget in kilobytes. */
+    double width;	    /* If 0 use the image width or height. */
+    double height;
+    Tk_Anchor anchor;       /* Where to anchor image relative to (x,y). */
+    int interpolation;
+    Tcl_HashTable tileTable;/* All tiles, keyed by {level col row}. */
+    PtilesTile *firstPtr;   /* Most recently used tile. */
+    PtilesTile *lastPtr;    /* Least recently used tile. */
+    long cacheBytes;	    /* Sum of the tile sizes. */
+    PtilesTile *queueFirstPtr; /* Tiles to request when idle. */
+    PtilesTile *queueLastPtr;
+    int idlePending;	    /* PtilesRequestProc is scheduled. */
+    unsigned long stamp;    /* Counts display passes. */
+} PtilesItem;
+
+/*
+ * Prototypes for procedures defined in this file:
+ */
+
+static void	ComputePtilesBbox(Tk_PathCanvas canvas, PtilesItem *ptilesPtr);
+static int	ConfigurePtiles(Tcl_Interp *interp, Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, Tcl_Size objc,
+			Tcl_Obj *const objv[], int flags);
+static int	CreatePtiles(Tcl_Interp *interp,
+			Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+			Tcl_Size objc, Tcl_Obj *const objv[]);
+static void	DeletePtiles(Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, Display *display);
+static void	DisplayPtiles(Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, Display *display, Drawable dst,
+			int x, int y, int width, int height);
+static void	PtilesBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+			int mask);
+static int	PtilesCoords(Tcl_Interp *interp,
+			Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+			Tcl_Size objc, Tcl_Obj *const objv[]);
+static int	PtilesToArea(Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, double *rectPtr);
+static double	PtilesToPoint(Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, double *coordPtr);
+static void	ScalePtiles(Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, int compensate,
+			double originX, double originY,
+			double scaleX, double scaleY);
+static void	TranslatePtiles(Tk_PathCanvas canvas,
+			Tk_PathItem *itemPtr, int compensate,
+			double deltaX, double deltaY);
+static void	PtilesStyleChangedProc(ClientData clientData, int flags);
+static void	PtilesRequestProc(ClientData clientData);
+static void	TileChangedProc(ClientData clientData,
+			int x, int y, int width, int height,
+			int imgWidth, int imgHeight);
+static void	SetTileSize(PtilesItem *ptilesPtr, PtilesTile *tilePtr);
+static void	FreeTile(PtilesItem *ptilesPtr, PtilesTile *tilePtr);
+static void	FreeTiles(PtilesItem *ptilesPtr);
+static void	TrimTileCache(PtilesItem *ptilesPtr);
+
+enum {
+    PTILES_OPTION_INDEX_FILLOPACITY =
+	(1L << (PATH_STYLE_OPTION_INDEX_END + 1)),
+    PTILES_OPTION_INDEX_HEIGHT =
+	(1L << (PATH_STYLE_OPTION_INDEX_END + 2)),
+    PTILES_OPTION_INDEX_MATRIX =
+	(1L << (PATH_STYLE_OPTION_INDEX_END + 3)),
+    PTILES_OPTION_INDEX_WIDTH =
+	(1L << (PATH_STYLE_OPTION_INDEX_END + 4)),
+    PTILES_OPTION_INDEX_COMMAND =
+	(1L << (PATH_STYLE_OPTION_INDEX_END + 5)),
+    PTILES_OPTION_INDEX_TILES =
+	(1L << (PATH_STYLE_OPTION_INDEX_END + 6)),
+    PTILES_OPTION_INDEX_CACHESIZE =
+	(1L << (PATH_STYLE_OPTION_INDEX_END + 7))
+};
+
+static const char *imageInterpolationST[] = {
+    "none", "fast", "best", NULL
+};
+
+PATH_STYLE_CUSTOM_OPTION_MATRIX
+PATH_CUSTOM_OPTION_TAGS
+PATH_OPTION_STRING_TABLES_STATE
+
+#define PATH_OPTION_SPEC_FILLOPACITY			    \
+    {TK_OPTION_DOUBLE, "-fillopacity", NULL, NULL,	    \
+        "1.0", -1, offsetof(PtilesItem, fillOpacity),	    \
+	0, 0, PTILES_OPTION_INDEX_FILLOPACITY}
+
+#define PATH_OPTION_SPEC_HEIGHT				    \
+    {TK_OPTION_DOUBLE, "-height", NULL, NULL,		    \
+        "0", -1, offsetof(PtilesItem, height),		    \
+	0, 0, PTILES_OPTION_INDEX_HEIGHT}
+
+#define PATH_OPTION_SPEC_MATRIX				    \
+    {TK_OPTION_CUSTOM, "-matrix", NULL, NULL,		    \
+	NULL, -1, offsetof(PtilesItem, matrixPtr),	    \
+	TK_OPTION_NULL_OK, (ClientData) &matrixCO,	    \
+	PTILES_OPTION_INDEX_MATRIX}
+
+#define PATH_OPTION_SPEC_WIDTH				    \
+    {TK_OPTION_DOUBLE, "-width", NULL, NULL,		    \
+        "0", -1, offsetof(PtilesItem, width),		    \
+        0, 0, PTILES_OPTION_INDEX_WIDTH}
+
+#define PATH_OPTION_SPEC_ANCHOR				    \
+    {TK_OPTION_ANCHOR, "-anchor", NULL, NULL,		    \
+	"nw", -1, offsetof(PtilesItem, anchor),		    \
+	0, 0, 0}
+
+#define PATH_OPTION_SPEC_INTERPOLATION			    \
+    {TK_OPTION_STRING_TABLE, "-interpolation", NULL, NULL,  \
+        "fast", -1, offsetof(PtilesItem, interpolation),   \
+        0, (ClientData) imageInterpolationST, 0}
+
+#define PATH_OPTION_SPEC_COMMAND			    \
+    {TK_OPTION_STRING, "-command", NULL, NULL,		    \
+        NULL, offsetof(PtilesItem, commandObj), -1,	    \
+	TK_OPTION_NULL_OK, 0, PTILES_OPTION_INDEX_COMMAND}
+
+#define PATH_OPTION_SPEC_IMAGEWIDTH			    \
+    {TK_OPTION_INT, "-imagewidth", NULL, NULL,		    \
+        "0", -1, offsetof(PtilesItem, imageWidth),	    \
+	0, 0, PTILES_OPTION_INDEX_TILES}
+
+#define PATH_OPTION_SPEC_IMAGEHEIGHT			    \
+    {TK_OPTION_INT, "-imageheight", NULL, NULL,		    \
+        "0", -1, offsetof(PtilesItem, imageHeight),	    \
+	0, 0, PTILES_OPTION_INDEX_TILES}
+
+#define PATH_OPTION_SPEC_TILESIZE			    \
+    {TK_OPTION_INT, "-tilesize", NULL, NULL,		    \
+        "256", -1, offsetof(PtilesItem, tileSize),	    \
+	0, 0, PTILES_OPTION_INDEX_TILES}
+
+#define PATH_OPTION_SPEC_LEVELS				    \
+    {TK_OPTION_INT, "-levels", NULL, NULL,		    \
+        "0", -1, offsetof(PtilesItem, levels),		    \
+	0, 0, PTILES_OPTION_INDEX_TILES}
+
+#define PATH_OPTION_SPEC_CACHESIZE			    \
+    {TK_OPTION_INT, "-cachesize", NULL, NULL,		    \
+        "65536", -1, offsetof(PtilesItem, cacheSize),	    \
+	0, 0, PTILES_OPTION_INDEX_CACHESIZE}
+
+static Tk_OptionSpec optionSpecs[] = {
+    PATH_OPTION_SPEC_CORE(Tk_PathItemEx),
+    PATH_OPTION_SPEC_PARENT,
+    PATH_OPTION_SPEC_MATRIX,
+    PATH_OPTION_SPEC_FILLOPACITY,
+    PATH_OPTION_SPEC_HEIGHT,
+    PATH_OPTION_SPEC_WIDTH,
+    PATH_OPTION_SPEC_ANCHOR,
+    PATH_OPTION_SPEC_INTERPOLATION,
+    PATH_OPTION_SPEC_COMMAND,
+    PATH_OPTION_SPEC_IMAGEWIDTH,
+    PATH_OPTION_SPEC_IMAGEHEIGHT,
+    PATH_OPTION_SPEC_TILESIZE,
+    PATH_OPTION_SPEC_LEVELS,
+    PATH_OPTION_SPEC_CACHESIZE,
+    PATH_OPTION_SPEC_END
+};
+
+/*
+ * The structures below defines the 'ptiles' item type by means
+ * of procedures that can be invoked by generic item code.
+ */
+
+Tk_PathItemType tkpPtilesType = {
+    "ptiles",				/* name */
+    sizeof(PtilesItem),			/* itemSize */
+    CreatePtiles,			/* createProc */
+    optionSpecs,			/* optionSpecs */
+    ConfigurePtiles,			/* configureProc */
+    PtilesCoords,			/* coordProc */
+    DeletePtiles,			/* deleteProc */
+    DisplayPtiles,			/* displayProc */
+    0,					/* flags */
+    PtilesBbox,				/* bboxProc */
+    PtilesToPoint,			/* pointProc */
+    PtilesToArea,			/* areaProc */
+#ifndef TKP_NO_POSTSCRIPT
+    (Tk_PathItemPostscriptProc *) NULL,	/* postscriptProc */
+#endif
+    (Tk_PathItemPdfProc *) NULL,	/* pdfProc */
+    ScalePtiles,			/* scaleProc */
+    TranslatePtiles,			/* translateProc */
+    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
+    (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
+    (Tk_PathItemInsertProc *) NULL,	/* insertProc */
+    (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
+    (Tk_PathItemType *) NULL,		/* nextPtr */
+    1,					/* isPathType */
+};
+
+static int
+CreatePtiles(Tcl_Interp *interp, Tk_PathCanvas canvas,
+    Tk_PathItem *itemPtr, Tcl_Size objc, Tcl_Obj *const objv[])
+{
+    PtilesItem *ptilesPtr = (PtilesItem *) itemPtr;
+    Tk_PathItemEx *itemExPtr = &ptilesPtr->headerEx;
+    Tcl_Size i;
+    Tk_OptionTable optionTable;
+
+    if (objc == 0) {
+        Tcl_Panic("canvas did not pass any coords\n");
+    }
+
+    /*
+     * Carry out initialization that is needed to set defaults and to
+     * allow proper cleanup after errors during the the remainder of
+     * this procedure.
+     */
+    TkPathInitStyle(&itemExPtr->style);
+    itemExPtr->canvas = canvas;
+    itemExPtr->styleObj = NULL;
+    itemExPtr->styleInst = NULL;
+    ptilesPtr->fillOpacity = 1.0;
+    ptilesPtr->matrixPtr = NULL;
+    ptilesPtr->commandObj = NULL;
+    ptilesPtr->imageWidth = 0;
+    ptilesPtr->imageHeight = 0;
+    ptilesPtr->tileSize = 256;
+    ptilesPtr->levels = 0;
+    ptilesPtr->numLevels = 0;
+    ptilesPtr->cacheSize = 0;
+    ptilesPtr->height = 0;
+    ptilesPtr->width = 0;
+    ptilesPtr->anchor = TK_ANCHOR_NW;
+    ptilesPtr->interpolation = kPathImageInterpolationFast;
+    Tcl_InitHashTable(&ptilesPtr->tileTable, 3);
+    ptilesPtr->firstPtr = NULL;
+    ptilesPtr->lastPtr = NULL;
+    ptilesPtr->cacheBytes = 0;
+    ptilesPtr->queueFirstPtr = NULL;
+    ptilesPtr->queueLastPtr = NULL;
+    ptilesPtr->idlePending = 0;
+    ptilesPtr->stamp = 0;
+    itemPtr->bbox = NewEmptyPathRect();
+
+    optionTable = Tk_CreateOptionTable(interp, optionSpecs);
+    itemPtr->optionTable = optionTable;
+    if (Tk_InitOptions(interp, (char *) ptilesPtr, optionTable,
+	    Tk_PathCanvasTkwin(canvas)) != TCL_OK) {
+        goto error;
+    }
+
+    for (i = 1; i < objc; i++) {
+        char *arg = Tcl_GetString(objv[i]);
+        if ((arg[0] == '-') && (arg[1] >= 'a') && (arg[1] <= 'z')) {
+            break;
+        }
+    }
+    if (CoordsForPointItems(interp, canvas, ptilesPtr->coord, i, objv)
+	!= TCL_OK) {
+        goto error;
+    }
+    if (ConfigurePtiles(interp, canvas, itemPtr, objc-i, objv+i, 0)
+	== TCL_OK) {
+        return TCL_OK;
+    }
+
+    error:
+    /*
+     * NB: We must unlink the item here since the ConfigurePtiles()
+     *     link it to the root by default.
+     */
+    TkPathCanvasItemDetach(itemPtr);
+    DeletePtiles(canvas, itemPtr, Tk_Display(Tk_PathCanvasTkwin(canvas)));
+    return TCL_ERROR;
+}
+
+static int
+PtilesCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+    Tcl_Size objc, Tcl_Obj *const objv[])
+{
+    PtilesItem *ptilesPtr = (PtilesItem *) itemPtr;
+    int result;
+
+    result = CoordsForPointItems(interp, canvas, ptilesPtr->coord, objc, objv);
+    if ((result == TCL_OK) && ((objc == 1) || (objc == 2))) {
+        ComputePtilesBbox(canvas, ptilesPtr);
+    }
+    return result;
+}
+
+/*
+ * This is just a convenience function to obtain any style matrix.
+ */
+
+static TMatrix
+GetTMatrix(PtilesItem *ptilesPtr)
+{
+    TMatrix *matrixPtr;
+    Tk_PathStyle *stylePtr;
+    TMatrix matrix = TkPathCanvasInheritTMatrix((Tk_PathItem *) ptilesPtr);
+
+    matrixPtr = ptilesPtr->matrixPtr;
+    if (ptilesPtr->headerEx.styleInst != NULL) {
+	stylePtr = ptilesPtr->headerEx.styleInst->masterPtr;
+	if (stylePtr->mask & PATH_STYLE_OPTION_MATRIX) {
+	    matrixPtr = stylePtr->matrixPtr;
+	}
+    }
+    if (matrixPtr != NULL) {
+	MMulTMatrix(matrixPtr, &matrix);
+    }
+    return matrix;
+}
+
+static void
+ComputePtilesBbox(Tk_PathCanvas canvas, PtilesItem *ptilesPtr)
+{
+    Tk_PathItem *itemPtr = (Tk_PathItem *)ptilesPtr;
+    TMatrix matrix;
+    double width, height;
+    PathRect bbox;
+
+    if ((ptilesPtr->imageWidth <= 0) || (ptilesPtr->imageHeight <= 0)) {
+        ptilesPtr->headerEx.header.x1 = ptilesPtr->headerEx.header.x2 =
+        ptilesPtr->headerEx.header.y1 = ptilesPtr->headerEx.header.y2 = -1;
+        return;
+    }
+    width = (ptilesPtr->width > 0.0) ?
+	    ptilesPtr->width : ptilesPtr->imageWidth;
+    height = (ptilesPtr->height > 0.0) ?
+	    ptilesPtr->height : ptilesPtr->imageHeight;
+    bbox.x1 = ptilesPtr->coord[0];
+    bbox.y1 = ptilesPtr->coord[1];
+
+    switch (ptilesPtr->anchor) {
+	case TK_ANCHOR_NW:
+	case TK_ANCHOR_W:
+	case TK_ANCHOR_SW:
+            bbox.x1 = ptilesPtr->coord[0];
+            break;
+
+	case TK_ANCHOR_N:
+	case TK_ANCHOR_CENTER:
+	case TK_ANCHOR_S:
+            bbox.x1 = ptilesPtr->coord[0] - width/2.0;
+            break;
+
+	case TK_ANCHOR_NE:
+	case TK_ANCHOR_E:
+	case TK_ANCHOR_SE:
+            bbox.x1 = ptilesPtr->coord[0] - width;
+	    break;
+#if TK_MAJOR_VERSION >= 9
+        case TK_ANCHOR_NULL:
+            break;
+#endif
+    }
+    bbox.x2 = bbox.x1 + width;
+
+    switch (ptilesPtr->anchor) {
+	case TK_ANCHOR_NW:
+	case TK_ANCHOR_N:
+	case TK_ANCHOR_NE:
+            bbox.y1 = ptilesPtr->coord[1];
+            break;
+
+	case TK_ANCHOR_W:
+	case TK_ANCHOR_CENTER:
+	case TK_ANCHOR_E:
+            bbox.y1 = ptilesPtr->coord[1] - height/2.0;
+            break;
+
+	case TK_ANCHOR_SW:
+	case TK_ANCHOR_S:
+	case TK_ANCHOR_SE:
+            bbox.y1 = ptilesPtr->coord[1] - height;
+	    break;
+#if TK_MAJOR_VERSION >= 9
+        case TK_ANCHOR_NULL:
+            break;
+#endif
+    }
+    bbox.y2 = bbox.y1 + height;
+
+    bbox.x1 -= BBOX_OUT;
+    bbox.x2 += BBOX_OUT;
+    bbox.y1 -= BBOX_OUT;
+    bbox.y2 += BBOX_OUT;
+
+    itemPtr->bbox = bbox;
+    itemPtr->totalBbox = itemPtr->bbox;
+    matrix = GetTMatrix(ptilesPtr);
+    SetGenericPathHeaderBbox(&ptilesPtr->headerEx.header, &matrix, &bbox);
+}
+
+static int
+ConfigurePtiles(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+    Tcl_Size objc, Tcl_Obj *const objv[], int flags)
+{
+    PtilesItem *ptilesPtr = (PtilesItem *) itemPtr;
+    Tk_Window tkwin;
+    Tk_SavedOptions savedOptions;
+    Tk_PathItem *parentPtr;
+    Tcl_Obj *errorResult = NULL;
+    int error, mask = 0, size;
+
+    tkwin = Tk_PathCanvasTkwin(canvas);
+    for (error = 0; error <= 1; error++) {
+	if (!error) {
+	    if (Tk_SetOptions(interp, (char *) ptilesPtr, itemPtr->optionTable,
+		    objc, objv, tkwin, &savedOptions, &mask) != TCL_OK) {
+		continue;
+	    }
+	} else {
+	    if (errorResult != NULL) {
+		Tcl_DecrRefCount(errorResult);
+	    }
+	    errorResult = Tcl_GetObjResult(interp);
+	    Tcl_IncrRefCount(errorResult);
+	    Tk_RestoreSavedOptions(&savedOptions);
+	}
+
+	/*
+	 * Take each custom option, not handled in Tk_SetOptions, in turn.
+	 */
+	if (mask & PATH_CORE_OPTION_PARENT) {
+	    if (TkPathCanvasFindGroup(interp, canvas, itemPtr->parentObj,
+				      &parentPtr) != TCL_OK) {
+		continue;
+	    }
+	    TkPathCanvasSetParent(parentPtr, itemPtr);
+	} else if ((itemPtr->id != 0) && (itemPtr->parentPtr == NULL)) {
+	    /*
+	     * If item not root and parent not set we must set it
+	     * to root by default.
+	     */
+	    CanvasSetParentToRoot(itemPtr);
+	}
+
+	if (mask & PATH_CORE_OPTION_STYLENAME) {
+	    TkPathStyleInst *styleInst = NULL;
+
+	    if (ptilesPtr->headerEx.styleObj != NULL) {
+		styleInst = TkPathGetStyle(interp,
+			Tcl_GetString(ptilesPtr->headerEx.styleObj),
+			TkPathCanvasStyleTable(canvas), PtilesStyleChangedProc,
+			(ClientData) itemPtr);
+		if (styleInst == NULL) {
+		    continue;
+		}
+	    } else {
+		styleInst = NULL;
+	    }
+	    if (ptilesPtr->headerEx.styleInst != NULL) {
+		TkPathFreeStyle(ptilesPtr->headerEx.styleInst);
+	    }
+	    ptilesPtr->headerEx.styleInst = styleInst;
+	}
+
+	if ((ptilesPtr->imageWidth < 0) || (ptilesPtr->imageHeight < 0)
+		|| (ptilesPtr->levels < 0) || (ptilesPtr->cacheSize < 0)) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "-imagewidth, -imageheight, -levels and -cachesize "
+		    "must not be negative", -1));
+	    continue;
+	}
+	if (ptilesPtr->tileSize <= 0) {
+	    Tcl_SetObjResult(interp,
+		    Tcl_NewStringObj("-tilesize must be positive", -1));
+	    continue;
+	}
+
+	/*
+	 * If we reach this on the first pass we are OK and continue below.
+	 */
+	break;
+    }
+    if (!error) {
+	Tk_FreeSavedOptions(&savedOptions);
+    }
+    ptilesPtr->fillOpacity = MAX(0.0, MIN(1.0, ptilesPtr->fillOpacity));
+
+    if (errorResult != NULL) {
+	Tcl_SetObjResult(interp, errorResult);
+	Tcl_DecrRefCount(errorResult);
+	return TCL_ERROR;
+    }
+
+    /*
+     * A different command or layout invalidates all tiles we have.
+     */
+    if (mask & (PTILES_OPTION_INDEX_COMMAND | PTILES_OPTION_INDEX_TILES)) {
+	FreeTiles(ptilesPtr);
+    }
+    ptilesPtr->numLevels = MIN(ptilesPtr->levels, PTILES_MAX_LEVELS);
+    if (ptilesPtr->numLevels == 0) {
+	size = MAX(ptilesPtr->imageWidth, ptilesPtr->imageHeight);
+	for (ptilesPtr->numLevels = 1; (size > ptilesPtr->tileSize)
+		&& (ptilesPtr->numLevels < PTILES_MAX_LEVELS);
+		ptilesPtr->numLevels++) {
+	    size = (size + 1) / 2;
+	}
+    }
+    if (mask & PTILES_OPTION_INDEX_CACHESIZE) {
+	TrimTileCache(ptilesPtr);
+    }
+
+    /*
+     * Recompute bounding box for path.
+     */
+    ComputePtilesBbox(canvas, ptilesPtr);
+    return TCL_OK;
+}
+
+static void
+DeletePtiles(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display)
+{
+    PtilesItem *ptilesPtr = (PtilesItem *) itemPtr;
+
+    if (ptilesPtr->headerEx.styleInst != NULL) {
+	TkPathFreeStyle(ptilesPtr->headerEx.styleInst);
+    }
+    FreeTiles(ptilesPtr);
+    Tcl_DeleteHashTable(&ptilesPtr->tileTable);
+    if (ptilesPtr->idlePending) {
+	Tcl_CancelIdleCall(PtilesRequestProc, (ClientData) ptilesPtr);
+    }
+    Tk_FreeConfigOptions((char *) ptilesPtr, itemPtr->optionTable,
+			 Tk_PathCanvasTkwin(canvas));
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TileRect --
+ *
+ *	Finds the area a tile covers, in the item coordinates the image
+ *	is drawn in.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+TileRect(PtilesItem *ptilesPtr, int level, int col, int row, PathRect *rPtr)
+{
+    Tk_PathItem *itemPtr = (Tk_PathItem *) ptilesPtr;
+    double xscale, yscale, span;
+
+    xscale = (ptilesPtr->width > 0.0) ?
+	    ptilesPtr->width / ptilesPtr->imageWidth : 1.0;
+    yscale = (ptilesPtr->height > 0.0) ?
+	    ptilesPtr->height / ptilesPtr->imageHeight : 1.0;
+    span = (double) ptilesPtr->tileSize * (1 << level);
+    rPtr->x1 = col * span;
+    rPtr->y1 = row * span;
+    rPtr->x2 = MIN(rPtr->x1 + span, (double) ptilesPtr->imageWidth);
+    rPtr->y2 = MIN(rPtr->y1 + span, (double) ptilesPtr->imageHeight);
+    rPtr->x1 = itemPtr->bbox.x1 + BBOX_OUT + rPtr->x1 * xscale;
+    rPtr->y1 = itemPtr->bbox.y1 + BBOX_OUT + rPtr->y1 * yscale;
+    rPtr->x2 = itemPtr->bbox.x1 + BBOX_OUT + rPtr->x2 * xscale;
+    rPtr->y2 = itemPtr->bbox.y1 + BBOX_OUT + rPtr->y2 * yscale;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * UseTile --
+ *
+ *	Looks up a tile, optionally creating it and queueing it to be
+ *	requested when idle. Tiles that are found are marked as used in
+ *	the current display pass.
+ *
+ * Results:
+ *	The tile, or NULL if there is none and 'create' is 0.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static PtilesTile *
+UseTile(PtilesItem *ptilesPtr, int level, int col, int row, int create)
+{
+    PtilesTile *tilePtr;
+    Tcl_HashEntry *hPtr;
+    int key[3], isNew;
+
+    key[0] = level, key[1] = col, key[2] = row;
+    if (!create) {
+	hPtr = Tcl_FindHashEntry(&ptilesPtr->tileTable, (char *) key);
+	if (hPtr == NULL) {
+	    return NULL;
+	}
+	tilePtr = (PtilesTile *) Tcl_GetHashValue(hPtr);
+    } else {
+	hPtr = Tcl_CreateHashEntry(&ptilesPtr->tileTable, (char *) key,
+		&isNew);
+	if (isNew) {
+	    tilePtr = (PtilesTile *) ckalloc(sizeof(PtilesTile));
+	    memset(tilePtr, 0, sizeof(PtilesTile));
+	    tilePtr->ptilesPtr = ptilesPtr;
+	    tilePtr->hPtr = hPtr;
+	    tilePtr->state = PTILE_QUEUED;
+	    Tcl_SetHashValue(hPtr, tilePtr);
+	    if (ptilesPtr->queueLastPtr != NULL) {
+		ptilesPtr->queueLastPtr->queuePtr = tilePtr;
+	    } else {
+		ptilesPtr->queueFirstPtr = tilePtr;
+	    }
+	    ptilesPtr->queueLastPtr = tilePtr;
+	    if (!ptilesPtr->idlePending) {
+		Tcl_DoWhenIdle(PtilesRequestProc, (ClientData) ptilesPtr);
+		ptilesPtr->idlePending = 1;
+	    }
+	} else {
+	    tilePtr = (PtilesTile *) Tcl_GetHashValue(hPtr);
+	}
+    }
+
+    /*
+     * Move it first in the least recently used list.
+     */
+    if (tilePtr != ptilesPtr->firstPtr) {
+	if (tilePtr->prevPtr != NULL) {
+	    tilePtr->prevPtr->nextPtr = tilePtr->nextPtr;
+	    if (tilePtr->nextPtr != NULL) {
+		tilePtr->nextPtr->prevPtr = tilePtr->prevPtr;
+	    } else {
+		ptilesPtr->lastPtr = tilePtr->prevPtr;
+	    }
+	}
+	tilePtr->prevPtr = NULL;
+	tilePtr->nextPtr = ptilesPtr->firstPtr;
+	if (ptilesPtr->firstPtr != NULL) {
+	    ptilesPtr->firstPtr->prevPtr = tilePtr;
+	}
+	ptilesPtr->firstPtr = tilePtr;
+	if (ptilesPtr->lastPtr == NULL) {
+	    ptilesPtr->lastPtr = tilePtr;
+	}
+    }
+    tilePtr->stamp = ptilesPtr->stamp;
+    return tilePtr;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayTiles --
+ *
+ *	Draws the ready tiles of one level within a rectangle of full
+ *	resolution pixels, or, if ctx is NULL, only asks for the missing
+ *	ones.
+ *
+ * Results:
+ *	The number of tiles that are not ready.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+DisplayTiles(PtilesItem *ptilesPtr, TkPathContext ctx, int level,
+    PathRect *areaPtr)
+{
+    PtilesTile *tilePtr;
+    PathRect r;
+    double span = (double) ptilesPtr->tileSize * (1 << level);
+    int col, row, col1, row1, col2, row2, converted, missing = 0;
+
+    col1 = (int) (areaPtr->x1 / span);
+    row1 = (int) (areaPtr->y1 / span);
+    col2 = (int) ceil(areaPtr->x2 / span);
+    row2 = (int) ceil(areaPtr->y2 / span);
+    for (row = row1; row < row2; row++) {
+	for (col = col1; col < col2; col++) {
+	    tilePtr = UseTile(ptilesPtr, level, col, row, ctx == NULL);
+	    if ((tilePtr == NULL) || (tilePtr->state != PTILE_READY)) {
+		missing++;
+		continue;
+	    }
+	    if (ctx != NULL) {
+		TileRect(ptilesPtr, level, col, row, &r);
+		converted = (tilePtr->custom != NULL);
+		TkPathImage(ctx, tilePtr->image, tilePtr->photo,
+			r.x1, r.y1, r.x2 - r.x1, r.y2 - r.y1,
+			ptilesPtr->fillOpacity, NULL, 0.0,
+			ptilesPtr->interpolation, NULL, &tilePtr->custom);
+		if (converted != (tilePtr->custom != NULL)) {
+		    SetTileSize(ptilesPtr, tilePtr);
+		}
+	    }
+	}
+    }
+    return missing;
+}
+
+static void
+DisplayPtiles(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display,
+    Drawable drawable,
+    int x, int y, int width, int height)
+{
+    PtilesItem *ptilesPtr = (PtilesItem *) itemPtr;
+    TMatrix m = GetCanvasTMatrix(canvas), mi;
+    TkPathContext ctx;
+    PathRect area;
+    double xscale, yscale, px, py, scale;
+    int i, level;
+
+    if ((ptilesPtr->commandObj == NULL) || (ptilesPtr->imageWidth <= 0)
+	    || (ptilesPtr->imageHeight <= 0)) {
+	return;
+    }
+    ctx = ContextOfCanvas(canvas);
+    TkPathPushTMatrix(ctx, &m);
+    m = GetTMatrix(ptilesPtr);
+    if (m.a*m.d - m.b*m.c == 0.0) {
+	return;
+    }
+    TkPathPushTMatrix(ctx, &m);
+
+    /*
+     * Map the area to redraw back to full resolution image pixels.
+     */
+    xscale = (ptilesPtr->width > 0.0) ?
+	    ptilesPtr->width / ptilesPtr->imageWidth : 1.0;
+    yscale = (ptilesPtr->height > 0.0) ?
+	    ptilesPtr->height / ptilesPtr->imageHeight : 1.0;
+    PathInverseTMatrix(&m, &mi);
+    area = NewEmptyPathRect();
+    for (i = 0; i < 4; i++) {
+	px = (i & 1) ? x + width : x;
+	py = (i & 2) ? y + height : y;
+	PathApplyTMatrix(&mi, &px, &py);
+	IncludePointInRect(&area,
+		(px - itemPtr->bbox.x1 - BBOX_OUT) / xscale,
+		(py - itemPtr->bbox.y1 - BBOX_OUT) / yscale);
+    }
+    area.x1 = MAX(area.x1, 0.0);
+    area.y1 = MAX(area.y1, 0.0);
+    area.x2 = MIN(area.x2, (double) ptilesPtr->imageWidth);
+    area.y2 = MIN(area.y2, (double) ptilesPtr->imageHeight);
+    if ((area.x1 >= area.x2) || (area.y1 >= area.y2)) {
+	return;
+    }
+
+    /*
+     * Pick the level that leaves between one and two of its pixels per
+     * device pixel.
+     */
+    scale = MAX(hypot(m.a, m.b) * xscale, hypot(m.c, m.d) * yscale);
+    for (level = 0; (scale <= 0.5) && (level < ptilesPtr->numLevels - 1);
+	    level++) {
+	scale *= 2.0;
+    }
+
+    /*
+     * Until all tiles of the level are there, draw whatever coarser
+     * tiles we have below them.
+     */
+    ptilesPtr->stamp++;
+    if (DisplayTiles(ptilesPtr, NULL, level, &area) > 0) {
+	for (i = ptilesPtr->numLevels - 1; i > level; i--) {
+	    DisplayTiles(ptilesPtr, ctx, i, &area);
+	}
+    }
+    DisplayTiles(ptilesPtr, ctx, level, &area);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * PtilesRequestProc --
+ *
+ *	Idle callback that gives each queued tile a photo and asks the
+ *	-command to fill it, and then drops tiles above the cache budget.
+ *	The commands are evaluated last, and without touching the item
+ *	afterwards, since they may well delete it.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+PtilesRequestProc(ClientData clientData)
+{
+    PtilesItem *ptilesPtr = (PtilesItem *) clientData;
+    Tk_PathCanvas canvas = ptilesPtr->headerEx.canvas;
+    Tcl_Interp *interp = ((TkPathCanvas *) canvas)->interp;
+    Tk_Window tkwin = Tk_PathCanvasTkwin(canvas);
+    PtilesTile *tilePtr;
+    Tcl_Obj *scriptsObj, *scriptObj, **scriptv;
+    Tcl_Obj *createObj[3];
+    Tcl_Size i, scriptc;
+    int *key;
+
+    ptilesPtr->idlePending = 0;
+    scriptsObj = Tcl_NewObj();
+    Tcl_IncrRefCount(scriptsObj);
+    createObj[0] = Tcl_NewStringObj("image", -1);
+    createObj[1] = Tcl_NewStringObj("create", -1);
+    createObj[2] = Tcl_NewStringObj("photo", -1);
+    for (i = 0; i < 3; i++) {
+	Tcl_IncrRefCount(createObj[i]);
+    }
+    while ((tilePtr = ptilesPtr->queueFirstPtr) != NULL) {
+	ptilesPtr->queueFirstPtr = tilePtr->queuePtr;
+	tilePtr->queuePtr = NULL;
+	tilePtr->state = PTILE_REQUESTED;
+	if (Tcl_EvalObjv(interp, 3, createObj, TCL_EVAL_GLOBAL) != TCL_OK) {
+	    Tcl_BackgroundException(interp, TCL_ERROR);
+	    continue;
+	}
+	tilePtr->nameObj = Tcl_GetObjResult(interp);
+	Tcl_IncrRefCount(tilePtr->nameObj);
+	Tcl_ResetResult(interp);
+	tilePtr->image = Tk_GetImage(interp, tkwin,
+		Tcl_GetString(tilePtr->nameObj), TileChangedProc,
+		(ClientData) tilePtr);
+	tilePtr->photo = Tk_FindPhoto(interp, Tcl_GetString(tilePtr->nameObj));
+	tilePtr->ownPhoto = tilePtr->photo;
+
+	key = (int *) Tcl_GetHashKey(&ptilesPtr->tileTable, tilePtr->hPtr);
+	scriptObj = Tcl_DuplicateObj(ptilesPtr->commandObj);
+	Tcl_ListObjAppendElement(NULL, scriptObj, tilePtr->nameObj);
+	Tcl_ListObjAppendElement(NULL, scriptObj, Tcl_NewIntObj(key[0]));
+	Tcl_ListObjAppendElement(NULL, scriptObj, Tcl_NewIntObj(key[1]));
+	Tcl_ListObjAppendElement(NULL, scriptObj, Tcl_NewIntObj(key[2]));
+	Tcl_ListObjAppendElement(NULL, scriptsObj, scriptObj);
+    }
+    ptilesPtr->queueLastPtr = NULL;
+    for (i = 0; i < 3; i++) {
+	Tcl_DecrRefCount(createObj[i]);
+    }
+    TrimTileCache(ptilesPtr);
+
+    Tcl_ListObjGetElements(NULL, scriptsObj, &scriptc, &scriptv);
+    for (i = 0; i < scriptc; i++) {
+	if (Tcl_EvalObjEx(interp, scriptv[i], TCL_EVAL_GLOBAL) != TCL_OK) {
+	    Tcl_BackgroundException(interp, TCL_ERROR);
+	}
+    }
+    Tcl_ResetResult(interp);
+    Tcl_DecrRefCount(scriptsObj);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TileChangedProc --
+ *
+ *	Called when the photo of a tile changes, normally because the
+ *	-command has filled it. Keeps the converted pixels up to date
+ *	and redraws the area the tile covers.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+TileChangedProc(
+    ClientData clientData,	/* Pointer to the tile. */
+    int x, int y,		/* Upper left pixel (within image)
+                                 * that must be redisplayed. */
+    int width, int height,	/* Dimensions of area to redisplay
+                                 * (may be <= 0). */
+    int imgWidth, int imgHeight)/* New dimensions of image. */
+{
+    PtilesTile *tilePtr = (PtilesTile *) clientData;
+    PtilesItem *ptilesPtr = tilePtr->ptilesPtr;
+    Tk_PathCanvas canvas = ptilesPtr->headerEx.canvas;
+    Tcl_Interp *interp = ((TkPathCanvas *) canvas)->interp;
+    Tk_PhotoHandle photo;
+    TMatrix matrix;
+    PathRect r, damage;
+    double px, py;
+    int *key, i;
+
+    photo = Tk_FindPhoto(interp, Tcl_GetString(tilePtr->nameObj));
+    if ((photo == NULL) || (photo != tilePtr->photo)
+	    || !TkPathImageChanged(tilePtr->custom, photo,
+		    x, y, width, height)) {
+	TkPathImageFree(tilePtr->custom);
+	tilePtr->custom = NULL;
+    }
+    tilePtr->photo = photo;
+    if ((photo != NULL) && (imgWidth > 0) && (imgHeight > 0)) {
+	tilePtr->state = PTILE_READY;
+    } else {
+	tilePtr->state = PTILE_REQUESTED;
+    }
+    SetTileSize(ptilesPtr, tilePtr);
+    SetAncestorsDirtyBbox(&ptilesPtr->headerEx.header);
+
+    key = (int *) Tcl_GetHashKey(&ptilesPtr->tileTable, tilePtr->hPtr);
+    TileRect(ptilesPtr, key[0], key[1], key[2], &r);
+    matrix = GetTMatrix(ptilesPtr);
+    damage = NewEmptyPathRect();
+    for (i = 0; i < 4; i++) {
+	px = (i & 1) ? r.x2 : r.x1;
+	py = (i & 2) ? r.y2 : r.y1;
+	PathApplyTMatrix(&matrix, &px, &py);
+	IncludePointInRect(&damage, px, py);
+    }
+    Tk_PathCanvasEventuallyRedraw(canvas,
+	    (int) floor(damage.x1) - 1, (int) floor(damage.y1) - 1,
+	    (int) ceil(damage.x2) + 1, (int) ceil(damage.y2) + 1);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * SetTileSize --
+ *
+ *	Counts the photo of a ready tile and, once TkPathImage has made
+ *	it, its converted copy against -cachesize, and arranges for the
+ *	cache to be trimmed when that takes it over the budget. Smaller
+ *	copies a backend may keep for drawing downscaled are not counted.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+SetTileSize(PtilesItem *ptilesPtr, PtilesTile *tilePtr)
+{
+    int width, height;
+
+    ptilesPtr->cacheBytes -= tilePtr->size;
+    tilePtr->size = 0;
+    if ((tilePtr->state == PTILE_READY) && (tilePtr->photo != NULL)) {
+	Tk_PhotoGetSize(tilePtr->photo, &width, &height);
+	tilePtr->size = 4L * width * height;
+	if (tilePtr->custom != NULL) {
+	    tilePtr->size *= 2;
+	}
+    }
+    ptilesPtr->cacheBytes += tilePtr->size;
+    if ((ptilesPtr->cacheBytes > 1024L * ptilesPtr->cacheSize)
+	    && !ptilesPtr->idlePending) {
+	Tcl_DoWhenIdle(PtilesRequestProc, (ClientData) ptilesPtr);
+	ptilesPtr->idlePending = 1;
+    }
+}
+
+static void
+FreeTile(PtilesItem *ptilesPtr, PtilesTile *tilePtr)
+{
+    Tcl_Interp *interp = ((TkPathCanvas *) ptilesPtr->headerEx.canvas)->interp;
+    PtilesTile *prevPtr;
+    int owned = 0;
+
+    if (tilePtr->prevPtr != NULL) {
+	tilePtr->prevPtr->nextPtr = tilePtr->nextPtr;
+    } else {
+	ptilesPtr->firstPtr = tilePtr->nextPtr;
+    }
+    if (tilePtr->nextPtr != NULL) {
+	tilePtr->nextPtr->prevPtr = tilePtr->prevPtr;
+    } else {
+	ptilesPtr->lastPtr = tilePtr->prevPtr;
+    }
+    if ((tilePtr->state == PTILE_QUEUED)
+	    && (ptilesPtr->queueFirstPtr != NULL)) {
+	if (ptilesPtr->queueFirstPtr == tilePtr) {
+	    ptilesPtr->queueFirstPtr = tilePtr->queuePtr;
+	    prevPtr = NULL;
+	} else {
+	    for (prevPtr = ptilesPtr->queueFirstPtr;
+		    prevPtr->queuePtr != tilePtr; prevPtr = prevPtr->queuePtr) {
+		/* Empty loop body. */
+	    }
+	    prevPtr->queuePtr = tilePtr->queuePtr;
+	}
+	if (ptilesPtr->queueLastPtr == tilePtr) {
+	    ptilesPtr->queueLastPtr = prevPtr;
+	}
+    }
+    ptilesPtr->cacheBytes -= tilePtr->size;
+    Tcl_DeleteHashEntry(tilePtr->hPtr);
+    TkPathImageFree(tilePtr->custom);
+
+    /*
+     * The -command may have deleted the photo, and its name may since
+     * have been taken by a photo of the application's. That one is not
+     * ours to delete. Our instance goes first, since deleting the photo
+     * would otherwise call TileChangedProc on the tile being freed.
+     */
+    if (tilePtr->nameObj != NULL) {
+	owned = (tilePtr->ownPhoto != NULL) && (Tk_FindPhoto(interp,
+		Tcl_GetString(tilePtr->nameObj)) == tilePtr->ownPhoto);
+    }
+    if (tilePtr->image != NULL) {
+	Tk_FreeImage(tilePtr->image);
+    }
+    if (tilePtr->nameObj != NULL) {
+	if (owned) {
+	    Tk_DeleteImage(interp, Tcl_GetString(tilePtr->nameObj));
+	}
+	Tcl_DecrRefCount(tilePtr->nameObj);
+    }
+    ckfree((char *) tilePtr);
+}
+
+static void
+FreeTiles(PtilesItem *ptilesPtr)
+{
+    ptilesPtr->queueFirstPtr = NULL;
+    ptilesPtr->queueLastPtr = NULL;
+    while (ptilesPtr->firstPtr != NULL) {
+	FreeTile(ptilesPtr, ptilesPtr->firstPtr);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TrimTileCache --
+ *
+ *	Frees the least recently used tiles until the cache fits in its
+ *	budget again. Tiles needed in the latest display pass are always
+ *	kept, or they would only be asked for again.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+TrimTileCache(PtilesItem *ptilesPtr)
+{
+    PtilesTile *tilePtr, *prevPtr;
+
+    for (tilePtr = ptilesPtr->lastPtr; (tilePtr != NULL)
+	    && (ptilesPtr->cacheBytes > 1024L * ptilesPtr->cacheSize);
+	    tilePtr = prevPtr) {
+	prevPtr = tilePtr->prevPtr;
+	if (tilePtr->stamp != ptilesPtr->stamp) {
+	    FreeTile(ptilesPtr, tilePtr);
+	}
+    }
+}
+
+static void
+PtilesBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int mask)
+{
+    PtilesItem *ptilesPtr = (PtilesItem *) itemPtr;
+    ComputePtilesBbox(canvas, ptilesPtr);
+}
+
+static double
+PtilesToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
+{
+    PtilesItem *ptilesPtr = (PtilesItem *) itemPtr;
+    TMatrix m = GetTMatrix(ptilesPtr);
+    return PathRectToPointWithMatrix(itemPtr->bbox, &m, pointPtr);
+}
+
+static int
+PtilesToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
+{
+    PtilesItem *ptilesPtr = (PtilesItem *) itemPtr;
+    TMatrix m = GetTMatrix(ptilesPtr);
+    return PathRectToAreaWithMatrix(itemPtr->bbox, &m, areaPtr);
+}
+
+static void
+ScalePtiles(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+    int compensate, double originX, double originY,
+    double scaleX, double scaleY)
+{
+    PtilesItem *ptilesPtr = (PtilesItem *) itemPtr;
+
+    CompensateScale(itemPtr, compensate, &originX, &originY, &scaleX, &scaleY);
+
+    /* Scale the anchor point and the size; 0 stands for the image size. */
+    ptilesPtr->coord[0] = originX + scaleX*(ptilesPtr->coord[0] - originX);
+    ptilesPtr->coord[1] = originY + scaleY*(ptilesPtr->coord[1] - originY);
+    if (ptilesPtr->width <= 0.0) {
+	ptilesPtr->width = ptilesPtr->imageWidth;
+    }
+    if (ptilesPtr->height <= 0.0) {
+	ptilesPtr->height = ptilesPtr->imageHeight;
+    }
+    ptilesPtr->width *= fabs(scaleX);
+    ptilesPtr->height *= fabs(scaleY);
+    /* Recompute bounding box. */
+    ComputePtilesBbox(canvas, ptilesPtr);
+}
+
+static void
+TranslatePtiles(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int compensate,
+    double deltaX, double deltaY)
+{
+    PtilesItem *ptilesPtr = (PtilesItem *) itemPtr;
+
+    CompensateTranslate(itemPtr, compensate, &deltaX, &deltaY);
+
+    /* Translate coordinates. */
+    ptilesPtr->coord[0] += deltaX;
+    ptilesPtr->coord[1] += deltaY;
+    /* Recompute bounding box. */
+    ComputePtilesBbox(canvas, ptilesPtr);
+}
+
+static void
+PtilesStyleChangedProc(ClientData clientData, int flags)
+{
+    Tk_PathItem *itemPtr = (Tk_PathItem *) clientData;
+    PtilesItem *ptilesPtr = (PtilesItem *) itemPtr;
+
+    if (flags) {
+	if (flags & PATH_STYLE_FLAG_DELETE) {
+	    TkPathFreeStyle(ptilesPtr->headerEx.styleInst);
+	    ptilesPtr->headerEx.styleInst = NULL;
+	    Tcl_DecrRefCount(ptilesPtr->headerEx.styleObj);
+	    ptilesPtr->headerEx.styleObj = NULL;
+	}
+	SetAncestorsDirtyBbox(itemPtr);
+	Tk_PathCanvasEventuallyRedraw(ptilesPtr->headerEx.canvas,
+		itemPtr->x1, itemPtr->y1,
+		itemPtr->x2, itemPtr->y2);
+    }
+}
+
+/*
+ * Local Variables:
+ * mode: c
+ * c-basic-offset: 4
+ * fill-column: 78
+ * End:
+ */
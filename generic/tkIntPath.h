@@ -316,7 +316,11 @@ MODULE_SCOPE void   TkPathImage(TkPathContext ctx, Tk_Image image,
 			double x, double y, double width, double height,
 			double fillOpacity,
 			XColor *tintColor, double tintAmount,
-			int interpolation, PathRect *srcRegion);
+			int interpolation, PathRect *srcRegion,
+			void **customPtr);
+MODULE_SCOPE void   TkPathImageFree(void *custom);
+MODULE_SCOPE int    TkPathImageChanged(void *custom, Tk_PhotoHandle photo,
+			int x, int y, int width, int height);
 MODULE_SCOPE int    TkPathTextConfig(Tcl_Interp *interp,
 			Tk_PathTextStyle *textStylePtr, char *utf8,
 			void **customPtr);
@@ -332,6 +336,9 @@ MODULE_SCOPE void   TkPathSurfaceErase(TkPathContext ctx, double x, double y,
 			double width, double height);
 MODULE_SCOPE void   TkPathSurfaceToPhoto(Tcl_Interp *interp,
 			TkPathContext ctx, Tk_PhotoHandle photo);
+MODULE_SCOPE void   TkPathSurfaceDraw(TkPathContext ctx,
+			TkPathContext surface, double x, double y,
+			double opacity);
 
 /*
  * General path drawing using linked list of path atoms.
@@ -390,6 +397,7 @@ MODULE_SCOPE void   TkPathFillPolygon(Tk_PathCanvas canvas, double *coordPtr,
 MODULE_SCOPE int    TableLookup(LookupTable *map, int n, int from);
 MODULE_SCOPE void   PathParseDashToArray(Tk_Dash *dash, double width, int *len,
 			float **arrayPtrPtr);
+MODULE_SCOPE double *TkPathDashScaled(Tk_PathDash *dashPtr, double width);
 MODULE_SCOPE void   PathApplyTMatrix(TMatrix *m, double *x, double *y);
 MODULE_SCOPE void   PathApplyTMatrixToPoint(TMatrix *m, double in[2],
 			double out[2]);
@@ -409,8 +417,11 @@ MODULE_SCOPE void   PathCopyBitsPremultipliedAlphaBGRA(unsigned char *from,
 			unsigned char *to,
 			int width, int height, int bytesPerRow);
 MODULE_SCOPE int    ObjectIsEmpty(Tcl_Obj *objPtr);
-MODULE_SCOPE int    PathGetTMatrix(Tcl_Interp* interp, const char *list,
+MODULE_SCOPE int    PathGetTMatrix(Tcl_Interp* interp, Tcl_Obj *objPtr,
+			TMatrix *matrixPtr);
+MODULE_SCOPE int    PathGetTMatrixFromObj(Tcl_Interp* interp, Tcl_Obj *objPtr,
 			TMatrix *matrixPtr);
+MODULE_SCOPE Tcl_Obj *PathNewTMatrixObj(TMatrix *matrixPtr);
 MODULE_SCOPE int    PathGetTclObjFromTMatrix(Tcl_Interp* interp,
 			TMatrix *matrixPtr, Tcl_Obj **listObjPtrPtr);
 MODULE_SCOPE int    EndpointToCentralArcParameters(
@@ -436,6 +447,7 @@ MODULE_SCOPE int    TkPathGenericCmdDispatcher(
 			void (*freeProc)(Tcl_Interp *interp, char *recordPtr));
 MODULE_SCOPE void   PathStyleInit(Tcl_Interp* interp);
 MODULE_SCOPE void   PathGradientInit(Tcl_Interp* interp);
+MODULE_SCOPE void   PathMatrixInit(Tcl_Interp* interp);
 MODULE_SCOPE void   TkPathStyleMergeStyles(Tk_PathStyle *srcStyle,
 			Tk_PathStyle *dstStyle,
 			long flags);
@@ -587,6 +599,60 @@ MODULE_SCOPE Tcl_Obj *	TkPathExtGS(Tk_PathStyle *stylePtr, long *smaskRef);
 MODULE_SCOPE int	TkPathPdfNumber(Tcl_Obj *ret, int fracDigis,
 			    double number, const char *append);
 
+/*
+ * Resource writers for pdf output. The pdfProcs get their callbacks as
+ * arguments; the canvas "pdf" command passes its own writer, which is
+ * served in C, while any other argument is a Tcl command prefix that is
+ * evaluated with the resource appended. Names are returned with their
+ * reference count incremented.
+ */
+
+typedef struct TkPathPdfContext TkPathPdfContext;
+
+/*
+ * Resources made of an image or gradient are remembered by the writer
+ * under a key that holds the image or gradient and everything else the
+ * resource depends on. Unused fields must be zero.
+ */
+
+typedef struct TkPathPdfKey {
+    const void *ptr;		/* Image or gradient. */
+    double params[6];		/* Everything else the resource depends
+				 * on. */
+} TkPathPdfKey;
+
+typedef struct TkPathPdfResource {
+    long id;			/* Object number. */
+    Tcl_Obj *nameObj;		/* Resource name, or NULL. */
+    TMatrix tm;			/* Transform to draw it with. */
+} TkPathPdfResource;
+
+MODULE_SCOPE TkPathPdfContext *TkPathPdfGetContext(Tcl_Obj *callbackObj);
+MODULE_SCOPE int	TkPathPdfAddObj(Tcl_Interp *interp, Tcl_Obj *mkobj,
+			    Tcl_Obj *objPtr, long *idPtr);
+MODULE_SCOPE int	TkPathPdfAddExtGState(Tcl_Interp *interp,
+			    Tcl_Obj *mkextgs, Tcl_Obj *gsObj, long smaskId,
+			    Tcl_Obj **namePtrPtr);
+MODULE_SCOPE int	TkPathPdfAddGradient(Tcl_Interp *interp,
+			    Tcl_Obj *mkgrad, long id, Tcl_Obj **namePtrPtr);
+MODULE_SCOPE int	TkPathPdfAddImage(Tcl_Interp *interp,
+			    Tcl_Obj *mkimage, int width, int height,
+			    Tcl_Obj *objPtr, long *idPtr,
+			    Tcl_Obj **namePtrPtr);
+MODULE_SCOPE int	TkPathPdfAddText(Tcl_Interp *interp, Tcl_Obj *text,
+			    const char *string, Tcl_Obj *resultPtr);
+MODULE_SCOPE int	TkPathPdfFindResource(Tcl_Obj *callbackObj,
+			    const TkPathPdfKey *keyPtr,
+			    TkPathPdfResource *resPtr);
+MODULE_SCOPE void	TkPathPdfKeepResource(Tcl_Obj *callbackObj,
+			    const TkPathPdfKey *keyPtr,
+			    const TkPathPdfResource *resPtr);
+MODULE_SCOPE int	TkPathPdfGroup(Tcl_Interp *interp,
+			    TkPathPdfContext *contextPtr,
+			    Tk_PathItem *itemPtr, double opacity);
+MODULE_SCOPE int	TkPathPsNumber(Tcl_Obj *ret, double number,
+			    const char *append);
+
 /*
  * Support functions for error messages.
  */
@@ -17,6 +17,24 @@ MODULE_SCOPE int gDepixelize;
 
 static const char kPathSyntaxError[] = "syntax error in path definition";
 
+/*
+ * The path data object type caches the parsed atoms of a path
+ * description, so that a Tcl_Obj reused for many items or surface
+ * drawings is only parsed once.
+ */
+
+static void	DupPathDataInternalRep(Tcl_Obj *srcPtr, Tcl_Obj *copyPtr);
+static void	FreePathDataInternalRep(Tcl_Obj *objPtr);
+static int	SetPathDataFromAny(Tcl_Interp *interp, Tcl_Obj *objPtr);
+
+const Tcl_ObjType tkPathDataObjType = {
+    "tkpathdata",			/* name */
+    FreePathDataInternalRep,		/* freeIntRepProc */
+    DupPathDataInternalRep,		/* dupIntRepProc */
+    NULL,				/* updateStringProc */
+    SetPathDataFromAny			/* setFromAnyProc */
+};
+
 /*
  * A placeholder for the context we are working in.
  * The current and lastMove are always original untransformed coordinates.
@@ -53,21 +71,23 @@ static void	PathPdfOval(Tcl_Obj *list, TkPointsContext_ *context,
 static void	PathPdfRect(Tcl_Obj *list, TkPointsContext_ *context,
 			double x, double y, double width, double height);
 static int	PathPdfGradFuncType2(Tcl_Interp *interp, Tcl_Obj *mkobj,
-			int isAlpha, GradientStop *stop0, GradientStop *stop1);
+			int isAlpha, GradientStop *stop0, GradientStop *stop1,
+			long *idPtr);
 static int	PathPdfGradSoftMask(Tcl_Interp *interp, Tcl_Obj *mkobj,
-			PathRect *bbox, const char *gradName, long gradId,
-			TMatrix *tmPtr);
+			PathRect *bbox, Tcl_Obj *gradName, long gradId,
+			TMatrix *tmPtr, long *idPtr);
 static int	PathPdfGradient(Tcl_Interp *interp, int isAlpha, Tcl_Obj *mkobj,
 			Tcl_Obj *mkgrad, PathRect *bbox,
-			TkPathGradientMaster *gradientPtr, char **gradName,
+			TkPathGradientMaster *gradientPtr, Tcl_Obj **gradName,
 			long *gradId, TMatrix *tmPtr);
 static int	PathPdfLinearGradient(Tcl_Interp *interp, int isAlpha,
-			Tcl_Obj *mkobj,	Tcl_Obj *mkgrad, PathRect *bbox,
-			LinearGradientFill *fillPtr, TMatrix *mPtr);
+			Tcl_Obj *mkobj,	PathRect *bbox,
+			LinearGradientFill *fillPtr, TMatrix *mPtr,
+			long *idPtr);
 static int	PathPdfRadialGradient(Tcl_Interp *interp, int isAlpha,
-			Tcl_Obj *mkobj,	Tcl_Obj *mkgrad, PathRect *bbox,
+			Tcl_Obj *mkobj,	PathRect *bbox,
 			RadialGradientFill *fillPtr, TMatrix *mPtr,
-			TMatrix *tmPtr);
+			TMatrix *tmPtr, long *idPtr);
 
 /*---------------------------------------------------------------------------*/
 
@@ -827,6 +847,184 @@ TkPathFreeAtoms(PathAtom *pathAtomPtr)
     }
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCopyAtoms
+ *
+ *		Makes a private copy of a list of atoms, typically
+ *		shared ones from a TkPathData, that may then be modified.
+ *
+ * Results:
+ *		The new list which must be freed with TkPathFreeAtoms.
+ *
+ * Side effects:
+ *		Memory allocated.
+ *
+ *--------------------------------------------------------------
+ */
+
+PathAtom *
+TkPathCopyAtoms(PathAtom *atomPtr)
+{
+    PathAtom *firstPtr = NULL, *lastPtr = NULL, *copyPtr;
+    size_t size;
+
+    while (atomPtr != NULL) {
+        switch (atomPtr->type) {
+            case PATH_ATOM_M:
+                size = sizeof(MoveToAtom);
+                break;
+            case PATH_ATOM_L:
+                size = sizeof(LineToAtom);
+                break;
+            case PATH_ATOM_A:
+                size = sizeof(ArcAtom);
+                break;
+            case PATH_ATOM_Q:
+                size = sizeof(QuadBezierAtom);
+                break;
+            case PATH_ATOM_C:
+                size = sizeof(CurveToAtom);
+                break;
+            case PATH_ATOM_Z:
+                size = sizeof(CloseAtom);
+                break;
+            case PATH_ATOM_ELLIPSE:
+                size = sizeof(EllipseAtom);
+                break;
+            case PATH_ATOM_RECT:
+                size = sizeof(RectAtom);
+                break;
+            default:
+                Tcl_Panic("unknown path atom type %d", (int) atomPtr->type);
+                return NULL;
+        }
+        copyPtr = (PathAtom *) ckalloc((unsigned) size);
+        memcpy(copyPtr, atomPtr, size);
+        copyPtr->nextPtr = NULL;
+        if (lastPtr == NULL) {
+            firstPtr = copyPtr;
+        } else {
+            lastPtr->nextPtr = copyPtr;
+        }
+        lastPtr = copyPtr;
+        atomPtr = atomPtr->nextPtr;
+    }
+    return firstPtr;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathGetDataFromObj
+ *
+ *		Returns the parsed path data of a path description,
+ *		parsing it only if it is not already cached in objPtr.
+ *
+ * Results:
+ *		A standard Tcl result. On success *dataPtrPtr holds a
+ *		reference that must be given back with TkPathReleaseData.
+ *
+ * Side effects:
+ *		objPtr may be converted to tkPathDataObjType.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathGetDataFromObj(Tcl_Interp *interp, Tcl_Obj *objPtr,
+		     TkPathData **dataPtrPtr)
+{
+    TkPathData *dataPtr;
+
+    if (objPtr->typePtr != &tkPathDataObjType) {
+        if (SetPathDataFromAny(interp, objPtr) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    dataPtr = (TkPathData *) objPtr->internalRep.twoPtrValue.ptr1;
+    dataPtr->refCount++;
+    *dataPtrPtr = dataPtr;
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathReleaseData
+ *
+ *		Gives back a reference obtained from TkPathGetDataFromObj.
+ *
+ * Results:
+ *		None.
+ *
+ * Side effects:
+ *		The data is freed when its last user is gone.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkPathReleaseData(TkPathData *dataPtr)
+{
+    if (--dataPtr->refCount <= 0) {
+        TkPathFreeAtoms(dataPtr->atomPtr);
+        ckfree((char *) dataPtr);
+    }
+}
+
+static int
+SetPathDataFromAny(Tcl_Interp *interp, Tcl_Obj *objPtr)
+{
+    TkPathData *dataPtr;
+    PathAtom *atomPtr;
+    Tcl_Size len;
+    const Tcl_ObjType *typePtr;
+
+    if (TkPathParseToAtoms(interp, objPtr, &atomPtr, &len) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    dataPtr = (TkPathData *) ckalloc(sizeof(TkPathData));
+    dataPtr->refCount = 1;
+    dataPtr->atomPtr = atomPtr;
+    dataPtr->len = len;
+    dataPtr->bbox = GetGenericBarePathBbox(atomPtr);
+
+    /*
+     * We have no updateStringProc so the string rep must exist before
+     * the list rep, which may have been the only one, is dropped.
+     */
+
+    (void) Tcl_GetString(objPtr);
+    typePtr = objPtr->typePtr;
+    if ((typePtr != NULL) && (typePtr->freeIntRepProc != NULL)) {
+        typePtr->freeIntRepProc(objPtr);
+    }
+    objPtr->internalRep.twoPtrValue.ptr1 = (void *) dataPtr;
+    objPtr->internalRep.twoPtrValue.ptr2 = NULL;
+    objPtr->typePtr = &tkPathDataObjType;
+    return TCL_OK;
+}
+
+static void
+FreePathDataInternalRep(Tcl_Obj *objPtr)
+{
+    TkPathReleaseData((TkPathData *) objPtr->internalRep.twoPtrValue.ptr1);
+    objPtr->typePtr = NULL;
+}
+
+static void
+DupPathDataInternalRep(Tcl_Obj *srcPtr, Tcl_Obj *copyPtr)
+{
+    TkPathData *dataPtr = (TkPathData *) srcPtr->internalRep.twoPtrValue.ptr1;
+
+    dataPtr->refCount++;
+    copyPtr->internalRep.twoPtrValue.ptr1 = (void *) dataPtr;
+    copyPtr->internalRep.twoPtrValue.ptr2 = NULL;
+    copyPtr->typePtr = &tkPathDataObjType;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -1119,6 +1317,100 @@ TkPathArcToUsingBezier(TkPathContext ctx,
     }
 }
 
+/*
+ * Exact powers of ten used by the number formatters below.
+ */
+
+static const double pow10Table[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+    1e13, 1e14, 1e15
+};
+
+/*
+ *--------------------------------------------------------------
+ *
+ * FormatScaled --
+ *
+ *	Formats |number| rounded to fracDigits decimals like "%.*f" and
+ *	strips trailing zeros and a trailing decimal point, without going
+ *	through sprintf. This is the hot path of PDF and PostScript export.
+ *
+ * Results:
+ *	Length of the string in buffer, or -1 if the number can't be done
+ *	exactly this way. That is when it is not finite, too large, or so
+ *	close to a rounding tie that the scaled double can't decide it. The
+ *	caller then falls back to sprintf, so output is always identical.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+FormatScaled(
+    char *buffer,
+    int fracDigits,
+    double number)
+{
+    double a = (number < 0.0) ? -number : number;
+    double p, ip, f;
+    Tcl_WideUInt r, ipart, fpart;
+    char digits[TCL_INTEGER_SPACE];
+    int n, len = 0;
+
+    if ((fracDigits < 0) || (fracDigits > 15) || !(a < 1e15)) {
+	return -1;
+    }
+    p = a * pow10Table[fracDigits];
+    if (!(p < 1e15)) {
+	return -1;
+    }
+    ip = floor(p);
+    f = p - ip;
+
+    /*
+     * The product is off by at most half an ulp; stay clear of ties.
+     */
+
+    if (fabs(f - 0.5) <= p * 2.5e-16 + 1e-300) {
+	return -1;
+    }
+    r = (Tcl_WideUInt) ip + ((f > 0.5) ? 1 : 0);
+    if (r == 0) {
+	buffer[0] = '0';
+	buffer[1] = '\0';
+	return 1;
+    }
+    if (number < 0.0) {
+	buffer[len++] = '-';
+    }
+    ipart = r / (Tcl_WideUInt) pow10Table[fracDigits];
+    fpart = r % (Tcl_WideUInt) pow10Table[fracDigits];
+    n = 0;
+    do {
+	digits[n++] = (char) ('0' + (int) (ipart % 10));
+	ipart /= 10;
+    } while (ipart > 0);
+    while (n > 0) {
+	buffer[len++] = digits[--n];
+    }
+    if (fpart != 0) {
+	while ((fpart % 10) == 0) {
+	    fpart /= 10;
+	    fracDigits--;
+	}
+	buffer[len++] = '.';
+	for (n = fracDigits; n > 0; n--) {
+	    buffer[len + n - 1] = (char) ('0' + (int) (fpart % 10));
+	    fpart /= 10;
+	}
+	len += fracDigits;
+    }
+    buffer[len] = '\0';
+    return len;
+}
+
 /*---------------------------------------------------------------------------*/
 
 static int
@@ -1129,6 +1421,17 @@ PrintNumber(
 {
     int len;
 
+    /*
+     * Without decimals the stripping below also eats integer zeros;
+     * leave that to the original code.
+     */
+
+    if (fracDigits > 0) {
+	len = FormatScaled(buffer, fracDigits, number);
+	if (len >= 0) {
+	    return len;
+	}
+    }
     sprintf(buffer, "%.*f", fracDigits, number);
     len = strlen(buffer);
     while (len > 0) {
@@ -1151,6 +1454,35 @@ PrintNumber(
 
 /*---------------------------------------------------------------------------*/
 
+static int
+PrintNumberG15(
+    char *buffer,
+    double number)
+{
+    double a = (number < 0.0) ? -number : number;
+    int k, len;
+
+    /*
+     * Between 1 and 1e15 "%.15g" is "%.*f" with 15 significant digits
+     * and trailing zeros stripped. The exception is a value rounding up
+     * to 1e15, which "%g" prints in exponential form.
+     */
+
+    if ((a >= 1.0) && (a < 1e15)) {
+	for (k = 0; a >= pow10Table[k + 1]; k++) {
+	    /* empty */
+	}
+	len = FormatScaled(buffer, 14 - k, number);
+	if ((len > 0) && ((k < 14) || (len - (number < 0.0) <= 15))) {
+	    return len;
+	}
+    }
+    sprintf(buffer, "%.15g", number);
+    return strlen(buffer);
+}
+
+/*---------------------------------------------------------------------------*/
+
 MODULE_SCOPE int
 TkPathPdfNumber(
     Tcl_Obj *ret,
@@ -1170,6 +1502,24 @@ TkPathPdfNumber(
 
 /*---------------------------------------------------------------------------*/
 
+MODULE_SCOPE int
+TkPathPsNumber(
+    Tcl_Obj *ret,
+    double number,
+    const char *append)
+{
+    char buffer[TCL_DOUBLE_SPACE*2];
+    int len = PrintNumberG15(buffer, number);
+
+    Tcl_AppendToObj(ret, buffer, len);
+    if (append != NULL) {
+	Tcl_AppendToObj(ret, append, -1);
+    }
+    return len;
+}
+
+/*---------------------------------------------------------------------------*/
+
 MODULE_SCOPE int
 TkPathPdfColor(
     Tcl_Obj *ret,
@@ -1213,34 +1563,21 @@ TkPathPdfArrow(
     TkPathColor fc;
     PathAtom *atomPtr;
 
-    if (arrow->arrowEnabled && arrow->arrowPointsPtr != NULL) {
+    if (arrow->arrowEnabled && TkPathArrowAtoms(arrow) != NULL) {
 	Tcl_Obj *ret;
 
 	arrowStyle.matrixPtr = NULL;
-	if (arrow->arrowFillRatio > 0.0 && arrow->arrowLength != 0.0) {
-	    arrowStyle.strokeWidth = 0.0;
-	    fc.color = arrowStyle.strokeColor;
-	    fc.gradientInstPtr = NULL;
-	    arrowStyle.fill = &fc;
-	    arrowStyle.fillOpacity = arrowStyle.strokeOpacity;
-	} else {
-	    arrowStyle.fill = NULL;
-	    arrowStyle.fillOpacity = 1.0;
-	    arrowStyle.joinStyle = 1;
-	    arrowStyle.dashPtr = NULL;
-	}
-	atomPtr = MakePathAtomsFromArrow(arrow);
+	TkPathArrowStyle(arrow, &arrowStyle, &fc);
+	atomPtr = TkPathArrowAtoms(arrow);
 	ret = Tcl_GetObjResult(interp);
 	Tcl_IncrRefCount(ret);
 	Tcl_ResetResult(interp);
 	if (TkPathPdf(interp, atomPtr, &arrowStyle, NULL, 0, NULL) != TCL_OK) {
 	    Tcl_DecrRefCount(ret);
-	    TkPathFreeAtoms(atomPtr);
 	    return TCL_ERROR;
 	}
 	Tcl_AppendObjToObj(ret, Tcl_GetObjResult(interp));
 	Tcl_SetObjResult(interp, ret);
-	TkPathFreeAtoms(atomPtr);
     }
     return TCL_OK;
 }
@@ -1265,7 +1602,7 @@ TkPathPdf(
     int myZ = 0, f = 0, s = 0, isLinear = 0, i;
     TkPointsContext_ context;
     PathAtom *atomPtr;
-    char *gradName = NULL;
+    Tcl_Obj *gradName = NULL;
     TMatrix gm;
 
     context.current[0] = context.current[1] = 0.;
@@ -1288,10 +1625,8 @@ TkPathPdf(
 	    isLinear = (gradientPtr->type == kPathGradientTypeLinear);
 	}
 	if (mkextgs != NULL) {
-	    Tcl_Size retc;
-	    long gradId, smaskId;
-	    char *gradAlpha = NULL;
-	    Tcl_Obj *gs, *cmd, **retv;
+	    long gradId, smaskId = 0;
+	    Tcl_Obj *gradAlpha = NULL, *gs, *gsName;
 
 	    if ((mkgrad != NULL) &&
 		(gradientPtr != NULL) &&
@@ -1299,96 +1634,39 @@ TkPathPdf(
 		if (PathPdfGradient(interp, 1, mkobj, mkgrad, bboxPtr,
 				    gradientPtr, &gradAlpha, &gradId, &gm)
 		    != TCL_OK) {
+		    Tcl_DecrRefCount(ret);
 		    return TCL_ERROR;
 		}
 	    }
 	    if (gradAlpha != NULL) {
 		if (PathPdfGradSoftMask(interp, mkobj, bboxPtr,
 					gradAlpha, gradId,
-					isLinear ? NULL : &gm) != TCL_OK) {
-		    return TCL_ERROR;
-		}
-		Tcl_GetLongFromObj(NULL, Tcl_GetObjResult(interp), &smaskId);
-		gs = TkPathExtGS(stylePtr, &smaskId);
-		cmd = Tcl_DuplicateObj(mkextgs);
-		Tcl_IncrRefCount(cmd);
-		if ((Tcl_ListObjAppendElement(interp, cmd, gs) != TCL_OK) ||
-		    (Tcl_ListObjAppendElement(interp, cmd,
-				Tcl_NewLongObj(smaskId)) != TCL_OK)) {
-		    Tcl_DecrRefCount(cmd);
-		    Tcl_DecrRefCount(gs);
+					isLinear ? NULL : &gm,
+					&smaskId) != TCL_OK) {
+		    Tcl_DecrRefCount(gradAlpha);
 		    Tcl_DecrRefCount(ret);
 		    return TCL_ERROR;
 		}
-		if (Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT) != TCL_OK) {
-		    Tcl_DecrRefCount(cmd);
-		    Tcl_DecrRefCount(ret);
-		    return TCL_ERROR;
-		}
-		Tcl_DecrRefCount(cmd);
-		/*
-		 * Get name of extended graphics state.
-		 */
-		if (Tcl_ListObjGetElements(interp, Tcl_GetObjResult(interp),
-					   &retc, &retv) != TCL_OK) {
-		    Tcl_DecrRefCount(ret);
-		    return TCL_ERROR;
-		}
-		if (retc < 2) {
-		    Tcl_SetResult(interp, (char *) "missing PDF id/name",
-				  TCL_STATIC);
+		Tcl_DecrRefCount(gradAlpha);
+		gs = TkPathExtGS(stylePtr, &smaskId);
+		if (TkPathPdfAddExtGState(interp, mkextgs, gs, smaskId,
+			&gsAlpha) != TCL_OK) {
 		    Tcl_DecrRefCount(ret);
 		    return TCL_ERROR;
 		}
-		gsAlpha = retv[1];
-		Tcl_IncrRefCount(gsAlpha);
 	    }
 	    gs = TkPathExtGS(stylePtr, NULL);
 	    if (gs != NULL) {
-		cmd = Tcl_DuplicateObj(mkextgs);
-		Tcl_IncrRefCount(cmd);
-		if ((Tcl_ListObjAppendElement(interp, cmd, gs) != TCL_OK) ||
-		    ((gradAlpha != NULL) &&
-		     (Tcl_ListObjAppendElement(interp, cmd,
-				Tcl_NewLongObj(smaskId)) != TCL_OK))) {
-		    Tcl_DecrRefCount(cmd);
-		    Tcl_DecrRefCount(gs);
-		    Tcl_DecrRefCount(ret);
-		    if (gsAlpha != NULL) {
-			Tcl_DecrRefCount(gsAlpha);
-		    }
-		    return TCL_ERROR;
-		}
-		if (Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT) != TCL_OK) {
-		    Tcl_DecrRefCount(cmd);
-		    Tcl_DecrRefCount(ret);
-		    if (gsAlpha != NULL) {
-			Tcl_DecrRefCount(gsAlpha);
-		    }
-		    return TCL_ERROR;
-		}
-		Tcl_DecrRefCount(cmd);
-		/*
-		 * Get name of extended graphics state.
-		 */
-		if (Tcl_ListObjGetElements(interp, Tcl_GetObjResult(interp),
-					   &retc, &retv) != TCL_OK) {
+		if (TkPathPdfAddExtGState(interp, mkextgs, gs, smaskId,
+			&gsName) != TCL_OK) {
 		    Tcl_DecrRefCount(ret);
 		    if (gsAlpha != NULL) {
 			Tcl_DecrRefCount(gsAlpha);
 		    }
 		    return TCL_ERROR;
 		}
-		if (retc < 2) {
-		    Tcl_SetResult(interp, (char *) "missing PDF id/name",
-				  TCL_STATIC);
-		    Tcl_DecrRefCount(ret);
-		    if (gsAlpha != NULL) {
-			Tcl_DecrRefCount(gsAlpha);
-		    }
-		    return TCL_ERROR;
-		}
-		Tcl_AppendPrintfToObj(ret, "/%s gs\n", Tcl_GetString(retv[1]));
+		Tcl_AppendPrintfToObj(ret, "/%s gs\n", Tcl_GetString(gsName));
+		Tcl_DecrRefCount(gsName);
 	    }
 	}
 	if (stylePtr->matrixPtr != NULL) {
@@ -1525,7 +1803,8 @@ again:
 	    Tcl_DecrRefCount(gsAlpha);
 	    gsAlpha = NULL;
 	}
-	Tcl_AppendPrintfToObj(ret, "/%s sh\nQ\n", gradName);
+	Tcl_AppendPrintfToObj(ret, "/%s sh\nQ\n", Tcl_GetString(gradName));
+	Tcl_DecrRefCount(gradName);
 	gradName = NULL;
 	if (s) {
 	    goto again;
@@ -1823,9 +2102,10 @@ PathPdfGradFuncType2(
     Tcl_Obj *mkobj,
     int isAlpha,
     GradientStop *stop0,
-    GradientStop *stop1)
+    GradientStop *stop1,
+    long *idPtr)
 {
-    Tcl_Obj *cmd, *obj = Tcl_NewObj();
+    Tcl_Obj *obj = Tcl_NewObj();
 
     if (isAlpha) {
 	Tcl_AppendToObj(obj, "<<\n/Domain [0 1]\n"
@@ -1844,19 +2124,7 @@ PathPdfGradFuncType2(
 	TkPathPdfNumber(obj, 3, (stop1->color->blue >> 8) / 255.0,
 			"]\n>>");
     }
-    cmd = Tcl_DuplicateObj(mkobj);
-    Tcl_IncrRefCount(cmd);
-    if (Tcl_ListObjAppendElement(interp, cmd, obj) != TCL_OK) {
-	Tcl_DecrRefCount(cmd);
-	Tcl_DecrRefCount(obj);
-	return TCL_ERROR;
-    }
-    if (Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT) != TCL_OK) {
-	Tcl_DecrRefCount(cmd);
-	return TCL_ERROR;
-    }
-    Tcl_DecrRefCount(cmd);
-    return TCL_OK;
+    return TkPathPdfAddObj(interp, mkobj, obj, idPtr);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -1866,17 +2134,18 @@ PathPdfGradSoftMask(
     Tcl_Interp *interp,
     Tcl_Obj *mkobj,
     PathRect *bbox,
-    const char *gradName,
+    Tcl_Obj *gradName,
     long gradId,
-    TMatrix *tmPtr)
+    TMatrix *tmPtr,
+    long *idPtr)
 {
-    Tcl_Obj *cmd, *obj = Tcl_NewObj();
+    Tcl_Obj *obj;
     long id;
     char fillBbox[128];
     PathRect r;
 
     /* form XObject with softmask */
-    sprintf(fillBbox, "/%s sh", gradName);
+    sprintf(fillBbox, "/%.100s sh", Tcl_GetString(gradName));
     obj = Tcl_NewObj();
     r = *bbox;
     if (tmPtr != NULL) {
@@ -1896,37 +2165,16 @@ PathPdfGradSoftMask(
 			  "/I true /K false >>\n/Resources <<\n"
 			  "/Shading << /%s %ld 0 R >>\n"
 			  ">>\n>>\nstream\n", (int) strlen(fillBbox),
-			  gradName, gradId);
+			  Tcl_GetString(gradName), gradId);
     Tcl_AppendPrintfToObj(obj, "%s\nendstream", fillBbox);
-    cmd = Tcl_DuplicateObj(mkobj);
-    Tcl_IncrRefCount(cmd);
-    if (Tcl_ListObjAppendElement(interp, cmd, obj) != TCL_OK) {
-	Tcl_DecrRefCount(cmd);
-	Tcl_DecrRefCount(obj);
-	return TCL_ERROR;
-    }
-    if (Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT) != TCL_OK) {
-	Tcl_DecrRefCount(cmd);
+    if (TkPathPdfAddObj(interp, mkobj, obj, &id) != TCL_OK) {
 	return TCL_ERROR;
     }
-    Tcl_GetLongFromObj(NULL, Tcl_GetObjResult(interp), &id);
     /* softmask for ExtGS */
     obj = Tcl_NewObj();
     Tcl_AppendPrintfToObj(obj, "<<\n/Type /Mask\n"
 			  "/S /Luminosity\n/G %ld 0 R\n>>", id);
-    cmd = Tcl_DuplicateObj(mkobj);
-    Tcl_IncrRefCount(cmd);
-    if (Tcl_ListObjAppendElement(interp, cmd, obj) != TCL_OK) {
-	Tcl_DecrRefCount(cmd);
-	Tcl_DecrRefCount(obj);
-	return TCL_ERROR;
-    }
-    if (Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT) != TCL_OK) {
-	Tcl_DecrRefCount(cmd);
-	return TCL_ERROR;
-    }
-    Tcl_DecrRefCount(cmd);
-    return TCL_OK;
+    return TkPathPdfAddObj(interp, mkobj, obj, idPtr);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -1939,52 +2187,73 @@ PathPdfGradient(
     Tcl_Obj *mkgrad,
     PathRect *bboxPtr,
     TkPathGradientMaster *gradientPtr,
-    char **gradName,
+    Tcl_Obj **gradName,
     long *gradId,
     TMatrix *tmPtr)
 {
-    Tcl_Size retc, code;
-    Tcl_Obj **retv;
+    TkPathPdfKey key;
+    TkPathPdfResource res;
+    int code;
 
-    if (tmPtr != NULL) {
-	tmPtr->a = tmPtr->d = 1.0;
-	tmPtr->b = tmPtr->c = 0.0;
-	tmPtr->tx = tmPtr->ty = 0.0;
-    }
+    res.tm.a = res.tm.d = 1.0;
+    res.tm.b = res.tm.c = 0.0;
+    res.tm.tx = res.tm.ty = 0.0;
     *gradName = NULL;
-    /* prepare shading/pattern/function for gradient */
-    if (!ObjectIsEmpty(gradientPtr->stopsObj)) {
+    if (ObjectIsEmpty(gradientPtr->stopsObj)) {
+	if (tmPtr != NULL) {
+	    *tmPtr = res.tm;
+	}
+	return TCL_OK;
+    }
+
+    /*
+     * The shading depends on the gradient, on the bbox and on whether it
+     * is drawn with a matrix. Once made it is reused.
+     */
+    memset(&key, 0, sizeof(key));
+    key.ptr = gradientPtr;
+    key.params[0] = isAlpha;
+    key.params[1] = (tmPtr != NULL);
+    key.params[2] = bboxPtr->x1;
+    key.params[3] = bboxPtr->y1;
+    key.params[4] = bboxPtr->x2;
+    key.params[5] = bboxPtr->y2;
+    if (TkPathPdfFindResource(mkgrad, &key, &res)) {
+	if (res.nameObj == NULL) {
+	    return TCL_OK;	/* nothing to do */
+	}
+    } else {
+	/* prepare shading/pattern/function for gradient */
 	if (gradientPtr->type == kPathGradientTypeLinear) {
-	    code = PathPdfLinearGradient(interp, isAlpha, mkobj, mkgrad,
+	    code = PathPdfLinearGradient(interp, isAlpha, mkobj,
 					 bboxPtr, &gradientPtr->linearFill,
-					 gradientPtr->matrixPtr);
+					 gradientPtr->matrixPtr, &res.id);
 	} else {
-	    code = PathPdfRadialGradient(interp, isAlpha, mkobj, mkgrad,
+	    code = PathPdfRadialGradient(interp, isAlpha, mkobj,
 					 bboxPtr, &gradientPtr->radialFill,
-					 gradientPtr->matrixPtr, tmPtr);
+					 gradientPtr->matrixPtr,
+					 (tmPtr != NULL) ? &res.tm : NULL,
+					 &res.id);
 	}
-	if (code != TCL_OK) {
-	    return (code == TCL_BREAK) ? TCL_OK : TCL_ERROR;
-	}
-
-	/*
-	 * Get name of shading/pattern/function for gradient
-	 */
-	if (Tcl_ListObjGetElements(interp, Tcl_GetObjResult(interp),
-				   &retc, &retv) != TCL_OK) {
-	    return TCL_ERROR;
+	res.nameObj = NULL;
+	if (code == TCL_BREAK) {
+	    TkPathPdfKeepResource(mkgrad, &key, &res);
+	    return TCL_OK;
 	}
-	if (retc < 2) {
-	    Tcl_SetResult(interp, (char *) "missing PDF id/name",
-			  TCL_STATIC);
+	if ((code != TCL_OK) ||
+	    (TkPathPdfAddGradient(interp, mkgrad, res.id, &res.nameObj)
+	     != TCL_OK)) {
 	    return TCL_ERROR;
 	}
-	if (gradId != NULL) {
-	    *gradId = 0;
-	    Tcl_GetLongFromObj(NULL, retv[0], gradId);
-	}
-	*gradName = Tcl_GetString(retv[1]);
+	TkPathPdfKeepResource(mkgrad, &key, &res);
+    }
+    if (tmPtr != NULL) {
+	*tmPtr = res.tm;
+    }
+    if (gradId != NULL) {
+	*gradId = res.id;
     }
+    *gradName = res.nameObj;
     return TCL_OK;
 }
 
@@ -1995,16 +2264,16 @@ PathPdfLinearGradient(
     Tcl_Interp *interp,
     int isAlpha,
     Tcl_Obj *mkobj,
-    Tcl_Obj *mkgrad,
     PathRect *bbox,
     LinearGradientFill *fillPtr,
-    TMatrix *mPtr)
+    TMatrix *mPtr,
+    long *idPtr)
 {
     PathRect *tPtr = fillPtr->transitionPtr;
     double x1, y1, x2, y2;
     GradientStop *stop0, *stop1;
     long id;
-    Tcl_Obj *obj, *cmd;
+    Tcl_Obj *obj;
 
     if (isAlpha) {
 	int i;
@@ -2048,11 +2317,10 @@ PathPdfLinearGradient(
     if (fillPtr->stopArrPtr->nstops == 2) {
 	stop0 = fillPtr->stopArrPtr->stops[0];
 	stop1 = fillPtr->stopArrPtr->stops[1];
-	if (PathPdfGradFuncType2(interp, mkobj, isAlpha, stop0, stop1)
+	if (PathPdfGradFuncType2(interp, mkobj, isAlpha, stop0, stop1, &id)
 	    != TCL_OK) {
 	    return TCL_ERROR;
 	}
-	Tcl_GetLongFromObj(NULL, Tcl_GetObjResult(interp), &id);
     } else {
 	int i;
 	Tcl_DString stitchF, enc, bounds;
@@ -2064,14 +2332,13 @@ PathPdfLinearGradient(
 	for (i = 1; i < fillPtr->stopArrPtr->nstops; i++) {
 	    stop0 = fillPtr->stopArrPtr->stops[i - 1];
 	    stop1 = fillPtr->stopArrPtr->stops[i];
-	    if (PathPdfGradFuncType2(interp, mkobj, isAlpha, stop0, stop1)
-		!= TCL_OK) {
+	    if (PathPdfGradFuncType2(interp, mkobj, isAlpha, stop0, stop1,
+				     &id) != TCL_OK) {
 		Tcl_DStringFree(&stitchF);
 		Tcl_DStringFree(&enc);
 		Tcl_DStringFree(&bounds);
 		return TCL_ERROR;
 	    }
-	    Tcl_GetLongFromObj(NULL, Tcl_GetObjResult(interp), &id);
 	    sprintf(buffer, "%s%ld 0 R", (i > 1) ? " " : "", id);
 	    Tcl_DStringAppend(&stitchF, buffer, -1);
 	    sprintf(buffer, "%s0 1", (i > 1) ? " " : "");
@@ -2083,14 +2350,13 @@ PathPdfLinearGradient(
 	    Tcl_DStringAppend(&bounds, buffer, -1);
 	}
 	stop1 = fillPtr->stopArrPtr->stops[fillPtr->stopArrPtr->nstops - 1];
-	if (PathPdfGradFuncType2(interp, mkobj, isAlpha, stop1, stop1)
+	if (PathPdfGradFuncType2(interp, mkobj, isAlpha, stop1, stop1, &id)
 	    != TCL_OK) {
 	    Tcl_DStringFree(&stitchF);
 	    Tcl_DStringFree(&enc);
 	    Tcl_DStringFree(&bounds);
 	    return TCL_ERROR;
 	}
-	Tcl_GetLongFromObj(NULL, Tcl_GetObjResult(interp), &id);
 	sprintf(buffer, "%s%ld 0 R", (i > 1) ? " " : "", id);
 	Tcl_DStringAppend(&stitchF, buffer, -1);
 	sprintf(buffer, "%s0 1", (i > 1) ? " " : "");
@@ -2105,19 +2371,9 @@ PathPdfLinearGradient(
 	Tcl_DStringFree(&stitchF);
 	Tcl_DStringFree(&enc);
 	Tcl_DStringFree(&bounds);
-	cmd = Tcl_DuplicateObj(mkobj);
-	Tcl_IncrRefCount(cmd);
-	if (Tcl_ListObjAppendElement(interp, cmd, obj) != TCL_OK) {
-	    Tcl_DecrRefCount(cmd);
-	    Tcl_DecrRefCount(obj);
+	if (TkPathPdfAddObj(interp, mkobj, obj, &id) != TCL_OK) {
 	    return TCL_ERROR;
 	}
-	if (Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT) != TCL_OK) {
-	    Tcl_DecrRefCount(cmd);
-	    return TCL_ERROR;
-	}
-	Tcl_DecrRefCount(cmd);
-	Tcl_GetLongFromObj(NULL, Tcl_GetObjResult(interp), &id);
     }
     obj = Tcl_NewObj();
     Tcl_AppendToObj(obj, "<<\n/ShadingType 2\n/Extend [true true]\n"
@@ -2128,33 +2384,7 @@ PathPdfLinearGradient(
     TkPathPdfNumber(obj, 3, y2, "]\n");
     Tcl_AppendPrintfToObj(obj, "/ColorSpace %s\n/Function %ld 0 R\n>>",
  			  isAlpha ? "/DeviceGray" : "/DeviceRGB", id);
-    cmd = Tcl_DuplicateObj(mkobj);
-    Tcl_IncrRefCount(cmd);
-    if (Tcl_ListObjAppendElement(interp, cmd, obj) != TCL_OK) {
-	Tcl_DecrRefCount(cmd);
-	Tcl_DecrRefCount(obj);
-	return TCL_ERROR;
-    }
-    if (Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT) != TCL_OK) {
-	Tcl_DecrRefCount(cmd);
-	return TCL_ERROR;
-    }
-    Tcl_DecrRefCount(cmd);
-    Tcl_GetLongFromObj(NULL, Tcl_GetObjResult(interp), &id);
-    cmd = Tcl_DuplicateObj(mkgrad);
-    Tcl_IncrRefCount(cmd);
-    if (Tcl_ListObjAppendElement(interp, cmd, Tcl_NewLongObj(id))
-	!= TCL_OK) {
-	Tcl_DecrRefCount(cmd);
-	Tcl_DecrRefCount(obj);
-	return TCL_ERROR;
-    }
-    if (Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT) != TCL_OK) {
-	Tcl_DecrRefCount(cmd);
-	return TCL_ERROR;
-    }
-    Tcl_DecrRefCount(cmd);
-    return TCL_OK;
+    return TkPathPdfAddObj(interp, mkobj, obj, idPtr);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -2164,11 +2394,11 @@ PathPdfRadialGradient(
     Tcl_Interp *interp,
     int isAlpha,
     Tcl_Obj *mkobj,
-    Tcl_Obj *mkgrad,
     PathRect *bbox,
     RadialGradientFill *fillPtr,
     TMatrix *mPtr,
-    TMatrix *tmPtr)
+    TMatrix *tmPtr,
+    long *idPtr)
 {
     RadialTransition *tPtr = fillPtr->radialPtr;
     double centerX, centerY, radiusX, focalX, focalY, width, height;
@@ -2177,7 +2407,7 @@ PathPdfRadialGradient(
 #endif
     GradientStop *stop0, *stop1;
     long id;
-    Tcl_Obj *obj, *cmd;
+    Tcl_Obj *obj;
 
     if (isAlpha) {
 	int i;
@@ -2248,11 +2478,10 @@ PathPdfRadialGradient(
     if (fillPtr->stopArrPtr->nstops == 2) {
 	stop0 = fillPtr->stopArrPtr->stops[0];
 	stop1 = fillPtr->stopArrPtr->stops[fillPtr->stopArrPtr->nstops - 1];
-	if (PathPdfGradFuncType2(interp, mkobj, isAlpha, stop0, stop1)
+	if (PathPdfGradFuncType2(interp, mkobj, isAlpha, stop0, stop1, &id)
 	    != TCL_OK) {
 	    return TCL_ERROR;
 	}
-	Tcl_GetLongFromObj(NULL, Tcl_GetObjResult(interp), &id);
     } else {
 	int i;
 	Tcl_DString stitchF, enc, bounds;
@@ -2264,14 +2493,13 @@ PathPdfRadialGradient(
 	for (i = 1; i < fillPtr->stopArrPtr->nstops; i++) {
 	    stop0 = fillPtr->stopArrPtr->stops[i - 1];
 	    stop1 = fillPtr->stopArrPtr->stops[i];
-	    if (PathPdfGradFuncType2(interp, mkobj, isAlpha, stop0, stop1)
-		!= TCL_OK) {
+	    if (PathPdfGradFuncType2(interp, mkobj, isAlpha, stop0, stop1,
+				     &id) != TCL_OK) {
 		Tcl_DStringFree(&stitchF);
 		Tcl_DStringFree(&enc);
 		Tcl_DStringFree(&bounds);
 		return TCL_ERROR;
 	    }
-	    Tcl_GetLongFromObj(NULL, Tcl_GetObjResult(interp), &id);
 	    sprintf(buffer, "%s%ld 0 R", (i > 1) ? " " : "", id);
 	    Tcl_DStringAppend(&stitchF, buffer, -1);
 	    sprintf(buffer, "%s0 1", (i > 1) ? " " : "");
@@ -2283,14 +2511,13 @@ PathPdfRadialGradient(
 	    Tcl_DStringAppend(&bounds, buffer, -1);
 	}
 	stop1 = fillPtr->stopArrPtr->stops[fillPtr->stopArrPtr->nstops - 1];
-	if (PathPdfGradFuncType2(interp, mkobj, isAlpha, stop1, stop1)
+	if (PathPdfGradFuncType2(interp, mkobj, isAlpha, stop1, stop1, &id)
 	    != TCL_OK) {
 	    Tcl_DStringFree(&stitchF);
 	    Tcl_DStringFree(&enc);
 	    Tcl_DStringFree(&bounds);
 	    return TCL_ERROR;
 	}
-	Tcl_GetLongFromObj(NULL, Tcl_GetObjResult(interp), &id);
 	sprintf(buffer, "%s%ld 0 R", (i > 1) ? " " : "", id);
 	Tcl_DStringAppend(&stitchF, buffer, -1);
 	sprintf(buffer, "%s0 1", (i > 1) ? " " : "");
@@ -2305,19 +2532,9 @@ PathPdfRadialGradient(
 	Tcl_DStringFree(&stitchF);
 	Tcl_DStringFree(&enc);
 	Tcl_DStringFree(&bounds);
-	cmd = Tcl_DuplicateObj(mkobj);
-	Tcl_IncrRefCount(cmd);
-	if (Tcl_ListObjAppendElement(interp, cmd, obj) != TCL_OK) {
-	    Tcl_DecrRefCount(cmd);
-	    Tcl_DecrRefCount(obj);
-	    return TCL_ERROR;
-	}
-	if (Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT) != TCL_OK) {
-	    Tcl_DecrRefCount(cmd);
+	if (TkPathPdfAddObj(interp, mkobj, obj, &id) != TCL_OK) {
 	    return TCL_ERROR;
 	}
-	Tcl_DecrRefCount(cmd);
-	Tcl_GetLongFromObj(NULL, Tcl_GetObjResult(interp), &id);
     }
     obj = Tcl_NewObj();
     Tcl_AppendToObj(obj, "<<\n/ShadingType 3\n/Extend [true true]\n"
@@ -2329,33 +2546,7 @@ PathPdfRadialGradient(
     TkPathPdfNumber(obj, 3, radiusX, "]\n");
     Tcl_AppendPrintfToObj(obj, "/ColorSpace %s\n/Function %ld 0 R\n>>",
 			  isAlpha ? "/DeviceGray" : "/DeviceRGB", id);
-    cmd = Tcl_DuplicateObj(mkobj);
-    Tcl_IncrRefCount(cmd);
-    if (Tcl_ListObjAppendElement(interp, cmd, obj) != TCL_OK) {
-	Tcl_DecrRefCount(cmd);
-	Tcl_DecrRefCount(obj);
-	return TCL_ERROR;
-    }
-    if (Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT) != TCL_OK) {
-	Tcl_DecrRefCount(cmd);
-	return TCL_ERROR;
-    }
-    Tcl_DecrRefCount(cmd);
-    Tcl_GetLongFromObj(NULL, Tcl_GetObjResult(interp), &id);
-    cmd = Tcl_DuplicateObj(mkgrad);
-    Tcl_IncrRefCount(cmd);
-    if (Tcl_ListObjAppendElement(interp, cmd, Tcl_NewLongObj(id))
-	!= TCL_OK) {
-	Tcl_DecrRefCount(cmd);
-	Tcl_DecrRefCount(obj);
-	return TCL_ERROR;
-    }
-    if (Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT) != TCL_OK) {
-	Tcl_DecrRefCount(cmd);
-	return TCL_ERROR;
-    }
-    Tcl_DecrRefCount(cmd);
-    return TCL_OK;
+    return TkPathPdfAddObj(interp, mkobj, obj, idPtr);
 }
 
 
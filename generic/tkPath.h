@@ -286,12 +286,32 @@ MODULE_SCOPE PathAtom *NewCurveToAtom(double ctrlX1, double ctrlY1,
 MODULE_SCOPE PathAtom *NewRectAtom(double pointsPtr[]);
 MODULE_SCOPE PathAtom *NewCloseAtom(double x, double y);
 
+/*
+ * Parsed path data kept in the internal representation of a Tcl_Obj
+ * of type tkPathDataObjType. It is reference counted and shared between
+ * all items and objects that use the same path description, so its
+ * atoms must never be modified; use TkPathCopyAtoms first.
+ */
+
+typedef struct TkPathData {
+    Tcl_Size refCount;		/* Number of users, including the Tcl_Obj. */
+    PathAtom *atomPtr;		/* The parsed atoms. */
+    Tcl_Size len;		/* Number of elements in the path list. */
+    PathRect bbox;		/* Bare bbox of atomPtr. */
+} TkPathData;
+
+MODULE_SCOPE const Tcl_ObjType tkPathDataObjType;
+
 /*
  * Functions that process lists and atoms.
  */
 
 MODULE_SCOPE int    TkPathParseToAtoms(Tcl_Interp *interp, Tcl_Obj *listObjPtr,
 			PathAtom **atomPtrPtr, Tcl_Size *lenPtr);
+MODULE_SCOPE int    TkPathGetDataFromObj(Tcl_Interp *interp, Tcl_Obj *objPtr,
+			TkPathData **dataPtrPtr);
+MODULE_SCOPE void   TkPathReleaseData(TkPathData *dataPtr);
+MODULE_SCOPE PathAtom *TkPathCopyAtoms(PathAtom *atomPtr);
 MODULE_SCOPE void   TkPathFreeAtoms(PathAtom *pathAtomPtr);
 MODULE_SCOPE int    TkPathNormalize(Tcl_Interp *interp, PathAtom *atomPtr,
 			Tcl_Obj **listObjPtrPtr);
@@ -59,8 +59,6 @@ int MatrixSetOption(
     char *internalPtr;	    /* Points to location in record where
                              * internal representation of value should
                              * be stored, or NULL. */
-    char *list;
-    Tcl_Size length;
     Tcl_Obj *valuePtr;
     TMatrix *newPtr;
 
@@ -75,9 +73,8 @@ int MatrixSetOption(
     }
     if (internalPtr != NULL) {
 	if (valuePtr != NULL) {
-            list = Tcl_GetStringFromObj(valuePtr, &length);
             newPtr = (TMatrix *) ckalloc(sizeof(TMatrix));
-            if (PathGetTMatrix(interp, list, newPtr) != TCL_OK) {
+            if (PathGetTMatrix(interp, valuePtr, newPtr) != TCL_OK) {
                 ckfree((char *) newPtr);
                 return TCL_ERROR;
             }
@@ -105,6 +102,9 @@ MatrixGetOption(
     /* @@@ An alternative to this could be to have an objOffset in option table. */
     internalPtr = recordPtr + internalOffset;
     matrixPtr = *((TMatrix **) internalPtr);
+    if (matrixPtr != NULL) {
+	return PathNewTMatrixObj(matrixPtr);
+    }
     PathGetTclObjFromTMatrix(NULL, matrixPtr, &listObj);
     return listObj;
 }
@@ -145,6 +145,8 @@ TkPathDashNew(Tcl_Interp *interp, Tcl_Obj *dashObjPtr)
     dashPtr = (Tk_PathDash *) ckalloc(sizeof(Tk_PathDash));
     dashPtr->number = 0;
     dashPtr->array = NULL;
+    dashPtr->scaled = NULL;
+    dashPtr->scaledWidth = 0.0;
     if (Tcl_ListObjGetElements(interp, dashObjPtr, &objc, (Tcl_Obj ***) &objv) != TCL_OK) {
 	goto error;
     }
@@ -169,9 +171,36 @@ TkPathDashFree(Tk_PathDash *dashPtr)
     if (dashPtr->array) {
 	ckfree((char *) dashPtr->array);
     }
+    if (dashPtr->scaled) {
+	ckfree((char *) dashPtr->scaled);
+    }
     ckfree((char *) dashPtr);
 }
 
+/*
+ * Returns the dash array multiplied by the stroke width, as the drawing
+ * backends want it. It is kept with the dash and only recomputed when
+ * stroked with another width; a new -strokedasharray makes a new dash.
+ */
+
+double *
+TkPathDashScaled(Tk_PathDash *dashPtr, double width)
+{
+    int i;
+
+    if (dashPtr->scaled == NULL) {
+	dashPtr->scaled = (double *)
+		ckalloc(dashPtr->number * sizeof(double));
+    } else if (dashPtr->scaledWidth == width) {
+	return dashPtr->scaled;
+    }
+    for (i = 0; i < dashPtr->number; i++) {
+	dashPtr->scaled[i] = dashPtr->array[i] * width;
+    }
+    dashPtr->scaledWidth = width;
+    return dashPtr->scaled;
+}
+
 /*
  * The -strokedasharray custom option.
  */
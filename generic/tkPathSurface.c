@@ -721,12 +721,12 @@ SurfaceCreatePath(Tcl_Interp *interp, InterpData *dataPtr,
 		  PathSurface *surfacePtr, int objc, Tcl_Obj* const objv[])
 {
     TkPathContext 	context = surfacePtr->ctx;
-    PathAtom 		*atomPtr = NULL;
+    TkPathData		*pathDataPtr;
+    PathAtom 		*atomPtr;
     PathRect		bbox;
     SurfGenericItem	item;
     Tk_PathStyle	*style = &item.style;
     Tk_PathStyle	mergedStyle;
-    Tcl_Size 		len;
     int			result = TCL_OK;
 
     memset(&item, 0, sizeof(item));
@@ -734,9 +734,10 @@ SurfaceCreatePath(Tcl_Interp *interp, InterpData *dataPtr,
     TkPathInitStyle(&item.style);
     TkPathArrowDescrInit(&item.startarrow);
     TkPathArrowDescrInit(&item.endarrow);
-    if (TkPathParseToAtoms(interp, objv[3], &atomPtr, &len) != TCL_OK) {
+    if (TkPathGetDataFromObj(interp, objv[3], &pathDataPtr) != TCL_OK) {
 	return TCL_ERROR;
     }
+    atomPtr = pathDataPtr->atomPtr;
     if (SurfaceParseOptions(interp, (char *)&item, dataPtr->optionTablePath,
 			    objc-4, objv+4) != TCL_OK) {
 	result = TCL_ERROR;
@@ -770,7 +771,7 @@ SurfaceCreatePath(Tcl_Interp *interp, InterpData *dataPtr,
 
 bail:
     TkPathDeleteStyle(style);
-    TkPathFreeAtoms(atomPtr);
+    TkPathReleaseData(pathDataPtr);
     TkPathFreeArrow(&item.startarrow);
     TkPathFreeArrow(&item.endarrow);
     Tk_FreeConfigOptions((char *)&item, dataPtr->optionTablePath,
@@ -848,7 +849,7 @@ SurfaceCreatePimage(Tcl_Interp *interp, InterpData *dataPtr,
 	if ((item.width > 0) && (item.height > 0)) {
 	    TkPathImage(context, image, photo, point[0], point[1],
 			item.width, item.height, style.fillOpacity,
-			NULL, 0.0, 99, NULL);
+			NULL, 0.0, 99, NULL, NULL);
 	}
 	Tk_FreeImage(image);
 	TkPathRestoreState(context);
@@ -5,9 +5,13 @@
  *      SVG counterpart. See http://www.w3.org/TR/SVG11/.
  *
  * 	Note:
- *		This is supposed to be a minimal implementation using
- *		Tk drawing only. It fails in a number of places such as
- *		filled and overlapping subpaths.
+ *		This is a self contained implementation that needs no
+ *		graphics library besides Xlib. Paths are flattened and
+ *		rendered by an antialiasing scanline rasterizer which
+ *		accumulates the signed area each edge covers in every pixel.
+ *		Strokes are turned into polygons first. The result is
+ *		composited either into an image of the drawable or into the
+ *		memory buffer of a surface. Text is not drawn.
  *
  * Copyright (c) 2005-2008  Mats Bengtsson
  *
@@ -16,9 +20,17 @@
 #include "tkIntPath.h"
 #include "tkCanvPathUtil.h"
 
-#define _PATH_N_BUFFER_POINTS 		2000
+#define _PATH_N_BUFFER_POINTS 		64
+#define _PATH_GRADIENT_LUT_SIZE		256
+#define _PATH_BAND_HEIGHT		32
+
+/*
+ * Exact (v + 127)/255 rounding for v in [0, 255*255] without a division.
+ */
+#define _DIV255(v)	((((v) + 128) + (((v) + 128) >> 8)) >> 8)
 
 MODULE_SCOPE int gAntiAlias;
+MODULE_SCOPE int gSurfaceCopyPremultiplyAlpha;
 
 /*
  * Each subpath is reconstructed as a number of straight line segments.
@@ -32,69 +44,248 @@ typedef struct _PathSegments {
     struct _PathSegments *next;
 } _PathSegments;
 
+/*
+ * Gradient colors along the transition, sampled at _PATH_GRADIENT_LUT_SIZE
+ * evenly spaced offsets. Made once per stop array and context.
+ */
+typedef struct _GradientLut {
+    GradientStopArray	*stopArrPtr;
+    unsigned char	rgba[_PATH_GRADIENT_LUT_SIZE][4];
+    struct _GradientLut *next;
+} _GradientLut;
+
+/*
+ * The edges handed to the rasterizer, in device coordinates. The
+ * direction of an edge is significant for the nonzero rule.
+ */
+typedef struct _PathEdge {
+    double		x0, y0, x1, y1;
+} _PathEdge;
+
+typedef struct _EdgeList {
+    int			num;
+    int			size;
+    _PathEdge		*edges;
+    double		xmin, ymin, xmax, ymax;
+} _EdgeList;
+
+/*
+ * A growable array of points used when stroking.
+ */
+typedef struct _PointBuf {
+    int			n;
+    int			size;
+    double		*pts;
+} _PointBuf;
+
+/*
+ * Coverage, 0 to 1, of a clip path over a rectangle of device pixels.
+ * Shared between the saved graphics states.
+ */
+typedef struct _CoverMask {
+    int			refCount;
+    int			x, y, width, height;
+    float		*cover;
+} _CoverMask;
+
+/*
+ * Memory surface: premultiplied RGBA, byte order R, G, B, A.
+ */
+typedef struct _PathSurface {
+    unsigned char	*data;
+    int			width;
+    int			height;
+    int			stride;
+} _PathSurface;
+
+typedef struct _PathState {
+    TMatrix		m;
+    _CoverMask		*clip;
+    struct _PathState	*next;
+} _PathState;
+
+/*
+ * What paints the covered pixels.
+ */
+enum {
+    _SOURCE_SOLID,
+    _SOURCE_LINEAR,
+    _SOURCE_RADIAL,
+    _SOURCE_IMAGE
+};
+
+typedef struct _PaintSource {
+    int			type;
+    unsigned char	color[4];	/* Premultiplied solid color. */
+    TMatrix		A;		/* Device pixels to gradient or
+					 * image space. */
+    unsigned char	lut[_PATH_GRADIENT_LUT_SIZE][4];
+					/* Premultiplied gradient colors. */
+    int			method;
+    PathRect		*linearPtr;
+    RadialTransition	*radialPtr;
+    Tk_PhotoImageBlock	block;		/* Image source, sampled with
+					 * the opacity in color[3]. */
+    int			interpolation;	/* Nearest pixel if
+					 * kPathImageInterpolationNone,
+					 * else bilinear. */
+    int			tintAmount;	/* 0 to 256, 0 if no tint. */
+    int			tint[3];	/* Tint color, 0 to 255. */
+    int			premultiplied;	/* The image is a surface, whose
+					 * pixels are premultiplied and
+					 * never tinted. */
+} _PaintSource;
+
+/*
+ * The pixels being painted: the whole area of the current paint
+ * operation, as premultiplied RGBA.
+ */
+typedef struct _PixelBuf {
+    unsigned char	*data;
+    int			x, y, width, height;
+    int			stride;
+    XImage		*image;		/* Non NULL for drawables. */
+} _PixelBuf;
+
 /*
  * A placeholder for the context we are working in.
  * The current and lastMove are always original untransformed coordinates.
  */
 typedef struct TkPathContext_ {
     Display 		*display;
-    Drawable 		drawable;
+    Drawable 		drawable;	/* None for memory surfaces. */
+    _PathSurface	*surface;	/* NULL unless TkPathInitSurface. */
+    int			width, height;	/* Size of drawable or surface. */
     double 			current[2];
     double 			lastMove[2];
     int				hasCurrent;
-    TMatrix 		*m;
+    TMatrix 		m;
+    _PathState		*states;	/* Stack of saved states. */
+    _CoverMask		*clip;		/* NULL if no clipping. */
     _PathSegments 	*segm;
     _PathSegments 	*currentSegm;
+    _PathSegments	*freeSegm;	/* Reused by later paths. */
+    _GradientLut	*luts;
+    float		*scratch;	/* Rasterizer rows, reused. */
+    int			scratchSize;
 } TkPathContext_;
 
+typedef void (_RowProc)(ClientData clientData, int y, float *cover);
+
 
 static TkPathContext_*
-_NewPathContext(Tk_Window tkwin, Drawable drawable)
+_NewPathContext(Display *display, Drawable drawable)
 {
     TkPathContext_ *ctx;
+    TMatrix m = kPathUnitTMatrix;
 
     ctx = (TkPathContext_ *) ckalloc(sizeof(TkPathContext_));
-    ctx->display = Tk_Display(tkwin);
+    ctx->display = display;
     ctx->drawable = drawable;
+    ctx->surface = NULL;
+    ctx->width = 0;
+    ctx->height = 0;
     ctx->current[0] = 0.0;
     ctx->current[1] = 0.0;
     ctx->lastMove[0] = 0.0;
     ctx->lastMove[1] = 0.0;
     ctx->hasCurrent = 0;
-    ctx->m = NULL;
+    ctx->m = m;
+    ctx->states = NULL;
+    ctx->clip = NULL;
     ctx->segm = NULL;
     ctx->currentSegm = NULL;
+    ctx->freeSegm = NULL;
+    ctx->luts = NULL;
+    ctx->scratch = NULL;
+    ctx->scratchSize = 0;
     return ctx;
 }
 
 static _PathSegments*
-_NewPathSegments(void)
+_NewPathSegments(TkPathContext_ *ctx)
 {
     _PathSegments *segm;
 
-    segm = (_PathSegments *) ckalloc(sizeof(_PathSegments));
+    if (ctx->freeSegm != NULL) {
+        segm = ctx->freeSegm;
+        ctx->freeSegm = segm->next;
+    } else {
+        segm = (_PathSegments *) ckalloc(sizeof(_PathSegments));
+        segm->points = (double *) ckalloc((unsigned) (2*_PATH_N_BUFFER_POINTS*sizeof(double)));
+        segm->size = _PATH_N_BUFFER_POINTS;
+    }
     segm->npoints = 0;
-    segm->points = (double *) ckalloc((unsigned) (2*_PATH_N_BUFFER_POINTS*sizeof(double)));
-    segm->size = _PATH_N_BUFFER_POINTS;
     segm->isclosed = 0;
     segm->next = NULL;
     return segm;
 }
 
+/*
+ * Moves the segments of the current path to the free list.
+ */
+
 static void
-_PathContextFree(TkPathContext_ *ctx)
+_ClearPath(TkPathContext_ *ctx)
 {
-    _PathSegments *tmpSegm, *segm;
+    if (ctx->segm != NULL) {
+        ctx->currentSegm->next = ctx->freeSegm;
+        ctx->freeSegm = ctx->segm;
+    }
+    ctx->segm = NULL;
+    ctx->currentSegm = NULL;
+    ctx->hasCurrent = 0;
+}
+
+static void
+_FreeSegmentList(_PathSegments *segm)
+{
+    _PathSegments *tmpSegm;
 
-    segm = ctx->segm;
     while (segm != NULL) {
         tmpSegm = segm;
         segm = tmpSegm->next;
         ckfree((char *) tmpSegm->points);
         ckfree((char *) tmpSegm);
     }
-    if (ctx->m != NULL) {
-        ckfree((char *) ctx->m);
+}
+
+static void
+_ReleaseMask(_CoverMask *maskPtr)
+{
+    if ((maskPtr != NULL) && (--maskPtr->refCount <= 0)) {
+        if (maskPtr->cover != NULL) {
+            ckfree((char *) maskPtr->cover);
+        }
+        ckfree((char *) maskPtr);
+    }
+}
+
+static void
+_PathContextFree(TkPathContext_ *ctx)
+{
+    _FreeSegmentList(ctx->segm);
+    _FreeSegmentList(ctx->freeSegm);
+    while (ctx->states != NULL) {
+        _PathState *statePtr = ctx->states;
+
+        ctx->states = statePtr->next;
+        _ReleaseMask(statePtr->clip);
+        ckfree((char *) statePtr);
+    }
+    _ReleaseMask(ctx->clip);
+    while (ctx->luts != NULL) {
+        _GradientLut *lutPtr = ctx->luts;
+
+        ctx->luts = lutPtr->next;
+        ckfree((char *) lutPtr);
+    }
+    if (ctx->scratch != NULL) {
+        ckfree((char *) ctx->scratch);
+    }
+    if (ctx->surface != NULL) {
+        ckfree((char *) ctx->surface->data);
+        ckfree((char *) ctx->surface);
     }
     ckfree((char *) ctx);
 }
@@ -103,65 +294,119 @@ static void
 _CheckCoordSpace(_PathSegments *segm, int numPoints)
 {
     if (segm->npoints + numPoints >= segm->size) {
-        double *points;
-        points = (double *) ckrealloc((char *)segm->points, 2*(segm->size + _PATH_N_BUFFER_POINTS)*sizeof(double));
-        segm->points = points;
+        int size = MAX(2*segm->size, segm->npoints + numPoints + 1);
+
+        segm->points = (double *) ckrealloc((char *)segm->points, 2*size*sizeof(double));
+        segm->size = size;
     }
 }
 
 TkPathContext
 TkPathInit(Tk_Window tkwin, Drawable d)
 {
-    return (TkPathContext) _NewPathContext(tkwin, d);
+    TkPathContext_ *context = _NewPathContext(Tk_Display(tkwin), d);
+    Window dummy;
+    int x, y;
+    unsigned int width, height, borderWidth, depth;
+
+    /* Find size of Drawable */
+    if (XGetGeometry(Tk_Display(tkwin), d,
+            &dummy, &x, &y, &width, &height, &borderWidth, &depth)) {
+        context->width = (int) width;
+        context->height = (int) height;
+    }
+    return (TkPathContext) context;
 }
 
 TkPathContext
 TkPathInitSurface(Display *display, int width, int height)
 {
-    return NULL;
+    TkPathContext_ *context;
+    _PathSurface *surface;
+
+    if ((width <= 0) || (height <= 0)) {
+        return NULL;
+    }
+    surface = (_PathSurface *) ckalloc(sizeof(_PathSurface));
+    surface->width = width;
+    surface->height = height;
+    /* Round up to nearest multiple of 16 */
+    surface->stride = (4*width + (16-1)) & ~(16-1);
+    surface->data = (unsigned char *) attemptckalloc(height*surface->stride);
+    if (surface->data == NULL) {
+        ckfree((char *) surface);
+        return NULL;
+    }
+    memset(surface->data, '\0', height*surface->stride);
+    context = _NewPathContext(display, None);
+    context->surface = surface;
+    context->width = width;
+    context->height = height;
+    return (TkPathContext) context;
 }
 
 void
 TkPathPushTMatrix(TkPathContext ctx, TMatrix *m)
 {
     TkPathContext_ *context = (TkPathContext_ *) ctx;
+    TMatrix tmp = context->m;
+    TMatrix *p = &context->m;
 
     if (m == NULL) {
         return;
     }
-    if (context->m == NULL) {
-        context->m = (TMatrix *) ckalloc(sizeof(TMatrix));
-        *(context->m) = *m;
-    } else {
-        TMatrix tmp = *(context->m);
-        TMatrix *p = context->m;
+    p->a  = m->a*tmp.a  + m->b*tmp.c;
+    p->b  = m->a*tmp.b  + m->b*tmp.d;
+    p->c  = m->c*tmp.a  + m->d*tmp.c;
+    p->d  = m->c*tmp.b  + m->d*tmp.d;
+    p->tx = m->tx*tmp.a + m->ty*tmp.c + tmp.tx;
+    p->ty = m->tx*tmp.b + m->ty*tmp.d + tmp.ty;
+}
 
-        p->a  = m->a*tmp.a  + m->b*tmp.c;
-        p->b  = m->a*tmp.b  + m->b*tmp.d;
-        p->c  = m->c*tmp.a  + m->d*tmp.c;
-        p->d  = m->c*tmp.b  + m->d*tmp.d;
-        p->tx = m->tx*tmp.a + m->ty*tmp.c + tmp.tx;
-        p->ty = m->tx*tmp.b + m->ty*tmp.d + tmp.ty;
-    }
+void
+TkPathResetTMatrix(TkPathContext ctx)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    TMatrix m = kPathUnitTMatrix;
+
+    context->m = m;
 }
 
 void
 TkPathSaveState(TkPathContext ctx)
 {
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    _PathState *statePtr = (_PathState *) ckalloc(sizeof(_PathState));
 
+    statePtr->m = context->m;
+    statePtr->clip = context->clip;
+    if (context->clip != NULL) {
+        context->clip->refCount++;
+    }
+    statePtr->next = context->states;
+    context->states = statePtr;
 }
 
 void
 TkPathRestoreState(TkPathContext ctx)
 {
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    _PathState *statePtr = context->states;
 
+    if (statePtr == NULL) {
+        return;
+    }
+    context->states = statePtr->next;
+    context->m = statePtr->m;
+    _ReleaseMask(context->clip);
+    context->clip = statePtr->clip;
+    ckfree((char *) statePtr);
 }
 
 void
 TkPathBeginPath(TkPathContext ctx, Tk_PathStyle *style)
 {
-    /* TkPathContext_ *context = (TkPathContext_ *) ctx; */
-    /* empty */
+    _ClearPath((TkPathContext_ *) ctx);
 }
 
 void
@@ -171,7 +416,7 @@ TkPathMoveTo(TkPathContext ctx, double x, double y)
     double *coordPtr;
     _PathSegments *segm;
 
-    segm = _NewPathSegments();
+    segm = _NewPathSegments(context);
     if (context->segm == NULL) {
         context->segm = segm;
     } else {
@@ -184,7 +429,7 @@ TkPathMoveTo(TkPathContext ctx, double x, double y)
     context->lastMove[0] = x;
     context->lastMove[1] = y;
     coordPtr = segm->points;
-    PathApplyTMatrixToPoint(context->m, context->current, coordPtr);
+    PathApplyTMatrixToPoint(&context->m, context->current, coordPtr);
     segm->npoints = 1;
 }
 
@@ -195,12 +440,16 @@ TkPathLineTo(TkPathContext ctx, double x, double y)
     double *coordPtr;
     _PathSegments *segm;
 
+    if (context->currentSegm == NULL) {
+        TkPathMoveTo(ctx, x, y);
+        return;
+    }
     segm = context->currentSegm;
     _CheckCoordSpace(segm, 1);
     context->current[0] = x;
     context->current[1] = y;
     coordPtr = segm->points + 2*segm->npoints;
-    PathApplyTMatrixToPoint(context->m, context->current, coordPtr);
+    PathApplyTMatrixToPoint(&context->m, context->current, coordPtr);
     (segm->npoints)++;
 }
 
@@ -237,13 +486,16 @@ TkPathCurveTo(TkPathContext ctx, double x1, double y1,
     double xc, yc;
     _PathSegments *segm;
 
+    if (context->currentSegm == NULL) {
+        TkPathMoveTo(ctx, x1, y1);
+    }
     xc = x;
     yc = y;
 
-    PathApplyTMatrixToPoint(context->m, context->current, control);
-    PathApplyTMatrix(context->m, &x1, &y1);
-    PathApplyTMatrix(context->m, &x2, &y2);
-    PathApplyTMatrix(context->m, &x, &y);
+    PathApplyTMatrixToPoint(&context->m, context->current, control);
+    PathApplyTMatrix(&context->m, &x1, &y1);
+    PathApplyTMatrix(&context->m, &x2, &y2);
+    PathApplyTMatrix(&context->m, &x, &y);
     control[2] = x1;
     control[3] = y1;
     control[4] = x2;
@@ -290,26 +542,6 @@ TkPathOval(TkPathContext ctx, double cx, double cy, double rx, double ry)
     TkPathClosePath(ctx);
 }
 
-void
-TkPathImage(TkPathContext ctx, Tk_Image image, Tk_PhotoHandle photo,
-        double x, double y, double width, double height, double fillOpacity,
-        XColor *tintColor, double tintAmount, int interpolation, PathRect *srcRegion)
-{
-    /* FIXME use fillOpacity, tintColor, tintAmount parameters */
-    TkPathContext_ *context = (TkPathContext_ *) ctx;
-    int iwidth, iheight;
-
-    if (image == NULL) {
-        return;
-    }
-    PathApplyTMatrix(context->m, &x, &y);
-    Tk_SizeOfImage(image, &iwidth, &iheight);
-    if ((iwidth == 0) || (iheight == 0)) {
-	return;
-    }
-    Tk_RedrawImage(image, 0, 0, iwidth, iheight, context->drawable, (int)x, (int)y);
-}
-
 void
 TkPathClosePath(TkPathContext ctx)
 {
@@ -318,12 +550,15 @@ TkPathClosePath(TkPathContext ctx)
     _PathSegments *segm;
 
     segm = context->currentSegm;
+    if (segm == NULL) {
+        return;
+    }
     _CheckCoordSpace(segm, 1);
     segm->isclosed = 1;
     context->current[0] = context->lastMove[0];
     context->current[1] = context->lastMove[1];
     coordPtr = segm->points + 2*segm->npoints;
-    PathApplyTMatrixToPoint(context->m, context->current, coordPtr);
+    PathApplyTMatrixToPoint(&context->m, context->current, coordPtr);
     (segm->npoints)++;
 }
 
@@ -341,8 +576,7 @@ TkPathTextConfig(Tcl_Interp *interp, Tk_PathTextStyle *textStylePtr, char *utf8,
 void
 TkPathTextDraw(TkPathContext ctx, Tk_PathStyle *style, Tk_PathTextStyle *textStylePtr, double x, double y, int fillOverStroke, char *utf8, void *custom)
 {
-    TkPathContext_ *context = (TkPathContext_ *) ctx;
-
+    /* empty */
 }
 
 void
@@ -352,7 +586,7 @@ TkPathTextFree(Tk_PathTextStyle *textStylePtr, void *custom)
 }
 
 PathRect
-TkPathTextMeasureBbox(Tk_PathTextStyle *textStylePtr, char *utf8, double *lineSpacing, void *custom)
+TkPathTextMeasureBbox(Display *display, Tk_PathTextStyle *textStylePtr, char *utf8, double *lineSpacing, void *custom)
 {
     PathRect r = {0, 0, 0, 0};
     if (lineSpacing != NULL) {
@@ -362,182 +596,1669 @@ TkPathTextMeasureBbox(Tk_PathTextStyle *textStylePtr, char *utf8, double *lineSp
 }
 
 void
-TkPathSurfaceErase(TkPathContext ctx, double x, double y, double width, double height)
+TkPathSurfaceErase(TkPathContext ctx, double dx, double dy, double dwidth, double dheight)
 {
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    _PathSurface *surface = context->surface;
+    int i, x, y, xend, yend;
 
+    if (surface == NULL) {
+        return;
+    }
+    x = MAX(0, MIN(surface->width, (int) (dx + 0.5)));
+    y = MAX(0, MIN(surface->height, (int) (dy + 0.5)));
+    xend = MIN(x + MAX(0, (int) (dwidth + 0.5)), surface->width);
+    yend = MIN(y + MAX(0, (int) (dheight + 0.5)), surface->height);
+    for (i = y; i < yend; i++) {
+        memset(surface->data + i*surface->stride + 4*x, '\0', 4*(xend - x));
+    }
 }
 
 void
 TkPathSurfaceToPhoto(Tcl_Interp *interp, TkPathContext ctx, Tk_PhotoHandle photo)
 {
     TkPathContext_ *context = (TkPathContext_ *) ctx;
+    _PathSurface *surface = context->surface;
+    Tk_PhotoImageBlock block;
+    unsigned char *pixel;
 
+    if (surface == NULL) {
+        return;
+    }
+    Tk_PhotoGetImage(photo, &block);
+    pixel = (unsigned char *) attemptckalloc(surface->height*surface->stride);
+    if (pixel == NULL) {
+        return;
+    }
+    if (gSurfaceCopyPremultiplyAlpha) {
+        PathCopyBitsPremultipliedAlphaRGBA(surface->data, pixel,
+                surface->width, surface->height, surface->stride);
+    } else {
+        memcpy(pixel, surface->data, surface->height*surface->stride);
+    }
+    block.pixelPtr = pixel;
+    block.width = surface->width;
+    block.height = surface->height;
+    block.pitch = surface->stride;
+    block.pixelSize = 4;
+    block.offset[0] = 0;
+    block.offset[1] = 1;
+    block.offset[2] = 2;
+    block.offset[3] = 3;
+    Tk_PhotoPutBlock(interp, photo, &block, 0, 0, surface->width,
+            surface->height, TK_PHOTO_COMPOSITE_OVERLAY);
+    ckfree((char *) pixel);
 }
 
-void
-TkPathClipToPath(TkPathContext ctx, int fillRule)
+/*
+ * The rasterizer.
+ *
+ * Every edge adds, for each pixel it passes, the signed area between the
+ * edge and the pixel's right side, and the rest of its height to the
+ * next pixel. A running sum along a row then gives the winding number of
+ * each pixel weighted by coverage, which the fill rule folds into 0..1.
+ * Rows are done in bands of _PATH_BAND_HEIGHT to keep the accumulation
+ * buffer small.
+ */
+
+static void
+_EdgeListInit(_EdgeList *listPtr)
 {
-    /* empty */
+    listPtr->num = 0;
+    listPtr->size = 0;
+    listPtr->edges = NULL;
+    listPtr->xmin = listPtr->ymin = 1.0e36;
+    listPtr->xmax = listPtr->ymax = -1.0e36;
 }
 
-void
-TkPathReleaseClipToPath(TkPathContext ctx)
+static void
+_EdgeListFree(_EdgeList *listPtr)
 {
-    /* empty */
+    if (listPtr->edges != NULL) {
+        ckfree((char *) listPtr->edges);
+    }
 }
 
-/* @@@ This is a very much simplified version of TkPathCanvTranslatePath that
- * doesn't do any clipping and no translation since we do that with
- * the more general affine matrix transform.
- */
 static void
-_DoubleCoordsToXPointArray(int npoints, double *coordArr, XPoint *outArr)
+_AddEdge(_EdgeList *listPtr, double x0, double y0, double x1, double y1)
 {
-    int i;
-    double x, y;
+    _PathEdge *edgePtr;
 
-    for (i = 0; i < npoints; i++){
-        x = coordArr[i*2];
-        y = coordArr[i*2+1];
+    if ((y0 == y1) || !isfinite(x0) || !isfinite(y0) || !isfinite(x1)
+            || !isfinite(y1)) {
+        return;
+    }
+    if (listPtr->num == listPtr->size) {
+        listPtr->size = MAX(2*listPtr->size, 64);
+        listPtr->edges = (_PathEdge *) ckrealloc((char *) listPtr->edges,
+                listPtr->size*sizeof(_PathEdge));
+    }
+    edgePtr = listPtr->edges + listPtr->num++;
+    edgePtr->x0 = x0;
+    edgePtr->y0 = y0;
+    edgePtr->x1 = x1;
+    edgePtr->y1 = y1;
+    listPtr->xmin = MIN(listPtr->xmin, MIN(x0, x1));
+    listPtr->xmax = MAX(listPtr->xmax, MAX(x0, x1));
+    listPtr->ymin = MIN(listPtr->ymin, MIN(y0, y1));
+    listPtr->ymax = MAX(listPtr->ymax, MAX(y0, y1));
+}
 
-        if (x > 0) {
-            x += 0.5;
-        } else {
-            x -= 0.5;
+/*
+ * All subpaths of the current path, each implicitly closed.
+ */
+
+static void
+_PathEdges(TkPathContext_ *context, _EdgeList *listPtr)
+{
+    _PathSegments *segm;
+    double *p;
+    int i, n;
+
+    for (segm = context->segm; segm != NULL; segm = segm->next) {
+        n = segm->npoints;
+        p = segm->points;
+        if (n < 2) {
+            continue;
         }
-        outArr[i].x = (short) x;
+        for (i = 0; i < n; i++) {
+            int j = (i + 1 < n) ? i + 1 : 0;
 
-        if (y > 0) {
-            y += 0.5;
-        } else {
-            y -= 0.5;
+            _AddEdge(listPtr, p[2*i], p[2*i+1], p[2*j], p[2*j+1]);
         }
-        outArr[i].y = (short) y;
     }
 }
 
-void
-TkPathStroke(TkPathContext ctx, Tk_PathStyle *style)
+/*
+ * Adds the part of an edge that affects pixels 0 to width-1, relative to
+ * the painted area. Parts left of it cover whole pixels and are moved
+ * onto its left side, parts right of it don't matter.
+ */
+
+static void
+_AddLocalEdge(_EdgeList *listPtr, double x0, double y0, double x1,
+        double y1, double width)
 {
-    TkPathContext_ *context = (TkPathContext_ *) ctx;
-    int numPoints;
-    XPoint *pointPtr;
-    _PathSegments *segm;
+    double t[4], tmp, xa, ya, xb, yb;
+    int i, n = 0;
 
-    segm = context->segm;
-    while (segm != NULL) {
-        numPoints = segm->npoints;
-        pointPtr = (XPoint *)ckalloc((unsigned)(numPoints * sizeof(XPoint)));
-        _DoubleCoordsToXPointArray(numPoints, segm->points, pointPtr);
-        XDrawLines(context->display, context->drawable, style->strokeGC, pointPtr, numPoints,
-                CoordModeOrigin);
-        ckfree((char *) pointPtr);
-        segm = segm->next;
+    if ((x0 >= width) && (x1 >= width)) {
+        return;
+    }
+    if ((x0 <= 0.0) && (x1 <= 0.0)) {
+        _AddEdge(listPtr, 0.0, y0, 0.0, y1);
+        return;
+    }
+    t[n++] = 0.0;
+    if ((x0 < 0.0) != (x1 < 0.0)) {
+        t[n++] = x0/(x0 - x1);
+    }
+    if ((x0 < width) != (x1 < width)) {
+        t[n++] = (x0 - width)/(x0 - x1);
+    }
+    t[n++] = 1.0;
+    if ((n == 4) && (t[1] > t[2])) {
+        tmp = t[1];
+        t[1] = t[2];
+        t[2] = tmp;
+    }
+    for (i = 0; i < n - 1; i++) {
+        xa = x0 + t[i]*(x1 - x0);
+        ya = y0 + t[i]*(y1 - y0);
+        xb = x0 + t[i+1]*(x1 - x0);
+        yb = y0 + t[i+1]*(y1 - y0);
+        tmp = 0.5*(xa + xb);
+        if (tmp >= width) {
+            continue;
+        } else if (tmp <= 0.0) {
+            xa = xb = 0.0;
+        }
+        _AddEdge(listPtr, MAX(0.0, MIN(width, xa)), ya,
+                MAX(0.0, MIN(width, xb)), yb);
     }
 }
 
-void
-TkPathFill(TkPathContext ctx, Tk_PathStyle *style)
-{
-    TkPathContext_ *context = (TkPathContext_ *) ctx;
-    int numPoints;
-    XPoint *pointPtr;
-    _PathSegments *segm;
+/*
+ * Accumulates one edge into the rows 0 to height-1 of acc, in
+ * coordinates relative to them. The x coordinates lie in [0, width].
+ */
 
-    segm = context->segm;
-    while (segm != NULL) {
-        numPoints = segm->npoints;
-        pointPtr = (XPoint *)ckalloc((unsigned)(numPoints * sizeof(XPoint)));
-        _DoubleCoordsToXPointArray(numPoints, segm->points, pointPtr);
-        XFillPolygon(context->display, context->drawable, style->fillGC, pointPtr, numPoints,
-                Complex, CoordModeOrigin);
-        ckfree((char *) pointPtr);
-        segm = segm->next;
+static void
+_AccumulateLine(float *acc, int stride, int width, int height,
+        double x0, double y0, double x1, double y1)
+{
+    double dir = 1.0, dxdy, x, xnext, dy, d, xa, xb;
+    double s, x0f, x1f, a0, a1, a2, am, xmf, ys, ye;
+    int y, ya, yb, x0i, x1i, xi;
+    float *row;
+
+    if (y0 > y1) {
+        dir = x0;
+        x0 = x1;
+        x1 = dir;
+        dir = y0;
+        y0 = y1;
+        y1 = dir;
+        dir = -1.0;
+    }
+    ys = MAX(y0, 0.0);
+    ye = MIN(y1, (double) height);
+    if (ys >= ye) {
+        return;
+    }
+    dxdy = (x1 - x0)/(y1 - y0);
+    x = x0 + (ys - y0)*dxdy;
+    ya = (int) ys;
+    yb = (int) ceil(ye);
+    for (y = ya; y < yb; y++) {
+        row = acc + y*stride;
+        dy = MIN(y + 1.0, ye) - MAX((double) y, ys);
+        xnext = x + dxdy*dy;
+        x = MAX(0.0, MIN((double) width, x));
+        xnext = MAX(0.0, MIN((double) width, xnext));
+        d = dy*dir;
+        if (x < xnext) {
+            xa = x;
+            xb = xnext;
+        } else {
+            xa = xnext;
+            xb = x;
+        }
+        x0i = (int) xa;
+        x1i = (int) ceil(xb);
+        if (x1i <= x0i + 1) {
+            xmf = 0.5*(x + xnext) - x0i;
+            row[x0i] += (float) (d - d*xmf);
+            row[x0i+1] += (float) (d*xmf);
+        } else {
+            s = 1.0/(xb - xa);
+            x0f = xa - x0i;
+            a0 = 0.5*s*(1.0 - x0f)*(1.0 - x0f);
+            x1f = xb - x1i + 1.0;
+            am = 0.5*s*x1f*x1f;
+            row[x0i] += (float) (d*a0);
+            if (x1i == x0i + 2) {
+                row[x0i+1] += (float) (d*(1.0 - a0 - am));
+            } else {
+                a1 = s*(1.5 - x0f);
+                row[x0i+1] += (float) (d*(a1 - a0));
+                for (xi = x0i + 2; xi < x1i - 1; xi++) {
+                    row[xi] += (float) (d*s);
+                }
+                a2 = a1 + (x1i - x0i - 3)*s;
+                row[x1i-1] += (float) (d*(1.0 - a2 - am));
+            }
+            row[x1i] += (float) (d*am);
+        }
+        x = xnext;
     }
 }
 
-void
-TkPathFillAndStroke(TkPathContext ctx, Tk_PathStyle *style)
+static float *
+_Scratch(TkPathContext_ *context, int size)
 {
-    TkPathContext_ *context = (TkPathContext_ *) ctx;
-    int numPoints;
-    XPoint *pointPtr;
-    _PathSegments *segm;
-
-    segm = context->segm;
-    while (segm != NULL) {
-        numPoints = segm->npoints;
-        pointPtr = (XPoint *)ckalloc((unsigned)(numPoints * sizeof(XPoint)));
-        _DoubleCoordsToXPointArray(numPoints, segm->points, pointPtr);
-        XFillPolygon(context->display, context->drawable, style->fillGC, pointPtr, numPoints,
-                Complex, CoordModeOrigin);
-        XDrawLines(context->display, context->drawable, style->strokeGC, pointPtr, numPoints,
-                CoordModeOrigin);
-        ckfree((char *) pointPtr);
-        segm = segm->next;
+    if (size > context->scratchSize) {
+        if (context->scratch != NULL) {
+            ckfree((char *) context->scratch);
+        }
+        context->scratch = (float *) ckalloc(size*sizeof(float));
+        context->scratchSize = size;
     }
+    return context->scratch;
 }
 
-void
-TkPathEndPath(TkPathContext ctx)
+/*
+ * Rasterizes the edges over the device area (x0, y0, width, height) and
+ * calls rowProc with the coverage of each row.
+ */
+
+static void
+_RasterizeEdges(TkPathContext_ *context, _EdgeList *edgesPtr, int fillRule,
+        int x0, int y0, int width, int height,
+        _RowProc *rowProc, ClientData clientData)
 {
-    /* empty */
+    _EdgeList local;
+    _PathEdge *e;
+    float *acc, *cover, *row;
+    int i, band, y, n, stride = width + 2;
+    double sum, v;
+
+    _EdgeListInit(&local);
+    for (i = 0; i < edgesPtr->num; i++) {
+        e = edgesPtr->edges + i;
+        _AddLocalEdge(&local, e->x0 - x0, e->y0 - y0, e->x1 - x0,
+                e->y1 - y0, (double) width);
+    }
+    acc = _Scratch(context, stride*_PATH_BAND_HEIGHT + width);
+    cover = acc + stride*_PATH_BAND_HEIGHT;
+    memset(acc, 0, stride*_PATH_BAND_HEIGHT*sizeof(float));
+
+    for (band = 0; band < height; band += _PATH_BAND_HEIGHT) {
+        n = MIN(_PATH_BAND_HEIGHT, height - band);
+        for (i = 0; i < local.num; i++) {
+            e = local.edges + i;
+            if ((MAX(e->y0, e->y1) <= band) || (MIN(e->y0, e->y1) >= band + n)) {
+                continue;
+            }
+            _AccumulateLine(acc, stride, width, n, e->x0, e->y0 - band,
+                    e->x1, e->y1 - band);
+        }
+        for (y = 0; y < n; y++) {
+            row = acc + y*stride;
+            sum = 0.0;
+            for (i = 0; i < width; i++) {
+                sum += row[i];
+                row[i] = 0.0f;
+                v = fabs(sum);
+                if (fillRule == EvenOddRule) {
+                    v -= 2.0*floor(0.5*v);
+                    if (v > 1.0) {
+                        v = 2.0 - v;
+                    }
+                } else if (v > 1.0) {
+                    v = 1.0;
+                }
+                if (!gAntiAlias) {
+                    v = (v >= 0.5) ? 1.0 : 0.0;
+                }
+                cover[i] = (float) v;
+            }
+            row[width] = row[width+1] = 0.0f;
+            (*rowProc)(clientData, y0 + band + y, cover);
+        }
+    }
+    _EdgeListFree(&local);
 }
 
-void
-TkPathFree(TkPathContext ctx)
+/*
+ * Painting.
+ */
+
+static int
+_MaskShift(unsigned long mask, unsigned long *maxPtr)
 {
-    TkPathContext_ *context = (TkPathContext_ *) ctx;
-    _PathContextFree(context);
+    int shift = 0;
+
+    while ((mask != 0) && !(mask & 1)) {
+        mask >>= 1;
+        shift++;
+    }
+    *maxPtr = (mask != 0) ? mask : 1;
+    return shift;
 }
 
-int
-TkPathDrawingDestroysPath(void)
+/*
+ * Gets the device pixels of the area as premultiplied RGBA: the surface
+ * memory as is, or an image of the drawable converted from its visual.
+ */
+
+static int
+_GetPixels(TkPathContext_ *context, _PixelBuf *bufPtr)
 {
-    return 0;
+    _PathSurface *surface = context->surface;
+    XImage *image;
+    unsigned long pixel, rmax, gmax, bmax;
+    unsigned char *p;
+    int i, j, rshift, gshift, bshift;
+
+    bufPtr->image = NULL;
+    if (surface != NULL) {
+        bufPtr->stride = surface->stride;
+        bufPtr->data = surface->data + bufPtr->y*surface->stride + 4*bufPtr->x;
+        return TCL_OK;
+    }
+    image = XGetImage(context->display, context->drawable, bufPtr->x,
+            bufPtr->y, (unsigned) bufPtr->width, (unsigned) bufPtr->height,
+            AllPlanes, ZPixmap);
+    if (image == NULL) {
+        return TCL_ERROR;
+    }
+    rshift = _MaskShift(image->red_mask ? image->red_mask : 0xff0000, &rmax);
+    gshift = _MaskShift(image->green_mask ? image->green_mask : 0xff00, &gmax);
+    bshift = _MaskShift(image->blue_mask ? image->blue_mask : 0xff, &bmax);
+    bufPtr->image = image;
+    bufPtr->stride = 4*bufPtr->width;
+    bufPtr->data = (unsigned char *)
+            ckalloc(bufPtr->stride*bufPtr->height);
+    for (j = 0; j < bufPtr->height; j++) {
+        p = bufPtr->data + j*bufPtr->stride;
+        for (i = 0; i < bufPtr->width; i++, p += 4) {
+            pixel = XGetPixel(image, i, j);
+            p[0] = (unsigned char) (((pixel >> rshift) & rmax)*255/rmax);
+            p[1] = (unsigned char) (((pixel >> gshift) & gmax)*255/gmax);
+            p[2] = (unsigned char) (((pixel >> bshift) & bmax)*255/bmax);
+            p[3] = 0xFF;
+        }
+    }
+    return TCL_OK;
 }
 
-int
-TkPathPixelAlign(void)
+static void
+_PutPixels(TkPathContext_ *context, _PixelBuf *bufPtr)
 {
-    return 1;
+    XImage *image = bufPtr->image;
+    unsigned long rmax, gmax, bmax;
+    unsigned char *p;
+    int i, j, rshift, gshift, bshift;
+    GC gc;
+
+    if (image == NULL) {
+        return;
+    }
+    rshift = _MaskShift(image->red_mask ? image->red_mask : 0xff0000, &rmax);
+    gshift = _MaskShift(image->green_mask ? image->green_mask : 0xff00, &gmax);
+    bshift = _MaskShift(image->blue_mask ? image->blue_mask : 0xff, &bmax);
+    for (j = 0; j < bufPtr->height; j++) {
+        p = bufPtr->data + j*bufPtr->stride;
+        for (i = 0; i < bufPtr->width; i++, p += 4) {
+            XPutPixel(image, i, j,
+                    (((p[0]*rmax + 127)/255) << rshift)
+                    | (((p[1]*gmax + 127)/255) << gshift)
+                    | (((p[2]*bmax + 127)/255) << bshift));
+        }
+    }
+    gc = XCreateGC(context->display, context->drawable, 0, NULL);
+    XPutImage(context->display, context->drawable, gc, image, 0, 0,
+            bufPtr->x, bufPtr->y, (unsigned) bufPtr->width,
+            (unsigned) bufPtr->height);
+    XFreeGC(context->display, gc);
+    XDestroyImage(image);
+    ckfree((char *) bufPtr->data);
 }
 
-int
-TkPathGetCurrentPosition(TkPathContext ctx, PathPoint *pt)
+static int
+_GradientIndex(double t, int method)
 {
-    TkPathContext_ *context = (TkPathContext_ *) ctx;
-    pt->x = context->current[0];
-    pt->y = context->current[1];
-    return TCL_OK;
+    switch (method) {
+        case kPathGradientMethodRepeat:
+            t -= floor(t);
+            break;
+        case kPathGradientMethodReflect:
+            t -= 2.0*floor(t/2.0);
+            if (t > 1.0) {
+                t = 2.0 - t;
+            }
+            break;
+        default:
+            break;
+    }
+    if (t < 0.0) {
+        t = 0.0;
+    } else if (t > 1.0) {
+        t = 1.0;
+    }
+    return (int) (t*(_PATH_GRADIENT_LUT_SIZE - 1) + 0.5);
 }
 
-int
-TkPathBoundingBox(TkPathContext ctx, PathRect *rPtr)
+/*
+ * Parameter of a two circle radial gradient, with a zero radius focal
+ * circle, at the point (x, y) in gradient space; < 0 where undefined.
+ */
+
+static double
+_RadialParameter(RadialTransition *tPtr, double x, double y)
 {
-    return TCL_ERROR;
+    double dx = tPtr->centerX - tPtr->focalX;
+    double dy = tPtr->centerY - tPtr->focalY;
+    double px = x - tPtr->focalX, py = y - tPtr->focalY;
+    double a = dx*dx + dy*dy - tPtr->radius*tPtr->radius;
+    double b = px*dx + py*dy;
+    double c = px*px + py*py;
+    double disc, t1, t2;
+
+    if (fabs(a) < 1e-12) {
+        return (b > 0.0) ? c/(2.0*b) : -1.0;
+    }
+    disc = b*b - a*c;
+    if (disc < 0.0) {
+        return -1.0;
+    }
+    disc = sqrt(disc);
+    t1 = (b + disc)/a;
+    t2 = (b - disc)/a;
+    return (t1 > t2) ? t1 : t2;
 }
 
-void
-TkPathPaintLinearGradient(TkPathContext ctx, PathRect *bbox, LinearGradientFill *fillPtr, int fillRule, double fillOpacity, TMatrix *mPtr)
+/*
+ * One pixel of the image source, tinted like the cairo backend does,
+ * and premultiplied with its alpha times the opacity.
+ */
+
+static void
+_ImagePixel(_PaintSource *srcPtr, int ix, int iy, unsigned int *rgba)
 {
-    /* TkPathContext_ *context = (TkPathContext_ *) ctx; */
-    /* The Tk X11 compatibility layer does not have tha ability to set up
-     * clipping to pixmap which is needed here, I believe.
-     */
+    Tk_PhotoImageBlock *bPtr = &srcPtr->block;
+    unsigned char *p;
+    unsigned int alpha, r, g, b, lum, keep, amount;
+
+    ix = MAX(0, MIN(bPtr->width - 1, ix));
+    iy = MAX(0, MIN(bPtr->height - 1, iy));
+    p = bPtr->pixelPtr + iy*bPtr->pitch + ix*bPtr->pixelSize;
+    if (srcPtr->premultiplied) {
+        rgba[0] = _DIV255(p[bPtr->offset[0]]*srcPtr->color[3]);
+        rgba[1] = _DIV255(p[bPtr->offset[1]]*srcPtr->color[3]);
+        rgba[2] = _DIV255(p[bPtr->offset[2]]*srcPtr->color[3]);
+        rgba[3] = _DIV255(p[bPtr->offset[3]]*srcPtr->color[3]);
+        return;
+    }
+    r = p[bPtr->offset[0]];
+    g = p[bPtr->offset[1]];
+    b = p[bPtr->offset[2]];
+    if (srcPtr->tintAmount > 0) {
+        amount = srcPtr->tintAmount;
+        keep = 256 - amount;
+        lum = (r*6966 + g*23436 + b*2366) >> 15;
+        r = MIN(255, (keep*r + amount*lum*srcPtr->tint[0]/255) >> 8);
+        g = MIN(255, (keep*g + amount*lum*srcPtr->tint[1]/255) >> 8);
+        b = MIN(255, (keep*b + amount*lum*srcPtr->tint[2]/255) >> 8);
+    }
+    alpha = (bPtr->pixelSize == 4) ? p[bPtr->offset[3]] : 0xFF;
+    alpha = _DIV255(alpha*srcPtr->color[3]);
+    rgba[0] = _DIV255(r*alpha);
+    rgba[1] = _DIV255(g*alpha);
+    rgba[2] = _DIV255(b*alpha);
+    rgba[3] = alpha;
 }
 
-void
-TkPathPaintRadialGradient(TkPathContext ctx, PathRect *bbox, RadialGradientFill *fillPtr, int fillRule, double fillOpacity, TMatrix *mPtr)
+/*
+ * Fills in the premultiplied source colors of pixels x0 to x0+width-1 of
+ * device row y.
+ */
+
+static void
+_SourceRow(_PaintSource *srcPtr, int x0, int y, int width,
+        unsigned char *out)
 {
+    TMatrix *A = &srcPtr->A;
+    double qx, qy, t, dt, len2, dx, dy;
+    int i, k;
+
+    qx = A->a*(x0 + 0.5) + A->c*(y + 0.5) + A->tx;
+    qy = A->b*(x0 + 0.5) + A->d*(y + 0.5) + A->ty;
+
+    switch (srcPtr->type) {
+        case _SOURCE_SOLID:
+            for (i = 0; i < width; i++) {
+                for (k = 0; k < 4; k++) {
+                    out[4*i+k] = srcPtr->color[k];
+                }
+            }
+            break;
+        case _SOURCE_LINEAR: {
+            PathRect *lPtr = srcPtr->linearPtr;
+
+            dx = lPtr->x2 - lPtr->x1;
+            dy = lPtr->y2 - lPtr->y1;
+            len2 = dx*dx + dy*dy;
+            t = 1.0;
+            dt = 0.0;
+            if (len2 > 0.0) {
+                t = ((qx - lPtr->x1)*dx + (qy - lPtr->y1)*dy)/len2;
+                dt = (A->a*dx + A->b*dy)/len2;
+            }
+            for (i = 0; i < width; i++, t += dt) {
+                unsigned char *c = srcPtr->lut[_GradientIndex(t, srcPtr->method)];
+
+                for (k = 0; k < 4; k++) {
+                    out[4*i+k] = c[k];
+                }
+            }
+            break;
+        }
+        case _SOURCE_RADIAL:
+            for (i = 0; i < width; i++, qx += A->a, qy += A->b) {
+                t = _RadialParameter(srcPtr->radialPtr, qx, qy);
+                if (t < 0.0) {
+                    memset(out + 4*i, 0, 4);
+                } else {
+                    unsigned char *c = srcPtr->lut[_GradientIndex(t, srcPtr->method)];
+
+                    for (k = 0; k < 4; k++) {
+                        out[4*i+k] = c[k];
+                    }
+                }
+            }
+            break;
+        case _SOURCE_IMAGE: {
+            unsigned int c00[4], c10[4], c01[4], c11[4], fx, fy;
+            double u, v;
+            int ix, iy;
+
+            for (i = 0; i < width; i++, qx += A->a, qy += A->b) {
+                if (srcPtr->interpolation == kPathImageInterpolationNone) {
+                    _ImagePixel(srcPtr, (int) floor(qx), (int) floor(qy), c00);
+                    for (k = 0; k < 4; k++) {
+                        out[4*i+k] = (unsigned char) c00[k];
+                    }
+                    continue;
+                }
+
+                /*
+                 * Bilinear between the four nearest pixel centers,
+                 * with 8 bit weights.
+                 */
+                u = qx - 0.5;
+                v = qy - 0.5;
+                ix = (int) floor(u);
+                iy = (int) floor(v);
+                fx = (unsigned int) ((u - ix)*256.0);
+                fy = (unsigned int) ((v - iy)*256.0);
+                _ImagePixel(srcPtr, ix, iy, c00);
+                _ImagePixel(srcPtr, ix + 1, iy, c10);
+                _ImagePixel(srcPtr, ix, iy + 1, c01);
+                _ImagePixel(srcPtr, ix + 1, iy + 1, c11);
+                for (k = 0; k < 4; k++) {
+                    unsigned int top = c00[k]*(256 - fx) + c10[k]*fx;
+                    unsigned int bot = c01[k]*(256 - fx) + c11[k]*fx;
+
+                    out[4*i+k] = (unsigned char)
+                            ((top*(256 - fy) + bot*fy + 32768) >> 16);
+                }
+            }
+            break;
+        }
+    }
 }
 
-int
-TkPathSetup(Tcl_Interp *interp)
+/*
+ * Composites a row of premultiplied source pixels, weighted by coverage,
+ * over the destination. Written as plain loops over arrays without
+ * branches so that the compiler can vectorize them.
+ */
+
+static void
+_CompositeRow(unsigned char *dst, const unsigned char *src,
+        const unsigned char *cover8, int width)
 {
+    int i, k;
+    unsigned int c, inv, s[4];
+
+    for (i = 0; i < width; i++) {
+        c = cover8[i];
+        for (k = 0; k < 4; k++) {
+            s[k] = _DIV255(src[4*i+k]*c);
+        }
+        inv = 255 - s[3];
+        for (k = 0; k < 4; k++) {
+            dst[4*i+k] = (unsigned char) (s[k] + _DIV255(dst[4*i+k]*inv));
+        }
+    }
+}
+
+typedef struct _PaintRecord {
+    TkPathContext_ *context;
+    _PaintSource *srcPtr;
+    _PixelBuf *bufPtr;
+    unsigned char *cover8;
+    unsigned char *srcRow;
+} _PaintRecord;
+
+/*
+ * Row procedure: weight the coverage by the clip and composite.
+ */
+
+static void
+_PaintRow(ClientData clientData, int y, float *cover)
+{
+    _PaintRecord *recPtr = (_PaintRecord *) clientData;
+    _PixelBuf *bufPtr = recPtr->bufPtr;
+    _CoverMask *clip = recPtr->context->clip;
+    float *clipRow = NULL;
+    int i, width = bufPtr->width;
+
+    if (clip != NULL) {
+        clipRow = clip->cover + (y - clip->y)*clip->width + bufPtr->x - clip->x;
+    }
+    for (i = 0; i < width; i++) {
+        float v = (clipRow != NULL) ? cover[i]*clipRow[i] : cover[i];
+
+        recPtr->cover8[i] = (unsigned char) (v*255.0f + 0.5f);
+    }
+    _SourceRow(recPtr->srcPtr, bufPtr->x, y, width, recPtr->srcRow);
+    _CompositeRow(bufPtr->data + (y - bufPtr->y)*bufPtr->stride,
+            recPtr->srcRow, recPtr->cover8, width);
+}
+
+/*
+ * The device area that can be painted: the drawable, or surface,
+ * intersected with the clip. Returns 0 if empty.
+ */
+
+static int
+_PaintArea(TkPathContext_ *context, double xmin, double ymin, double xmax,
+        double ymax, int *x0Ptr, int *y0Ptr, int *x1Ptr, int *y1Ptr)
+{
+    int x0, y0, x1, y1;
+
+    if ((xmin > xmax) || (ymin > ymax)) {
+        return 0;
+    }
+    x0 = MAX(0, (int) floor(MAX(xmin, -1.0e6)));
+    y0 = MAX(0, (int) floor(MAX(ymin, -1.0e6)));
+    x1 = MIN(context->width, (int) ceil(MIN(xmax, 1.0e6)));
+    y1 = MIN(context->height, (int) ceil(MIN(ymax, 1.0e6)));
+    if (context->clip != NULL) {
+        x0 = MAX(x0, context->clip->x);
+        y0 = MAX(y0, context->clip->y);
+        x1 = MIN(x1, context->clip->x + context->clip->width);
+        y1 = MIN(y1, context->clip->y + context->clip->height);
+    }
+    *x0Ptr = x0;
+    *y0Ptr = y0;
+    *x1Ptr = x1;
+    *y1Ptr = y1;
+    return (x0 < x1) && (y0 < y1);
+}
+
+static void
+_PaintEdges(TkPathContext_ *context, _EdgeList *edgesPtr, int fillRule,
+        _PaintSource *srcPtr)
+{
+    _PaintRecord rec;
+    _PixelBuf buf;
+    int x0, y0, x1, y1;
+
+    if ((edgesPtr->num == 0) || !_PaintArea(context, edgesPtr->xmin,
+            edgesPtr->ymin, edgesPtr->xmax, edgesPtr->ymax,
+            &x0, &y0, &x1, &y1)) {
+        return;
+    }
+    buf.x = x0;
+    buf.y = y0;
+    buf.width = x1 - x0;
+    buf.height = y1 - y0;
+    if (_GetPixels(context, &buf) != TCL_OK) {
+        return;
+    }
+    rec.context = context;
+    rec.srcPtr = srcPtr;
+    rec.bufPtr = &buf;
+    rec.cover8 = (unsigned char *) ckalloc(5*buf.width);
+    rec.srcRow = rec.cover8 + buf.width;
+    _RasterizeEdges(context, edgesPtr, fillRule, x0, y0, buf.width,
+            buf.height, _PaintRow, (ClientData) &rec);
+    ckfree((char *) rec.cover8);
+    _PutPixels(context, &buf);
+}
+
+/*
+ * Paints the clip region, like cairo_paint does.
+ */
+
+static void
+_PaintClip(TkPathContext_ *context, _PaintSource *srcPtr)
+{
+    _CoverMask *clip = context->clip;
+    _PaintRecord rec;
+    _PixelBuf buf;
+    float *ones;
+    int i, y, x0, y0, x1, y1;
+
+    if (!_PaintArea(context, clip->x, clip->y, clip->x + clip->width,
+            clip->y + clip->height, &x0, &y0, &x1, &y1)) {
+        return;
+    }
+    buf.x = x0;
+    buf.y = y0;
+    buf.width = x1 - x0;
+    buf.height = y1 - y0;
+    if (_GetPixels(context, &buf) != TCL_OK) {
+        return;
+    }
+    rec.context = context;
+    rec.srcPtr = srcPtr;
+    rec.bufPtr = &buf;
+    rec.cover8 = (unsigned char *) ckalloc(5*buf.width);
+    rec.srcRow = rec.cover8 + buf.width;
+    ones = _Scratch(context, buf.width);
+    for (i = 0; i < buf.width; i++) {
+        ones[i] = 1.0f;
+    }
+    for (y = y0; y < y1; y++) {
+        _PaintRow((ClientData) &rec, y, ones);
+    }
+    ckfree((char *) rec.cover8);
+    _PutPixels(context, &buf);
+}
+
+static void
+_SolidSource(_PaintSource *srcPtr, XColor *colorPtr, double opacity)
+{
+    unsigned int alpha;
+
+    opacity = MAX(0.0, MIN(1.0, opacity));
+    alpha = (unsigned int) (255.0*opacity + 0.5);
+    srcPtr->type = _SOURCE_SOLID;
+    srcPtr->color[0] = (unsigned char) _DIV255((colorPtr->red >> 8)*alpha);
+    srcPtr->color[1] = (unsigned char) _DIV255((colorPtr->green >> 8)*alpha);
+    srcPtr->color[2] = (unsigned char) _DIV255((colorPtr->blue >> 8)*alpha);
+    srcPtr->color[3] = (unsigned char) alpha;
+}
+
+/*
+ * Strokes are made into polygons in user space, so that the pen follows
+ * the current matrix, which are all given the same orientation and
+ * filled with the nonzero rule: a quadrilateral per line segment, plus
+ * the joins and caps.
+ */
+
+static void
+_PointBufAdd(_PointBuf *bufPtr, double x, double y)
+{
+    if (bufPtr->n == bufPtr->size) {
+        bufPtr->size = MAX(2*bufPtr->size, 32);
+        bufPtr->pts = (double *) ckrealloc((char *) bufPtr->pts,
+                2*bufPtr->size*sizeof(double));
+    }
+    bufPtr->pts[2*bufPtr->n] = x;
+    bufPtr->pts[2*bufPtr->n+1] = y;
+    bufPtr->n++;
+}
+
+static void
+_AddPolygon(_EdgeList *listPtr, TMatrix *m, double *pts, int n)
+{
+    double buf[2*16], *dev = buf, area = 0.0;
+    int i, j;
+
+    if (n > 16) {
+        dev = (double *) ckalloc(2*n*sizeof(double));
+    }
+    for (i = 0; i < n; i++) {
+        PathApplyTMatrixToPoint(m, pts + 2*i, dev + 2*i);
+    }
+    for (i = 0; i < n; i++) {
+        j = (i + 1 < n) ? i + 1 : 0;
+        area += dev[2*i]*dev[2*j+1] - dev[2*j]*dev[2*i+1];
+    }
+    for (i = 0; i < n; i++) {
+        j = (i + 1 < n) ? i + 1 : 0;
+        if (area >= 0.0) {
+            _AddEdge(listPtr, dev[2*i], dev[2*i+1], dev[2*j], dev[2*j+1]);
+        } else {
+            _AddEdge(listPtr, dev[2*j], dev[2*j+1], dev[2*i], dev[2*i+1]);
+        }
+    }
+    if (dev != buf) {
+        ckfree((char *) dev);
+    }
+}
+
+static void
+_AddCircle(_EdgeList *listPtr, TMatrix *m, double cx, double cy, double r)
+{
+    double det = m->a*m->d - m->b*m->c;
+    double scale = sqrt(fabs(det))*r;
+    double a, prev[2], pt[2], cur[2];
+    int i, n;
+
+    /*
+     * Enough sides to keep the error below a fifth of a pixel.
+     */
+    n = 8;
+    if (scale > 0.2) {
+        n = (int) ceil(M_PI/acos(1.0 - 0.2/scale));
+        n = MAX(8, MIN(128, n));
+    }
+    pt[0] = cx + r;
+    pt[1] = cy;
+    PathApplyTMatrixToPoint(m, pt, prev);
+    for (i = 1; i <= n; i++) {
+        a = 2.0*M_PI*i/n;
+        pt[0] = cx + r*cos(a);
+        pt[1] = cy + r*sin(a);
+        PathApplyTMatrixToPoint(m, pt, cur);
+        if (det >= 0.0) {
+            _AddEdge(listPtr, prev[0], prev[1], cur[0], cur[1]);
+        } else {
+            _AddEdge(listPtr, cur[0], cur[1], prev[0], prev[1]);
+        }
+        prev[0] = cur[0];
+        prev[1] = cur[1];
+    }
+}
+
+static void
+_AddCap(_EdgeList *listPtr, TMatrix *m, Tk_PathStyle *style, double hw,
+        double *p, double dx, double dy)
+{
+    double q[8];
+
+    switch (style->capStyle) {
+        case CapRound:
+            _AddCircle(listPtr, m, p[0], p[1], hw);
+            break;
+        case CapProjecting:
+            q[0] = p[0] - dy*hw;
+            q[1] = p[1] + dx*hw;
+            q[2] = q[0] + dx*hw;
+            q[3] = q[1] + dy*hw;
+            q[6] = p[0] + dy*hw;
+            q[7] = p[1] - dx*hw;
+            q[4] = q[6] + dx*hw;
+            q[5] = q[7] + dy*hw;
+            _AddPolygon(listPtr, m, q, 4);
+            break;
+        default:
+            break;
+    }
+}
+
+static void
+_AddJoin(_EdgeList *listPtr, TMatrix *m, Tk_PathStyle *style, double hw,
+        double *p, double dx0, double dy0, double dx1, double dy1)
+{
+    double cross = dx0*dy1 - dy0*dx1, dot = dx0*dx1 + dy0*dy1;
+    double s, o0x, o0y, o1x, o1y, q[8];
+
+    if ((fabs(cross) < 1e-9) && (dot > 0.0)) {
+        return;
+    }
+    if (style->joinStyle == JoinRound) {
+        _AddCircle(listPtr, m, p[0], p[1], hw);
+        return;
+    }
+
+    /*
+     * Unit normals on the outer side of the turn.
+     */
+    s = (cross > 0.0) ? 1.0 : -1.0;
+    o0x = s*dy0;
+    o0y = -s*dx0;
+    o1x = s*dy1;
+    o1y = -s*dx1;
+    q[0] = p[0];
+    q[1] = p[1];
+    q[2] = p[0] + o0x*hw;
+    q[3] = p[1] + o0y*hw;
+    if ((style->joinStyle == JoinMiter) && (1.0 + dot > 1e-9)
+            && (2.0/(1.0 - dot) <= style->miterLimit*style->miterLimit)) {
+        double f = hw/(1.0 + o0x*o1x + o0y*o1y);
+
+        q[4] = p[0] + (o0x + o1x)*f;
+        q[5] = p[1] + (o0y + o1y)*f;
+        q[6] = p[0] + o1x*hw;
+        q[7] = p[1] + o1y*hw;
+        _AddPolygon(listPtr, m, q, 4);
+    } else {
+        q[4] = p[0] + o1x*hw;
+        q[5] = p[1] + o1y*hw;
+        _AddPolygon(listPtr, m, q, 3);
+    }
+}
+
+/*
+ * Removes, in place, points that coincide with the one before them, and
+ * for closed polylines the last point if it coincides with the first.
+ * Dash boundaries that fall on a vertex make such points, and a segment
+ * without length has no direction to offset along. Returns the number
+ * of points left.
+ */
+
+static int
+_UniquePoints(double *pts, int n, int closed)
+{
+    int i, k;
+
+    if (n == 0) {
+        return 0;
+    }
+    for (i = 1, k = 1; i < n; i++) {
+        if (hypot(pts[2*i] - pts[2*k-2], pts[2*i+1] - pts[2*k-1]) > 1e-9) {
+            pts[2*k] = pts[2*i];
+            pts[2*k+1] = pts[2*i+1];
+            k++;
+        }
+    }
+    if (closed && (k > 1)
+            && (hypot(pts[2*k-2] - pts[0], pts[2*k-1] - pts[1]) <= 1e-9)) {
+        k--;
+    }
+    return k;
+}
+
+/*
+ * The outline of an open or closed polyline in user space.
+ */
+
+static void
+_StrokePolyline(_EdgeList *listPtr, TMatrix *m, Tk_PathStyle *style,
+        double hw, double *pts, int n, int closed)
+{
+    double q[8], dx, dy, len, pdx = 0.0, pdy = 0.0, fdx = 0.0, fdy = 0.0;
+    int i, j, nsegs;
+
+    n = _UniquePoints(pts, n, closed);
+    if (n == 0) {
+        return;
+    }
+    if (n == 1) {
+        if (style->capStyle == CapRound) {
+            _AddCircle(listPtr, m, pts[0], pts[1], hw);
+        } else if (style->capStyle == CapProjecting) {
+            _AddCap(listPtr, m, style, hw, pts, 1.0, 0.0);
+            _AddCap(listPtr, m, style, hw, pts, -1.0, 0.0);
+        }
+        return;
+    }
+    if (closed && (n < 3)) {
+        closed = 0;
+    }
+    nsegs = closed ? n : n - 1;
+    for (i = 0; i < nsegs; i++) {
+        j = (i + 1 < n) ? i + 1 : 0;
+        dx = pts[2*j] - pts[2*i];
+        dy = pts[2*j+1] - pts[2*i+1];
+        len = hypot(dx, dy);
+        if (len == 0.0) {
+            continue;
+        }
+        dx /= len;
+        dy /= len;
+        q[0] = pts[2*i] - dy*hw;
+        q[1] = pts[2*i+1] + dx*hw;
+        q[2] = pts[2*j] - dy*hw;
+        q[3] = pts[2*j+1] + dx*hw;
+        q[4] = pts[2*j] + dy*hw;
+        q[5] = pts[2*j+1] - dx*hw;
+        q[6] = pts[2*i] + dy*hw;
+        q[7] = pts[2*i+1] - dx*hw;
+        _AddPolygon(listPtr, m, q, 4);
+        if (i == 0) {
+            fdx = dx;
+            fdy = dy;
+            if (!closed) {
+                _AddCap(listPtr, m, style, hw, pts, -dx, -dy);
+            }
+        } else {
+            _AddJoin(listPtr, m, style, hw, pts + 2*i, pdx, pdy, dx, dy);
+        }
+        pdx = dx;
+        pdy = dy;
+    }
+    if (closed) {
+        _AddJoin(listPtr, m, style, hw, pts, pdx, pdy, fdx, fdy);
+    } else {
+        _AddCap(listPtr, m, style, hw, pts + 2*(n-1), pdx, pdy);
+    }
+}
+
+/*
+ * Splits a polyline into its dashes, each stroked as an open polyline.
+ * A dash may start or end exactly on a vertex; _StrokePolyline drops
+ * the repeated point that gives.
+ */
+
+static void
+_StrokeDashed(_EdgeList *listPtr, TMatrix *m, Tk_PathStyle *style,
+        double hw, double *pts, int n, int closed)
+{
+    Tk_PathDash *dashPtr = style->dashPtr;
+    double *dashes = TkPathDashScaled(dashPtr, style->strokeWidth);
+    int ndash = dashPtr->number, i, j, k, nsegs, on;
+    double period = 0.0, left, len, dx, dy, t, pos;
+    _PointBuf piece = {0, 0, NULL};
+
+    for (k = 0; k < ndash; k++) {
+        period += MAX(0.0, dashes[k]);
+    }
+    if (ndash % 2) {
+        period *= 2.0;
+    }
+    if (period <= 0.0) {
+        _StrokePolyline(listPtr, m, style, hw, pts, n, closed);
+        return;
+    }
+    n = _UniquePoints(pts, n, closed);
+    if (n < 2) {
+        _StrokePolyline(listPtr, m, style, hw, pts, n, closed);
+        return;
+    }
+
+    /*
+     * Find where in the pattern the offset puts the start.
+     */
+    pos = fmod((double) style->offset, period);
+    if (pos < 0.0) {
+        pos += period;
+    }
+    k = 0;
+    on = 1;
+    while (pos >= MAX(0.0, dashes[k % ndash])) {
+        pos -= MAX(0.0, dashes[k % ndash]);
+        k = (k + 1) % (2*ndash);
+        on = !on;
+    }
+    left = MAX(0.0, dashes[k % ndash]) - pos;
+    if (on) {
+        _PointBufAdd(&piece, pts[0], pts[1]);
+    }
+    nsegs = closed ? n : n - 1;
+    for (i = 0; i < nsegs; i++) {
+        j = (i + 1 < n) ? i + 1 : 0;
+        dx = pts[2*j] - pts[2*i];
+        dy = pts[2*j+1] - pts[2*i+1];
+        len = hypot(dx, dy);
+        if (len == 0.0) {
+            continue;
+        }
+        t = 0.0;
+        while (len - t > left) {
+            t += left;
+            if (on) {
+                _PointBufAdd(&piece, pts[2*i] + dx*t/len, pts[2*i+1] + dy*t/len);
+                _StrokePolyline(listPtr, m, style, hw, piece.pts, piece.n, 0);
+                piece.n = 0;
+            } else {
+                _PointBufAdd(&piece, pts[2*i] + dx*t/len, pts[2*i+1] + dy*t/len);
+            }
+            on = !on;
+            k = (k + 1) % (2*ndash);
+            left = MAX(0.0, dashes[k % ndash]);
+        }
+        left -= len - t;
+        if (on) {
+            _PointBufAdd(&piece, pts[2*j], pts[2*j+1]);
+        }
+    }
+    if (on && (piece.n > 1)) {
+        _StrokePolyline(listPtr, m, style, hw, piece.pts, piece.n, 0);
+    }
+    if (piece.pts != NULL) {
+        ckfree((char *) piece.pts);
+    }
+}
+
+static void
+_StrokeEdges(TkPathContext_ *context, Tk_PathStyle *style,
+        _EdgeList *listPtr)
+{
+    _PathSegments *segm;
+    _PointBuf user = {0, 0, NULL};
+    TMatrix *m = &context->m, mi;
+    double hw = 0.5*style->strokeWidth, pt[2];
+    int i, closed;
+
+    if ((hw <= 0.0) || (m->a*m->d - m->b*m->c == 0.0)) {
+        return;
+    }
+    PathInverseTMatrix(m, &mi);
+    for (segm = context->segm; segm != NULL; segm = segm->next) {
+        user.n = 0;
+        for (i = 0; i < segm->npoints; i++) {
+            PathApplyTMatrixToPoint(&mi, segm->points + 2*i, pt);
+            if ((user.n > 0) && (pt[0] == user.pts[2*user.n-2])
+                    && (pt[1] == user.pts[2*user.n-1])) {
+                continue;
+            }
+            _PointBufAdd(&user, pt[0], pt[1]);
+        }
+        closed = segm->isclosed;
+        if (closed && (user.n > 1) && (user.pts[0] == user.pts[2*user.n-2])
+                && (user.pts[1] == user.pts[2*user.n-1])) {
+            user.n--;
+        }
+        if (user.n == 0) {
+            continue;
+        }
+        if ((style->dashPtr != NULL) && (style->dashPtr->number > 0)
+                && (user.n > 1)) {
+            _StrokeDashed(listPtr, m, style, hw, user.pts, user.n, closed);
+        } else {
+            _StrokePolyline(listPtr, m, style, hw, user.pts, user.n, closed);
+        }
+    }
+    if (user.pts != NULL) {
+        ckfree((char *) user.pts);
+    }
+}
+
+/*
+ * Paints the region sx1,sy1 to sx2,sy2 of the image of srcPtr onto the
+ * rectangle at x,y in user coordinates.
+ */
+
+static void
+_PaintImage(TkPathContext_ *context, _PaintSource *srcPtr,
+        double x, double y, double width, double height,
+        double sx1, double sy1, double sx2, double sy2)
+{
+    _EdgeList edges;
+    TMatrix *m = &context->m, tmp;
+    double q[8];
+
+    /*
+     * Device pixels to image pixels: undo the matrix, then map the
+     * destination rectangle onto the source region.
+     */
+    PathInverseTMatrix(m, &srcPtr->A);
+    tmp.a = (sx2 - sx1)/width;
+    tmp.b = tmp.c = 0.0;
+    tmp.d = (sy2 - sy1)/height;
+    tmp.tx = sx1 - x*tmp.a;
+    tmp.ty = sy1 - y*tmp.d;
+    MMulTMatrix(&srcPtr->A, &tmp);
+    srcPtr->A = tmp;
+
+    q[0] = x;
+    q[1] = y;
+    q[2] = x + width;
+    q[3] = y;
+    q[4] = x + width;
+    q[5] = y + height;
+    q[6] = x;
+    q[7] = y + height;
+    _EdgeListInit(&edges);
+    _AddPolygon(&edges, m, q, 4);
+    _PaintEdges(context, &edges, WindingRule, srcPtr);
+    _EdgeListFree(&edges);
+}
+
+void
+TkPathImage(TkPathContext ctx, Tk_Image image, Tk_PhotoHandle photo,
+        double x, double y, double width, double height, double fillOpacity,
+        XColor *tintColor, double tintAmount, int interpolation, PathRect *srcRegion,
+        void **customPtr)
+{
+    /*
+     * The photo is sampled as is, so nothing is kept in *customPtr.
+     */
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    _PaintSource *srcPtr;
+    TMatrix *m = &context->m;
+    double sx1, sy1, sx2, sy2;
+    int iwidth, iheight;
+
+    if (image == NULL) {
+        return;
+    }
+    Tk_SizeOfImage(image, &iwidth, &iheight);
+    if ((iwidth == 0) || (iheight == 0)) {
+	return;
+    }
+    if (photo == NULL) {
+        if (context->surface == NULL) {
+            PathApplyTMatrix(m, &x, &y);
+            Tk_RedrawImage(image, 0, 0, iwidth, iheight, context->drawable,
+                    (int)x, (int)y);
+        }
+        return;
+    }
+    if (width == 0.0) {
+        width = (double) iwidth;
+    }
+    if (height == 0.0) {
+        height = (double) iheight;
+    }
+    if (m->a*m->d - m->b*m->c == 0.0) {
+        return;
+    }
+    srcPtr = (_PaintSource *) ckalloc(sizeof(_PaintSource));
+    srcPtr->type = _SOURCE_IMAGE;
+    srcPtr->color[3] = (unsigned char)
+            (255.0*MAX(0.0, MIN(1.0, fillOpacity)) + 0.5);
+    Tk_PhotoGetImage(photo, &srcPtr->block);
+    srcPtr->interpolation = interpolation;
+    srcPtr->tintAmount = 0;
+    srcPtr->premultiplied = 0;
+    if ((tintColor != NULL) && (tintAmount > 0.0)) {
+        srcPtr->tintAmount = (int) (256.0*MIN(1.0, tintAmount));
+        srcPtr->tint[0] = tintColor->red >> 8;
+        srcPtr->tint[1] = tintColor->green >> 8;
+        srcPtr->tint[2] = tintColor->blue >> 8;
+    }
+    sx1 = sy1 = 0.0;
+    sx2 = (double) srcPtr->block.width;
+    sy2 = (double) srcPtr->block.height;
+    if (srcRegion != NULL) {
+        sx1 = MAX(0.0, srcRegion->x1);
+        sy1 = MAX(0.0, srcRegion->y1);
+        sx2 = MIN(sx2, srcRegion->x2);
+        sy2 = MIN(sy2, srcRegion->y2);
+    }
+    if ((sx1 < sx2) && (sy1 < sy2) && (srcPtr->block.pixelPtr != NULL)) {
+        _PaintImage(context, srcPtr, x, y, width, height, sx1, sy1, sx2, sy2);
+    }
+    ckfree((char *) srcPtr);
+}
+
+void
+TkPathSurfaceDraw(TkPathContext ctx, TkPathContext surfaceCtx,
+        double x, double y, double opacity)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    _PathSurface *surface = ((TkPathContext_ *) surfaceCtx)->surface;
+    TMatrix *m = &context->m;
+    _PaintSource *srcPtr;
+
+    if ((surface == NULL) || (m->a*m->d - m->b*m->c == 0.0)) {
+        return;
+    }
+    srcPtr = (_PaintSource *) ckalloc(sizeof(_PaintSource));
+    srcPtr->type = _SOURCE_IMAGE;
+    srcPtr->color[3] = (unsigned char)
+            (255.0*MAX(0.0, MIN(1.0, opacity)) + 0.5);
+    srcPtr->block.pixelPtr = surface->data;
+    srcPtr->block.width = surface->width;
+    srcPtr->block.height = surface->height;
+    srcPtr->block.pitch = surface->stride;
+    srcPtr->block.pixelSize = 4;
+    srcPtr->block.offset[0] = 0;
+    srcPtr->block.offset[1] = 1;
+    srcPtr->block.offset[2] = 2;
+    srcPtr->block.offset[3] = 3;
+    srcPtr->interpolation = kPathImageInterpolationNone;
+    srcPtr->tintAmount = 0;
+    srcPtr->premultiplied = 1;
+    _PaintImage(context, srcPtr, x, y, (double) surface->width,
+            (double) surface->height, 0.0, 0.0, (double) surface->width,
+            (double) surface->height);
+    ckfree((char *) srcPtr);
+}
+
+void
+TkPathImageFree(void *custom)
+{
+    /* empty */
+}
+
+int
+TkPathImageChanged(void *custom, Tk_PhotoHandle photo,
+    int x, int y, int width, int height)
+{
+    return 0;
+}
+
+typedef struct _MaskRecord {
+    _CoverMask *maskPtr;
+    _CoverMask *oldPtr;
+} _MaskRecord;
+
+/*
+ * Row procedure: store the coverage, weighted by the old clip, in the
+ * new mask.
+ */
+
+static void
+_MaskRow(ClientData clientData, int y, float *cover)
+{
+    _MaskRecord *recPtr = (_MaskRecord *) clientData;
+    _CoverMask *maskPtr = recPtr->maskPtr, *oldPtr = recPtr->oldPtr;
+    float *dst = maskPtr->cover + (y - maskPtr->y)*maskPtr->width;
+    float *old;
+    int i;
+
+    if (oldPtr == NULL) {
+        memcpy(dst, cover, maskPtr->width*sizeof(float));
+        return;
+    }
+    old = oldPtr->cover + (y - oldPtr->y)*oldPtr->width
+            + maskPtr->x - oldPtr->x;
+    for (i = 0; i < maskPtr->width; i++) {
+        dst[i] = cover[i]*old[i];
+    }
+}
+
+void
+TkPathClipToPath(TkPathContext ctx, int fillRule)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    _MaskRecord rec;
+    _EdgeList edges;
+    int x0, y0, x1, y1;
+
+    rec.oldPtr = context->clip;
+    rec.maskPtr = (_CoverMask *) ckalloc(sizeof(_CoverMask));
+    rec.maskPtr->refCount = 1;
+    rec.maskPtr->x = rec.maskPtr->y = 0;
+    rec.maskPtr->width = rec.maskPtr->height = 0;
+    rec.maskPtr->cover = NULL;
+
+    /*
+     * An empty mask, where the path covers nothing, clips everything.
+     */
+    _EdgeListInit(&edges);
+    _PathEdges(context, &edges);
+    if ((edges.num > 0) && _PaintArea(context, edges.xmin, edges.ymin,
+            edges.xmax, edges.ymax, &x0, &y0, &x1, &y1)) {
+        rec.maskPtr->x = x0;
+        rec.maskPtr->y = y0;
+        rec.maskPtr->width = x1 - x0;
+        rec.maskPtr->height = y1 - y0;
+        rec.maskPtr->cover = (float *) ckalloc(
+                (x1 - x0)*(y1 - y0)*sizeof(float));
+        _RasterizeEdges(context, &edges, fillRule, x0, y0, x1 - x0,
+                y1 - y0, _MaskRow, (ClientData) &rec);
+    }
+    _EdgeListFree(&edges);
+    _ReleaseMask(rec.oldPtr);
+    context->clip = rec.maskPtr;
+}
+
+void
+TkPathReleaseClipToPath(TkPathContext ctx)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+
+    _ReleaseMask(context->clip);
+    context->clip = NULL;
+}
+
+void
+TkPathStroke(TkPathContext ctx, Tk_PathStyle *style)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    _PaintSource src;
+    _EdgeList edges;
+
+    if (style->strokeColor == NULL) {
+        return;
+    }
+    _SolidSource(&src, style->strokeColor, style->strokeOpacity);
+    _EdgeListInit(&edges);
+    _StrokeEdges(context, style, &edges);
+    _PaintEdges(context, &edges, WindingRule, &src);
+    _EdgeListFree(&edges);
+}
+
+void
+TkPathFill(TkPathContext ctx, Tk_PathStyle *style)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    XColor *colorPtr = GetColorFromPathColor(style->fill);
+    _PaintSource src;
+    _EdgeList edges;
+
+    if (colorPtr == NULL) {
+        return;
+    }
+    _SolidSource(&src, colorPtr, style->fillOpacity);
+    _EdgeListInit(&edges);
+    _PathEdges(context, &edges);
+    _PaintEdges(context, &edges, style->fillRule, &src);
+    _EdgeListFree(&edges);
+}
+
+void
+TkPathFillAndStroke(TkPathContext ctx, Tk_PathStyle *style)
+{
+    TkPathFill(ctx, style);
+    TkPathStroke(ctx, style);
+}
+
+void
+TkPathEndPath(TkPathContext ctx)
+{
+    /* empty */
+}
+
+void
+TkPathFree(TkPathContext ctx)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    _PathContextFree(context);
+}
+
+int
+TkPathDrawingDestroysPath(void)
+{
+    return 0;
+}
+
+int
+TkPathPixelAlign(void)
+{
+    return 0;
+}
+
+int
+TkPathGetCurrentPosition(TkPathContext ctx, PathPoint *pt)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    pt->x = context->current[0];
+    pt->y = context->current[1];
+    return TCL_OK;
+}
+
+/*
+ * The bounding box of the flattened current path in device coordinates.
+ */
+
+int
+TkPathBoundingBox(TkPathContext ctx, PathRect *rPtr)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    _PathSegments *segm;
+    int i, found = 0;
+
+    rPtr->x1 = rPtr->y1 = 1.0e36;
+    rPtr->x2 = rPtr->y2 = -1.0e36;
+    for (segm = context->segm; segm != NULL; segm = segm->next) {
+        for (i = 0; i < segm->npoints; i++) {
+            IncludePointInRect(rPtr, segm->points[2*i], segm->points[2*i+1]);
+            found = 1;
+        }
+    }
+    return found ? TCL_OK : TCL_ERROR;
+}
+
+/*
+ * Gradients: the colors are looked up in a table per stop array, made
+ * premultiplied with the opacity for each paint, at the gradient
+ * parameter of each pixel. The parameter is computed incrementally along
+ * the rows for linear gradients.
+ */
+
+static _GradientLut *
+_GetGradientLut(TkPathContext_ *context, GradientStopArray *stopArrPtr)
+{
+    _GradientLut *lutPtr;
+    GradientStop **stops = stopArrPtr->stops;
+    GradientStop *s0, *s1;
+    int i, j, k, nstops = stopArrPtr->nstops;
+    double t, f, c0, c1;
+
+    for (lutPtr = context->luts; lutPtr != NULL; lutPtr = lutPtr->next) {
+        if (lutPtr->stopArrPtr == stopArrPtr) {
+            return lutPtr;
+        }
+    }
+    if (nstops == 0) {
+        return NULL;
+    }
+    lutPtr = (_GradientLut *) ckalloc(sizeof(_GradientLut));
+    lutPtr->stopArrPtr = stopArrPtr;
+    lutPtr->next = context->luts;
+    context->luts = lutPtr;
+
+    for (i = 0, j = 0; i < _PATH_GRADIENT_LUT_SIZE; i++) {
+        t = (double) i / (_PATH_GRADIENT_LUT_SIZE - 1);
+        while ((j + 1 < nstops) && (stops[j+1]->offset <= t)) {
+            j++;
+        }
+        s0 = stops[j];
+        s1 = (j + 1 < nstops) ? stops[j+1] : s0;
+        f = 0.0;
+        if ((t > s0->offset) && (s1->offset > s0->offset)) {
+            f = (t - s0->offset)/(s1->offset - s0->offset);
+            if (f > 1.0) {
+                f = 1.0;
+            }
+        }
+        for (k = 0; k < 3; k++) {
+            c0 = (k == 0) ? s0->color->red :
+                    (k == 1) ? s0->color->green : s0->color->blue;
+            c1 = (k == 0) ? s1->color->red :
+                    (k == 1) ? s1->color->green : s1->color->blue;
+            lutPtr->rgba[i][k] = (unsigned char)
+                    (((1.0 - f)*c0 + f*c1)/257.0 + 0.5);
+        }
+        lutPtr->rgba[i][3] = (unsigned char)
+                (255.0*((1.0 - f)*s0->opacity + f*s1->opacity) + 0.5);
+    }
+    return lutPtr;
+}
+
+static void
+_PaintGradient(TkPathContext_ *context, PathRect *bbox, int units,
+        int method, GradientStopArray *stopArrPtr, TMatrix *mPtr,
+        int fillRule, double fillOpacity,
+        PathRect *linearPtr, RadialTransition *radialPtr)
+{
+    _GradientLut *lutPtr;
+    _PaintSource *srcPtr;
+    _EdgeList edges;
+    TMatrix *m = &context->m, tmp;
+    unsigned int alpha, opacity;
+    int i, k;
+
+    if (units == kPathGradientUnitsBoundingBox) {
+        if (bbox->x2 - bbox->x1 == 0 || bbox->y2 - bbox->y1 == 0) {
+            return;
+        }
+    }
+    if (m->a*m->d - m->b*m->c == 0.0) {
+        return;
+    }
+    lutPtr = _GetGradientLut(context, stopArrPtr);
+    if (lutPtr == NULL) {
+        return;
+    }
+    srcPtr = (_PaintSource *) ckalloc(sizeof(_PaintSource));
+    srcPtr->type = (linearPtr != NULL) ? _SOURCE_LINEAR : _SOURCE_RADIAL;
+    srcPtr->method = method;
+    srcPtr->linearPtr = linearPtr;
+    srcPtr->radialPtr = radialPtr;
+
+    /*
+     * The mapping from device pixels to gradient space, as cairo does it:
+     * undo the context's matrix, map the bbox to the unit square for
+     * bbox units, then apply the gradient's matrix.
+     */
+    PathInverseTMatrix(m, &srcPtr->A);
+    if (units == kPathGradientUnitsBoundingBox) {
+        tmp.a = 1.0/(bbox->x2 - bbox->x1);
+        tmp.b = tmp.c = 0.0;
+        tmp.d = 1.0/(bbox->y2 - bbox->y1);
+        tmp.tx = -bbox->x1*tmp.a;
+        tmp.ty = -bbox->y1*tmp.d;
+        MMulTMatrix(&srcPtr->A, &tmp);
+        srcPtr->A = tmp;
+    }
+    if (mPtr != NULL) {
+        tmp = *mPtr;
+        MMulTMatrix(&srcPtr->A, &tmp);
+        srcPtr->A = tmp;
+    }
+
+    opacity = (unsigned int) (255.0*MAX(0.0, MIN(1.0, fillOpacity)) + 0.5);
+    for (i = 0; i < _PATH_GRADIENT_LUT_SIZE; i++) {
+        alpha = _DIV255(lutPtr->rgba[i][3]*opacity);
+        for (k = 0; k < 3; k++) {
+            srcPtr->lut[i][k] = (unsigned char)
+                    _DIV255(lutPtr->rgba[i][k]*alpha);
+        }
+        srcPtr->lut[i][3] = (unsigned char) alpha;
+    }
+
+    /*
+     * TkPathPaintPath clips to the path before painting the gradient;
+     * then the clip is painted, else the path is filled.
+     */
+    if (context->clip != NULL) {
+        _PaintClip(context, srcPtr);
+    } else {
+        _EdgeListInit(&edges);
+        _PathEdges(context, &edges);
+        _PaintEdges(context, &edges, fillRule, srcPtr);
+        _EdgeListFree(&edges);
+    }
+    ckfree((char *) srcPtr);
+}
+
+void
+TkPathPaintLinearGradient(TkPathContext ctx, PathRect *bbox, LinearGradientFill *fillPtr, int fillRule, double fillOpacity, TMatrix *mPtr)
+{
+    _PaintGradient((TkPathContext_ *) ctx, bbox, fillPtr->units,
+            fillPtr->method, fillPtr->stopArrPtr, mPtr, fillRule, fillOpacity,
+            fillPtr->transitionPtr, NULL);
+}
+
+void
+TkPathPaintRadialGradient(TkPathContext ctx, PathRect *bbox, RadialGradientFill *fillPtr, int fillRule, double fillOpacity, TMatrix *mPtr)
+{
+    _PaintGradient((TkPathContext_ *) ctx, bbox, fillPtr->units,
+            fillPtr->method, fillPtr->stopArrPtr, mPtr, fillRule, fillOpacity,
+            NULL, fillPtr->radialPtr);
+}
+
+int
+TkPathSetup(Tcl_Interp *interp)
+{
+    Tcl_SetVar(interp, "::tkp::backend", "tk", TCL_GLOBAL_ONLY);
     return TCL_OK;
 }
-
+
 /*
  * Local Variables:
  * mode: c
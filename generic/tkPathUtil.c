@@ -777,12 +777,177 @@ MMulTMatrix(TMatrix *m1, TMatrix *m2)
     }
 }
 
+/*
+ * The matrix object type keeps a TMatrix in the internal representation
+ * so that -matrix options and the ::tkp::matrix commands can pass
+ * matrices around without converting them to and from strings.
+ */
+
+static void	DupTMatrixInternalRep(Tcl_Obj *srcPtr, Tcl_Obj *copyPtr);
+static void	FreeTMatrixInternalRep(Tcl_Obj *objPtr);
+static int	SetTMatrixFromAny(Tcl_Interp *interp, Tcl_Obj *objPtr);
+static void	UpdateStringOfTMatrix(Tcl_Obj *objPtr);
+
+const Tcl_ObjType tkPathMatrixObjType = {
+    "tkpathmatrix",			/* name */
+    FreeTMatrixInternalRep,		/* freeIntRepProc */
+    DupTMatrixInternalRep,		/* dupIntRepProc */
+    UpdateStringOfTMatrix,		/* updateStringProc */
+    SetTMatrixFromAny			/* setFromAnyProc */
+};
+
+#define ObjTMatrix(objPtr) ((TMatrix *) (objPtr)->internalRep.twoPtrValue.ptr1)
+
+static void
+FreeTMatrixInternalRep(Tcl_Obj *objPtr)
+{
+    ckfree((char *) ObjTMatrix(objPtr));
+    objPtr->typePtr = NULL;
+}
+
+static void
+DupTMatrixInternalRep(Tcl_Obj *srcPtr, Tcl_Obj *copyPtr)
+{
+    TMatrix *matrixPtr = (TMatrix *) ckalloc(sizeof(TMatrix));
+
+    *matrixPtr = *ObjTMatrix(srcPtr);
+    copyPtr->internalRep.twoPtrValue.ptr1 = (void *) matrixPtr;
+    copyPtr->internalRep.twoPtrValue.ptr2 = NULL;
+    copyPtr->typePtr = &tkPathMatrixObjType;
+}
+
+/*
+ * Gives the same string as the list made by PathGetTclObjFromTMatrix.
+ */
+
+static void
+UpdateStringOfTMatrix(Tcl_Obj *objPtr)
+{
+    TMatrix *matrixPtr = ObjTMatrix(objPtr);
+    char buf[6][TCL_DOUBLE_SPACE];
+    char str[6*TCL_DOUBLE_SPACE + 16];
+    size_t len;
+
+    Tcl_PrintDouble(NULL, matrixPtr->a, buf[0]);
+    Tcl_PrintDouble(NULL, matrixPtr->b, buf[1]);
+    Tcl_PrintDouble(NULL, matrixPtr->c, buf[2]);
+    Tcl_PrintDouble(NULL, matrixPtr->d, buf[3]);
+    Tcl_PrintDouble(NULL, matrixPtr->tx, buf[4]);
+    Tcl_PrintDouble(NULL, matrixPtr->ty, buf[5]);
+    sprintf(str, "{%s %s} {%s %s} {%s %s}",
+	    buf[0], buf[1], buf[2], buf[3], buf[4], buf[5]);
+    len = strlen(str);
+    objPtr->bytes = ckalloc((unsigned) len + 1);
+    memcpy(objPtr->bytes, str, len + 1);
+    objPtr->length = (Tcl_Size) len;
+}
+
+static int
+SetTMatrixFromAny(Tcl_Interp *interp, Tcl_Obj *objPtr)
+{
+    Tcl_Obj **objv, **rowObjv;
+    Tcl_Size objc, rowObjc;
+    const Tcl_ObjType *typePtr;
+    double tmp[3][2];
+    TMatrix *matrixPtr;
+    int i, j;
+
+    /* Check matrix consistency. */
+    if (Tcl_ListObjGetElements(interp, objPtr, &objc, &objv) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (objc != 3) {
+        goto inconsistent;
+    }
+
+    /* Take each row in turn. */
+    for (i = 0; i < 3; i++) {
+        if (Tcl_ListObjGetElements(interp, objv[i], &rowObjc,
+                &rowObjv) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        if (rowObjc != 2) {
+            goto inconsistent;
+        }
+        for (j = 0; j < 2; j++) {
+            if (Tcl_GetDoubleFromObj(interp, rowObjv[j],
+                    &(tmp[i][j])) != TCL_OK) {
+                goto inconsistent;
+            }
+        }
+    }
+    matrixPtr = (TMatrix *) ckalloc(sizeof(TMatrix));
+    matrixPtr->a  = tmp[0][0];
+    matrixPtr->b  = tmp[0][1];
+    matrixPtr->c  = tmp[1][0];
+    matrixPtr->d  = tmp[1][1];
+    matrixPtr->tx = tmp[2][0];
+    matrixPtr->ty = tmp[2][1];
+
+    /*
+     * The list rep may be the only one, so make sure we have the string
+     * before it is dropped.
+     */
+    (void) Tcl_GetString(objPtr);
+    typePtr = objPtr->typePtr;
+    if ((typePtr != NULL) && (typePtr->freeIntRepProc != NULL)) {
+        typePtr->freeIntRepProc(objPtr);
+    }
+    objPtr->internalRep.twoPtrValue.ptr1 = (void *) matrixPtr;
+    objPtr->internalRep.twoPtrValue.ptr2 = NULL;
+    objPtr->typePtr = &tkPathMatrixObjType;
+    return TCL_OK;
+
+inconsistent:
+    if (interp != NULL) {
+        Tcl_ResetResult(interp);
+        Tcl_AppendResult(interp, "matrix \"", Tcl_GetString(objPtr),
+                "\" is inconsistent", (char *) NULL);
+    }
+    return TCL_ERROR;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * PathGetTMatrixFromObj --
+ *
+ *	Gets the TMatrix from a Tcl list {{a b} {c d} {tx ty}},
+ *	converting the object to the matrix object type so that
+ *	the next call need not parse it.
+ *
+ * Results:
+ *	Standard Tcl result
+ *
+ * Side effects:
+ *	The internal representation of objPtr may change.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+PathGetTMatrixFromObj(
+        Tcl_Interp* interp,
+        Tcl_Obj *objPtr,	/* Object containg the lists for the matrix. */
+        TMatrix *matrixPtr)	/* Where to store TMatrix corresponding
+                                 * to objPtr. Must be allocated! */
+{
+    if (objPtr->typePtr != &tkPathMatrixObjType) {
+        if (SetTMatrixFromAny(interp, objPtr) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    *matrixPtr = *ObjTMatrix(objPtr);
+    return TCL_OK;
+}
+
 /*
  *----------------------------------------------------------------------
  *
  * PathGetTMatrix --
  *
- *	Parses a Tcl list (in string) into a TMatrix record.
+ *	Gets a TMatrix for a -matrix option. Like PathGetTMatrixFromObj
+ *	but also rejects matrices which are close to singular.
  *
  * Results:
  *	Standard Tcl result
@@ -796,79 +961,294 @@ MMulTMatrix(TMatrix *m1, TMatrix *m2)
 int
 PathGetTMatrix(
         Tcl_Interp* interp,
-        const char *list, 	/* Object containg the lists for the matrix. */
+        Tcl_Obj *objPtr, 	/* Object containg the lists for the matrix. */
         TMatrix *matrixPtr)	/* Where to store TMatrix corresponding
-                                 * to list. Must be allocated! */
+                                 * to objPtr. Must be allocated! */
 {
-    const char **argv = NULL;
-    const char **rowArgv = NULL;
-    Tcl_Size argc, rowArgc;
-    int i, j;
-    int result = TCL_OK;
-    double tmp[3][2];
+    if (PathGetTMatrixFromObj(interp, objPtr, matrixPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
 
-    /* Check matrix consistency. */
-    if (Tcl_SplitList(interp, list, &argc, &argv) != TCL_OK) {
-        result = TCL_ERROR;
-        goto bail;
+    /* Check that the matrix is not close to being singular. */
+    if (fabs(matrixPtr->a*matrixPtr->d - matrixPtr->b*matrixPtr->c) < 1e-6) {
+        Tcl_AppendResult(interp, "matrix \"", Tcl_GetString(objPtr),
+                "\" is close to singular", (char *) NULL);
+        return TCL_ERROR;
     }
-    if (argc != 3) {
-        Tcl_AppendResult(interp, "matrix \"", list, "\" is inconsistent",
-                (char *) NULL);
-        result = TCL_ERROR;
-        goto bail;
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * PathNewTMatrixObj --
+ *
+ *	Creates a matrix object. Its string is only generated if
+ *	somebody asks for it.
+ *
+ * Results:
+ *	A new object with refcount 0.
+ *
+ * Side effects:
+ *	Memory allocated.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tcl_Obj *
+PathNewTMatrixObj(TMatrix *matrixPtr)
+{
+    Tcl_Obj *objPtr = Tcl_NewObj();
+    TMatrix *newPtr = (TMatrix *) ckalloc(sizeof(TMatrix));
+
+    *newPtr = *matrixPtr;
+    Tcl_InvalidateStringRep(objPtr);
+    objPtr->internalRep.twoPtrValue.ptr1 = (void *) newPtr;
+    objPtr->internalRep.twoPtrValue.ptr2 = NULL;
+    objPtr->typePtr = &tkPathMatrixObjType;
+    return objPtr;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * The ::tkp::matrix commands --
+ *
+ *	Each returns a transformation matrix as a matrix object.
+ *	Angles are in radians or, with a "d" suffix, in degrees.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+MatrixGetAngle(Tcl_Interp *interp, Tcl_Obj *objPtr, double *anglePtr)
+{
+    Tcl_Size len;
+    const char *str = Tcl_GetStringFromObj(objPtr, &len);
+
+    if ((len > 1) && (str[len-1] == 'd')) {
+        Tcl_DString ds;
+        int result;
+
+        Tcl_DStringInit(&ds);
+        Tcl_DStringAppend(&ds, str, len-1);
+        result = Tcl_GetDouble(interp, Tcl_DStringValue(&ds), anglePtr);
+        Tcl_DStringFree(&ds);
+        *anglePtr *= DEGREES_TO_RADIANS;
+        return result;
     }
+    return Tcl_GetDoubleFromObj(interp, objPtr, anglePtr);
+}
 
-    /* Take each row in turn. */
-    for (i = 0; i < 3; i++) {
-        if (Tcl_SplitList(interp, argv[i], &rowArgc, &rowArgv) != TCL_OK) {
-            result = TCL_ERROR;
-            goto bail;
-        }
-        if (rowArgc != 2) {
-            Tcl_AppendResult(interp, "matrix \"", list, "\" is inconsistent",
-                    (char *) NULL);
-            result = TCL_ERROR;
-            goto bail;
-        }
-        for (j = 0; j < 2; j++) {
-            if (Tcl_GetDouble(interp, rowArgv[j], &(tmp[i][j])) != TCL_OK) {
-                Tcl_AppendResult(interp, "matrix \"", list, "\" is inconsistent",
-                        (char *) NULL);
-                result = TCL_ERROR;
-                goto bail;
+/*
+ * Parses the arguments from objv[1] on into argv, the first with
+ * MatrixGetAngle if hasAngle, and leaves the defaults for missing ones.
+ */
+
+static int
+MatrixGetArgs(Tcl_Interp *interp, int objc, Tcl_Obj *const objv[],
+	int minArgs, int maxArgs, const char *usage, int hasAngle,
+	double argv[])
+{
+    int i;
+
+    if ((objc < minArgs + 1) || (objc > maxArgs + 1)) {
+        Tcl_WrongNumArgs(interp, 1, objv, usage);
+        return TCL_ERROR;
+    }
+    for (i = 1; i < objc; i++) {
+        if ((i == 1) && hasAngle) {
+            if (MatrixGetAngle(interp, objv[i], &argv[0]) != TCL_OK) {
+                return TCL_ERROR;
             }
-        }
-        if (rowArgv != NULL) {
-            Tcl_Free((char *) rowArgv);
-            rowArgv = NULL;
+        } else if (Tcl_GetDoubleFromObj(interp, objv[i],
+                &argv[i-1]) != TCL_OK) {
+            return TCL_ERROR;
         }
     }
+    return TCL_OK;
+}
 
-    /* Check that the matrix is not close to being singular. */
-    if (fabs(tmp[0][0]*tmp[1][1] - tmp[0][1]*tmp[1][0]) < 1e-6) {
-        Tcl_AppendResult(interp, "matrix \"", list, "\" is close to singular",
-                (char *) NULL);
-            result = TCL_ERROR;
-            goto bail;
+static int
+MatrixSetResult(Tcl_Interp *interp, double a, double b, double c, double d,
+	double tx, double ty)
+{
+    TMatrix m;
+
+    m.a = a, m.b = b, m.c = c, m.d = d, m.tx = tx, m.ty = ty;
+    Tcl_SetObjResult(interp, PathNewTMatrixObj(&m));
+    return TCL_OK;
+}
+
+static int
+MatrixRotateCmd(ClientData clientData, Tcl_Interp *interp,
+	int objc, Tcl_Obj *const objv[])
+{
+    double argv[3] = {0.0, 0.0, 0.0};
+    double c, s, cx, cy;
+
+    if (MatrixGetArgs(interp, objc, objv, 1, 3, "angle ?cx? ?cy?", 1,
+	    argv) != TCL_OK) {
+        return TCL_ERROR;
     }
+    c = cos(argv[0]), s = sin(argv[0]);
+    cx = argv[1], cy = argv[2];
+    return MatrixSetResult(interp, c, s, -s, c,
+	    cx - c*cx + s*cy, cy - s*cx - c*cy);
+}
 
-    /* Matrix. */
-    matrixPtr->a  = tmp[0][0];
-    matrixPtr->b  = tmp[0][1];
-    matrixPtr->c  = tmp[1][0];
-    matrixPtr->d  = tmp[1][1];
-    matrixPtr->tx = tmp[2][0];
-    matrixPtr->ty = tmp[2][1];
+static int
+MatrixScaleCmd(ClientData clientData, Tcl_Interp *interp,
+	int objc, Tcl_Obj *const objv[])
+{
+    double argv[2];
 
-bail:
-    if (argv != NULL) {
-        Tcl_Free((char *) argv);
+    if (MatrixGetArgs(interp, objc, objv, 1, 2, "sx ?sy?", 0,
+	    argv) != TCL_OK) {
+        return TCL_ERROR;
     }
-    if (rowArgv != NULL) {
-        Tcl_Free((char *) rowArgv);
+    if (objc == 2) {
+        argv[1] = argv[0];
+    }
+    return MatrixSetResult(interp, argv[0], 0.0, 0.0, argv[1], 0.0, 0.0);
+}
+
+static int
+MatrixFlipCmd(ClientData clientData, Tcl_Interp *interp,
+	int objc, Tcl_Obj *const objv[])
+{
+    double argv[4] = {0.0, 0.0, 1.0, 1.0};
+    double cx, cy, fx, fy;
+
+    if (MatrixGetArgs(interp, objc, objv, 0, 4, "?cx? ?cy? ?fx? ?fy?", 0,
+	    argv) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    cx = argv[0], cy = argv[1], fx = argv[2], fy = argv[3];
+    return MatrixSetResult(interp, fx, 0.0, 0.0, fy,
+	    cx*(1.0 - fx), cy*(1.0 - fy));
+}
+
+static int
+MatrixRotateflipCmd(ClientData clientData, Tcl_Interp *interp,
+	int objc, Tcl_Obj *const objv[])
+{
+    double argv[5] = {0.0, 0.0, 0.0, 1.0, 1.0};
+    double c, s, cx, cy, fx, fy;
+
+    if (MatrixGetArgs(interp, objc, objv, 0, 5,
+	    "?angle? ?cx? ?cy? ?fx? ?fy?", 1, argv) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    c = cos(argv[0]), s = sin(argv[0]);
+    cx = argv[1], cy = argv[2], fx = argv[3], fy = argv[4];
+    return MatrixSetResult(interp, fx*c, fx*s, -s*fy, c*fy,
+	    c*cx*(1.0 - fx) - s*cy*(1.0 - fy) + cx - c*cx + s*cy,
+	    s*cx*(1.0 - fx) + c*cy*(1.0 - fy) + cy - s*cx - c*cy);
+}
+
+static int
+MatrixSkewxCmd(ClientData clientData, Tcl_Interp *interp,
+	int objc, Tcl_Obj *const objv[])
+{
+    double argv[1];
+
+    if (MatrixGetArgs(interp, objc, objv, 1, 1, "angle", 1,
+	    argv) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    return MatrixSetResult(interp, 1.0, 0.0, tan(argv[0]), 1.0, 0.0, 0.0);
+}
+
+static int
+MatrixSkewyCmd(ClientData clientData, Tcl_Interp *interp,
+	int objc, Tcl_Obj *const objv[])
+{
+    double argv[1];
+
+    if (MatrixGetArgs(interp, objc, objv, 1, 1, "angle", 1,
+	    argv) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    return MatrixSetResult(interp, 1.0, tan(argv[0]), 0.0, 1.0, 0.0, 0.0);
+}
+
+static int
+MatrixMoveCmd(ClientData clientData, Tcl_Interp *interp,
+	int objc, Tcl_Obj *const objv[])
+{
+    double argv[2];
+
+    if (MatrixGetArgs(interp, objc, objv, 2, 2, "dx dy", 0,
+	    argv) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    return MatrixSetResult(interp, 1.0, 0.0, 0.0, 1.0, argv[0], argv[1]);
+}
+
+static int
+MatrixMultCmd(ClientData clientData, Tcl_Interp *interp,
+	int objc, Tcl_Obj *const objv[])
+{
+    TMatrix ma, mb;
+
+    if (objc != 3) {
+        Tcl_WrongNumArgs(interp, 1, objv, "ma mb");
+        return TCL_ERROR;
+    }
+    if ((PathGetTMatrixFromObj(interp, objv[1], &ma) != TCL_OK)
+	    || (PathGetTMatrixFromObj(interp, objv[2], &mb) != TCL_OK)) {
+        return TCL_ERROR;
+    }
+
+    /* mb is applied first, then ma. */
+    MMulTMatrix(&mb, &ma);
+    Tcl_SetObjResult(interp, PathNewTMatrixObj(&ma));
+    return TCL_OK;
+}
+
+static const struct {
+    const char *name;
+    Tcl_ObjCmdProc *proc;
+} matrixCmds[] = {
+    {"::tkp::matrix::flip",		MatrixFlipCmd},
+    {"::tkp::matrix::move",		MatrixMoveCmd},
+    {"::tkp::matrix::mult",		MatrixMultCmd},
+    {"::tkp::matrix::rotate",		MatrixRotateCmd},
+    {"::tkp::matrix::rotateflip",	MatrixRotateflipCmd},
+    {"::tkp::matrix::scale",		MatrixScaleCmd},
+    {"::tkp::matrix::skewx",		MatrixSkewxCmd},
+    {"::tkp::matrix::skewy",		MatrixSkewyCmd},
+    {NULL, NULL}
+};
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * PathMatrixInit --
+ *
+ *	Creates the ::tkp::matrix commands. The ensemble itself is made
+ *	in tkpath.tcl.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Tcl commands created and the matrix object type registered.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+PathMatrixInit(Tcl_Interp *interp)
+{
+    int i;
+
+    Tcl_RegisterObjType(&tkPathMatrixObjType);
+    for (i = 0; matrixCmds[i].name != NULL; i++) {
+        Tcl_CreateObjCommand(interp, matrixCmds[i].name, matrixCmds[i].proc,
+                (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
     }
-    return result;
 }
 
 /*
@@ -281,7 +281,8 @@ typedef struct Tk_PathItemType {
 				/* Procedure to delete characters from an
 				 * item. */
     struct Tk_PathItemType *nextPtr;/* Used to link types together into a list. */
-    int isPathType;		/* False for original canvas item types. */
+    int isPathType;		/* False for original canvas item types,
+				 * 2 for lightweight path items. */
 } Tk_PathItemType;
 
 #endif
@@ -336,6 +337,9 @@ typedef struct Tk_PathCanvasTextInfo {
 typedef struct Tk_PathDash {
     int number;
     float *array;
+    double *scaled;		/* The array multiplied by scaledWidth, made
+				 * on demand by TkPathDashScaled. */
+    double scaledWidth;		/* Stroke width of scaled. */
 } Tk_PathDash;
 
 /*
@@ -0,0 +1,1557 @@
+/*
+ * tkpCanvPdf.c --
+ *
+ *	This module provides the "pdf" widget command for path canvases.
+ *	It writes a complete single page PDF document in one pass over the
+ *	item tree, either to a channel or as the command result. The per
+ *	item pdfProcs are reused; instead of Tcl command prefixes they get
+ *	the writer of the document as their resource callbacks, which the
+ *	resource functions below serve in C. Every resource object is
+ *	emitted immediately, and identical ones only once.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#include "tkIntPath.h"
+#include "tkpCanvas.h"
+
+MODULE_SCOPE int gCanZlib;
+
+#define ZLIB_SUPPORT						\
+    ((TCL_MAJOR_VERSION > 8) ||					\
+     ((TCL_MAJOR_VERSION == 8) && (TCL_MINOR_VERSION >= 6)))
+
+/*
+ * Content streams are flushed as separate stream objects whenever a
+ * resource object must be written, or when they grow beyond this size.
+ * The page refers to all of them in its /Contents array. Transparency
+ * groups are written in forms of at most about this size likewise.
+ */
+
+#define PDF_CONTENT_CHUNK 65536
+
+/*
+ * Object numbers reserved for the document skeleton, which is written
+ * last since it refers to everything else.
+ */
+
+#define PDF_OBJ_CATALOG	1
+#define PDF_OBJ_PAGES	2
+#define PDF_OBJ_PAGE	3
+#define PDF_OBJ_RESOURCES 4
+#define PDF_OBJ_FIRST	5
+
+/*
+ * A group drawn as a transparency group collects the content of its
+ * descendants in one of the following. Whenever that grows too large it
+ * is written as a plain form XObject; the transparency group then draws
+ * these forms in turn.
+ */
+
+typedef struct PdfGroup {
+    Tk_PathItem *itemPtr;	/* The group. */
+    Tcl_DString content;	/* Content not yet written as a form. */
+    Tcl_DString forms;		/* Draws the forms written so far. */
+    struct PdfGroup *parentPtr;	/* Enclosing transparency group, or NULL
+				 * for the page. */
+} PdfGroup;
+
+/*
+ * One of the following structures is created to keep track of PDF output
+ * being generated.
+ */
+
+typedef struct TkPathPdfContext {
+    TkPathCanvas *canvasPtr;	/* Canvas being written. */
+    Tcl_Obj *writerObj;		/* Passed to the pdfProcs as each of their
+				 * callbacks. */
+    int x, y, width, height;	/* Area to print, in canvas pixel
+				 * coordinates. One pixel maps to one
+				 * point. */
+    int compress;		/* Non-zero means Flate-compress content
+				 * streams. */
+    char *fileName;		/* Name of file in which to write PDF; NULL
+				 * means return PDF as result. Malloc'ed. */
+    char *channelName;		/* If -channel is specified, the name of the
+				 * channel to use. */
+    Tcl_Channel chan;		/* Open channel corresponding to fileName or
+				 * channelName. */
+    Tcl_DString output;		/* Collects the document when there is no
+				 * channel. */
+    Tcl_WideInt offset;		/* Number of bytes written so far. */
+    int writeError;		/* Non-zero once writing to chan failed. */
+    Tcl_WideInt *xref;		/* File offset of each object, indexed by
+				 * object number. */
+    int numObjs;		/* Highest object number allocated. */
+    int maxObjs;		/* Allocated size of xref. */
+    Tcl_HashTable objTable;	/* Maps the text of every dictionary written
+				 * so far to its object number. */
+    Tcl_HashTable resourceTable;/* Maps TkPathPdfKeys of images and
+				 * gradients to TkPathPdfResources. */
+    Tcl_HashTable fontTable;	/* Maps base font names to object numbers. */
+    Tcl_HashTable resTable;	/* Resource names already listed in one of
+				 * the dictionaries below. */
+    Tcl_DString extGState;	/* Entries of the /ExtGState dictionary. */
+    Tcl_DString shading;	/* Entries of the /Shading dictionary. */
+    Tcl_DString xObject;	/* Entries of the /XObject dictionary. */
+    Tcl_DString font;		/* Entries of the /Font dictionary. */
+    Tcl_DString content;	/* Content not yet flushed to a stream. */
+    PdfGroup *groupPtr;		/* Transparency group being drawn, or NULL
+				 * when items draw into the page. */
+    Tcl_DString contents;	/* References to all content streams. */
+    Tcl_Encoding encoding;	/* WinAnsi (cp1252) encoding for text. */
+} TkPdfInfo;
+
+/*
+ * The writer object handed to the pdfProcs. Its internal representation
+ * points to the TkPdfInfo; it lives only while the document is written.
+ */
+
+static void		DupPdfWriterInternalRep(Tcl_Obj *srcPtr,
+			    Tcl_Obj *copyPtr);
+
+static const Tcl_ObjType pdfWriterObjType = {
+    "pdfwriter",			/* name */
+    NULL,				/* freeIntRepProc */
+    DupPdfWriterInternalRep,		/* dupIntRepProc */
+    NULL,				/* updateStringProc */
+    NULL				/* setFromAnyProc */
+};
+
+/*
+ * The table below provides a template that's used to process arguments to the
+ * canvas "pdf" command and fill in TkPdfInfo structures.
+ */
+
+static Tk_OptionSpec optionSpecs[] = {
+    {TK_OPTION_STRING, "-channel", NULL, NULL,
+	NULL, -1, offsetof(TkPdfInfo, channelName),
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_BOOLEAN, "-compress", NULL, NULL,
+	NULL, -1, offsetof(TkPdfInfo, compress),
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_STRING, "-file", NULL, NULL,
+	NULL, -1, offsetof(TkPdfInfo, fileName),
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_PIXELS, "-height", NULL, NULL,
+	NULL, -1, offsetof(TkPdfInfo, height),
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_PIXELS, "-width", NULL, NULL,
+	NULL, -1, offsetof(TkPdfInfo, width),
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_PIXELS, "-x", NULL, NULL,
+	NULL, -1, offsetof(TkPdfInfo, x),
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_PIXELS, "-y", NULL, NULL,
+	NULL, -1, offsetof(TkPdfInfo, y),
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_END, NULL, NULL, NULL,
+	NULL, 0, -1, 0, (ClientData) NULL, 0}
+};
+
+/*
+ * Forward declarations for functions defined later in this file:
+ */
+
+static void		PdfWrite(TkPdfInfo *pdfPtr, const char *bytes,
+			    Tcl_Size len);
+static int		PdfNewObj(TkPdfInfo *pdfPtr);
+static void		PdfBeginObj(TkPdfInfo *pdfPtr, int id);
+static int		PdfWriteStream(Tcl_Interp *interp,
+			    TkPdfInfo *pdfPtr, const char *dict,
+			    Tcl_DString *dataPtr, long *idPtr);
+static int		PdfFlushContent(Tcl_Interp *interp,
+			    TkPdfInfo *pdfPtr);
+static int		PdfFlushGroup(Tcl_Interp *interp,
+			    TkPdfInfo *pdfPtr);
+static int		PdfCheckContent(Tcl_Interp *interp,
+			    TkPdfInfo *pdfPtr);
+static int		PdfWriteObj(Tcl_Interp *interp, TkPdfInfo *pdfPtr,
+			    Tcl_Obj *objPtr, int share, long *idPtr);
+static Tcl_Obj *	PdfAddResource(TkPdfInfo *pdfPtr,
+			    Tcl_DString *dictPtr, const char *prefix,
+			    long id);
+static int		PdfGetFont(Tcl_Interp *interp, TkPdfInfo *pdfPtr,
+			    Tk_PathItem *itemPtr, Tcl_Obj **namePtrPtr);
+static int		PdfItem(Tcl_Interp *interp, TkPdfInfo *pdfPtr,
+			    Tk_PathItem *itemPtr);
+static int		PdfEvalCallback(Tcl_Interp *interp,
+			    Tcl_Obj *prefixObj, int objc,
+			    Tcl_Obj *const objv[]);
+static int		PdfCallbackResult(Tcl_Interp *interp, long *idPtr,
+			    Tcl_Obj **namePtrPtr);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkpCanvPdfCmd --
+ *
+ *	This function is invoked to process the "pdf" options of the widget
+ *	command for canvas widgets. See the user documentation for details
+ *	on what it does.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	See the user documentation.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkpCanvPdfCmd(
+    TkPathCanvas *canvasPtr,	/* Information about canvas widget. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument strings. Caller has already parsed
+				 * this command enough to know that argv[1] is
+				 * "pdf". */
+{
+    TkPdfInfo pdfInfo;
+    Tk_PathItem *itemPtr;
+    Tk_Window tkwin = canvasPtr->tkwin;
+    Tk_OptionTable optionTable;
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+    Tcl_DString buffer;
+    const char *p;
+    char string[200];
+    int result = TCL_ERROR, i;
+
+    pdfInfo.canvasPtr = canvasPtr;
+    pdfInfo.x = canvasPtr->xOrigin;
+    pdfInfo.y = canvasPtr->yOrigin;
+    pdfInfo.width = -1;
+    pdfInfo.height = -1;
+    pdfInfo.compress = 0;
+    pdfInfo.fileName = NULL;
+    pdfInfo.channelName = NULL;
+    pdfInfo.chan = NULL;
+    pdfInfo.offset = 0;
+    pdfInfo.writeError = 0;
+    pdfInfo.numObjs = PDF_OBJ_FIRST - 1;
+    pdfInfo.maxObjs = 64;
+    pdfInfo.xref = (Tcl_WideInt *)
+	    ckalloc(pdfInfo.maxObjs * sizeof(Tcl_WideInt));
+    memset(pdfInfo.xref, 0, pdfInfo.maxObjs * sizeof(Tcl_WideInt));
+    Tcl_DStringInit(&pdfInfo.output);
+    Tcl_InitHashTable(&pdfInfo.objTable, TCL_STRING_KEYS);
+    Tcl_InitHashTable(&pdfInfo.resourceTable,
+	    sizeof(TkPathPdfKey) / sizeof(int));
+    Tcl_InitHashTable(&pdfInfo.fontTable, TCL_STRING_KEYS);
+    Tcl_InitHashTable(&pdfInfo.resTable, TCL_STRING_KEYS);
+    Tcl_DStringInit(&pdfInfo.extGState);
+    Tcl_DStringInit(&pdfInfo.shading);
+    Tcl_DStringInit(&pdfInfo.xObject);
+    Tcl_DStringInit(&pdfInfo.font);
+    Tcl_DStringInit(&pdfInfo.content);
+    pdfInfo.groupPtr = NULL;
+    Tcl_DStringInit(&pdfInfo.contents);
+    pdfInfo.encoding = Tcl_GetEncoding(NULL, "cp1252");
+
+    /*
+     * The writer object serves the callbacks of the item pdfProcs.
+     */
+
+    pdfInfo.writerObj = Tcl_NewStringObj("pdfwriter", -1);
+    pdfInfo.writerObj->internalRep.twoPtrValue.ptr1 = (void *) &pdfInfo;
+    pdfInfo.writerObj->internalRep.twoPtrValue.ptr2 = NULL;
+    pdfInfo.writerObj->typePtr = &pdfWriterObjType;
+    Tcl_IncrRefCount(pdfInfo.writerObj);
+
+    optionTable = Tk_CreateOptionTable(interp, optionSpecs);
+    if (Tk_InitOptions(interp, (char *) &pdfInfo, optionTable,
+	    tkwin) != TCL_OK) {
+	goto cleanup;
+    }
+    if (Tk_SetOptions(interp, (char *) &pdfInfo, optionTable,
+	    objc-2, objv+2, tkwin, NULL, NULL) != TCL_OK) {
+	goto cleanup;
+    }
+    if (pdfInfo.width == -1) {
+	pdfInfo.width = Tk_Width(tkwin);
+    }
+    if (pdfInfo.height == -1) {
+	pdfInfo.height = Tk_Height(tkwin);
+    }
+
+    if (pdfInfo.fileName != NULL) {
+	if (pdfInfo.channelName != NULL) {
+	    Tcl_AppendResult(interp, "can't specify both -file",
+		    " and -channel", NULL);
+	    goto cleanup;
+	}
+	if (Tcl_IsSafe(interp)) {
+	    Tcl_AppendResult(interp, "can't specify -file in a",
+		    " safe interpreter", NULL);
+	    goto cleanup;
+	}
+	p = Tcl_TranslateFileName(interp, pdfInfo.fileName, &buffer);
+	if (p == NULL) {
+	    goto cleanup;
+	}
+	pdfInfo.chan = Tcl_OpenFileChannel(interp, p, "w", 0666);
+	Tcl_DStringFree(&buffer);
+	if (pdfInfo.chan == NULL) {
+	    goto cleanup;
+	}
+	if (Tcl_SetChannelOption(interp, pdfInfo.chan, "-translation",
+		"binary") != TCL_OK) {
+	    goto cleanup;
+	}
+    }
+    if (pdfInfo.channelName != NULL) {
+	int mode;
+
+	/*
+	 * The channel is written as is; it should have been configured
+	 * with -translation binary by the caller.
+	 */
+
+	pdfInfo.chan = Tcl_GetChannel(interp, pdfInfo.channelName, &mode);
+	if (pdfInfo.chan == (Tcl_Channel) NULL) {
+	    goto cleanup;
+	}
+	if ((mode & TCL_WRITABLE) == 0) {
+	    Tcl_AppendResult(interp, "channel \"", pdfInfo.channelName,
+		    "\" wasn't opened for writing", NULL);
+	    goto cleanup;
+	}
+    }
+
+    PdfWrite(&pdfInfo, "%PDF-1.4\n%\342\343\317\323\n", -1);
+
+    /*
+     * Flip the y axis so that the content can be given in canvas
+     * coordinates, which is what all pdfProcs produce.
+     */
+
+    sprintf(string, "1 0 0 -1 %d %d cm\n", -pdfInfo.x,
+	    pdfInfo.height + pdfInfo.y);
+    Tcl_DStringAppend(&pdfInfo.content, string, -1);
+
+    /*
+     * Have each relevant item draw itself into the current content
+     * stream; groups draw their descendants. Quit if any of the items
+     * returns an error.
+     */
+
+    Tcl_ResetResult(interp);
+    for (itemPtr = canvasPtr->rootItemPtr->firstChildPtr; itemPtr != NULL;
+	    itemPtr = itemPtr->nextPtr) {
+	if ((PdfItem(interp, &pdfInfo, itemPtr) != TCL_OK)
+		|| (PdfCheckContent(interp, &pdfInfo) != TCL_OK)) {
+	    goto cleanup;
+	}
+	if (pdfInfo.writeError) {
+	    break;
+	}
+    }
+    if (PdfFlushContent(interp, &pdfInfo) != TCL_OK) {
+	goto cleanup;
+    }
+
+    /*
+     * Output the document skeleton, the cross-reference table and the
+     * trailer. The resources are an object of their own since transparency
+     * groups refer to them too.
+     */
+
+    PdfBeginObj(&pdfInfo, PDF_OBJ_RESOURCES);
+    PdfWrite(&pdfInfo, "<<\n/ProcSet [/PDF /Text /ImageB /ImageC]\n", -1);
+    if (Tcl_DStringLength(&pdfInfo.extGState) > 0) {
+	PdfWrite(&pdfInfo, "/ExtGState <<", -1);
+	PdfWrite(&pdfInfo, Tcl_DStringValue(&pdfInfo.extGState),
+		Tcl_DStringLength(&pdfInfo.extGState));
+	PdfWrite(&pdfInfo, " >>\n", -1);
+    }
+    if (Tcl_DStringLength(&pdfInfo.shading) > 0) {
+	PdfWrite(&pdfInfo, "/Shading <<", -1);
+	PdfWrite(&pdfInfo, Tcl_DStringValue(&pdfInfo.shading),
+		Tcl_DStringLength(&pdfInfo.shading));
+	PdfWrite(&pdfInfo, " >>\n", -1);
+    }
+    if (Tcl_DStringLength(&pdfInfo.xObject) > 0) {
+	PdfWrite(&pdfInfo, "/XObject <<", -1);
+	PdfWrite(&pdfInfo, Tcl_DStringValue(&pdfInfo.xObject),
+		Tcl_DStringLength(&pdfInfo.xObject));
+	PdfWrite(&pdfInfo, " >>\n", -1);
+    }
+    if (Tcl_DStringLength(&pdfInfo.font) > 0) {
+	PdfWrite(&pdfInfo, "/Font <<", -1);
+	PdfWrite(&pdfInfo, Tcl_DStringValue(&pdfInfo.font),
+		Tcl_DStringLength(&pdfInfo.font));
+	PdfWrite(&pdfInfo, " >>\n", -1);
+    }
+    PdfWrite(&pdfInfo, ">>\nendobj\n", -1);
+
+    PdfBeginObj(&pdfInfo, PDF_OBJ_PAGE);
+    sprintf(string, "<<\n/Type /Page\n/Parent %d 0 R\n"
+	    "/MediaBox [0 0 %d %d]\n/Resources %d 0 R\n/Contents [",
+	    PDF_OBJ_PAGES, pdfInfo.width, pdfInfo.height, PDF_OBJ_RESOURCES);
+    PdfWrite(&pdfInfo, string, -1);
+    PdfWrite(&pdfInfo, Tcl_DStringValue(&pdfInfo.contents),
+	    Tcl_DStringLength(&pdfInfo.contents));
+    PdfWrite(&pdfInfo, "]\n>>\nendobj\n", -1);
+
+    PdfBeginObj(&pdfInfo, PDF_OBJ_PAGES);
+    sprintf(string, "<<\n/Type /Pages\n/Kids [%d 0 R]\n/Count 1\n>>\n"
+	    "endobj\n", PDF_OBJ_PAGE);
+    PdfWrite(&pdfInfo, string, -1);
+
+    PdfBeginObj(&pdfInfo, PDF_OBJ_CATALOG);
+    sprintf(string, "<<\n/Type /Catalog\n/Pages %d 0 R\n>>\nendobj\n",
+	    PDF_OBJ_PAGES);
+    PdfWrite(&pdfInfo, string, -1);
+
+    {
+	Tcl_WideInt xrefOffset = pdfInfo.offset;
+
+	sprintf(string, "xref\n0 %d\n0000000000 65535 f \n",
+		pdfInfo.numObjs + 1);
+	PdfWrite(&pdfInfo, string, -1);
+	for (i = 1; i <= pdfInfo.numObjs; i++) {
+	    sprintf(string, "%010" TCL_LL_MODIFIER "d 00000 n \n",
+		    pdfInfo.xref[i]);
+	    PdfWrite(&pdfInfo, string, -1);
+	}
+	sprintf(string, "trailer\n<<\n/Size %d\n/Root %d 0 R\n>>\n"
+		"startxref\n%" TCL_LL_MODIFIER "d\n%%%%EOF\n",
+		pdfInfo.numObjs + 1, PDF_OBJ_CATALOG, xrefOffset);
+	PdfWrite(&pdfInfo, string, -1);
+    }
+    if (pdfInfo.writeError) {
+	Tcl_AppendResult(interp, "error writing \"",
+		Tcl_GetChannelName(pdfInfo.chan), "\": ",
+		Tcl_PosixError(interp), NULL);
+	goto cleanup;
+    }
+    if (pdfInfo.chan == NULL) {
+	Tcl_SetObjResult(interp, Tcl_NewByteArrayObj((unsigned char *)
+		Tcl_DStringValue(&pdfInfo.output),
+		Tcl_DStringLength(&pdfInfo.output)));
+    }
+    result = TCL_OK;
+
+    /*
+     * Clean up pdfInfo to release malloc'ed stuff. The writer object may
+     * still be referenced, so it must forget pdfInfo.
+     */
+
+  cleanup:
+    pdfInfo.writerObj->internalRep.twoPtrValue.ptr1 = NULL;
+    Tcl_DecrRefCount(pdfInfo.writerObj);
+    if ((pdfInfo.chan != NULL) && (pdfInfo.channelName == NULL)) {
+	Tcl_Close(interp, pdfInfo.chan);
+    }
+    for (hPtr = Tcl_FirstHashEntry(&pdfInfo.resourceTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	TkPathPdfResource *resPtr =
+		(TkPathPdfResource *) Tcl_GetHashValue(hPtr);
+
+	if (resPtr->nameObj != NULL) {
+	    Tcl_DecrRefCount(resPtr->nameObj);
+	}
+	ckfree((char *) resPtr);
+    }
+    Tcl_DeleteHashTable(&pdfInfo.resourceTable);
+    Tcl_DeleteHashTable(&pdfInfo.objTable);
+    Tcl_DeleteHashTable(&pdfInfo.fontTable);
+    Tcl_DeleteHashTable(&pdfInfo.resTable);
+    Tcl_DStringFree(&pdfInfo.output);
+    Tcl_DStringFree(&pdfInfo.extGState);
+    Tcl_DStringFree(&pdfInfo.shading);
+    Tcl_DStringFree(&pdfInfo.xObject);
+    Tcl_DStringFree(&pdfInfo.font);
+    Tcl_DStringFree(&pdfInfo.content);
+    Tcl_DStringFree(&pdfInfo.contents);
+    if (pdfInfo.encoding != NULL) {
+	Tcl_FreeEncoding(pdfInfo.encoding);
+    }
+    ckfree((char *) pdfInfo.xref);
+    Tk_FreeConfigOptions((char *) &pdfInfo, optionTable, tkwin);
+    return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * DupPdfWriterInternalRep --
+ *
+ *	Copies the writer reference of a writer object.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	copyPtr refers to the same document as srcPtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+DupPdfWriterInternalRep(
+    Tcl_Obj *srcPtr,
+    Tcl_Obj *copyPtr)
+{
+    copyPtr->internalRep.twoPtrValue.ptr1 =
+	    srcPtr->internalRep.twoPtrValue.ptr1;
+    copyPtr->internalRep.twoPtrValue.ptr2 = NULL;
+    copyPtr->typePtr = &pdfWriterObjType;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PdfItem --
+ *
+ *	Has an item draw itself, appending its content to the page or to
+ *	the transparency group being drawn.
+ *	Items outside the area, hidden ones, also by the state they inherit
+ *	from their groups, and ones without a pdfProc are skipped. Groups
+ *	are always asked, since their descendants may set their own state.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Resource objects may be written.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PdfItem(
+    Tcl_Interp *interp,
+    TkPdfInfo *pdfPtr,
+    Tk_PathItem *itemPtr)
+{
+    Tk_PathCanvas canvas = (Tk_PathCanvas) pdfPtr->canvasPtr;
+    Tcl_DString *contentPtr;
+    Tcl_Obj *argv[3];
+    Tcl_Obj *fontName = NULL;
+    Tcl_Size argc, len;
+    const char *p;
+    char string[64];
+    int result;
+
+    if (itemPtr->firstChildPtr != NULL) {
+	TkPathCanvasUpdateGroupBbox(canvas, itemPtr);
+    }
+    if ((itemPtr->x1 >= pdfPtr->x + pdfPtr->width)
+	    || (itemPtr->x2 < pdfPtr->x)
+	    || (itemPtr->y1 >= pdfPtr->y + pdfPtr->height)
+	    || (itemPtr->y2 < pdfPtr->y)) {
+	return TCL_OK;
+    }
+    if (itemPtr->typePtr->pdfProc == NULL) {
+	return TCL_OK;
+    }
+    if ((strcmp(itemPtr->typePtr->name, "group") != 0) &&
+	    (TkPathCanvasItemState(canvas, itemPtr) == TK_PATHSTATE_HIDDEN)) {
+	return TCL_OK;
+    }
+
+    /*
+     * The callbacks differ between item types; see the pdfProcs.
+     */
+
+    argv[0] = argv[1] = argv[2] = pdfPtr->writerObj;
+    if (strcmp(itemPtr->typePtr->name, "pimage") == 0) {
+	argc = 1;
+    } else if (strcmp(itemPtr->typePtr->name, "ptext") == 0) {
+	if (PdfGetFont(interp, pdfPtr, itemPtr, &fontName) != TCL_OK) {
+	    goto error;
+	}
+	argv[2] = fontName;
+	argc = 3;
+    } else {
+	argc = 3;
+    }
+    result = (*itemPtr->typePtr->pdfProc)(interp, canvas, itemPtr,
+	    argc, argv, 0);
+    if (fontName != NULL) {
+	Tcl_DecrRefCount(fontName);
+    }
+    if (result != TCL_OK) {
+	goto error;
+    }
+    contentPtr = (pdfPtr->groupPtr != NULL)
+	    ? &pdfPtr->groupPtr->content : &pdfPtr->content;
+    p = Tcl_GetStringFromObj(Tcl_GetObjResult(interp), &len);
+    if (len > 0) {
+	Tcl_DStringAppend(contentPtr, "q\n", 2);
+	Tcl_DStringAppend(contentPtr, p, len);
+	Tcl_DStringAppend(contentPtr, "Q\n", 2);
+    }
+    Tcl_ResetResult(interp);
+    return TCL_OK;
+
+  error:
+    sprintf(string, "\n    (generating PDF for item %d)", itemPtr->id);
+    Tcl_AddErrorInfo(interp, string);
+    return TCL_ERROR;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathPdfGroup --
+ *
+ *	Draws the children of a group for the pdfProc of the group. At
+ *	full opacity they draw straight into the content of the page or the
+ *	enclosing transparency group. Below that they are drawn as a
+ *	transparency group, so that the opacity applies to them as a whole
+ *	like with the layer the group is drawn from on screen. The content
+ *	is written out in chunks either way, never held as a whole.
+ *
+ * Results:
+ *	A standard Tcl result. The content drawing the transparency group,
+ *	if any, is left in the interp's result.
+ *
+ * Side effects:
+ *	Content and resource objects may be written.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathPdfGroup(
+    Tcl_Interp *interp,
+    TkPathPdfContext *contextPtr,
+    Tk_PathItem *itemPtr,	/* The group. */
+    double opacity)
+{
+    TkPdfInfo *pdfPtr = (TkPdfInfo *) contextPtr;
+    Tk_PathItem *childPtr;
+    PdfGroup group;
+    Tcl_DString *contentPtr;
+    Tcl_Obj *gsObj, *formName, *gsName;
+    char buffer[200];
+    long id;
+    int result = TCL_ERROR;
+
+    if ((opacity >= 1.0) ||
+	    (TkPathCanvasItemState((Tk_PathCanvas) pdfPtr->canvasPtr,
+		itemPtr) == TK_PATHSTATE_HIDDEN)) {
+	for (childPtr = itemPtr->firstChildPtr; childPtr != NULL;
+		childPtr = childPtr->nextPtr) {
+	    if ((PdfItem(interp, pdfPtr, childPtr) != TCL_OK)
+		    || (PdfCheckContent(interp, pdfPtr) != TCL_OK)) {
+		return TCL_ERROR;
+	    }
+	    if (pdfPtr->writeError) {
+		break;
+	    }
+	}
+	return TCL_OK;
+    }
+    if (opacity < 0.0) {
+	opacity = 0.0;
+    }
+
+    group.itemPtr = itemPtr;
+    Tcl_DStringInit(&group.content);
+    Tcl_DStringInit(&group.forms);
+    group.parentPtr = pdfPtr->groupPtr;
+    pdfPtr->groupPtr = &group;
+    for (childPtr = itemPtr->firstChildPtr; childPtr != NULL;
+	    childPtr = childPtr->nextPtr) {
+	if ((PdfItem(interp, pdfPtr, childPtr) != TCL_OK)
+		|| (PdfCheckContent(interp, pdfPtr) != TCL_OK)) {
+	    goto done;
+	}
+	if (pdfPtr->writeError) {
+	    break;
+	}
+    }
+
+    /*
+     * Unless it was written in chunks, the content goes into the
+     * transparency group itself.
+     */
+
+    if (Tcl_DStringLength(&group.forms) > 0) {
+	if (PdfFlushGroup(interp, pdfPtr) != TCL_OK) {
+	    goto done;
+	}
+	contentPtr = &group.forms;
+    } else {
+	contentPtr = &group.content;
+    }
+    if (Tcl_DStringLength(contentPtr) == 0) {
+	result = TCL_OK;
+	goto done;
+    }
+    sprintf(buffer, "/Type /XObject\n/Subtype /Form\n"
+	    "/BBox [%d %d %d %d]\n/Group << /S /Transparency /I true >>\n"
+	    "/Resources %d 0 R\n",
+	    itemPtr->x1, itemPtr->y1, itemPtr->x2, itemPtr->y2,
+	    PDF_OBJ_RESOURCES);
+    if (PdfWriteStream(interp, pdfPtr, buffer, contentPtr, &id) != TCL_OK) {
+	goto done;
+    }
+    formName = PdfAddResource(pdfPtr, &pdfPtr->xObject, "Fm", id);
+
+    gsObj = Tcl_NewStringObj("<<\n/Type /ExtGState\n/CA ", -1);
+    TkPathPdfNumber(gsObj, 3, opacity, "\n/ca ");
+    TkPathPdfNumber(gsObj, 3, opacity, "\n>>");
+    Tcl_IncrRefCount(gsObj);
+    if (PdfWriteObj(interp, pdfPtr, gsObj, 1, &id) != TCL_OK) {
+	Tcl_DecrRefCount(gsObj);
+	Tcl_DecrRefCount(formName);
+	goto done;
+    }
+    Tcl_DecrRefCount(gsObj);
+    gsName = PdfAddResource(pdfPtr, &pdfPtr->extGState, "GS", id);
+    Tcl_SetObjResult(interp, Tcl_ObjPrintf("/%s gs\n/%s Do\n",
+	    Tcl_GetString(gsName), Tcl_GetString(formName)));
+    Tcl_DecrRefCount(gsName);
+    Tcl_DecrRefCount(formName);
+    result = TCL_OK;
+
+  done:
+    pdfPtr->groupPtr = group.parentPtr;
+    Tcl_DStringFree(&group.content);
+    Tcl_DStringFree(&group.forms);
+    return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PdfWrite --
+ *
+ *	Appends bytes to the document, either by writing them to the
+ *	output channel or by collecting them for the command result.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Advances the current file offset. A failed channel write is
+ *	remembered and reported when the document is complete.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+PdfWrite(
+    TkPdfInfo *pdfPtr,
+    const char *bytes,
+    Tcl_Size len)
+{
+    if (len < 0) {
+	len = strlen(bytes);
+    }
+    if (pdfPtr->chan != NULL) {
+	if (!pdfPtr->writeError &&
+		(Tcl_Write(pdfPtr->chan, bytes, len) < 0)) {
+	    pdfPtr->writeError = 1;
+	}
+    } else {
+	Tcl_DStringAppend(&pdfPtr->output, bytes, len);
+    }
+    pdfPtr->offset += len;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PdfNewObj, PdfBeginObj --
+ *
+ *	Allocate a new object number and start writing an object,
+ *	recording its offset for the cross-reference table.
+ *
+ * Results:
+ *	PdfNewObj returns the new object number.
+ *
+ * Side effects:
+ *	The cross-reference table may grow.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PdfNewObj(
+    TkPdfInfo *pdfPtr)
+{
+    pdfPtr->numObjs++;
+    if (pdfPtr->numObjs >= pdfPtr->maxObjs) {
+	pdfPtr->maxObjs *= 2;
+	pdfPtr->xref = (Tcl_WideInt *) ckrealloc((char *) pdfPtr->xref,
+		pdfPtr->maxObjs * sizeof(Tcl_WideInt));
+    }
+    pdfPtr->xref[pdfPtr->numObjs] = 0;
+    return pdfPtr->numObjs;
+}
+
+static void
+PdfBeginObj(
+    TkPdfInfo *pdfPtr,
+    int id)
+{
+    char buffer[TCL_INTEGER_SPACE + 10];
+
+    pdfPtr->xref[id] = pdfPtr->offset;
+    sprintf(buffer, "%d 0 obj\n", id);
+    PdfWrite(pdfPtr, buffer, -1);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PdfWriteStream --
+ *
+ *	Writes a stream object holding the bytes of dataPtr, compressed if
+ *	requested and available. The dictionary of the stream starts with
+ *	the entries in dict.
+ *
+ * Results:
+ *	A standard Tcl result. The object number is stored in *idPtr.
+ *
+ * Side effects:
+ *	dataPtr is emptied.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PdfWriteStream(
+    Tcl_Interp *interp,
+    TkPdfInfo *pdfPtr,
+    const char *dict,
+    Tcl_DString *dataPtr,
+    long *idPtr)
+{
+    Tcl_Obj *dataObj = NULL;
+    const char *data;
+    Tcl_Size len;
+    char buffer[100];
+    int id;
+
+    len = Tcl_DStringLength(dataPtr);
+    data = Tcl_DStringValue(dataPtr);
+#if ZLIB_SUPPORT
+    if (pdfPtr->compress && gCanZlib) {
+	Tcl_Obj *rawObj = Tcl_NewByteArrayObj((unsigned char *) data, len);
+	Tcl_Obj *saveObj = Tcl_GetObjResult(interp);
+
+	Tcl_IncrRefCount(saveObj);
+	Tcl_IncrRefCount(rawObj);
+	if (Tcl_ZlibDeflate(interp, TCL_ZLIB_FORMAT_ZLIB, rawObj,
+		9, NULL) != TCL_OK) {
+	    Tcl_DecrRefCount(rawObj);
+	    Tcl_DecrRefCount(saveObj);
+	    return TCL_ERROR;
+	}
+	Tcl_DecrRefCount(rawObj);
+	dataObj = Tcl_GetObjResult(interp);
+	Tcl_IncrRefCount(dataObj);
+	Tcl_SetObjResult(interp, saveObj);
+	Tcl_DecrRefCount(saveObj);
+	data = (const char *) Tcl_GetByteArrayFromObj(dataObj, &len);
+    }
+#endif
+    id = PdfNewObj(pdfPtr);
+    PdfBeginObj(pdfPtr, id);
+    PdfWrite(pdfPtr, "<<\n", 3);
+    PdfWrite(pdfPtr, dict, -1);
+    sprintf(buffer, "/Length %ld\n%s>>\nstream\n", (long) len,
+	    (dataObj != NULL) ? "/Filter /FlateDecode\n" : "");
+    PdfWrite(pdfPtr, buffer, -1);
+    PdfWrite(pdfPtr, data, len);
+    PdfWrite(pdfPtr, "\nendstream\nendobj\n", -1);
+    if (dataObj != NULL) {
+	Tcl_DecrRefCount(dataObj);
+    }
+    Tcl_DStringSetLength(dataPtr, 0);
+    *idPtr = id;
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PdfFlushContent, PdfFlushGroup --
+ *
+ *	PdfFlushContent writes the pending page content as a stream object
+ *	of its own. PdfFlushGroup writes the pending content of the
+ *	transparency group being drawn as a form XObject.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	The pending content is emptied. The stream is added to the page's
+ *	/Contents array, or the form to the ones the group draws.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PdfFlushContent(
+    Tcl_Interp *interp,
+    TkPdfInfo *pdfPtr)
+{
+    char buffer[TCL_INTEGER_SPACE + 10];
+    long id;
+
+    if (Tcl_DStringLength(&pdfPtr->content) == 0) {
+	return TCL_OK;
+    }
+    if (PdfWriteStream(interp, pdfPtr, "", &pdfPtr->content,
+	    &id) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    sprintf(buffer, "%ld 0 R ", id);
+    Tcl_DStringAppend(&pdfPtr->contents, buffer, -1);
+    return TCL_OK;
+}
+
+static int
+PdfFlushGroup(
+    Tcl_Interp *interp,
+    TkPdfInfo *pdfPtr)
+{
+    PdfGroup *groupPtr = pdfPtr->groupPtr;
+    Tk_PathItem *itemPtr = groupPtr->itemPtr;
+    Tcl_Obj *formName;
+    char buffer[200];
+    long id;
+
+    if (Tcl_DStringLength(&groupPtr->content) == 0) {
+	return TCL_OK;
+    }
+    sprintf(buffer, "/Type /XObject\n/Subtype /Form\n"
+	    "/BBox [%d %d %d %d]\n/Resources %d 0 R\n",
+	    itemPtr->x1, itemPtr->y1, itemPtr->x2, itemPtr->y2,
+	    PDF_OBJ_RESOURCES);
+    if (PdfWriteStream(interp, pdfPtr, buffer, &groupPtr->content,
+	    &id) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    formName = PdfAddResource(pdfPtr, &pdfPtr->xObject, "Fm", id);
+    Tcl_DStringAppend(&groupPtr->forms, "/", 1);
+    Tcl_DStringAppend(&groupPtr->forms, Tcl_GetString(formName), -1);
+    Tcl_DStringAppend(&groupPtr->forms, " Do\n", 4);
+    Tcl_DecrRefCount(formName);
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PdfCheckContent --
+ *
+ *	Called after each item; writes out the content of the page or of
+ *	the transparency group being drawn once it grows beyond
+ *	PDF_CONTENT_CHUNK.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	See PdfFlushContent and PdfFlushGroup.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PdfCheckContent(
+    Tcl_Interp *interp,
+    TkPdfInfo *pdfPtr)
+{
+    if (pdfPtr->groupPtr == NULL) {
+	if (Tcl_DStringLength(&pdfPtr->content) <= PDF_CONTENT_CHUNK) {
+	    return TCL_OK;
+	}
+	return PdfFlushContent(interp, pdfPtr);
+    }
+    if (Tcl_DStringLength(&pdfPtr->groupPtr->content) <= PDF_CONTENT_CHUNK) {
+	return TCL_OK;
+    }
+    return PdfFlushGroup(interp, pdfPtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PdfWriteObj --
+ *
+ *	Writes an object given by its complete text. Shared objects are
+ *	dictionaries, which are written only once however often they are
+ *	asked for; others, such as image data, are given as byte arrays
+ *	and deduplicated by the caller.
+ *
+ * Results:
+ *	A standard Tcl result. The object number is stored in *idPtr.
+ *
+ * Side effects:
+ *	Pending page content is flushed first, since objects can't be
+ *	nested in a content stream.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PdfWriteObj(
+    Tcl_Interp *interp,
+    TkPdfInfo *pdfPtr,
+    Tcl_Obj *objPtr,
+    int share,
+    long *idPtr)
+{
+    Tcl_HashEntry *hPtr = NULL;
+    const char *bytes;
+    Tcl_Size len;
+    int id, isNew;
+
+    if (share) {
+	bytes = Tcl_GetStringFromObj(objPtr, &len);
+	hPtr = Tcl_CreateHashEntry(&pdfPtr->objTable, bytes, &isNew);
+	if (!isNew) {
+	    *idPtr = PTR2INT(Tcl_GetHashValue(hPtr));
+	    return TCL_OK;
+	}
+    }
+    if (PdfFlushContent(interp, pdfPtr) != TCL_OK) {
+	if (hPtr != NULL) {
+	    Tcl_DeleteHashEntry(hPtr);
+	}
+	return TCL_ERROR;
+    }
+    if (share) {
+	bytes = Tcl_GetStringFromObj(objPtr, &len);
+    } else {
+	bytes = (const char *) Tcl_GetByteArrayFromObj(objPtr, &len);
+    }
+    id = PdfNewObj(pdfPtr);
+    if (hPtr != NULL) {
+	Tcl_SetHashValue(hPtr, INT2PTR(id));
+    }
+    PdfBeginObj(pdfPtr, id);
+    PdfWrite(pdfPtr, bytes, len);
+    PdfWrite(pdfPtr, "\nendobj\n", -1);
+    *idPtr = id;
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PdfAddResource --
+ *
+ *	Names object id as a page resource and lists it in the resource
+ *	dictionary dictPtr unless done before.
+ *
+ * Results:
+ *	The resource name, with its reference count incremented.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static Tcl_Obj *
+PdfAddResource(
+    TkPdfInfo *pdfPtr,
+    Tcl_DString *dictPtr,
+    const char *prefix,
+    long id)
+{
+    Tcl_Obj *nameObj;
+    char name[TCL_INTEGER_SPACE + 10];
+    char buffer[2 * TCL_INTEGER_SPACE + 20];
+    int isNew;
+
+    sprintf(name, "%s%ld", prefix, id);
+    Tcl_CreateHashEntry(&pdfPtr->resTable, name, &isNew);
+    if (isNew) {
+	sprintf(buffer, " /%s %ld 0 R", name, id);
+	Tcl_DStringAppend(dictPtr, buffer, -1);
+    }
+    nameObj = Tcl_NewStringObj(name, -1);
+    Tcl_IncrRefCount(nameObj);
+    return nameObj;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PdfGetFont --
+ *
+ *	Maps the font family of a ptext item to one of the standard Type 1
+ *	fonts and makes sure it is available as a page resource.
+ *
+ * Results:
+ *	A standard Tcl result. The resource name is stored in *namePtrPtr
+ *	with its reference count incremented.
+ *
+ * Side effects:
+ *	A font object may be written.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PdfGetFont(
+    Tcl_Interp *interp,
+    TkPdfInfo *pdfPtr,
+    Tk_PathItem *itemPtr,
+    Tcl_Obj **namePtrPtr)
+{
+    Tcl_Obj *optionObj, *familyObj, *objPtr;
+    Tcl_HashEntry *hPtr;
+    Tcl_DString ds;
+    const char *baseFont = "Helvetica";
+    char *family;
+    long id;
+    int isNew;
+
+    optionObj = Tcl_NewStringObj("-fontfamily", -1);
+    Tcl_IncrRefCount(optionObj);
+    familyObj = Tk_GetOptionValue(interp, (char *) itemPtr,
+	    itemPtr->optionTable, optionObj, pdfPtr->canvasPtr->tkwin);
+    Tcl_DecrRefCount(optionObj);
+    if (familyObj != NULL) {
+	Tcl_DStringInit(&ds);
+	Tcl_DStringAppend(&ds, Tcl_GetString(familyObj), -1);
+	family = Tcl_DStringValue(&ds);
+	Tcl_UtfToLower(family);
+	if ((strstr(family, "courier") != NULL) ||
+		(strstr(family, "mono") != NULL)) {
+	    baseFont = "Courier";
+	} else if ((strstr(family, "times") != NULL) ||
+		((strstr(family, "serif") != NULL) &&
+		 (strstr(family, "sans") == NULL))) {
+	    baseFont = "Times-Roman";
+	}
+	Tcl_DStringFree(&ds);
+	Tcl_DecrRefCount(familyObj);
+    }
+    Tcl_ResetResult(interp);
+    hPtr = Tcl_CreateHashEntry(&pdfPtr->fontTable, baseFont, &isNew);
+    if (isNew) {
+	objPtr = Tcl_ObjPrintf("<<\n/Type /Font\n/Subtype /Type1\n"
+		"/BaseFont /%s\n/Encoding /WinAnsiEncoding\n>>", baseFont);
+	Tcl_IncrRefCount(objPtr);
+	if (PdfWriteObj(interp, pdfPtr, objPtr, 1, &id) != TCL_OK) {
+	    Tcl_DecrRefCount(objPtr);
+	    Tcl_DeleteHashEntry(hPtr);
+	    return TCL_ERROR;
+	}
+	Tcl_DecrRefCount(objPtr);
+	Tcl_SetHashValue(hPtr, INT2PTR(id));
+    } else {
+	id = PTR2INT(Tcl_GetHashValue(hPtr));
+    }
+    *namePtrPtr = PdfAddResource(pdfPtr, &pdfPtr->font, "F", id);
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PdfEvalCallback, PdfCallbackResult --
+ *
+ *	Serve the resource functions below when a pdfProc was given a
+ *	Tcl command prefix instead of the writer: PdfEvalCallback calls
+ *	it with objv appended, PdfCallbackResult parses the {id ?name?}
+ *	list it returns.
+ *
+ * Results:
+ *	A standard Tcl result. The name is returned with its reference
+ *	count incremented.
+ *
+ * Side effects:
+ *	Whatever the callback does. The interp's result is reset after it
+ *	has been parsed.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PdfEvalCallback(
+    Tcl_Interp *interp,
+    Tcl_Obj *prefixObj,
+    int objc,
+    Tcl_Obj *const objv[])
+{
+    Tcl_Obj *cmd;
+    Tcl_Size len;
+    int result;
+
+    cmd = Tcl_DuplicateObj(prefixObj);
+    Tcl_IncrRefCount(cmd);
+    result = Tcl_ListObjLength(interp, cmd, &len);
+    if (result == TCL_OK) {
+	result = Tcl_ListObjReplace(interp, cmd, len, 0, objc, objv);
+    }
+    if (result == TCL_OK) {
+	result = Tcl_EvalObjEx(interp, cmd, TCL_EVAL_DIRECT);
+    }
+    Tcl_DecrRefCount(cmd);
+    return result;
+}
+
+static int
+PdfCallbackResult(
+    Tcl_Interp *interp,
+    long *idPtr,
+    Tcl_Obj **namePtrPtr)
+{
+    Tcl_Obj **retv;
+    Tcl_Size retc;
+
+    if (Tcl_ListObjGetElements(interp, Tcl_GetObjResult(interp),
+	    &retc, &retv) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if ((retc < 1) || ((namePtrPtr != NULL) && (retc < 2))) {
+	Tcl_SetResult(interp, (char *) "missing PDF id/name", TCL_STATIC);
+	return TCL_ERROR;
+    }
+    if (idPtr != NULL) {
+	*idPtr = 0;
+	Tcl_GetLongFromObj(NULL, retv[0], idPtr);
+    }
+    if (namePtrPtr != NULL) {
+	*namePtrPtr = retv[1];
+	Tcl_IncrRefCount(*namePtrPtr);
+    }
+    Tcl_ResetResult(interp);
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathPdfGetContext --
+ *
+ *	Tells whether a callback argument of a pdfProc is the writer of
+ *	the canvas "pdf" command.
+ *
+ * Results:
+ *	The writer, or NULL for a Tcl command prefix.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+TkPathPdfContext *
+TkPathPdfGetContext(
+    Tcl_Obj *callbackObj)
+{
+    if ((callbackObj == NULL) || (callbackObj->typePtr != &pdfWriterObjType)) {
+	return NULL;
+    }
+    return (TkPathPdfContext *) callbackObj->internalRep.twoPtrValue.ptr1;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathPdfAddObj, TkPathPdfAddExtGState, TkPathPdfAddGradient,
+ * TkPathPdfAddImage --
+ *
+ *	Write resources for a pdfProc. TkPathPdfAddObj writes an object
+ *	given by its text and returns its number. The others also name it
+ *	as a page resource: an ExtGState dictionary, which refers to the
+ *	soft mask smaskId if that is not 0; the shading written as object
+ *	id; and an image XObject given as a byte array, unless namePtrPtr
+ *	is NULL as for soft masks. Each is passed to
+ *	the callback given as a Tcl command prefix instead, as
+ *
+ *	    mkobj obj		    returns its id
+ *	    mkextgs gs ?smask?	    returns {id name}
+ *	    mkgrad id		    returns {id name}
+ *	    mkimage w h obj	    returns {id name}
+ *
+ * Results:
+ *	A standard Tcl result. The object number is stored in *idPtr and
+ *	the name in *namePtrPtr with its reference count incremented.
+ *	Objects with a reference count of zero are freed.
+ *
+ * Side effects:
+ *	Objects are written to the document.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathPdfAddObj(
+    Tcl_Interp *interp,
+    Tcl_Obj *mkobj,
+    Tcl_Obj *objPtr,
+    long *idPtr)
+{
+    TkPdfInfo *pdfPtr = (TkPdfInfo *) TkPathPdfGetContext(mkobj);
+    int result;
+
+    Tcl_IncrRefCount(objPtr);
+    if (pdfPtr != NULL) {
+	result = PdfWriteObj(interp, pdfPtr, objPtr, 1, idPtr);
+    } else {
+	result = PdfEvalCallback(interp, mkobj, 1, &objPtr);
+	if (result == TCL_OK) {
+	    result = PdfCallbackResult(interp, idPtr, NULL);
+	}
+    }
+    Tcl_DecrRefCount(objPtr);
+    return result;
+}
+
+int
+TkPathPdfAddExtGState(
+    Tcl_Interp *interp,
+    Tcl_Obj *mkextgs,
+    Tcl_Obj *gsObj,
+    long smaskId,
+    Tcl_Obj **namePtrPtr)
+{
+    TkPdfInfo *pdfPtr = (TkPdfInfo *) TkPathPdfGetContext(mkextgs);
+    Tcl_Obj *argv[2];
+    long id;
+    int result;
+
+    Tcl_IncrRefCount(gsObj);
+    if (pdfPtr != NULL) {
+	/*
+	 * A soft mask, if any, is already referenced from the dictionary.
+	 */
+
+	result = PdfWriteObj(interp, pdfPtr, gsObj, 1, &id);
+	if (result == TCL_OK) {
+	    *namePtrPtr = PdfAddResource(pdfPtr, &pdfPtr->extGState, "GS",
+		    id);
+	}
+    } else {
+	argv[0] = gsObj;
+	argv[1] = Tcl_NewLongObj(smaskId);
+	Tcl_IncrRefCount(argv[1]);
+	result = PdfEvalCallback(interp, mkextgs, (smaskId != 0) ? 2 : 1,
+		argv);
+	Tcl_DecrRefCount(argv[1]);
+	if (result == TCL_OK) {
+	    result = PdfCallbackResult(interp, NULL, namePtrPtr);
+	}
+    }
+    Tcl_DecrRefCount(gsObj);
+    return result;
+}
+
+int
+TkPathPdfAddGradient(
+    Tcl_Interp *interp,
+    Tcl_Obj *mkgrad,
+    long id,
+    Tcl_Obj **namePtrPtr)
+{
+    TkPdfInfo *pdfPtr = (TkPdfInfo *) TkPathPdfGetContext(mkgrad);
+    Tcl_Obj *idObj;
+    int result;
+
+    if (pdfPtr != NULL) {
+	*namePtrPtr = PdfAddResource(pdfPtr, &pdfPtr->shading, "Sh", id);
+	return TCL_OK;
+    }
+    idObj = Tcl_NewLongObj(id);
+    Tcl_IncrRefCount(idObj);
+    result = PdfEvalCallback(interp, mkgrad, 1, &idObj);
+    Tcl_DecrRefCount(idObj);
+    if (result == TCL_OK) {
+	result = PdfCallbackResult(interp, NULL, namePtrPtr);
+    }
+    return result;
+}
+
+int
+TkPathPdfAddImage(
+    Tcl_Interp *interp,
+    Tcl_Obj *mkimage,
+    int width, int height,
+    Tcl_Obj *objPtr,
+    long *idPtr,
+    Tcl_Obj **namePtrPtr)
+{
+    TkPdfInfo *pdfPtr = (TkPdfInfo *) TkPathPdfGetContext(mkimage);
+    Tcl_Obj *argv[3];
+    int result;
+
+    Tcl_IncrRefCount(objPtr);
+    if (pdfPtr != NULL) {
+	result = PdfWriteObj(interp, pdfPtr, objPtr, 0, idPtr);
+	if ((result == TCL_OK) && (namePtrPtr != NULL)) {
+	    *namePtrPtr = PdfAddResource(pdfPtr, &pdfPtr->xObject, "Im",
+		    *idPtr);
+	}
+    } else {
+	argv[0] = Tcl_NewIntObj(width);
+	argv[1] = Tcl_NewIntObj(height);
+	argv[2] = objPtr;
+	Tcl_IncrRefCount(argv[0]);
+	Tcl_IncrRefCount(argv[1]);
+	result = PdfEvalCallback(interp, mkimage, 3, argv);
+	Tcl_DecrRefCount(argv[0]);
+	Tcl_DecrRefCount(argv[1]);
+	if (result == TCL_OK) {
+	    result = PdfCallbackResult(interp, idPtr, namePtrPtr);
+	}
+    }
+    Tcl_DecrRefCount(objPtr);
+    return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathPdfAddText --
+ *
+ *	Encodes a line of text for a PDF string literal, without the
+ *	surrounding parentheses, and appends it to resultPtr. The writer
+ *	converts it to the WinAnsi encoding of the standard fonts and
+ *	escapes everything that is not printable ASCII; a Tcl command
+ *	prefix is called with the text and returns it encoded.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Whatever the callback does.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathPdfAddText(
+    Tcl_Interp *interp,
+    Tcl_Obj *text,
+    const char *string,
+    Tcl_Obj *resultPtr)
+{
+    TkPdfInfo *pdfPtr = (TkPdfInfo *) TkPathPdfGetContext(text);
+    Tcl_DString ext;
+    Tcl_Obj *strObj;
+    const unsigned char *p;
+    Tcl_Size i, len;
+    char obuf[8];
+    int result;
+
+    if (pdfPtr == NULL) {
+	strObj = Tcl_NewStringObj(string, -1);
+	Tcl_IncrRefCount(strObj);
+	result = PdfEvalCallback(interp, text, 1, &strObj);
+	Tcl_DecrRefCount(strObj);
+	if (result == TCL_OK) {
+	    Tcl_AppendObjToObj(resultPtr, Tcl_GetObjResult(interp));
+	    Tcl_ResetResult(interp);
+	}
+	return result;
+    }
+    Tcl_UtfToExternalDString(pdfPtr->encoding, string, -1, &ext);
+    p = (const unsigned char *) Tcl_DStringValue(&ext);
+    len = Tcl_DStringLength(&ext);
+    for (i = 0; i < len; i++) {
+	if ((p[i] == '(') || (p[i] == ')') || (p[i] == '\\')) {
+	    obuf[0] = '\\';
+	    obuf[1] = p[i];
+	    Tcl_AppendToObj(resultPtr, obuf, 2);
+	} else if ((p[i] < ' ') || (p[i] > '~')) {
+	    sprintf(obuf, "\\%03o", p[i]);
+	    Tcl_AppendToObj(resultPtr, obuf, -1);
+	} else {
+	    Tcl_AppendToObj(resultPtr, (const char *) p + i, 1);
+	}
+    }
+    Tcl_DStringFree(&ext);
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathPdfFindResource, TkPathPdfKeepResource --
+ *
+ *	Let pdfProcs reuse what they made of an image or gradient before,
+ *	instead of converting it again. Resources are only kept by the
+ *	writer; with a Tcl command prefix nothing is ever found.
+ *
+ * Results:
+ *	TkPathPdfFindResource returns 1 and fills in *resPtr, with the
+ *	reference count of the name incremented, if a resource was kept
+ *	under the key, else 0.
+ *
+ * Side effects:
+ *	TkPathPdfKeepResource keeps a copy of *resPtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathPdfFindResource(
+    Tcl_Obj *callbackObj,
+    const TkPathPdfKey *keyPtr,
+    TkPathPdfResource *resPtr)
+{
+    TkPdfInfo *pdfPtr = (TkPdfInfo *) TkPathPdfGetContext(callbackObj);
+    Tcl_HashEntry *hPtr;
+
+    if (pdfPtr == NULL) {
+	return 0;
+    }
+    hPtr = Tcl_FindHashEntry(&pdfPtr->resourceTable, (const char *) keyPtr);
+    if (hPtr == NULL) {
+	return 0;
+    }
+    *resPtr = *((TkPathPdfResource *) Tcl_GetHashValue(hPtr));
+    if (resPtr->nameObj != NULL) {
+	Tcl_IncrRefCount(resPtr->nameObj);
+    }
+    return 1;
+}
+
+void
+TkPathPdfKeepResource(
+    Tcl_Obj *callbackObj,
+    const TkPathPdfKey *keyPtr,
+    const TkPathPdfResource *resPtr)
+{
+    TkPdfInfo *pdfPtr = (TkPdfInfo *) TkPathPdfGetContext(callbackObj);
+    TkPathPdfResource *keptPtr;
+    Tcl_HashEntry *hPtr;
+    int isNew;
+
+    if (pdfPtr == NULL) {
+	return;
+    }
+    hPtr = Tcl_CreateHashEntry(&pdfPtr->resourceTable,
+	    (const char *) keyPtr, &isNew);
+    if (isNew) {
+	keptPtr = (TkPathPdfResource *) ckalloc(sizeof(TkPathPdfResource));
+	Tcl_SetHashValue(hPtr, keptPtr);
+    } else {
+	keptPtr = (TkPathPdfResource *) Tcl_GetHashValue(hPtr);
+	if (keptPtr->nameObj != NULL) {
+	    Tcl_DecrRefCount(keptPtr->nameObj);
+	}
+    }
+    *keptPtr = *resPtr;
+    if (keptPtr->nameObj != NULL) {
+	Tcl_IncrRefCount(keptPtr->nameObj);
+    }
+}
+
+/*
+ * Local Variables:
+ * mode: c
+ * c-basic-offset: 4
+ * fill-column: 78
+ * End:
+ */
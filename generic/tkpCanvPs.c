@@ -152,6 +152,8 @@ static Tk_OptionSpec optionSpecs[] = {
 
 static int		GetPostscriptPoints(Tcl_Interp *interp,
 			    char *string, double *doublePtr);
+static void		PsCacheValidate(TkPathCanvas *canvasPtr,
+			    TkPostscriptInfo *psInfoPtr);
 
 /*
  *--------------------------------------------------------------
@@ -200,6 +202,9 @@ TkpCanvPostscriptCmd(
 				 * anchor position). Initial values needed
 				 * only to stop compiler warnings. */
     Tk_OptionTable optionTable;
+    int useCache;
+    Tcl_Obj *fragObj;
+    Tcl_Size start, length2;
 
     /*
      * Initialize the data structure describing Postscript generation, then
@@ -408,12 +413,23 @@ TkpCanvPostscriptCmd(
         }
     }
 
+    /*
+     * Fragments of unchanged items are reused from earlier exports. They
+     * can't be when the output depends on the contents of the -colormap or
+     * -fontmap variables.
+     */
+
+    useCache = (psInfo.colorVar == NULL) && (psInfo.fontVar == NULL);
+    if (useCache) {
+	PsCacheValidate(canvasPtr, psInfoPtr);
+    }
+
     /*
      * Make a pre-pass over all of the items, generating Postscript and then
      * throwing it away. The purpose of this pass is just to collect
      * information about all the fonts in use, so that we can output font
      * information in the proper form required by the Document Structuring
-     * Conventions.
+     * Conventions. Cached items use no fonts and are skipped.
      */
 
     psInfo.prepass = 1;
@@ -426,6 +442,10 @@ TkpCanvPostscriptCmd(
 	if (itemPtr->typePtr->postscriptProc == NULL) {
 	    continue;
 	}
+	if (useCache && (Tcl_FindHashEntry(&canvasPtr->psCache,
+		(char *) INT2PTR(itemPtr->id)) != NULL)) {
+	    continue;
+	}
 	result = (*itemPtr->typePtr->postscriptProc)(interp,
 		(Tk_PathCanvas) canvasPtr, itemPtr, 1);
 	Tcl_ResetResult(interp);
@@ -552,8 +572,9 @@ TkpCanvPostscriptCmd(
     }
 
     /*
-     * Iterate through all the items, having each relevant one draw itself.
-     * Quit if any of the items returns an error.
+     * Iterate through all the items, having each relevant one draw itself,
+     * or emit its cached fragment. Quit if any of the items returns an
+     * error.
      */
 
     result = TCL_OK;
@@ -569,6 +590,22 @@ TkpCanvPostscriptCmd(
 	if (itemPtr->state == TK_PATHSTATE_HIDDEN) {
 	    continue;
 	}
+	hPtr = NULL;
+	if (useCache) {
+	    hPtr = Tcl_FindHashEntry(&canvasPtr->psCache,
+		    (char *) INT2PTR(itemPtr->id));
+	}
+	if (hPtr != NULL) {
+	    fragObj = (Tcl_Obj *) Tcl_GetHashValue(hPtr);
+	    if (psInfo.chan != NULL) {
+		Tcl_WriteObj(psInfo.chan, fragObj);
+	    } else {
+		Tcl_AppendResult(interp, Tcl_GetString(fragObj), NULL);
+	    }
+	    continue;
+	}
+	Tcl_GetStringFromObj(Tcl_GetObjResult(interp), &start);
+	canvasPtr->flags &= ~PS_FONT_USED;
 	Tcl_AppendResult(interp, "gsave\n", NULL);
 	result = (*itemPtr->typePtr->postscriptProc)(interp,
 		(Tk_PathCanvas) canvasPtr, itemPtr, 0);
@@ -581,6 +618,21 @@ TkpCanvPostscriptCmd(
 	    goto cleanup;
 	}
 	Tcl_AppendResult(interp, "grestore\n", NULL);
+
+	/*
+	 * Keep the fragment unless it depends on fonts, which the pre-pass
+	 * must see, or on window contents the canvas isn't told about.
+	 */
+
+	if (useCache && !(canvasPtr->flags & PS_FONT_USED)
+		&& !(itemPtr->typePtr->alwaysRedraw & 1)) {
+	    p = Tcl_GetStringFromObj(Tcl_GetObjResult(interp), &length2);
+	    fragObj = Tcl_NewStringObj(p + start, length2 - start);
+	    Tcl_IncrRefCount(fragObj);
+	    hPtr = Tcl_CreateHashEntry(&canvasPtr->psCache,
+		    (char *) INT2PTR(itemPtr->id), NULL);
+	    Tcl_SetHashValue(hPtr, fragObj);
+	}
 	if (psInfo.chan != NULL) {
 	    Tcl_Write(psInfo.chan, Tcl_GetStringResult(interp), -1);
 	    Tcl_ResetResult(interp);
@@ -615,6 +667,130 @@ TkpCanvPostscriptCmd(
     return result;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * PsCacheValidate --
+ *
+ *	Drops the cached Postscript fragments that can't be used for the
+ *	export described by psInfoPtr: all of them if the page bottom or the
+ *	color level differs from the previous export, else those of items
+ *	that overlap the area changed since then.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Entries of the canvas's psCache may be freed.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+PsCacheValidate(
+    TkPathCanvas *canvasPtr,	/* Canvas that is being exported. */
+    TkPostscriptInfo *psInfoPtr)/* The export's parameters. */
+{
+    Tcl_HashEntry *hPtr, *idPtr;
+    Tcl_HashSearch search;
+    Tk_PathItem *itemPtr;
+
+    if ((canvasPtr->psCacheY2 != psInfoPtr->y2)
+	    || (canvasPtr->psCacheColorLevel != psInfoPtr->colorLevel)) {
+	TkPathCanvasPsFlush(canvasPtr);
+	canvasPtr->psCacheY2 = psInfoPtr->y2;
+	canvasPtr->psCacheColorLevel = psInfoPtr->colorLevel;
+	return;
+    }
+    if (!(canvasPtr->flags & PS_DIRTY)) {
+	return;
+    }
+    for (hPtr = Tcl_FirstHashEntry(&canvasPtr->psCache, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	idPtr = Tcl_FindHashEntry(&canvasPtr->idTable,
+		Tcl_GetHashKey(&canvasPtr->psCache, hPtr));
+	if (idPtr != NULL) {
+	    itemPtr = (Tk_PathItem *) Tcl_GetHashValue(idPtr);
+	    if ((itemPtr->x1 > canvasPtr->psDirtyX2)
+		    || (itemPtr->x2 < canvasPtr->psDirtyX1)
+		    || (itemPtr->y1 > canvasPtr->psDirtyY2)
+		    || (itemPtr->y2 < canvasPtr->psDirtyY1)) {
+		continue;
+	    }
+	}
+	Tcl_DecrRefCount((Tcl_Obj *) Tcl_GetHashValue(hPtr));
+	Tcl_DeleteHashEntry(hPtr);
+    }
+    canvasPtr->flags &= ~PS_DIRTY;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasPsForget --
+ *
+ *	Drops the cached Postscript fragment of an item, if any. Called
+ *	whenever the item is redrawn or deleted.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May free memory.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkPathCanvasPsForget(
+    TkPathCanvas *canvasPtr,	/* Canvas containing the item. */
+    Tk_PathItem *itemPtr)	/* The item that changed. */
+{
+    Tcl_HashEntry *hPtr;
+
+    if (canvasPtr->psCache.numEntries == 0) {
+	return;
+    }
+    hPtr = Tcl_FindHashEntry(&canvasPtr->psCache,
+	    (char *) INT2PTR(itemPtr->id));
+    if (hPtr != NULL) {
+	Tcl_DecrRefCount((Tcl_Obj *) Tcl_GetHashValue(hPtr));
+	Tcl_DeleteHashEntry(hPtr);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasPsFlush --
+ *
+ *	Drops all cached Postscript fragments of a canvas, for changes that
+ *	may affect every item such as the canvas state or fonts.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May free memory.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkPathCanvasPsFlush(
+    TkPathCanvas *canvasPtr)	/* Canvas whose cache is emptied. */
+{
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+
+    for (hPtr = Tcl_FirstHashEntry(&canvasPtr->psCache, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	Tcl_DecrRefCount((Tcl_Obj *) Tcl_GetHashValue(hPtr));
+	Tcl_DeleteHashEntry(hPtr);
+    }
+    canvasPtr->flags &= ~PS_DIRTY;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -1020,6 +1196,56 @@ TkPathPostscriptImage(
     return TCL_OK;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * Tk_PathCanvasPsPath --
+ *
+ *	Given an array of points for a path, generate Postscript commands to
+ *	create the path. The output is the same as Tk_PostscriptPath gives,
+ *	but numbers are formatted without going through sprintf.
+ *
+ * Results:
+ *	Postscript commands get appended to what's in interp->result.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+Tk_PathCanvasPsPath(
+    Tcl_Interp *interp,		/* Put generated Postscript in this
+				 * interpreter's result field. */
+    Tk_PathCanvas canvas,	/* Canvas on whose behalf Postscript is being
+				 * generated. */
+    double *coordPtr,		/* Pointer to first in array of 2*numPoints
+				 * coordinates giving points for path. */
+    int numPoints)		/* Number of points at *coordPtr. */
+{
+    TkPostscriptInfo *psInfoPtr = (TkPostscriptInfo *)
+	    ((TkPathCanvas *) canvas)->psInfo;
+    Tcl_Obj *psObj;
+
+    if (psInfoPtr->prepass) {
+	return;
+    }
+    psObj = Tcl_GetObjResult(interp);
+    if (Tcl_IsShared(psObj)) {
+	psObj = Tcl_DuplicateObj(psObj);
+	Tcl_SetObjResult(interp, psObj);
+    }
+    TkPathPsNumber(psObj, coordPtr[0], " ");
+    TkPathPsNumber(psObj, Tk_PathCanvasPsY(canvas, coordPtr[1]), " moveto\n");
+    for (numPoints--, coordPtr += 2; numPoints > 0;
+	    numPoints--, coordPtr += 2) {
+	TkPathPsNumber(psObj, coordPtr[0], " ");
+	TkPathPsNumber(psObj, Tk_PathCanvasPsY(canvas, coordPtr[1]),
+		" lineto\n");
+    }
+}
+
 #endif /* TKP_NO_POSTSCRIPT */
 
 
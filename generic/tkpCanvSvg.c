@@ -0,0 +1,1662 @@
+/*
+ * tkpCanvSvg.c --
+ *
+ *	This module provides the "svg" widget command for path canvases.
+ *	It writes an SVG document in one pass over the item tree, either to
+ *	a channel or as the command result. Named gradients and styles go
+ *	into a shared <defs> section, groups become <g> elements with their
+ *	matrix as transform, and each item is written as it is visited so
+ *	that the document is never built in memory when writing to a
+ *	channel.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#include "tkIntPath.h"
+#include "tkpCanvas.h"
+
+/*
+ * Pending output is written to the channel whenever it grows beyond this
+ * size.
+ */
+
+#define SVG_CHUNK 65536
+
+/*
+ * The pimage item pads its bbox by this amount; see tkCanvPimage.c.
+ */
+
+#define SVG_PIMAGE_BBOX_OUT 2.0
+
+/*
+ * All the style options that have an SVG presentation attribute.
+ */
+
+#define SVG_STYLE_OPTIONS						\
+    (PATH_STYLE_OPTION_FILL | PATH_STYLE_OPTION_FILL_OPACITY		\
+    | PATH_STYLE_OPTION_FILL_RULE | PATH_STYLE_OPTION_STROKE		\
+    | PATH_STYLE_OPTION_STROKE_DASHARRAY				\
+    | PATH_STYLE_OPTION_STROKE_DASHOFFSET				\
+    | PATH_STYLE_OPTION_STROKE_LINECAP | PATH_STYLE_OPTION_STROKE_LINEJOIN \
+    | PATH_STYLE_OPTION_STROKE_MITERLIMIT				\
+    | PATH_STYLE_OPTION_STROKE_OPACITY | PATH_STYLE_OPTION_STROKE_WIDTH)
+
+/*
+ * The item types known to this module.
+ */
+
+enum SvgItemKind {
+    SVG_NONE, SVG_GROUP, SVG_PATH, SVG_PRECT, SVG_CIRCLE, SVG_ELLIPSE,
+    SVG_PLINE, SVG_POLYLINE, SVG_PPOLYGON, SVG_PTEXT, SVG_PIMAGE,
+    SVG_LRECT, SVG_LCIRCLE, SVG_LELLIPSE
+};
+
+static const struct {
+    const char *name;
+    enum SvgItemKind kind;
+} svgKinds[] = {
+    {"group", SVG_GROUP},
+    {"path", SVG_PATH},
+    {"prect", SVG_PRECT},
+    {"circle", SVG_CIRCLE},
+    {"ellipse", SVG_ELLIPSE},
+    {"pline", SVG_PLINE},
+    {"polyline", SVG_POLYLINE},
+    {"ppolygon", SVG_PPOLYGON},
+    {"ptext", SVG_PTEXT},
+    {"pimage", SVG_PIMAGE},
+    {"lrect", SVG_LRECT},
+    {"lcircle", SVG_LCIRCLE},
+    {"lellipse", SVG_LELLIPSE},
+    {NULL, SVG_NONE}
+};
+
+/*
+ * One of the following structures is created to keep track of SVG output
+ * being generated.
+ */
+
+typedef struct TkSvgInfo {
+    int x, y, width, height;	/* Area to export, in canvas pixel
+				 * coordinates. */
+    char *fileName;		/* Name of file in which to write SVG; NULL
+				 * means return SVG as result. Malloc'ed. */
+    char *channelName;		/* If -channel is specified, the name of the
+				 * channel to use. */
+    Tcl_Obj *imageCmdObj;	/* If -imagecommand is specified, a command
+				 * prefix returning the href of an image;
+				 * otherwise images are embedded. */
+    Tcl_Channel chan;		/* Open channel corresponding to fileName or
+				 * channelName. */
+    int writeError;		/* Non-zero once writing to chan failed. */
+    TkPathCanvas *canvasPtr;	/* The canvas being exported. */
+    Tcl_Obj *output;		/* Collects the document when there is no
+				 * channel. */
+    Tcl_Obj *buffer;		/* Output not yet written. */
+    Tcl_Obj *attrs;		/* Scratch space for the attributes of the
+				 * current item. */
+    double *coords;		/* Scratch space for item coordinates. */
+    int maxCoords;		/* Allocated size of coords. */
+    Tcl_HashTable imageTable;	/* Maps image names to the number of their
+				 * <image> definition. */
+    const Tk_PathItemType *lastTypePtr;
+    enum SvgItemKind lastKind;	/* Kind of the last item type looked up. */
+} TkSvgInfo;
+
+/*
+ * The table below provides a template that's used to process arguments to the
+ * canvas "svg" command and fill in TkSvgInfo structures.
+ */
+
+static Tk_OptionSpec optionSpecs[] = {
+    {TK_OPTION_STRING, "-channel", NULL, NULL,
+	NULL, -1, offsetof(TkSvgInfo, channelName),
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_STRING, "-file", NULL, NULL,
+	NULL, -1, offsetof(TkSvgInfo, fileName),
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_PIXELS, "-height", NULL, NULL,
+	NULL, -1, offsetof(TkSvgInfo, height),
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_STRING, "-imagecommand", NULL, NULL,
+	NULL, offsetof(TkSvgInfo, imageCmdObj), -1,
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_PIXELS, "-width", NULL, NULL,
+	NULL, -1, offsetof(TkSvgInfo, width),
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_PIXELS, "-x", NULL, NULL,
+	NULL, -1, offsetof(TkSvgInfo, x),
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_PIXELS, "-y", NULL, NULL,
+	NULL, -1, offsetof(TkSvgInfo, y),
+	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_END, NULL, NULL, NULL,
+	NULL, 0, -1, 0, (ClientData) NULL, 0}
+};
+
+/*
+ * Forward declarations for functions defined later in this file:
+ */
+
+static void		SvgFlush(TkSvgInfo *svgPtr);
+static void		SvgEscape(Tcl_Obj *objPtr, const char *string);
+static void		SvgCssEscape(Tcl_Obj *objPtr, const char *string);
+static int		SvgIsClassName(const char *name);
+static void		SvgNumberAttr(Tcl_Obj *objPtr, const char *name,
+			    double number);
+static void		SvgColor(Tcl_Obj *objPtr, XColor *colorPtr);
+static void		SvgMatrix(Tcl_Obj *objPtr, TMatrix *matrixPtr);
+static void		SvgStyleProps(Tcl_Obj *objPtr,
+			    Tk_PathStyle *stylePtr, int mask, int css);
+static void		SvgGradients(TkSvgInfo *svgPtr);
+static void		SvgStyles(TkSvgInfo *svgPtr);
+static enum SvgItemKind	SvgGetKind(TkSvgInfo *svgPtr,
+			    Tk_PathItem *itemPtr);
+static Tcl_Obj *	SvgGetOption(Tcl_Interp *interp, TkSvgInfo *svgPtr,
+			    Tk_PathItem *itemPtr, const char *name);
+static double		SvgGetDoubleOption(Tcl_Interp *interp,
+			    TkSvgInfo *svgPtr, Tk_PathItem *itemPtr,
+			    const char *name);
+static int		SvgGetCoords(Tcl_Interp *interp, TkSvgInfo *svgPtr,
+			    Tk_PathItem *itemPtr, int *numPtr);
+static void		SvgItemAttrs(TkSvgInfo *svgPtr,
+			    Tk_PathItem *itemPtr, int mask);
+static int		SvgItem(Tcl_Interp *interp, TkSvgInfo *svgPtr,
+			    Tk_PathItem *itemPtr);
+static int		SvgShapes(Tcl_Interp *interp, TkSvgInfo *svgPtr,
+			    Tk_PathItem *itemPtr, enum SvgItemKind kind);
+static int		SvgText(Tcl_Interp *interp, TkSvgInfo *svgPtr,
+			    Tk_PathItem *itemPtr);
+static int		SvgImage(Tcl_Interp *interp, TkSvgInfo *svgPtr,
+			    Tk_PathItem *itemPtr);
+static void		SvgBase64(Tcl_Obj *objPtr,
+			    const unsigned char *bytes, Tcl_Size len);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkpCanvSvgCmd --
+ *
+ *	This function is invoked to process the "svg" options of the widget
+ *	command for canvas widgets. See the user documentation for details
+ *	on what it does.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	See the user documentation.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkpCanvSvgCmd(
+    TkPathCanvas *canvasPtr,	/* Information about canvas widget. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument strings. Caller has already parsed
+				 * this command enough to know that argv[1] is
+				 * "svg". */
+{
+    TkSvgInfo svgInfo;
+    Tk_Window tkwin = canvasPtr->tkwin;
+    Tk_OptionTable optionTable;
+    Tcl_DString buffer;
+    const char *p;
+    char string[200];
+    int result = TCL_ERROR;
+
+    svgInfo.x = canvasPtr->xOrigin;
+    svgInfo.y = canvasPtr->yOrigin;
+    svgInfo.width = -1;
+    svgInfo.height = -1;
+    svgInfo.fileName = NULL;
+    svgInfo.channelName = NULL;
+    svgInfo.imageCmdObj = NULL;
+    svgInfo.chan = NULL;
+    svgInfo.writeError = 0;
+    svgInfo.canvasPtr = canvasPtr;
+    svgInfo.output = Tcl_NewObj();
+    Tcl_IncrRefCount(svgInfo.output);
+    svgInfo.buffer = Tcl_NewObj();
+    Tcl_IncrRefCount(svgInfo.buffer);
+    svgInfo.attrs = Tcl_NewObj();
+    Tcl_IncrRefCount(svgInfo.attrs);
+    svgInfo.maxCoords = 64;
+    svgInfo.coords = (double *) ckalloc(svgInfo.maxCoords * sizeof(double));
+    Tcl_InitHashTable(&svgInfo.imageTable, TCL_STRING_KEYS);
+    svgInfo.lastTypePtr = NULL;
+    svgInfo.lastKind = SVG_NONE;
+
+    optionTable = Tk_CreateOptionTable(interp, optionSpecs);
+    if (Tk_InitOptions(interp, (char *) &svgInfo, optionTable,
+	    tkwin) != TCL_OK) {
+	goto cleanup;
+    }
+    if (Tk_SetOptions(interp, (char *) &svgInfo, optionTable,
+	    objc-2, objv+2, tkwin, NULL, NULL) != TCL_OK) {
+	goto cleanup;
+    }
+    if (svgInfo.width == -1) {
+	svgInfo.width = Tk_Width(tkwin);
+    }
+    if (svgInfo.height == -1) {
+	svgInfo.height = Tk_Height(tkwin);
+    }
+    if ((svgInfo.imageCmdObj != NULL) && ObjectIsEmpty(svgInfo.imageCmdObj)) {
+	svgInfo.imageCmdObj = NULL;
+    }
+
+    if (svgInfo.fileName != NULL) {
+	if (svgInfo.channelName != NULL) {
+	    Tcl_AppendResult(interp, "can't specify both -file",
+		    " and -channel", NULL);
+	    goto cleanup;
+	}
+	if (Tcl_IsSafe(interp)) {
+	    Tcl_AppendResult(interp, "can't specify -file in a",
+		    " safe interpreter", NULL);
+	    goto cleanup;
+	}
+	p = Tcl_TranslateFileName(interp, svgInfo.fileName, &buffer);
+	if (p == NULL) {
+	    goto cleanup;
+	}
+	svgInfo.chan = Tcl_OpenFileChannel(interp, p, "w", 0666);
+	Tcl_DStringFree(&buffer);
+	if (svgInfo.chan == NULL) {
+	    goto cleanup;
+	}
+	if (Tcl_SetChannelOption(interp, svgInfo.chan, "-encoding",
+		"utf-8") != TCL_OK) {
+	    goto cleanup;
+	}
+    }
+    if (svgInfo.channelName != NULL) {
+	int mode;
+
+	/*
+	 * The document declares UTF-8; the caller should have configured
+	 * the channel with -encoding utf-8.
+	 */
+
+	svgInfo.chan = Tcl_GetChannel(interp, svgInfo.channelName, &mode);
+	if (svgInfo.chan == (Tcl_Channel) NULL) {
+	    goto cleanup;
+	}
+	if ((mode & TCL_WRITABLE) == 0) {
+	    Tcl_AppendResult(interp, "channel \"", svgInfo.channelName,
+		    "\" wasn't opened for writing", NULL);
+	    goto cleanup;
+	}
+    }
+
+    Tcl_AppendToObj(svgInfo.buffer,
+	    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n"
+	    "<svg xmlns=\"http://www.w3.org/2000/svg\""
+	    " xmlns:xlink=\"http://www.w3.org/1999/xlink\" version=\"1.1\"",
+	    -1);
+    sprintf(string, " width=\"%d\" height=\"%d\" viewBox=\"%d %d %d %d\">\n",
+	    svgInfo.width, svgInfo.height, svgInfo.x, svgInfo.y,
+	    svgInfo.width, svgInfo.height);
+    Tcl_AppendToObj(svgInfo.buffer, string, -1);
+
+    /*
+     * Gradients and named styles are shared by the items referring to
+     * them and written up front.
+     */
+
+    Tcl_AppendToObj(svgInfo.buffer, "<defs>\n", -1);
+    SvgGradients(&svgInfo);
+    SvgStyles(&svgInfo);
+    Tcl_AppendToObj(svgInfo.buffer, "</defs>\n", -1);
+
+    Tcl_ResetResult(interp);
+    if (SvgItem(interp, &svgInfo, canvasPtr->rootItemPtr) != TCL_OK) {
+	goto cleanup;
+    }
+    Tcl_AppendToObj(svgInfo.buffer, "</svg>\n", -1);
+    SvgFlush(&svgInfo);
+    if (svgInfo.writeError) {
+	Tcl_AppendResult(interp, "error writing \"",
+		Tcl_GetChannelName(svgInfo.chan), "\": ",
+		Tcl_PosixError(interp), NULL);
+	goto cleanup;
+    }
+    if (svgInfo.chan == NULL) {
+	Tcl_SetObjResult(interp, svgInfo.output);
+    }
+    result = TCL_OK;
+
+    /*
+     * Clean up svgInfo to release malloc'ed stuff.
+     */
+
+  cleanup:
+    if ((svgInfo.chan != NULL) && (svgInfo.channelName == NULL)) {
+	Tcl_Close(interp, svgInfo.chan);
+    }
+    Tcl_DecrRefCount(svgInfo.output);
+    Tcl_DecrRefCount(svgInfo.buffer);
+    Tcl_DecrRefCount(svgInfo.attrs);
+    ckfree((char *) svgInfo.coords);
+    Tcl_DeleteHashTable(&svgInfo.imageTable);
+    Tk_FreeConfigOptions((char *) &svgInfo, optionTable, tkwin);
+    return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgFlush --
+ *
+ *	Moves the pending output to the channel, or to the collected
+ *	document if there is no channel.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	A failed channel write is remembered and reported when the
+ *	document is complete.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgFlush(
+    TkSvgInfo *svgPtr)
+{
+    if (svgPtr->chan != NULL) {
+	if (!svgPtr->writeError &&
+		(Tcl_WriteObj(svgPtr->chan, svgPtr->buffer) < 0)) {
+	    svgPtr->writeError = 1;
+	}
+    } else {
+	Tcl_AppendObjToObj(svgPtr->output, svgPtr->buffer);
+    }
+    Tcl_SetObjLength(svgPtr->buffer, 0);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgEscape --
+ *
+ *	Appends a string with the XML markup characters replaced by
+ *	entity references.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Appends to objPtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgEscape(
+    Tcl_Obj *objPtr,
+    const char *string)
+{
+    const char *p, *start = string;
+    const char *entity;
+
+    for (p = string; *p != '\0'; p++) {
+	switch (*p) {
+	case '&':	entity = "&amp;";	break;
+	case '<':	entity = "&lt;";	break;
+	case '>':	entity = "&gt;";	break;
+	case '"':	entity = "&quot;";	break;
+	default:	continue;
+	}
+	Tcl_AppendToObj(objPtr, start, p - start);
+	Tcl_AppendToObj(objPtr, entity, -1);
+	start = p + 1;
+    }
+    Tcl_AppendToObj(objPtr, start, p - start);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgCssEscape --
+ *
+ *	Appends a name as a CSS identifier, escaping every character that
+ *	may not appear there, such as '.', ')' or ']' which would also end
+ *	the CDATA section the styles are written in.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Appends to objPtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgCssEscape(
+    Tcl_Obj *objPtr,
+    const char *string)
+{
+    const unsigned char *p;
+    char buffer[8];
+
+    for (p = (const unsigned char *) string; *p != '\0'; p++) {
+	int first = (p == (const unsigned char *) string);
+	int digit = ((*p >= '0') && (*p <= '9'));
+
+	if ((*p >= 0x80) || (*p == '_')
+		|| ((*p >= 'a') && (*p <= 'z'))
+		|| ((*p >= 'A') && (*p <= 'Z'))
+		|| (digit && !first)
+		|| ((*p == '-') && !first)) {
+	    Tcl_AppendToObj(objPtr, (const char *) p, 1);
+	} else if (digit || (*p <= ' ') || (*p == 0x7F)) {
+	    sprintf(buffer, "\\%x ", *p);
+	    Tcl_AppendToObj(objPtr, buffer, -1);
+	} else {
+	    Tcl_AppendToObj(objPtr, "\\", 1);
+	    Tcl_AppendToObj(objPtr, (const char *) p, 1);
+	}
+    }
+}
+
+/*
+ * A class attribute holds a list of names separated by white space, so
+ * a style whose name has any can't be referred to as a class.
+ */
+
+static int
+SvgIsClassName(
+    const char *name)
+{
+    const char *p;
+
+    if (*name == '\0') {
+	return 0;
+    }
+    for (p = name; *p != '\0'; p++) {
+	if ((*p == ' ') || (*p == '\t') || (*p == '\n') || (*p == '\r')
+		|| (*p == '\f')) {
+	    return 0;
+	}
+    }
+    return 1;
+}
+
+static void
+SvgNumberAttr(
+    Tcl_Obj *objPtr,
+    const char *name,		/* Attribute name with leading space. */
+    double number)
+{
+    Tcl_AppendStringsToObj(objPtr, name, "=\"", NULL);
+    TkPathPdfNumber(objPtr, 3, number, "\"");
+}
+
+static void
+SvgColor(
+    Tcl_Obj *objPtr,
+    XColor *colorPtr)
+{
+    char buffer[8];
+
+    sprintf(buffer, "#%02x%02x%02x", (colorPtr->red >> 8) & 0xFF,
+	    (colorPtr->green >> 8) & 0xFF, (colorPtr->blue >> 8) & 0xFF);
+    Tcl_AppendToObj(objPtr, buffer, 7);
+}
+
+static void
+SvgMatrix(
+    Tcl_Obj *objPtr,
+    TMatrix *matrixPtr)
+{
+    Tcl_AppendToObj(objPtr, "matrix(", -1);
+    TkPathPdfNumber(objPtr, 6, matrixPtr->a, " ");
+    TkPathPdfNumber(objPtr, 6, matrixPtr->b, " ");
+    TkPathPdfNumber(objPtr, 6, matrixPtr->c, " ");
+    TkPathPdfNumber(objPtr, 6, matrixPtr->d, " ");
+    TkPathPdfNumber(objPtr, 3, matrixPtr->tx, " ");
+    TkPathPdfNumber(objPtr, 3, matrixPtr->ty, ")");
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgStyleProps --
+ *
+ *	Appends the style options selected by mask, either as presentation
+ *	attributes or as CSS declarations. The matrix is never part of
+ *	these since it maps to the transform attribute.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Appends to objPtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgStyleProps(
+    Tcl_Obj *objPtr,
+    Tk_PathStyle *stylePtr,
+    int mask,
+    int css)			/* Non-zero for CSS declarations. */
+{
+    const char *open = css ? ":" : "=\"";
+    const char *close = css ? ";" : "\"";
+    const char *value;
+    int i;
+
+    if (mask & PATH_STYLE_OPTION_FILL) {
+	TkPathColor *fill = stylePtr->fill;
+	TkPathGradientMaster *gradientPtr =
+		GetGradientMasterFromPathColor(fill);
+
+	Tcl_AppendStringsToObj(objPtr, " fill", open, NULL);
+	if (gradientPtr != NULL) {
+	    Tcl_AppendToObj(objPtr, "url(#", -1);
+	    if (css) {
+		SvgCssEscape(objPtr, gradientPtr->name);
+	    } else {
+		SvgEscape(objPtr, gradientPtr->name);
+	    }
+	    Tcl_AppendToObj(objPtr, ")", 1);
+	} else if ((fill != NULL) && (fill->color != NULL)) {
+	    SvgColor(objPtr, fill->color);
+	} else {
+	    Tcl_AppendToObj(objPtr, "none", 4);
+	}
+	Tcl_AppendToObj(objPtr, close, -1);
+    }
+    if (mask & PATH_STYLE_OPTION_FILL_OPACITY) {
+	Tcl_AppendStringsToObj(objPtr, " fill-opacity", open, NULL);
+	TkPathPdfNumber(objPtr, 3, stylePtr->fillOpacity, close);
+    }
+    if (mask & PATH_STYLE_OPTION_FILL_RULE) {
+	value = (stylePtr->fillRule == EvenOddRule) ? "evenodd" : "nonzero";
+	Tcl_AppendStringsToObj(objPtr, " fill-rule", open, value, close,
+		NULL);
+    }
+    if (mask & PATH_STYLE_OPTION_STROKE) {
+	Tcl_AppendStringsToObj(objPtr, " stroke", open, NULL);
+	if (stylePtr->strokeColor != NULL) {
+	    SvgColor(objPtr, stylePtr->strokeColor);
+	} else {
+	    Tcl_AppendToObj(objPtr, "none", 4);
+	}
+	Tcl_AppendToObj(objPtr, close, -1);
+    }
+    if (mask & PATH_STYLE_OPTION_STROKE_WIDTH) {
+	Tcl_AppendStringsToObj(objPtr, " stroke-width", open, NULL);
+	TkPathPdfNumber(objPtr, 3, stylePtr->strokeWidth, close);
+    }
+    if (mask & PATH_STYLE_OPTION_STROKE_OPACITY) {
+	Tcl_AppendStringsToObj(objPtr, " stroke-opacity", open, NULL);
+	TkPathPdfNumber(objPtr, 3, stylePtr->strokeOpacity, close);
+    }
+    if (mask & PATH_STYLE_OPTION_STROKE_DASHARRAY) {
+	Tcl_AppendStringsToObj(objPtr, " stroke-dasharray", open, NULL);
+	if ((stylePtr->dashPtr != NULL) && (stylePtr->dashPtr->number > 0)) {
+	    for (i = 0; i < stylePtr->dashPtr->number; i++) {
+		TkPathPdfNumber(objPtr, 3, stylePtr->dashPtr->array[i],
+			(i + 1 < stylePtr->dashPtr->number) ? "," : NULL);
+	    }
+	} else {
+	    Tcl_AppendToObj(objPtr, "none", 4);
+	}
+	Tcl_AppendToObj(objPtr, close, -1);
+    }
+    if (mask & PATH_STYLE_OPTION_STROKE_DASHOFFSET) {
+	char buffer[TCL_INTEGER_SPACE];
+
+	sprintf(buffer, "%d", stylePtr->offset);
+	Tcl_AppendStringsToObj(objPtr, " stroke-dashoffset", open, buffer,
+		close, NULL);
+    }
+    if (mask & PATH_STYLE_OPTION_STROKE_LINECAP) {
+	switch (stylePtr->capStyle) {
+	case CapRound:		value = "round";	break;
+	case CapProjecting:	value = "square";	break;
+	default:		value = "butt";		break;
+	}
+	Tcl_AppendStringsToObj(objPtr, " stroke-linecap", open, value, close,
+		NULL);
+    }
+    if (mask & PATH_STYLE_OPTION_STROKE_LINEJOIN) {
+	switch (stylePtr->joinStyle) {
+	case JoinRound:		value = "round";	break;
+	case JoinBevel:		value = "bevel";	break;
+	default:		value = "miter";	break;
+	}
+	Tcl_AppendStringsToObj(objPtr, " stroke-linejoin", open, value, close,
+		NULL);
+    }
+    if (mask & PATH_STYLE_OPTION_STROKE_MITERLIMIT) {
+	Tcl_AppendStringsToObj(objPtr, " stroke-miterlimit", open, NULL);
+	TkPathPdfNumber(objPtr, 3, stylePtr->miterLimit, close);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgGradients --
+ *
+ *	Writes a <linearGradient> or <radialGradient> element for every
+ *	gradient of the canvas, using the gradient name as id.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Appends to the pending output.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgGradients(
+    TkSvgInfo *svgPtr)
+{
+    Tcl_Obj *objPtr = svgPtr->buffer;
+    Tcl_HashSearch search;
+    Tcl_HashEntry *hPtr;
+    static const char *methods[] = {"pad", "repeat", "reflect"};
+
+    for (hPtr = Tcl_FirstHashEntry(TkPathCanvasGradientTable(
+	    (Tk_PathCanvas) svgPtr->canvasPtr), &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	TkPathGradientMaster *gradientPtr =
+		(TkPathGradientMaster *) Tcl_GetHashValue(hPtr);
+	GradientStopArray *stopArrPtr;
+	const char *element;
+	int method, units, i;
+
+	if (gradientPtr->type == kPathGradientTypeLinear) {
+	    LinearGradientFill *fillPtr = &gradientPtr->linearFill;
+	    PathRect *tPtr = fillPtr->transitionPtr;
+
+	    element = "linearGradient";
+	    Tcl_AppendToObj(objPtr, "<linearGradient id=\"", -1);
+	    SvgEscape(objPtr, gradientPtr->name);
+	    Tcl_AppendToObj(objPtr, "\"", 1);
+	    if (tPtr != NULL) {
+		SvgNumberAttr(objPtr, " x1", tPtr->x1);
+		SvgNumberAttr(objPtr, " y1", tPtr->y1);
+		SvgNumberAttr(objPtr, " x2", tPtr->x2);
+		SvgNumberAttr(objPtr, " y2", tPtr->y2);
+	    }
+	    method = fillPtr->method;
+	    units = fillPtr->units;
+	    stopArrPtr = fillPtr->stopArrPtr;
+	} else {
+	    RadialGradientFill *fillPtr = &gradientPtr->radialFill;
+	    RadialTransition *tPtr = fillPtr->radialPtr;
+
+	    element = "radialGradient";
+	    Tcl_AppendToObj(objPtr, "<radialGradient id=\"", -1);
+	    SvgEscape(objPtr, gradientPtr->name);
+	    Tcl_AppendToObj(objPtr, "\"", 1);
+	    if (tPtr != NULL) {
+		SvgNumberAttr(objPtr, " cx", tPtr->centerX);
+		SvgNumberAttr(objPtr, " cy", tPtr->centerY);
+		SvgNumberAttr(objPtr, " r", tPtr->radius);
+		SvgNumberAttr(objPtr, " fx", tPtr->focalX);
+		SvgNumberAttr(objPtr, " fy", tPtr->focalY);
+	    }
+	    method = fillPtr->method;
+	    units = fillPtr->units;
+	    stopArrPtr = fillPtr->stopArrPtr;
+	}
+	if (units == kPathGradientUnitsUserSpace) {
+	    Tcl_AppendToObj(objPtr, " gradientUnits=\"userSpaceOnUse\"", -1);
+	}
+	if ((method > kPathGradientMethodPad)
+		&& (method <= kPathGradientMethodReflect)) {
+	    Tcl_AppendStringsToObj(objPtr, " spreadMethod=\"",
+		    methods[method], "\"", NULL);
+	}
+	if (gradientPtr->matrixPtr != NULL) {
+	    Tcl_AppendToObj(objPtr, " gradientTransform=\"", -1);
+	    SvgMatrix(objPtr, gradientPtr->matrixPtr);
+	    Tcl_AppendToObj(objPtr, "\"", 1);
+	}
+	Tcl_AppendToObj(objPtr, ">\n", 2);
+	if (stopArrPtr != NULL) {
+	    for (i = 0; i < stopArrPtr->nstops; i++) {
+		GradientStop *stopPtr = stopArrPtr->stops[i];
+
+		SvgNumberAttr(objPtr, "<stop offset", stopPtr->offset);
+		if (stopPtr->color != NULL) {
+		    Tcl_AppendToObj(objPtr, " stop-color=\"", -1);
+		    SvgColor(objPtr, stopPtr->color);
+		    Tcl_AppendToObj(objPtr, "\"", 1);
+		}
+		if (stopPtr->opacity < 1.0) {
+		    SvgNumberAttr(objPtr, " stop-opacity", stopPtr->opacity);
+		}
+		Tcl_AppendToObj(objPtr, "/>\n", 3);
+	    }
+	}
+	Tcl_AppendStringsToObj(objPtr, "</", element, ">\n", NULL);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgStyles --
+ *
+ *	Writes a CSS class for every named style of the canvas. Items and
+ *	groups using a style refer to it by class, and since CSS rules
+ *	override presentation attributes the named style takes precedence
+ *	over the item's own options, as it does on screen. Styles whose
+ *	name can't be a class are left out; SvgItemAttrs writes them as
+ *	attributes.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Appends to the pending output.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgStyles(
+    TkSvgInfo *svgPtr)
+{
+    Tcl_Obj *objPtr = svgPtr->buffer;
+    Tcl_HashTable *tablePtr;
+    Tcl_HashSearch search;
+    Tcl_HashEntry *hPtr;
+
+    tablePtr = TkPathCanvasStyleTable((Tk_PathCanvas) svgPtr->canvasPtr);
+    if (tablePtr->numEntries == 0) {
+	return;
+    }
+    Tcl_AppendToObj(objPtr, "<style type=\"text/css\"><![CDATA[\n", -1);
+    for (hPtr = Tcl_FirstHashEntry(tablePtr, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	Tk_PathStyle *stylePtr = (Tk_PathStyle *) Tcl_GetHashValue(hPtr);
+	const char *name = (const char *) Tcl_GetHashKey(tablePtr, hPtr);
+
+	if (!SvgIsClassName(name)) {
+	    continue;
+	}
+	Tcl_AppendToObj(objPtr, ".", 1);
+	SvgCssEscape(objPtr, name);
+	Tcl_AppendToObj(objPtr, " {", 2);
+	SvgStyleProps(objPtr, stylePtr, stylePtr->mask & SVG_STYLE_OPTIONS,
+		1);
+	Tcl_AppendToObj(objPtr, " }\n", 3);
+    }
+    Tcl_AppendToObj(objPtr, "]]></style>\n", -1);
+}
+
+static enum SvgItemKind
+SvgGetKind(
+    TkSvgInfo *svgPtr,
+    Tk_PathItem *itemPtr)
+{
+    int i;
+
+    if (itemPtr->typePtr != svgPtr->lastTypePtr) {
+	svgPtr->lastTypePtr = itemPtr->typePtr;
+	svgPtr->lastKind = SVG_NONE;
+	if (itemPtr->typePtr->isPathType) {
+	    for (i = 0; svgKinds[i].name != NULL; i++) {
+		if (strcmp(itemPtr->typePtr->name, svgKinds[i].name) == 0) {
+		    svgPtr->lastKind = svgKinds[i].kind;
+		    break;
+		}
+	    }
+	}
+    }
+    return svgPtr->lastKind;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgGetOption, SvgGetDoubleOption --
+ *
+ *	Look up the current value of an item option.
+ *
+ * Results:
+ *	The value, with its reference count incremented, or NULL. Zero
+ *	for a double option that can't be found.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static Tcl_Obj *
+SvgGetOption(
+    Tcl_Interp *interp,
+    TkSvgInfo *svgPtr,
+    Tk_PathItem *itemPtr,
+    const char *name)
+{
+    Tcl_Obj *nameObj, *valueObj;
+
+    nameObj = Tcl_NewStringObj(name, -1);
+    Tcl_IncrRefCount(nameObj);
+    valueObj = Tk_GetOptionValue(interp, (char *) itemPtr,
+	    itemPtr->optionTable, nameObj, svgPtr->canvasPtr->tkwin);
+    Tcl_DecrRefCount(nameObj);
+    if (valueObj == NULL) {
+	Tcl_ResetResult(interp);
+    } else {
+	Tcl_IncrRefCount(valueObj);
+    }
+    return valueObj;
+}
+
+static double
+SvgGetDoubleOption(
+    Tcl_Interp *interp,
+    TkSvgInfo *svgPtr,
+    Tk_PathItem *itemPtr,
+    const char *name)
+{
+    Tcl_Obj *valueObj = SvgGetOption(interp, svgPtr, itemPtr, name);
+    double value = 0.0;
+
+    if (valueObj != NULL) {
+	if (Tcl_GetDoubleFromObj(NULL, valueObj, &value) != TCL_OK) {
+	    value = 0.0;
+	}
+	Tcl_DecrRefCount(valueObj);
+    }
+    return value;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgGetCoords --
+ *
+ *	Retrieves the coordinates of an item through its coordProc.
+ *
+ * Results:
+ *	A standard Tcl result. The coordinates are left in svgPtr->coords
+ *	and their number in *numPtr.
+ *
+ * Side effects:
+ *	svgPtr->coords may be reallocated.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SvgGetCoords(
+    Tcl_Interp *interp,
+    TkSvgInfo *svgPtr,
+    Tk_PathItem *itemPtr,
+    int *numPtr)
+{
+    Tcl_Obj **objv;
+    Tcl_Size objc, i;
+
+    if ((*itemPtr->typePtr->coordProc)(interp,
+	    (Tk_PathCanvas) svgPtr->canvasPtr, itemPtr, 0, NULL) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (Tcl_ListObjGetElements(interp, Tcl_GetObjResult(interp),
+	    &objc, &objv) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (objc > svgPtr->maxCoords) {
+	svgPtr->maxCoords = objc;
+	svgPtr->coords = (double *) ckrealloc((char *) svgPtr->coords,
+		svgPtr->maxCoords * sizeof(double));
+    }
+    for (i = 0; i < objc; i++) {
+	if (Tcl_GetDoubleFromObj(interp, objv[i],
+		&svgPtr->coords[i]) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+    }
+    *numPtr = (int) objc;
+    Tcl_ResetResult(interp);
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgItemAttrs --
+ *
+ *	Collects the class, transform and style attributes of an item or
+ *	group in svgPtr->attrs. Only the style options set on the item
+ *	itself are written; the rest is inherited from the enclosing <g>
+ *	elements just like on screen.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Replaces the content of svgPtr->attrs.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgItemAttrs(
+    TkSvgInfo *svgPtr,
+    Tk_PathItem *itemPtr,
+    int mask)			/* Style options to write in addition to the
+				 * ones set on the item. */
+{
+    Tcl_Obj *objPtr = svgPtr->attrs;
+    Tk_PathItemEx *itemExPtr = (Tk_PathItemEx *) itemPtr;
+    Tk_PathStyle *namedPtr = NULL;
+    TMatrix *matrixPtr = NULL;
+
+    int namedMask = 0;
+
+    Tcl_SetObjLength(objPtr, 0);
+    if (itemExPtr->styleInst != NULL) {
+	const char *name = Tcl_GetString(itemExPtr->styleObj);
+
+	namedPtr = itemExPtr->styleInst->masterPtr;
+	if (SvgIsClassName(name)) {
+	    Tcl_AppendToObj(objPtr, " class=\"", -1);
+	    SvgEscape(objPtr, name);
+	    Tcl_AppendToObj(objPtr, "\"", 1);
+	} else {
+	    namedMask = namedPtr->mask & SVG_STYLE_OPTIONS;
+	}
+	if (namedPtr->mask & PATH_STYLE_OPTION_MATRIX) {
+	    matrixPtr = namedPtr->matrixPtr;
+	}
+    }
+    if (TkPathItemIsLite(itemPtr)) {
+	mask = 0;
+    } else {
+	if (matrixPtr == NULL) {
+	    matrixPtr = itemExPtr->style.matrixPtr;
+	}
+	mask |= itemExPtr->style.mask;
+    }
+    if (matrixPtr != NULL) {
+	Tcl_AppendToObj(objPtr, " transform=\"", -1);
+	SvgMatrix(objPtr, matrixPtr);
+	Tcl_AppendToObj(objPtr, "\"", 1);
+    }
+
+    /*
+     * A named style that isn't written as a class still takes precedence
+     * over the options of the item.
+     */
+
+    if (namedMask != 0) {
+	SvgStyleProps(objPtr, namedPtr, namedMask, 0);
+    }
+    mask &= ~namedMask;
+    if (mask & SVG_STYLE_OPTIONS) {
+	SvgStyleProps(objPtr, &itemExPtr->style, mask & SVG_STYLE_OPTIONS, 0);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgItem --
+ *
+ *	Writes an item, or a group with all its descendants.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Output may be written to the channel.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SvgItem(
+    Tcl_Interp *interp,
+    TkSvgInfo *svgPtr,
+    Tk_PathItem *itemPtr)
+{
+    enum SvgItemKind kind;
+    Tk_PathItem *childPtr;
+    Tcl_Size len;
+    int result;
+    char string[64];
+
+    kind = SvgGetKind(svgPtr, itemPtr);
+    if (kind == SVG_NONE) {
+	return TCL_OK;
+    }
+
+    /*
+     * A hidden group is still written since its children may be shown;
+     * those that are not inherit its state.
+     */
+
+    if ((kind != SVG_GROUP) && (TkPathCanvasItemState(
+	    (Tk_PathCanvas) svgPtr->canvasPtr, itemPtr) == TK_PATHSTATE_HIDDEN)) {
+	return TCL_OK;
+    }
+    if (kind == SVG_GROUP) {
+	/*
+	 * The root item carries the defaults for everything else, which
+	 * differ from those of SVG.
+	 */
+
+	SvgItemAttrs(svgPtr, itemPtr,
+		(itemPtr->parentPtr == NULL) ? SVG_STYLE_OPTIONS : 0);
+	Tcl_AppendStringsToObj(svgPtr->buffer, "<g",
+		Tcl_GetString(svgPtr->attrs), ">\n", NULL);
+	for (childPtr = itemPtr->firstChildPtr; childPtr != NULL;
+		childPtr = childPtr->nextPtr) {
+	    if (SvgItem(interp, svgPtr, childPtr) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	}
+	Tcl_AppendToObj(svgPtr->buffer, "</g>\n", 5);
+	return TCL_OK;
+    }
+    if ((itemPtr->x1 >= svgPtr->x + svgPtr->width)
+	    || (itemPtr->x2 < svgPtr->x)
+	    || (itemPtr->y1 >= svgPtr->y + svgPtr->height)
+	    || (itemPtr->y2 < svgPtr->y)) {
+	return TCL_OK;
+    }
+    switch (kind) {
+    case SVG_PTEXT:
+	result = SvgText(interp, svgPtr, itemPtr);
+	break;
+    case SVG_PIMAGE:
+	result = SvgImage(interp, svgPtr, itemPtr);
+	break;
+    default:
+	result = SvgShapes(interp, svgPtr, itemPtr, kind);
+	break;
+    }
+    if (result != TCL_OK) {
+	sprintf(string, "\n    (generating SVG for item %d)", itemPtr->id);
+	Tcl_AddErrorInfo(interp, string);
+	return TCL_ERROR;
+    }
+    Tcl_GetStringFromObj(svgPtr->buffer, &len);
+    if (len > SVG_CHUNK) {
+	SvgFlush(svgPtr);
+    }
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgShapes --
+ *
+ *	Writes the items that map onto SVG basic shapes. Items holding
+ *	many shapes become a <g> with one element per shape.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Appends to the pending output.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SvgShapes(
+    Tcl_Interp *interp,
+    TkSvgInfo *svgPtr,
+    Tk_PathItem *itemPtr,
+    enum SvgItemKind kind)
+{
+    Tcl_Obj *objPtr = svgPtr->buffer;
+    const char *element = NULL;
+    double *c = svgPtr->coords;
+    double rx = 0.0, ry = 0.0;
+    int num, numPerShape = 0, numShapes, i, j;
+
+    SvgItemAttrs(svgPtr, itemPtr, 0);
+    if (kind == SVG_PATH) {
+	if ((*itemPtr->typePtr->coordProc)(interp,
+		(Tk_PathCanvas) svgPtr->canvasPtr, itemPtr, 0, NULL) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	Tcl_AppendStringsToObj(objPtr, "<path",
+		Tcl_GetString(svgPtr->attrs), " d=\"", NULL);
+	SvgEscape(objPtr, Tcl_GetString(Tcl_GetObjResult(interp)));
+	Tcl_AppendToObj(objPtr, "\"/>\n", 4);
+	Tcl_ResetResult(interp);
+	return TCL_OK;
+    }
+    if (SvgGetCoords(interp, svgPtr, itemPtr, &num) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    c = svgPtr->coords;
+    switch (kind) {
+    case SVG_PRECT:
+	rx = SvgGetDoubleOption(interp, svgPtr, itemPtr, "-rx");
+	ry = SvgGetDoubleOption(interp, svgPtr, itemPtr, "-ry");
+	/* fall through */
+    case SVG_LRECT:
+	element = "<rect";
+	numPerShape = 4;
+	break;
+    case SVG_CIRCLE:
+	rx = SvgGetDoubleOption(interp, svgPtr, itemPtr, "-rx");
+	element = "<circle";
+	numPerShape = 2;
+	break;
+    case SVG_ELLIPSE:
+	rx = SvgGetDoubleOption(interp, svgPtr, itemPtr, "-rx");
+	ry = SvgGetDoubleOption(interp, svgPtr, itemPtr, "-ry");
+	element = "<ellipse";
+	numPerShape = 2;
+	break;
+    case SVG_LCIRCLE:
+	element = "<circle";
+	numPerShape = 3;
+	break;
+    case SVG_LELLIPSE:
+	element = "<ellipse";
+	numPerShape = 4;
+	break;
+    case SVG_PLINE:
+	element = "<line";
+	numPerShape = 4;
+	break;
+    case SVG_POLYLINE:
+    case SVG_PPOLYGON:
+	Tcl_AppendStringsToObj(objPtr,
+		(kind == SVG_POLYLINE) ? "<polyline" : "<polygon",
+		Tcl_GetString(svgPtr->attrs), " points=\"", NULL);
+	for (i = 0; i + 1 < num; i += 2) {
+	    TkPathPdfNumber(objPtr, 3, c[i], ",");
+	    TkPathPdfNumber(objPtr, 3, c[i+1], (i + 3 < num) ? " " : NULL);
+	}
+	Tcl_AppendToObj(objPtr, "\"/>\n", 4);
+	return TCL_OK;
+    default:
+	return TCL_OK;
+    }
+
+    numShapes = num / numPerShape;
+    if (numShapes == 0) {
+	return TCL_OK;
+    }
+    if (numShapes > 1) {
+	Tcl_AppendStringsToObj(objPtr, "<g", Tcl_GetString(svgPtr->attrs),
+		">\n", NULL);
+    }
+    for (i = 0, j = 0; i < numShapes; i++, j += numPerShape) {
+	Tcl_AppendToObj(objPtr, element, -1);
+	if (numShapes == 1) {
+	    Tcl_AppendObjToObj(objPtr, svgPtr->attrs);
+	}
+	switch (kind) {
+	case SVG_PRECT:
+	case SVG_LRECT:
+	    SvgNumberAttr(objPtr, " x", (c[j] < c[j+2]) ? c[j] : c[j+2]);
+	    SvgNumberAttr(objPtr, " y", (c[j+1] < c[j+3]) ? c[j+1] : c[j+3]);
+	    SvgNumberAttr(objPtr, " width", fabs(c[j+2] - c[j]));
+	    SvgNumberAttr(objPtr, " height", fabs(c[j+3] - c[j+1]));
+	    if (rx > 0.0) {
+		SvgNumberAttr(objPtr, " rx", rx);
+	    }
+	    if (ry > 0.0) {
+		SvgNumberAttr(objPtr, " ry", ry);
+	    }
+	    break;
+	case SVG_CIRCLE:
+	case SVG_LCIRCLE:
+	    SvgNumberAttr(objPtr, " cx", c[j]);
+	    SvgNumberAttr(objPtr, " cy", c[j+1]);
+	    SvgNumberAttr(objPtr, " r", (kind == SVG_LCIRCLE) ? c[j+2] : rx);
+	    break;
+	case SVG_ELLIPSE:
+	case SVG_LELLIPSE:
+	    SvgNumberAttr(objPtr, " cx", c[j]);
+	    SvgNumberAttr(objPtr, " cy", c[j+1]);
+	    SvgNumberAttr(objPtr, " rx", (kind == SVG_LELLIPSE) ? c[j+2] : rx);
+	    SvgNumberAttr(objPtr, " ry", (kind == SVG_LELLIPSE) ? c[j+3] : ry);
+	    break;
+	default:
+	    SvgNumberAttr(objPtr, " x1", c[j]);
+	    SvgNumberAttr(objPtr, " y1", c[j+1]);
+	    SvgNumberAttr(objPtr, " x2", c[j+2]);
+	    SvgNumberAttr(objPtr, " y2", c[j+3]);
+	    break;
+	}
+	Tcl_AppendToObj(objPtr, "/>\n", 3);
+    }
+    if (numShapes > 1) {
+	Tcl_AppendToObj(objPtr, "</g>\n", 5);
+    }
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgText --
+ *
+ *	Writes a ptext item as a <text> element with one <tspan> per line.
+ *	The ptext anchors map onto text-anchor and dominant-baseline; line
+ *	spacing is approximated by 1.2em.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Appends to the pending output.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SvgText(
+    Tcl_Interp *interp,
+    TkSvgInfo *svgPtr,
+    Tk_PathItem *itemPtr)
+{
+    Tcl_Obj *objPtr = svgPtr->buffer;
+    Tk_PathItemEx *itemExPtr = (Tk_PathItemEx *) itemPtr;
+    Tcl_Obj *textObj, *valueObj;
+    Tk_PathStyle style;
+    const char *text, *anchor, *p, *lineEnd;
+    const char *textAnchor = NULL, *baseline = NULL;
+    double firstLine = 0.0;
+    int num, numLines;
+
+    textObj = SvgGetOption(interp, svgPtr, itemPtr, "-text");
+    if (textObj == NULL) {
+	return TCL_OK;
+    }
+    text = Tcl_GetString(textObj);
+    if (*text == '\0') {
+	Tcl_DecrRefCount(textObj);
+	return TCL_OK;
+    }
+    if (SvgGetCoords(interp, svgPtr, itemPtr, &num) != TCL_OK) {
+	Tcl_DecrRefCount(textObj);
+	return TCL_ERROR;
+    }
+
+    /*
+     * The defaults for -fill and -stroke differ for the ptext item.
+     */
+
+    SvgItemAttrs(svgPtr, itemPtr, 0);
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    Tcl_AppendToObj(objPtr, "<text", 5);
+    Tcl_AppendObjToObj(objPtr, svgPtr->attrs);
+    if (!(style.mask & PATH_STYLE_OPTION_FILL)) {
+	SvgStyleProps(objPtr, &itemExPtr->style, PATH_STYLE_OPTION_FILL, 0);
+    }
+    if (!(style.mask & PATH_STYLE_OPTION_STROKE)) {
+	Tcl_AppendToObj(objPtr, " stroke=\"none\"", -1);
+    }
+    TkPathCanvasFreeInheritedStyle(&style);
+    SvgNumberAttr(objPtr, " x", svgPtr->coords[0]);
+    SvgNumberAttr(objPtr, " y", svgPtr->coords[1]);
+
+    valueObj = SvgGetOption(interp, svgPtr, itemPtr, "-fontfamily");
+    if (valueObj != NULL) {
+	Tcl_AppendToObj(objPtr, " font-family=\"", -1);
+	SvgEscape(objPtr, Tcl_GetString(valueObj));
+	Tcl_AppendToObj(objPtr, "\"", 1);
+	Tcl_DecrRefCount(valueObj);
+    }
+    SvgNumberAttr(objPtr, " font-size",
+	    SvgGetDoubleOption(interp, svgPtr, itemPtr, "-fontsize"));
+    valueObj = SvgGetOption(interp, svgPtr, itemPtr, "-fontslant");
+    if (valueObj != NULL) {
+	if (strcmp(Tcl_GetString(valueObj), "normal") != 0) {
+	    Tcl_AppendStringsToObj(objPtr, " font-style=\"",
+		    Tcl_GetString(valueObj), "\"", NULL);
+	}
+	Tcl_DecrRefCount(valueObj);
+    }
+    valueObj = SvgGetOption(interp, svgPtr, itemPtr, "-fontweight");
+    if (valueObj != NULL) {
+	if (strcmp(Tcl_GetString(valueObj), "bold") == 0) {
+	    Tcl_AppendToObj(objPtr, " font-weight=\"bold\"", -1);
+	}
+	Tcl_DecrRefCount(valueObj);
+    }
+
+    numLines = 1;
+    for (p = text; *p != '\0'; p++) {
+	if (*p == '\n') {
+	    numLines++;
+	}
+    }
+    valueObj = SvgGetOption(interp, svgPtr, itemPtr, "-textanchor");
+    anchor = (valueObj != NULL) ? Tcl_GetString(valueObj) : "start";
+    if ((strcmp(anchor, "middle") == 0) || (strcmp(anchor, "n") == 0)
+	    || (strcmp(anchor, "s") == 0) || (strcmp(anchor, "c") == 0)) {
+	textAnchor = "middle";
+    } else if ((strcmp(anchor, "end") == 0) || (anchor[1] == 'e')
+	    || (strcmp(anchor, "e") == 0)) {
+	textAnchor = "end";
+    }
+    if (anchor[0] == 'n') {
+	baseline = "text-before-edge";
+    } else if ((anchor[0] == 's') && (anchor[1] != 't')) {
+	baseline = "text-after-edge";
+	firstLine = -1.2 * (numLines - 1);
+    } else if ((strcmp(anchor, "w") == 0) || (strcmp(anchor, "e") == 0)
+	    || (strcmp(anchor, "c") == 0)) {
+	baseline = "central";
+	firstLine = -0.6 * (numLines - 1);
+    }
+    if (textAnchor != NULL) {
+	Tcl_AppendStringsToObj(objPtr, " text-anchor=\"", textAnchor, "\"",
+		NULL);
+    }
+    if (baseline != NULL) {
+	Tcl_AppendStringsToObj(objPtr, " dominant-baseline=\"", baseline,
+		"\"", NULL);
+    }
+    if (valueObj != NULL) {
+	Tcl_DecrRefCount(valueObj);
+    }
+    Tcl_AppendToObj(objPtr, ">", 1);
+
+    if (numLines == 1) {
+	SvgEscape(objPtr, text);
+    } else {
+	Tcl_DString ds;
+
+	Tcl_DStringInit(&ds);
+	for (p = text; ; p = lineEnd + 1) {
+	    lineEnd = strchr(p, '\n');
+	    if (lineEnd == NULL) {
+		lineEnd = p + strlen(p);
+	    }
+	    SvgNumberAttr(objPtr, "<tspan x", svgPtr->coords[0]);
+	    Tcl_AppendToObj(objPtr, " dy=\"", -1);
+	    TkPathPdfNumber(objPtr, 1, (p == text) ? firstLine : 1.2,
+		    "em\">");
+	    Tcl_DStringSetLength(&ds, 0);
+	    Tcl_DStringAppend(&ds, p, lineEnd - p);
+	    SvgEscape(objPtr, Tcl_DStringValue(&ds));
+	    Tcl_AppendToObj(objPtr, "</tspan>", -1);
+	    if (*lineEnd == '\0') {
+		break;
+	    }
+	}
+	Tcl_DStringFree(&ds);
+    }
+    Tcl_AppendToObj(objPtr, "</text>\n", -1);
+    Tcl_DecrRefCount(textObj);
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgImage --
+ *
+ *	Writes a pimage item. Each photo image is defined once, at its
+ *	first use, as an <image> element either embedding the photo as PNG
+ *	data or referring to the href returned by the -imagecommand. Every
+ *	pimage then places it with a <use> element. With -srcregion a
+ *	<pattern> of the image, which also repeats it like on screen, fills
+ *	a <rect> of the size of the region instead.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Appends to the pending output.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SvgImage(
+    Tcl_Interp *interp,
+    TkSvgInfo *svgPtr,
+    Tk_PathItem *itemPtr)
+{
+    Tcl_Obj *objPtr = svgPtr->buffer;
+    Tcl_Obj *imageObj, *matrixObj, *regionObj, **objv;
+    Tcl_HashEntry *hPtr;
+    Tk_PhotoHandle photo;
+    TMatrix matrix;
+    PathRect region;
+    const char *imageName;
+    double width, height, opacity;
+    Tcl_Size objc;
+    int iwidth, iheight, isNew, id, hasRegion = 0;
+    char string[64];
+
+    imageObj = SvgGetOption(interp, svgPtr, itemPtr, "-image");
+    if (imageObj == NULL) {
+	return TCL_OK;
+    }
+    imageName = Tcl_GetString(imageObj);
+    photo = (*imageName != '\0') ? Tk_FindPhoto(interp, imageName) : NULL;
+    if (photo == NULL) {
+	Tcl_DecrRefCount(imageObj);
+	return TCL_OK;
+    }
+    Tk_PhotoGetSize(photo, &iwidth, &iheight);
+    if ((iwidth <= 0) || (iheight <= 0)) {
+	Tcl_DecrRefCount(imageObj);
+	return TCL_OK;
+    }
+
+    hPtr = Tcl_CreateHashEntry(&svgPtr->imageTable, imageName, &isNew);
+    if (isNew) {
+	Tcl_Obj *hrefObj;
+
+	id = svgPtr->imageTable.numEntries;
+	Tcl_SetHashValue(hPtr, INT2PTR(id));
+	if (svgPtr->imageCmdObj != NULL) {
+	    Tcl_Obj *cmdObj = Tcl_DuplicateObj(svgPtr->imageCmdObj);
+
+	    Tcl_IncrRefCount(cmdObj);
+	    if (Tcl_ListObjAppendElement(interp, cmdObj, imageObj) != TCL_OK
+		    || Tcl_EvalObjEx(interp, cmdObj, TCL_EVAL_GLOBAL) != TCL_OK) {
+		Tcl_DecrRefCount(cmdObj);
+		Tcl_DecrRefCount(imageObj);
+		return TCL_ERROR;
+	    }
+	    Tcl_DecrRefCount(cmdObj);
+	    hrefObj = Tcl_GetObjResult(interp);
+	    Tcl_IncrRefCount(hrefObj);
+	} else {
+	    Tcl_Obj *dataObjv[4];
+	    const unsigned char *bytes;
+	    Tcl_Size len;
+	    int i;
+
+	    dataObjv[0] = imageObj;
+	    dataObjv[1] = Tcl_NewStringObj("data", -1);
+	    dataObjv[2] = Tcl_NewStringObj("-format", -1);
+	    dataObjv[3] = Tcl_NewStringObj("png", -1);
+	    for (i = 1; i < 4; i++) {
+		Tcl_IncrRefCount(dataObjv[i]);
+	    }
+	    if (Tcl_EvalObjv(interp, 4, dataObjv, TCL_EVAL_GLOBAL) != TCL_OK) {
+		for (i = 1; i < 4; i++) {
+		    Tcl_DecrRefCount(dataObjv[i]);
+		}
+		Tcl_DecrRefCount(imageObj);
+		return TCL_ERROR;
+	    }
+	    for (i = 1; i < 4; i++) {
+		Tcl_DecrRefCount(dataObjv[i]);
+	    }
+
+	    /*
+	     * Depending on the Tk version the PNG writer returns either the
+	     * raw file or its base64 encoding.
+	     */
+
+	    hrefObj = Tcl_NewStringObj("data:image/png;base64,", -1);
+	    Tcl_IncrRefCount(hrefObj);
+	    bytes = Tcl_GetByteArrayFromObj(Tcl_GetObjResult(interp), &len);
+	    if ((len >= 4) && (memcmp(bytes, "\211PNG", 4) == 0)) {
+		SvgBase64(hrefObj, bytes, len);
+	    } else {
+		Tcl_AppendObjToObj(hrefObj, Tcl_GetObjResult(interp));
+	    }
+	}
+	sprintf(string, "<defs><image id=\"tkpimage%d\"", id);
+	Tcl_AppendToObj(objPtr, string, -1);
+	SvgNumberAttr(objPtr, " width", iwidth);
+	SvgNumberAttr(objPtr, " height", iheight);
+	Tcl_AppendToObj(objPtr,
+		" preserveAspectRatio=\"none\" xlink:href=\"", -1);
+	SvgEscape(objPtr, Tcl_GetString(hrefObj));
+	Tcl_AppendToObj(objPtr, "\"/></defs>\n", -1);
+	Tcl_DecrRefCount(hrefObj);
+	Tcl_ResetResult(interp);
+    } else {
+	id = PTR2INT(Tcl_GetHashValue(hPtr));
+    }
+    Tcl_DecrRefCount(imageObj);
+
+    region.x1 = region.y1 = 0.0;
+    region.x2 = iwidth;
+    region.y2 = iheight;
+    regionObj = SvgGetOption(interp, svgPtr, itemPtr, "-srcregion");
+    if (regionObj != NULL) {
+	if ((Tcl_ListObjGetElements(NULL, regionObj, &objc, &objv) == TCL_OK)
+		&& (objc == 4)
+		&& (Tcl_GetDoubleFromObj(NULL, objv[0], &region.x1) == TCL_OK)
+		&& (Tcl_GetDoubleFromObj(NULL, objv[1], &region.y1) == TCL_OK)
+		&& (Tcl_GetDoubleFromObj(NULL, objv[2], &region.x2) == TCL_OK)
+		&& (Tcl_GetDoubleFromObj(NULL, objv[3], &region.y2) == TCL_OK)) {
+	    hasRegion = 1;
+	}
+	Tcl_DecrRefCount(regionObj);
+    }
+    if ((region.x2 <= region.x1) || (region.y2 <= region.y1)) {
+	return TCL_OK;
+    }
+    width = SvgGetDoubleOption(interp, svgPtr, itemPtr, "-width");
+    height = SvgGetDoubleOption(interp, svgPtr, itemPtr, "-height");
+    if (width <= 0.0) {
+	width = region.x2 - region.x1;
+    }
+    if (height <= 0.0) {
+	height = region.y2 - region.y1;
+    }
+    if (hasRegion) {
+	sprintf(string, "<defs><pattern id=\"tkpregion%d\"", itemPtr->id);
+	Tcl_AppendToObj(objPtr, string, -1);
+	Tcl_AppendToObj(objPtr, " patternUnits=\"userSpaceOnUse\"", -1);
+	SvgNumberAttr(objPtr, " x", -region.x1);
+	SvgNumberAttr(objPtr, " y", -region.y1);
+	SvgNumberAttr(objPtr, " width", iwidth);
+	SvgNumberAttr(objPtr, " height", iheight);
+	sprintf(string, "><use xlink:href=\"#tkpimage%d\"/>", id);
+	Tcl_AppendToObj(objPtr, string, -1);
+	Tcl_AppendToObj(objPtr, "</pattern></defs>\n<rect", -1);
+	SvgNumberAttr(objPtr, " width", region.x2 - region.x1);
+	SvgNumberAttr(objPtr, " height", region.y2 - region.y1);
+	sprintf(string, " fill=\"url(#tkpregion%d)\"", itemPtr->id);
+	Tcl_AppendToObj(objPtr, string, -1);
+    } else {
+	sprintf(string, "<use xlink:href=\"#tkpimage%d\"", id);
+	Tcl_AppendToObj(objPtr, string, -1);
+    }
+    opacity = SvgGetDoubleOption(interp, svgPtr, itemPtr, "-fillopacity");
+    if (opacity < 1.0) {
+	SvgNumberAttr(objPtr, " opacity", opacity);
+    }
+    Tcl_AppendToObj(objPtr, " transform=\"", -1);
+    matrixObj = SvgGetOption(interp, svgPtr, itemPtr, "-matrix");
+    if (matrixObj != NULL) {
+	if (!ObjectIsEmpty(matrixObj)
+		&& (PathGetTMatrixFromObj(NULL, matrixObj, &matrix) == TCL_OK)) {
+	    SvgMatrix(objPtr, &matrix);
+	    Tcl_AppendToObj(objPtr, " ", 1);
+	}
+	Tcl_DecrRefCount(matrixObj);
+    }
+    Tcl_AppendToObj(objPtr, "translate(", -1);
+    TkPathPdfNumber(objPtr, 3, itemPtr->bbox.x1 + SVG_PIMAGE_BBOX_OUT, " ");
+    TkPathPdfNumber(objPtr, 3, itemPtr->bbox.y1 + SVG_PIMAGE_BBOX_OUT,
+	    ") scale(");
+    TkPathPdfNumber(objPtr, 6, width / (region.x2 - region.x1), " ");
+    TkPathPdfNumber(objPtr, 6, height / (region.y2 - region.y1), ")\"/>\n");
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgBase64 --
+ *
+ *	Appends the base64 encoding of a byte sequence.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Appends to objPtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgBase64(
+    Tcl_Obj *objPtr,
+    const unsigned char *bytes,
+    Tcl_Size len)
+{
+    static const char digits[] =
+	    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char buffer[4096];
+    Tcl_Size i;
+    int n = 0;
+
+    for (i = 0; i < len; i += 3) {
+	unsigned long word = (unsigned long) bytes[i] << 16;
+
+	if (i + 1 < len) {
+	    word |= (unsigned long) bytes[i+1] << 8;
+	}
+	if (i + 2 < len) {
+	    word |= bytes[i+2];
+	}
+	buffer[n++] = digits[(word >> 18) & 0x3F];
+	buffer[n++] = digits[(word >> 12) & 0x3F];
+	buffer[n++] = (i + 1 < len) ? digits[(word >> 6) & 0x3F] : '=';
+	buffer[n++] = (i + 2 < len) ? digits[word & 0x3F] : '=';
+	if (n > (int) sizeof(buffer) - 4) {
+	    Tcl_AppendToObj(objPtr, buffer, n);
+	    n = 0;
+	}
+    }
+    Tcl_AppendToObj(objPtr, buffer, n);
+}
+
+/*
+ * Local Variables:
+ * mode: c
+ * c-basic-offset: 4
+ * fill-column: 78
+ * End:
+ */
@@ -0,0 +1,2400 @@
+/*
+ * tkpCanvSvgLoad.c --
+ *
+ *	This module provides the "loadsvg" widget command for path
+ *	canvases. It parses an SVG document into a lightweight element
+ *	tree and builds the corresponding items directly from C: groups
+ *	become group items, the basic shapes, paths, text and images become
+ *	path items and gradients canvas gradients. No Tcl command is
+ *	evaluated per element, and path data is handed to the path item as
+ *	an already split list of numbers.
+ *
+ *	Only presentation attributes and the style attribute are honoured;
+ *	style sheets, clipping, masks, filters, patterns and markers are
+ *	ignored.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#include <float.h>
+#include "tkIntPath.h"
+#include "tkpCanvas.h"
+
+/*
+ * Limits protecting against malicious or broken documents.
+ */
+
+#define SVG_MAX_NESTING	    1000
+#define SVG_MAX_USE_DEPTH   8
+#define SVG_MAX_USE_NODES   100000
+#define SVG_MAX_HREF_CHAIN  8
+
+/*
+ * The element tree produced by the parser. Names and attribute values
+ * point into the document buffer, which is modified in place.
+ */
+
+typedef struct SvgNode {
+    char *name;			/* Element name without namespace prefix,
+				 * or NULL for character data. */
+    char *text;			/* Character data, malloc'ed. */
+    int numAttrs;		/* Number of attributes. */
+    char **attrs;		/* numAttrs name/value pairs, malloc'ed. */
+    struct SvgNode *parentPtr;
+    struct SvgNode *firstChildPtr;
+    struct SvgNode *lastChildPtr;
+    struct SvgNode *nextPtr;
+} SvgNode;
+
+/*
+ * The presentation properties that are understood.
+ */
+
+enum SvgProp {
+    SVG_P_COLOR, SVG_P_DISPLAY, SVG_P_FILL, SVG_P_FILL_OPACITY,
+    SVG_P_FILL_RULE, SVG_P_FONT_FAMILY, SVG_P_FONT_SIZE, SVG_P_FONT_STYLE,
+    SVG_P_FONT_WEIGHT, SVG_P_OPACITY, SVG_P_STOP_COLOR, SVG_P_STOP_OPACITY,
+    SVG_P_STROKE, SVG_P_STROKE_DASHARRAY, SVG_P_STROKE_DASHOFFSET,
+    SVG_P_STROKE_LINECAP, SVG_P_STROKE_LINEJOIN, SVG_P_STROKE_MITERLIMIT,
+    SVG_P_STROKE_OPACITY, SVG_P_STROKE_WIDTH, SVG_P_TEXT_ANCHOR,
+    SVG_P_VISIBILITY, SVG_P_COUNT
+};
+
+static const char *svgPropNames[] = {
+    "color", "display", "fill", "fill-opacity",
+    "fill-rule", "font-family", "font-size", "font-style",
+    "font-weight", "opacity", "stop-color", "stop-opacity",
+    "stroke", "stroke-dasharray", "stroke-dashoffset",
+    "stroke-linecap", "stroke-linejoin", "stroke-miterlimit",
+    "stroke-opacity", "stroke-width", "text-anchor",
+    "visibility", NULL
+};
+
+/*
+ * The elements that produce items. All others are skipped together with
+ * their content.
+ */
+
+enum SvgElement {
+    SVG_E_A, SVG_E_CIRCLE, SVG_E_ELLIPSE, SVG_E_G, SVG_E_IMAGE, SVG_E_LINE,
+    SVG_E_PATH, SVG_E_POLYGON, SVG_E_POLYLINE, SVG_E_RECT, SVG_E_SVG,
+    SVG_E_SWITCH, SVG_E_SYMBOL, SVG_E_TEXT, SVG_E_USE
+};
+
+static const char *svgElementNames[] = {
+    "a", "circle", "ellipse", "g", "image", "line",
+    "path", "polygon", "polyline", "rect", "svg",
+    "switch", "symbol", "text", "use", NULL
+};
+
+/*
+ * Inherited state that has no counterpart in the group options of the
+ * canvas, or that is needed while building. It is applied to the leaf
+ * items themselves.
+ */
+
+typedef struct SvgState {
+    double opacity;		/* Product of all group opacities. */
+    double fillOpacity;
+    double strokeOpacity;
+    const char *color;		/* Value of currentColor. */
+    const char *fontFamily;
+    double fontSize;
+    int bold;
+    const char *fontSlant;
+    const char *textAnchor;
+    int hidden;			/* Non-zero for visibility: hidden. */
+} SvgState;
+
+/*
+ * A gradient reference resolves to the canvas gradient and the color of
+ * its first stop, which stands in where gradients can't be used.
+ */
+
+typedef struct SvgPaint {
+    Tcl_Obj *gradientObj;	/* Gradient name, or NULL. */
+    Tcl_Obj *colorObj;		/* Fallback color. */
+} SvgPaint;
+
+/*
+ * One of the following structures is created to keep track of a document
+ * being loaded.
+ */
+
+typedef struct TkSvgLoadInfo {
+    Tcl_Interp *interp;
+    TkPathCanvas *canvasPtr;
+    char *data;			/* The document, malloc'ed. */
+    SvgNode *rootPtr;		/* The outermost element. */
+    Tcl_Obj *dirObj;		/* Directory of the file for relative image
+				 * references, or NULL. */
+    Tcl_Obj *tagsObj;		/* Tags for all items created, or NULL. */
+    Tcl_HashTable idTable;	/* Maps id attributes to nodes. */
+    Tcl_HashTable paintTable;	/* Maps gradient ids to their SvgPaint. */
+    SvgNode *useTargetPtr;	/* Element referenced by the <use> being
+				 * built, which may be a <symbol>. */
+    int useDepth;		/* Nesting of <use> elements. */
+    int numUseNodes;		/* Elements built for <use> elements so
+				 * far, which nesting can multiply. */
+    Tcl_Obj **objv;		/* Arguments for the item being created. */
+    int objc;
+    int maxObjc;
+} TkSvgLoadInfo;
+
+/*
+ * Flags for SvgAddStyle.
+ */
+
+#define SVG_STYLE_PAINT	    (1 << 0)
+#define SVG_STYLE_OPACITY   (1 << 1)
+
+/*
+ * Forward declarations for functions defined later in this file:
+ */
+
+static int		SvgParse(Tcl_Interp *interp, TkSvgLoadInfo *infoPtr);
+static void		SvgLinkNode(SvgNode *parentPtr, SvgNode *nodePtr);
+static void		SvgAddText(SvgNode *parentPtr, const char *start,
+			    int len, int decode);
+static void		SvgDecode(char *start, char *end);
+static void		SvgFreeNode(SvgNode *nodePtr);
+static const char *	SvgAttr(SvgNode *nodePtr, const char *name);
+static const char *	SvgHref(SvgNode *nodePtr);
+static void		SvgIndexIds(TkSvgLoadInfo *infoPtr, SvgNode *nodePtr);
+static void		SvgGetProps(SvgNode *nodePtr, const char **props,
+			    Tcl_DString *dsPtr);
+static void		SvgUpdateState(const char **props, SvgState *statePtr,
+			    Tcl_DString *familyPtr);
+static int		SvgNumber(const char **pp, double *dPtr);
+static double		SvgLength(const char *value, double def,
+			    double fontSize);
+static double		SvgFraction(const char *value, double def);
+static void		SvgMulMatrix(TMatrix *mPtr, TMatrix *tPtr);
+static int		SvgParseTransform(const char *value, TMatrix *mPtr);
+static Tcl_Obj *	SvgColorObj(TkSvgLoadInfo *infoPtr, const char *value,
+			    SvgState *statePtr);
+static Tcl_Obj *	SvgPaintObj(TkSvgLoadInfo *infoPtr, const char *value,
+			    SvgState *statePtr, int isFill);
+static SvgPaint *	SvgGetPaint(TkSvgLoadInfo *infoPtr, const char *id);
+static Tcl_Obj *	SvgPathData(const char *d);
+static Tcl_Obj *	SvgPoints(const char *points);
+static void		SvgAddObj(TkSvgLoadInfo *infoPtr, Tcl_Obj *objPtr);
+static void		SvgAddArg(TkSvgLoadInfo *infoPtr, const char *option,
+			    Tcl_Obj *valueObj);
+static void		SvgAddStyle(TkSvgLoadInfo *infoPtr, SvgNode *nodePtr,
+			    const char **props, SvgState *statePtr,
+			    TMatrix *extraPtr, int flags);
+static int		SvgCreate(TkSvgLoadInfo *infoPtr,
+			    const char *typeName, Tk_PathItem **itemPtrPtr);
+static int		SvgBuildChildren(TkSvgLoadInfo *infoPtr,
+			    SvgNode *nodePtr, Tcl_Obj *parentObj,
+			    SvgState *statePtr);
+static int		SvgBuild(TkSvgLoadInfo *infoPtr, SvgNode *nodePtr,
+			    Tcl_Obj *parentObj, SvgState *statePtr);
+static Tcl_Obj *	SvgImage(TkSvgLoadInfo *infoPtr, SvgNode *nodePtr);
+static void		SvgTextContent(SvgNode *nodePtr, Tcl_DString *dsPtr);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkpCanvLoadSvgCmd --
+ *
+ *	This function is invoked to process the "loadsvg" options of the
+ *	widget command for canvas widgets:
+ *
+ *	    pathName loadsvg ?-data string? ?-file fileName?
+ *		    ?-parent tagOrId? ?-tags tagList?
+ *
+ * Results:
+ *	A standard Tcl result. The id of the group holding the document
+ *	is left in the interp's result.
+ *
+ * Side effects:
+ *	Items, gradients and photo images are created. Nothing is left
+ *	behind on errors, except gradients and images.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkpCanvLoadSvgCmd(
+    TkPathCanvas *canvasPtr,	/* Information about canvas widget. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument strings. Caller has already parsed
+				 * this command enough to know that argv[1] is
+				 * "loadsvg". */
+{
+    TkSvgLoadInfo info;
+    Tk_PathItem *parentPtr = canvasPtr->rootItemPtr;
+    Tk_PathItem *groupPtr = NULL;
+    Tcl_Obj *dataObj = NULL, *fileObj = NULL, *parentObj;
+    Tcl_HashSearch search;
+    Tcl_HashEntry *hPtr;
+    Tcl_DString ds, family;
+    SvgState state;
+    TMatrix matrix = kPathUnitTMatrix;
+    const char *props[SVG_P_COUNT];
+    const char *value;
+    const char *bytes;
+    Tcl_Size len;
+    int i, index, result = TCL_ERROR;
+    static const char *optionStrings[] = {
+	"-data", "-file", "-parent", "-tags", NULL
+    };
+    enum options {
+	SVG_DATA, SVG_FILE, SVG_PARENT, SVG_TAGS
+    };
+
+    memset(&info, 0, sizeof(info));
+    info.interp = interp;
+    info.canvasPtr = canvasPtr;
+    Tcl_InitHashTable(&info.idTable, TCL_STRING_KEYS);
+    Tcl_InitHashTable(&info.paintTable, TCL_STRING_KEYS);
+    Tcl_DStringInit(&ds);
+    Tcl_DStringInit(&family);
+
+    if ((objc < 4) || (objc & 1)) {
+	Tcl_WrongNumArgs(interp, 2, objv, "?-data string? ?-file fileName?"
+		" ?-parent tagOrId? ?-tags tagList?");
+	goto cleanup;
+    }
+    for (i = 2; i < objc; i += 2) {
+	if (Tcl_GetIndexFromObj(interp, objv[i], optionStrings, "option", 0,
+		&index) != TCL_OK) {
+	    goto cleanup;
+	}
+	switch ((enum options) index) {
+	case SVG_DATA:
+	    dataObj = objv[i+1];
+	    break;
+	case SVG_FILE:
+	    fileObj = objv[i+1];
+	    break;
+	case SVG_PARENT:
+	    if (TkPathCanvasFindGroup(interp, (Tk_PathCanvas) canvasPtr,
+		    objv[i+1], &parentPtr) != TCL_OK) {
+		goto cleanup;
+	    }
+	    break;
+	case SVG_TAGS:
+	    info.tagsObj = objv[i+1];
+	    break;
+	}
+    }
+    if ((dataObj == NULL) == (fileObj == NULL)) {
+	Tcl_AppendResult(interp, "must specify exactly one of -data and -file",
+		NULL);
+	goto cleanup;
+    }
+
+    /*
+     * Read the document into a private buffer which the parser modifies
+     * in place.
+     */
+
+    if (fileObj != NULL) {
+	Tcl_Channel chan;
+	Tcl_Obj *partsObj;
+	Tcl_Size numParts;
+
+	if (Tcl_IsSafe(interp)) {
+	    Tcl_AppendResult(interp, "can't specify -file in a",
+		    " safe interpreter", NULL);
+	    goto cleanup;
+	}
+	chan = Tcl_FSOpenFileChannel(interp, fileObj, "r", 0);
+	if (chan == NULL) {
+	    goto cleanup;
+	}
+	Tcl_SetChannelOption(NULL, chan, "-encoding", "utf-8");
+	dataObj = Tcl_NewObj();
+	Tcl_IncrRefCount(dataObj);
+	if (Tcl_ReadChars(chan, dataObj, -1, 0) < 0) {
+	    Tcl_AppendResult(interp, "error reading \"",
+		    Tcl_GetString(fileObj), "\": ", Tcl_PosixError(interp),
+		    NULL);
+	    Tcl_Close(NULL, chan);
+	    Tcl_DecrRefCount(dataObj);
+	    goto cleanup;
+	}
+	Tcl_Close(NULL, chan);
+	bytes = Tcl_GetStringFromObj(dataObj, &len);
+	info.data = ckalloc(len + 1);
+	memcpy(info.data, bytes, len + 1);
+	Tcl_DecrRefCount(dataObj);
+
+	partsObj = Tcl_FSSplitPath(fileObj, &numParts);
+	Tcl_IncrRefCount(partsObj);
+	if (numParts > 1) {
+	    info.dirObj = Tcl_FSJoinPath(partsObj, numParts - 1);
+	    Tcl_IncrRefCount(info.dirObj);
+	}
+	Tcl_DecrRefCount(partsObj);
+    } else {
+	bytes = Tcl_GetStringFromObj(dataObj, &len);
+	info.data = ckalloc(len + 1);
+	memcpy(info.data, bytes, len + 1);
+    }
+
+    if (SvgParse(interp, &info) != TCL_OK) {
+	goto cleanup;
+    }
+    if ((info.rootPtr == NULL) || (strcmp(info.rootPtr->name, "svg") != 0)) {
+	Tcl_AppendResult(interp, "not an SVG document", NULL);
+	goto cleanup;
+    }
+    SvgIndexIds(&info, info.rootPtr);
+
+    /*
+     * The outermost group establishes the SVG defaults, which differ from
+     * those of the canvas, and maps the viewBox onto the document size.
+     */
+
+    value = SvgAttr(info.rootPtr, "viewBox");
+    if (value != NULL) {
+	double vb[4], w, h, sx, sy;
+
+	for (i = 0; i < 4; i++) {
+	    if (!SvgNumber(&value, vb + i)) {
+		break;
+	    }
+	}
+	if ((i == 4) && (vb[2] > 0.0) && (vb[3] > 0.0)) {
+	    w = SvgLength(SvgAttr(info.rootPtr, "width"), vb[2], 16.0);
+	    h = SvgLength(SvgAttr(info.rootPtr, "height"), vb[3], 16.0);
+	    sx = w / vb[2];
+	    sy = h / vb[3];
+	    value = SvgAttr(info.rootPtr, "preserveAspectRatio");
+	    if ((value == NULL) || (strncmp(value, "none", 4) != 0)) {
+		sx = sy = (sx < sy) ? sx : sy;
+	    }
+	    matrix.a = sx;
+	    matrix.d = sy;
+	    matrix.tx = (w - vb[2] * sx) / 2.0 - vb[0] * sx;
+	    matrix.ty = (h - vb[3] * sy) / 2.0 - vb[1] * sy;
+	}
+    }
+    state.opacity = 1.0;
+    state.fillOpacity = 1.0;
+    state.strokeOpacity = 1.0;
+    state.color = "black";
+    state.fontFamily = "Helvetica";
+    state.fontSize = 16.0;
+    state.bold = 0;
+    state.fontSlant = "normal";
+    state.textAnchor = "start";
+    state.hidden = 0;
+    SvgGetProps(info.rootPtr, props, &ds);
+    SvgUpdateState(props, &state, &family);
+
+    SvgAddArg(&info, "-parent", Tcl_NewIntObj(parentPtr->id));
+    SvgAddArg(&info, "-fill", Tcl_NewStringObj("black", -1));
+    SvgAddArg(&info, "-fillrule", Tcl_NewStringObj("nonzero", -1));
+    SvgAddArg(&info, "-stroke", Tcl_NewObj());
+    SvgAddArg(&info, "-strokewidth", Tcl_NewDoubleObj(1.0));
+    SvgAddArg(&info, "-strokelinecap", Tcl_NewStringObj("butt", -1));
+    SvgAddArg(&info, "-strokelinejoin", Tcl_NewStringObj("miter", -1));
+    SvgAddArg(&info, "-strokemiterlimit", Tcl_NewDoubleObj(4.0));
+    SvgAddArg(&info, "-matrix", PathNewTMatrixObj(&matrix));
+    SvgAddStyle(&info, info.rootPtr, props, &state, NULL, SVG_STYLE_PAINT);
+    if (SvgCreate(&info, "group", &groupPtr) != TCL_OK) {
+	goto cleanup;
+    }
+    parentObj = Tcl_NewIntObj(groupPtr->id);
+    Tcl_IncrRefCount(parentObj);
+    result = SvgBuildChildren(&info, info.rootPtr, parentObj, &state);
+    Tcl_DecrRefCount(parentObj);
+    if (result != TCL_OK) {
+	TkPathCanvasDeleteItem(canvasPtr, groupPtr);
+	goto cleanup;
+    }
+    Tcl_SetObjResult(interp, Tcl_NewIntObj(groupPtr->id));
+
+  cleanup:
+    for (hPtr = Tcl_FirstHashEntry(&info.paintTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	SvgPaint *paintPtr = (SvgPaint *) Tcl_GetHashValue(hPtr);
+
+	if (paintPtr != NULL) {
+	    if (paintPtr->gradientObj != NULL) {
+		Tcl_DecrRefCount(paintPtr->gradientObj);
+	    }
+	    Tcl_DecrRefCount(paintPtr->colorObj);
+	    ckfree((char *) paintPtr);
+	}
+    }
+    Tcl_DeleteHashTable(&info.paintTable);
+    Tcl_DeleteHashTable(&info.idTable);
+    for (i = 0; i < info.objc; i++) {
+	Tcl_DecrRefCount(info.objv[i]);
+    }
+    if (info.objv != NULL) {
+	ckfree((char *) info.objv);
+    }
+    if (info.rootPtr != NULL) {
+	SvgFreeNode(info.rootPtr);
+    }
+    if (info.dirObj != NULL) {
+	Tcl_DecrRefCount(info.dirObj);
+    }
+    if (info.data != NULL) {
+	ckfree(info.data);
+    }
+    Tcl_DStringFree(&ds);
+    Tcl_DStringFree(&family);
+    return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgParse --
+ *
+ *	A small non-validating XML parser building the element tree.
+ *	Comments, processing instructions and the document type
+ *	declaration are skipped; character data is only kept inside text
+ *	elements. Parsing stops at the end of the outermost element.
+ *
+ * Results:
+ *	A standard Tcl result. The tree is stored in infoPtr->rootPtr.
+ *
+ * Side effects:
+ *	The document buffer is modified.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SvgParse(
+    Tcl_Interp *interp,
+    TkSvgLoadInfo *infoPtr)
+{
+    char *p = infoPtr->data;
+    char *q, *name = NULL;
+    SvgNode *currentPtr = NULL, *nodePtr;
+    char **attrs = NULL;
+    int maxAttrs = 0, numAttrs, depth = 0, isText;
+    char c;
+
+    while (*p != '\0') {
+	isText = (currentPtr != NULL)
+		&& ((strcmp(currentPtr->name, "text") == 0)
+		|| (strcmp(currentPtr->name, "tspan") == 0));
+	if (*p != '<') {
+	    q = strchr(p, '<');
+	    if (q == NULL) {
+		q = p + strlen(p);
+	    }
+	    if (isText) {
+		SvgAddText(currentPtr, p, q - p, 1);
+	    }
+	    p = q;
+	    continue;
+	}
+	if (strncmp(p, "<!--", 4) == 0) {
+	    q = strstr(p + 4, "-->");
+	    p = (q == NULL) ? p + strlen(p) : q + 3;
+	    continue;
+	}
+	if (strncmp(p, "<![CDATA[", 9) == 0) {
+	    p += 9;
+	    q = strstr(p, "]]>");
+	    if (q == NULL) {
+		q = p + strlen(p);
+	    }
+	    if (isText) {
+		SvgAddText(currentPtr, p, q - p, 0);
+	    }
+	    p = (*q == '\0') ? q : q + 3;
+	    continue;
+	}
+	if ((p[1] == '?') || (p[1] == '!')) {
+	    int bracket = 0;
+
+	    for (p++; *p != '\0'; p++) {
+		if (*p == '[') {
+		    bracket++;
+		} else if (*p == ']') {
+		    bracket--;
+		} else if ((*p == '>') && (bracket <= 0)) {
+		    p++;
+		    break;
+		}
+	    }
+	    continue;
+	}
+	if (p[1] == '/') {
+	    q = strchr(p, '>');
+	    p = (q == NULL) ? p + strlen(p) : q + 1;
+	    if (currentPtr != NULL) {
+		currentPtr = currentPtr->parentPtr;
+		depth--;
+		if (currentPtr == NULL) {
+		    break;
+		}
+	    }
+	    continue;
+	}
+
+	/*
+	 * A start tag. Names and values are terminated in place.
+	 */
+
+	name = ++p;
+	while ((*p != '\0') && !isspace(UCHAR(*p)) && (*p != '/')
+		&& (*p != '>')) {
+	    p++;
+	}
+	c = *p;
+	*p = '\0';
+	if (c != '\0') {
+	    p++;
+	}
+	if (*name == '\0') {
+	    goto syntaxError;
+	}
+	q = strchr(name, ':');
+	if (q != NULL) {
+	    name = q + 1;
+	}
+	numAttrs = 0;
+	while (isspace(UCHAR(c))) {
+	    char *attrName, *value, quote;
+
+	    while (isspace(UCHAR(*p))) {
+		p++;
+	    }
+	    if ((*p == '>') || (*p == '/') || (*p == '\0')) {
+		c = *p;
+		if (c != '\0') {
+		    p++;
+		}
+		break;
+	    }
+	    attrName = p;
+	    while ((*p != '\0') && (*p != '=') && !isspace(UCHAR(*p))
+		    && (*p != '>')) {
+		p++;
+	    }
+	    q = p;
+	    while (isspace(UCHAR(*p))) {
+		p++;
+	    }
+	    if (*p != '=') {
+		goto syntaxError;
+	    }
+	    *q = '\0';
+	    p++;
+	    while (isspace(UCHAR(*p))) {
+		p++;
+	    }
+	    quote = *p;
+	    if ((quote != '"') && (quote != '\'')) {
+		goto syntaxError;
+	    }
+	    value = ++p;
+	    q = strchr(p, quote);
+	    if (q == NULL) {
+		goto syntaxError;
+	    }
+	    SvgDecode(value, q);
+	    p = q + 1;
+	    if (numAttrs + 2 > maxAttrs) {
+		maxAttrs = 2 * maxAttrs + 16;
+		attrs = (char **) ckrealloc((char *) attrs,
+			maxAttrs * sizeof(char *));
+	    }
+	    attrs[numAttrs++] = attrName;
+	    attrs[numAttrs++] = value;
+	    c = ' ';
+	}
+	if (c == '/') {
+	    while ((*p != '\0') && (*p != '>')) {
+		p++;
+	    }
+	    if (*p != '\0') {
+		p++;
+	    }
+	}
+
+	nodePtr = (SvgNode *) ckalloc(sizeof(SvgNode));
+	memset(nodePtr, 0, sizeof(SvgNode));
+	nodePtr->name = name;
+	nodePtr->numAttrs = numAttrs / 2;
+	if (numAttrs > 0) {
+	    nodePtr->attrs = (char **) ckalloc(numAttrs * sizeof(char *));
+	    memcpy(nodePtr->attrs, attrs, numAttrs * sizeof(char *));
+	}
+	if (currentPtr == NULL) {
+	    infoPtr->rootPtr = nodePtr;
+	} else {
+	    SvgLinkNode(currentPtr, nodePtr);
+	}
+	if (c != '/') {
+	    if (++depth > SVG_MAX_NESTING) {
+		Tcl_AppendResult(interp, "SVG elements nested too deeply",
+			NULL);
+		goto error;
+	    }
+	    currentPtr = nodePtr;
+	} else if (currentPtr == NULL) {
+	    break;
+	}
+    }
+    if (attrs != NULL) {
+	ckfree((char *) attrs);
+    }
+    return TCL_OK;
+
+  syntaxError:
+    Tcl_AppendResult(interp, "syntax error in SVG element \"", name, "\"",
+	    NULL);
+  error:
+    if (attrs != NULL) {
+	ckfree((char *) attrs);
+    }
+    return TCL_ERROR;
+}
+
+static void
+SvgLinkNode(
+    SvgNode *parentPtr,
+    SvgNode *nodePtr)
+{
+    nodePtr->parentPtr = parentPtr;
+    if (parentPtr->lastChildPtr == NULL) {
+	parentPtr->firstChildPtr = nodePtr;
+    } else {
+	parentPtr->lastChildPtr->nextPtr = nodePtr;
+    }
+    parentPtr->lastChildPtr = nodePtr;
+}
+
+static void
+SvgAddText(
+    SvgNode *parentPtr,
+    const char *start,
+    int len,
+    int decode)
+{
+    SvgNode *nodePtr = (SvgNode *) ckalloc(sizeof(SvgNode));
+
+    memset(nodePtr, 0, sizeof(SvgNode));
+    nodePtr->text = ckalloc(len + 1);
+    memcpy(nodePtr->text, start, len);
+    nodePtr->text[len] = '\0';
+    if (decode) {
+	SvgDecode(nodePtr->text, nodePtr->text + len);
+    }
+    SvgLinkNode(parentPtr, nodePtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgDecode --
+ *
+ *	Replaces entity and character references between start and end
+ *	by the characters they stand for. The result is never longer.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The string is modified in place and NUL terminated.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgDecode(
+    char *start,
+    char *end)
+{
+    char *p = start, *q = start, *semi;
+    char buffer[TCL_UTF_MAX];
+    long ch;
+    int len;
+
+    while (p < end) {
+	if ((*p != '&')
+		|| ((semi = (char *) memchr(p, ';', end - p)) == NULL)) {
+	    *q++ = *p++;
+	    continue;
+	}
+	ch = -1;
+	if (p[1] == '#') {
+	    ch = (p[2] == 'x') ? strtol(p + 3, NULL, 16)
+		    : strtol(p + 2, NULL, 10);
+	} else if (strncmp(p, "&lt;", 4) == 0) {
+	    ch = '<';
+	} else if (strncmp(p, "&gt;", 4) == 0) {
+	    ch = '>';
+	} else if (strncmp(p, "&amp;", 5) == 0) {
+	    ch = '&';
+	} else if (strncmp(p, "&quot;", 6) == 0) {
+	    ch = '"';
+	} else if (strncmp(p, "&apos;", 6) == 0) {
+	    ch = '\'';
+	}
+	if ((ch <= 0) || (ch > 0xFFFF)) {
+	    *q++ = *p++;
+	    continue;
+	}
+	len = Tcl_UniCharToUtf((int) ch, buffer);
+	memcpy(q, buffer, len);
+	q += len;
+	p = semi + 1;
+    }
+    *q = '\0';
+}
+
+static void
+SvgFreeNode(
+    SvgNode *nodePtr)
+{
+    SvgNode *childPtr, *nextPtr;
+
+    for (childPtr = nodePtr->firstChildPtr; childPtr != NULL;
+	    childPtr = nextPtr) {
+	nextPtr = childPtr->nextPtr;
+	SvgFreeNode(childPtr);
+    }
+    if (nodePtr->attrs != NULL) {
+	ckfree((char *) nodePtr->attrs);
+    }
+    if (nodePtr->text != NULL) {
+	ckfree(nodePtr->text);
+    }
+    ckfree((char *) nodePtr);
+}
+
+static const char *
+SvgAttr(
+    SvgNode *nodePtr,
+    const char *name)
+{
+    int i;
+
+    for (i = 0; i < nodePtr->numAttrs; i++) {
+	if (strcmp(nodePtr->attrs[2*i], name) == 0) {
+	    return nodePtr->attrs[2*i+1];
+	}
+    }
+    return NULL;
+}
+
+/*
+ * Returns the id referenced by a local xlink:href or href, without
+ * the '#'.
+ */
+
+static const char *
+SvgHref(
+    SvgNode *nodePtr)
+{
+    const char *value = SvgAttr(nodePtr, "xlink:href");
+
+    if (value == NULL) {
+	value = SvgAttr(nodePtr, "href");
+    }
+    if ((value == NULL) || (value[0] != '#')) {
+	return NULL;
+    }
+    return value + 1;
+}
+
+static void
+SvgIndexIds(
+    TkSvgLoadInfo *infoPtr,
+    SvgNode *nodePtr)
+{
+    SvgNode *childPtr;
+    const char *id;
+    int isNew;
+
+    if (nodePtr->name == NULL) {
+	return;
+    }
+    id = SvgAttr(nodePtr, "id");
+    if (id != NULL) {
+	Tcl_HashEntry *hPtr = Tcl_CreateHashEntry(&infoPtr->idTable, id,
+		&isNew);
+
+	if (isNew) {
+	    Tcl_SetHashValue(hPtr, nodePtr);
+	}
+    }
+    for (childPtr = nodePtr->firstChildPtr; childPtr != NULL;
+	    childPtr = childPtr->nextPtr) {
+	SvgIndexIds(infoPtr, childPtr);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgGetProps --
+ *
+ *	Collects the presentation properties of an element. Declarations
+ *	in the style attribute override presentation attributes.
+ *
+ * Results:
+ *	props is filled in, with NULL for properties not given.
+ *
+ * Side effects:
+ *	The style attribute is copied into dsPtr, which the values may
+ *	point into.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgGetProps(
+    SvgNode *nodePtr,
+    const char **props,
+    Tcl_DString *dsPtr)
+{
+    const char *style = NULL;
+    char *p, *decl, *value, *end;
+    int i, index;
+
+    for (index = 0; index < SVG_P_COUNT; index++) {
+	props[index] = NULL;
+    }
+    for (i = 0; i < nodePtr->numAttrs; i++) {
+	const char *name = nodePtr->attrs[2*i];
+
+	if (strcmp(name, "style") == 0) {
+	    style = nodePtr->attrs[2*i+1];
+	    continue;
+	}
+	for (index = 0; svgPropNames[index] != NULL; index++) {
+	    if (strcmp(name, svgPropNames[index]) == 0) {
+		props[index] = nodePtr->attrs[2*i+1];
+		break;
+	    }
+	}
+    }
+    if (style == NULL) {
+	return;
+    }
+    Tcl_DStringAppend(dsPtr, style, -1);
+    for (p = Tcl_DStringValue(dsPtr); *p != '\0'; ) {
+	decl = p;
+	while ((*p != '\0') && (*p != ';')) {
+	    p++;
+	}
+	if (*p != '\0') {
+	    *p++ = '\0';
+	}
+	value = strchr(decl, ':');
+	if (value == NULL) {
+	    continue;
+	}
+	*value++ = '\0';
+	while (isspace(UCHAR(*decl))) {
+	    decl++;
+	}
+	for (end = decl + strlen(decl); (end > decl)
+		&& isspace(UCHAR(end[-1])); end--) {
+	    end[-1] = '\0';
+	}
+	while (isspace(UCHAR(*value))) {
+	    value++;
+	}
+	for (end = value + strlen(value); (end > value)
+		&& isspace(UCHAR(end[-1])); end--) {
+	    end[-1] = '\0';
+	}
+	for (index = 0; svgPropNames[index] != NULL; index++) {
+	    if (strcmp(decl, svgPropNames[index]) == 0) {
+		props[index] = value;
+		break;
+	    }
+	}
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgUpdateState --
+ *
+ *	Applies the inherited properties of an element to the state
+ *	copied from its parent.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The font family may be copied into familyPtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgUpdateState(
+    const char **props,
+    SvgState *statePtr,
+    Tcl_DString *familyPtr)
+{
+    const char *value, *end;
+    double d;
+
+    if (props[SVG_P_OPACITY] != NULL) {
+	d = SvgFraction(props[SVG_P_OPACITY], 1.0);
+	statePtr->opacity *= (d < 0.0) ? 0.0 : (d > 1.0) ? 1.0 : d;
+    }
+    if (props[SVG_P_FILL_OPACITY] != NULL) {
+	d = SvgFraction(props[SVG_P_FILL_OPACITY], statePtr->fillOpacity);
+	statePtr->fillOpacity = (d < 0.0) ? 0.0 : (d > 1.0) ? 1.0 : d;
+    }
+    if (props[SVG_P_STROKE_OPACITY] != NULL) {
+	d = SvgFraction(props[SVG_P_STROKE_OPACITY], statePtr->strokeOpacity);
+	statePtr->strokeOpacity = (d < 0.0) ? 0.0 : (d > 1.0) ? 1.0 : d;
+    }
+    if ((props[SVG_P_COLOR] != NULL)
+	    && (strcmp(props[SVG_P_COLOR], "inherit") != 0)) {
+	statePtr->color = props[SVG_P_COLOR];
+    }
+    value = props[SVG_P_FONT_FAMILY];
+    if (value != NULL) {
+	while (isspace(UCHAR(*value)) || (*value == '"') || (*value == '\'')) {
+	    value++;
+	}
+	for (end = value; (*end != '\0') && (*end != ','); end++) {
+	    /* empty */
+	}
+	while ((end > value) && (isspace(UCHAR(end[-1])) || (end[-1] == '"')
+		|| (end[-1] == '\''))) {
+	    end--;
+	}
+	if ((end > value) && (strncmp(value, "inherit", end - value) != 0)) {
+	    Tcl_DStringSetLength(familyPtr, 0);
+	    Tcl_DStringAppend(familyPtr, value, end - value);
+	    value = Tcl_DStringValue(familyPtr);
+	    if (strcmp(value, "serif") == 0) {
+		value = "Times";
+	    } else if (strcmp(value, "sans-serif") == 0) {
+		value = "Helvetica";
+	    } else if (strcmp(value, "monospace") == 0) {
+		value = "Courier";
+	    }
+	    statePtr->fontFamily = value;
+	}
+    }
+    if (props[SVG_P_FONT_SIZE] != NULL) {
+	d = SvgLength(props[SVG_P_FONT_SIZE], statePtr->fontSize,
+		statePtr->fontSize);
+	if (d > 0.0) {
+	    statePtr->fontSize = d;
+	}
+    }
+    value = props[SVG_P_FONT_WEIGHT];
+    if (value != NULL) {
+	if ((strcmp(value, "bold") == 0) || (strcmp(value, "bolder") == 0)) {
+	    statePtr->bold = 1;
+	} else if (isdigit(UCHAR(*value))) {
+	    statePtr->bold = (atoi(value) >= 600);
+	} else if (strcmp(value, "inherit") != 0) {
+	    statePtr->bold = 0;
+	}
+    }
+    value = props[SVG_P_FONT_STYLE];
+    if (value != NULL) {
+	if (strcmp(value, "italic") == 0) {
+	    statePtr->fontSlant = "italic";
+	} else if (strcmp(value, "oblique") == 0) {
+	    statePtr->fontSlant = "oblique";
+	} else if (strcmp(value, "normal") == 0) {
+	    statePtr->fontSlant = "normal";
+	}
+    }
+    value = props[SVG_P_TEXT_ANCHOR];
+    if (value != NULL) {
+	if (strcmp(value, "middle") == 0) {
+	    statePtr->textAnchor = "middle";
+	} else if (strcmp(value, "end") == 0) {
+	    statePtr->textAnchor = "end";
+	} else if (strcmp(value, "start") == 0) {
+	    statePtr->textAnchor = "start";
+	}
+    }
+    value = props[SVG_P_VISIBILITY];
+    if (value != NULL) {
+	if ((strcmp(value, "hidden") == 0)
+		|| (strcmp(value, "collapse") == 0)) {
+	    statePtr->hidden = 1;
+	} else if (strcmp(value, "visible") == 0) {
+	    statePtr->hidden = 0;
+	}
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgNumber --
+ *
+ *	Scans the next number of a list separated by white space and/or
+ *	commas, as used in path data, points and transforms. Only the SVG
+ *	number syntax is accepted, not what else strtod() knows such as
+ *	"inf", "nan" or hexadecimal numbers, and the value must be finite.
+ *
+ * Results:
+ *	1 if a number was found, else 0.
+ *
+ * Side effects:
+ *	*pp is advanced past the number.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SvgNumber(
+    const char **pp,
+    double *dPtr)
+{
+    const char *p = *pp, *q, *e;
+    char *end;
+    int numDigits = 0;
+    double d;
+
+    while (isspace(UCHAR(*p)) || (*p == ',')) {
+	p++;
+    }
+    *pp = p;
+    q = p;
+    if ((*q == '+') || (*q == '-')) {
+	q++;
+    }
+    for (; isdigit(UCHAR(*q)); q++) {
+	numDigits++;
+    }
+    if (*q == '.') {
+	for (q++; isdigit(UCHAR(*q)); q++) {
+	    numDigits++;
+	}
+    }
+    if (numDigits == 0) {
+	return 0;
+    }
+    if ((*q == 'e') || (*q == 'E')) {
+	e = q + 1;
+	if ((*e == '+') || (*e == '-')) {
+	    e++;
+	}
+	if (isdigit(UCHAR(*e))) {
+	    for (q = e; isdigit(UCHAR(*q)); q++) {
+		/* Empty. */
+	    }
+	}
+    }
+
+    /*
+     * What has been scanned is a decimal number which strtod() reads the
+     * same way, unless it is followed by more that strtod() knows, like
+     * the "x10" of "0x10".
+     */
+
+    d = strtod(p, &end);
+    if ((end != q) || (d > DBL_MAX) || (d < -DBL_MAX)) {
+	return 0;
+    }
+    *dPtr = d;
+    *pp = end;
+    return 1;
+}
+
+/*
+ * Converts a length with an optional unit to pixels. Percentages are not
+ * supported and give the default.
+ */
+
+static double
+SvgLength(
+    const char *value,
+    double def,
+    double fontSize)
+{
+    const char *p = value;
+    double d;
+
+    if ((value == NULL) || !SvgNumber(&p, &d)) {
+	return def;
+    }
+    while (isspace(UCHAR(*p))) {
+	p++;
+    }
+    if ((*p == '\0') || (strncmp(p, "px", 2) == 0)) {
+	return d;
+    } else if (strncmp(p, "pt", 2) == 0) {
+	return d * 4.0 / 3.0;
+    } else if (strncmp(p, "pc", 2) == 0) {
+	return d * 16.0;
+    } else if (strncmp(p, "mm", 2) == 0) {
+	return d * 96.0 / 25.4;
+    } else if (strncmp(p, "cm", 2) == 0) {
+	return d * 96.0 / 2.54;
+    } else if (strncmp(p, "in", 2) == 0) {
+	return d * 96.0;
+    } else if (strncmp(p, "em", 2) == 0) {
+	return d * fontSize;
+    } else if (strncmp(p, "ex", 2) == 0) {
+	return d * fontSize / 2.0;
+    }
+    return def;
+}
+
+/*
+ * Converts a number or percentage to a fraction.
+ */
+
+static double
+SvgFraction(
+    const char *value,
+    double def)
+{
+    const char *p = value;
+    double d;
+
+    if ((value == NULL) || !SvgNumber(&p, &d)) {
+	return def;
+    }
+    return (*p == '%') ? d / 100.0 : d;
+}
+
+/*
+ * Composes m = m * t, that is t is applied first.
+ */
+
+static void
+SvgMulMatrix(
+    TMatrix *mPtr,
+    TMatrix *tPtr)
+{
+    TMatrix m = *mPtr;
+
+    mPtr->a = m.a * tPtr->a + m.c * tPtr->b;
+    mPtr->b = m.b * tPtr->a + m.d * tPtr->b;
+    mPtr->c = m.a * tPtr->c + m.c * tPtr->d;
+    mPtr->d = m.b * tPtr->c + m.d * tPtr->d;
+    mPtr->tx = m.a * tPtr->tx + m.c * tPtr->ty + m.tx;
+    mPtr->ty = m.b * tPtr->tx + m.d * tPtr->ty + m.ty;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgParseTransform --
+ *
+ *	Parses a transform attribute into a matrix. Parsing stops at the
+ *	first malformed transform.
+ *
+ * Results:
+ *	1 if any transform was found, else 0.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SvgParseTransform(
+    const char *value,
+    TMatrix *mPtr)
+{
+    TMatrix unit = kPathUnitTMatrix, t;
+    const char *p = value, *name;
+    double v[6], phi;
+    int n, nameLen, found = 0;
+
+    *mPtr = unit;
+    if (value == NULL) {
+	return 0;
+    }
+    while (*p != '\0') {
+	while (isspace(UCHAR(*p)) || (*p == ',')) {
+	    p++;
+	}
+	name = p;
+	while (isalpha(UCHAR(*p))) {
+	    p++;
+	}
+	nameLen = p - name;
+	while (isspace(UCHAR(*p))) {
+	    p++;
+	}
+	if ((nameLen == 0) || (*p != '(')) {
+	    break;
+	}
+	p++;
+	for (n = 0; (n < 6) && SvgNumber(&p, v + n); n++) {
+	    /* empty */
+	}
+	while (isspace(UCHAR(*p))) {
+	    p++;
+	}
+	if (*p != ')') {
+	    break;
+	}
+	p++;
+	t = unit;
+	if ((nameLen == 6) && (strncmp(name, "matrix", 6) == 0) && (n == 6)) {
+	    t.a = v[0]; t.b = v[1]; t.c = v[2];
+	    t.d = v[3]; t.tx = v[4]; t.ty = v[5];
+	} else if ((nameLen == 9) && (strncmp(name, "translate", 9) == 0)
+		&& (n >= 1)) {
+	    t.tx = v[0];
+	    t.ty = (n > 1) ? v[1] : 0.0;
+	} else if ((nameLen == 5) && (strncmp(name, "scale", 5) == 0)
+		&& (n >= 1)) {
+	    t.a = v[0];
+	    t.d = (n > 1) ? v[1] : v[0];
+	} else if ((nameLen == 6) && (strncmp(name, "rotate", 6) == 0)
+		&& (n >= 1)) {
+	    phi = v[0] * DEGREES_TO_RADIANS;
+	    t.a = cos(phi); t.b = sin(phi);
+	    t.c = -sin(phi); t.d = cos(phi);
+	    if (n >= 3) {
+		t.tx = v[1] - t.a * v[1] - t.c * v[2];
+		t.ty = v[2] - t.b * v[1] - t.d * v[2];
+	    }
+	} else if ((nameLen == 5) && (strncmp(name, "skewX", 5) == 0)
+		&& (n == 1)) {
+	    t.c = tan(v[0] * DEGREES_TO_RADIANS);
+	} else if ((nameLen == 5) && (strncmp(name, "skewY", 5) == 0)
+		&& (n == 1)) {
+	    t.b = tan(v[0] * DEGREES_TO_RADIANS);
+	} else {
+	    break;
+	}
+	SvgMulMatrix(mPtr, &t);
+	found = 1;
+    }
+    return found;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgColorObj --
+ *
+ *	Converts an SVG color to one understood by Tk. The color keywords
+ *	of SVG are those of X11 as far as Tk is concerned.
+ *
+ * Results:
+ *	A new object, empty for no color, or NULL for a color Tk doesn't
+ *	know, which is then treated like an unset one.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static Tcl_Obj *
+SvgColorObj(
+    TkSvgLoadInfo *infoPtr,
+    const char *value,
+    SvgState *statePtr)
+{
+    char buffer[16];
+    const char *p;
+    double v[3];
+    int i;
+    XColor *colorPtr;
+
+    while (isspace(UCHAR(*value))) {
+	value++;
+    }
+    if ((*value == '\0') || (strcmp(value, "none") == 0)
+	    || (strcmp(value, "transparent") == 0)) {
+	return Tcl_NewObj();
+    }
+    if (strcmp(value, "currentColor") == 0) {
+	value = statePtr->color;
+	if (strcmp(value, "currentColor") == 0) {
+	    value = "black";
+	}
+    }
+    if ((value[0] == '#') && (strlen(value) == 4)) {
+	sprintf(buffer, "#%c%c%c%c%c%c", value[1], value[1], value[2],
+		value[2], value[3], value[3]);
+	return Tcl_NewStringObj(buffer, -1);
+    }
+    if ((strncmp(value, "rgb(", 4) == 0)
+	    || (strncmp(value, "rgba(", 5) == 0)) {
+	p = strchr(value, '(') + 1;
+	for (i = 0; i < 3; i++) {
+	    if (!SvgNumber(&p, v + i)) {
+		return Tcl_NewStringObj("black", -1);
+	    }
+	    if (*p == '%') {
+		v[i] *= 2.55;
+		p++;
+	    }
+	    v[i] = (v[i] < 0.0) ? 0.0 : (v[i] > 255.0) ? 255.0 : v[i];
+	}
+	sprintf(buffer, "#%02x%02x%02x", (int) (v[0] + 0.5),
+		(int) (v[1] + 0.5), (int) (v[2] + 0.5));
+	return Tcl_NewStringObj(buffer, -1);
+    }
+    colorPtr = Tk_GetColor(NULL, infoPtr->canvasPtr->tkwin,
+	    Tk_GetUid(value));
+    if (colorPtr == NULL) {
+	return NULL;
+    }
+    Tk_FreeColor(colorPtr);
+    return Tcl_NewStringObj(value, -1);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgPaintObj --
+ *
+ *	Converts a fill or stroke value. A gradient reference gives the
+ *	gradient for fills; strokes can only be colored and use the color
+ *	of its first stop.
+ *
+ * Results:
+ *	An object, or NULL if the value inherits.
+ *
+ * Side effects:
+ *	A gradient may be created.
+ *
+ *--------------------------------------------------------------
+ */
+
+static Tcl_Obj *
+SvgPaintObj(
+    TkSvgLoadInfo *infoPtr,
+    const char *value,
+    SvgState *statePtr,
+    int isFill)
+{
+    SvgPaint *paintPtr;
+    Tcl_DString ds;
+    const char *end;
+
+    if ((value == NULL) || (strcmp(value, "inherit") == 0)) {
+	return NULL;
+    }
+    if (strncmp(value, "url(", 4) != 0) {
+	return SvgColorObj(infoPtr, value, statePtr);
+    }
+    value += 4;
+    while (isspace(UCHAR(*value))) {
+	value++;
+    }
+    if (*value == '#') {
+	value++;
+    }
+    for (end = value; (*end != '\0') && (*end != ')')
+	    && !isspace(UCHAR(*end)); end++) {
+	/* empty */
+    }
+    Tcl_DStringInit(&ds);
+    Tcl_DStringAppend(&ds, value, end - value);
+    paintPtr = SvgGetPaint(infoPtr, Tcl_DStringValue(&ds));
+    Tcl_DStringFree(&ds);
+    if (paintPtr == NULL) {
+	return Tcl_NewObj();
+    }
+    if (isFill && (paintPtr->gradientObj != NULL)) {
+	return paintPtr->gradientObj;
+    }
+    return paintPtr->colorObj;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgGetPaint --
+ *
+ *	Resolves a gradient reference, creating the canvas gradient on
+ *	first use. Attributes and stops are inherited along the href
+ *	chain.
+ *
+ * Results:
+ *	The paint, or NULL if the id doesn't name a usable gradient.
+ *
+ * Side effects:
+ *	A gradient may be created.
+ *
+ *--------------------------------------------------------------
+ */
+
+static SvgPaint *
+SvgGetPaint(
+    TkSvgLoadInfo *infoPtr,
+    const char *id)
+{
+    Tcl_Interp *interp = infoPtr->interp;
+    Tcl_HashEntry *paintEntryPtr, *hPtr;
+    SvgNode *chain[SVG_MAX_HREF_CHAIN], *nodePtr, *stopsPtr = NULL;
+    SvgPaint *paintPtr;
+    SvgState state;
+    Tcl_Obj *stopsObj, *listObj, *colorObj, *objv[14], *savedObj;
+    const char *attrs[9], *value, *gradientColor;
+    const char *props[SVG_P_COUNT];
+    Tcl_DString gradientDs;
+    TMatrix matrix;
+    double lastOffset = 0.0, cx, cy;
+    int n, numChain, i, j, isNew, isLinear, isUser, numStops = 0;
+    static const char *attrNames[] = {
+	"x1", "y1", "x2", "y2", "cx", "cy", "r", "fx", "fy"
+    };
+
+    paintEntryPtr = Tcl_CreateHashEntry(&infoPtr->paintTable, id, &isNew);
+    if (!isNew) {
+	return (SvgPaint *) Tcl_GetHashValue(paintEntryPtr);
+    }
+    Tcl_SetHashValue(paintEntryPtr, NULL);
+
+    for (numChain = 0; numChain < SVG_MAX_HREF_CHAIN; numChain++) {
+	hPtr = (id == NULL) ? NULL : Tcl_FindHashEntry(&infoPtr->idTable, id);
+	if (hPtr == NULL) {
+	    break;
+	}
+	nodePtr = (SvgNode *) Tcl_GetHashValue(hPtr);
+	if ((strcmp(nodePtr->name, "linearGradient") != 0)
+		&& (strcmp(nodePtr->name, "radialGradient") != 0)) {
+	    break;
+	}
+	chain[numChain] = nodePtr;
+	id = SvgHref(nodePtr);
+    }
+    if (numChain == 0) {
+	return NULL;
+    }
+    isLinear = (strcmp(chain[0]->name, "linearGradient") == 0);
+    for (i = 0; (i < numChain) && (stopsPtr == NULL); i++) {
+	for (nodePtr = chain[i]->firstChildPtr; nodePtr != NULL;
+		nodePtr = nodePtr->nextPtr) {
+	    if ((nodePtr->name != NULL)
+		    && (strcmp(nodePtr->name, "stop") == 0)) {
+		stopsPtr = chain[i];
+		break;
+	    }
+	}
+    }
+    if (stopsPtr == NULL) {
+	return NULL;
+    }
+
+    /*
+     * Collect the stops; offsets are clamped and made monotonic as the
+     * canvas requires. A stop takes currentColor from its own color, else
+     * from that of the gradient element, never from a sibling.
+     */
+
+    Tcl_DStringInit(&gradientDs);
+    SvgGetProps(stopsPtr, props, &gradientDs);
+    gradientColor = (props[SVG_P_COLOR] != NULL) ? props[SVG_P_COLOR]
+	    : "black";
+    stopsObj = Tcl_NewObj();
+    Tcl_IncrRefCount(stopsObj);
+    for (nodePtr = stopsPtr->firstChildPtr; nodePtr != NULL;
+	    nodePtr = nodePtr->nextPtr) {
+	Tcl_DString ds;
+	double offset, opacity;
+
+	if ((nodePtr->name == NULL) || (strcmp(nodePtr->name, "stop") != 0)) {
+	    continue;
+	}
+	Tcl_DStringInit(&ds);
+	SvgGetProps(nodePtr, props, &ds);
+	offset = SvgFraction(SvgAttr(nodePtr, "offset"), 0.0);
+	offset = (offset < lastOffset) ? lastOffset
+		: (offset > 1.0) ? 1.0 : offset;
+	lastOffset = offset;
+	opacity = SvgFraction(props[SVG_P_STOP_OPACITY], 1.0);
+	state.color = (props[SVG_P_COLOR] != NULL) ? props[SVG_P_COLOR]
+		: gradientColor;
+	colorObj = SvgColorObj(infoPtr, (props[SVG_P_STOP_COLOR] != NULL)
+		? props[SVG_P_STOP_COLOR] : "black", &state);
+	listObj = Tcl_NewObj();
+	Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewDoubleObj(offset));
+	Tcl_ListObjAppendElement(NULL, listObj, (colorObj != NULL) ? colorObj
+		: Tcl_NewStringObj("black", -1));
+	Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewDoubleObj(
+		(opacity < 0.0) ? 0.0 : (opacity > 1.0) ? 1.0 : opacity));
+	Tcl_ListObjAppendElement(NULL, stopsObj, listObj);
+	numStops++;
+	Tcl_DStringFree(&ds);
+    }
+    Tcl_DStringFree(&gradientDs);
+
+    paintPtr = (SvgPaint *) ckalloc(sizeof(SvgPaint));
+    paintPtr->gradientObj = NULL;
+    Tcl_ListObjIndex(NULL, stopsObj, 0, &listObj);
+    Tcl_ListObjIndex(NULL, listObj, 1, &paintPtr->colorObj);
+    Tcl_IncrRefCount(paintPtr->colorObj);
+    Tcl_SetHashValue(paintEntryPtr, paintPtr);
+    if (numStops == 1) {
+	/*
+	 * A single stop paints a plain color.
+	 */
+
+	Tcl_DecrRefCount(stopsObj);
+	return paintPtr;
+    }
+
+    /*
+     * The geometry attributes are looked up along the chain as well.
+     */
+
+    for (j = 0; j < 9; j++) {
+	attrs[j] = NULL;
+	for (i = 0; (i < numChain) && (attrs[j] == NULL); i++) {
+	    attrs[j] = SvgAttr(chain[i], attrNames[j]);
+	}
+    }
+    value = NULL;
+    for (i = 0; (i < numChain) && (value == NULL); i++) {
+	value = SvgAttr(chain[i], "gradientUnits");
+    }
+    isUser = (value != NULL) && (strcmp(value, "userSpaceOnUse") == 0);
+
+    n = 0;
+    objv[n++] = Tcl_NewStringObj(Tk_PathName(infoPtr->canvasPtr->tkwin), -1);
+    objv[n++] = Tcl_NewStringObj("gradient", -1);
+    objv[n++] = Tcl_NewStringObj("create", -1);
+    objv[n++] = Tcl_NewStringObj(isLinear ? "linear" : "radial", -1);
+    objv[n++] = Tcl_NewStringObj("-stops", -1);
+    objv[n++] = stopsObj;
+    objv[n++] = Tcl_NewStringObj("-units", -1);
+    objv[n++] = Tcl_NewStringObj(isUser ? "userspace" : "bbox", -1);
+    listObj = Tcl_NewObj();
+    if (isLinear) {
+	objv[n++] = Tcl_NewStringObj("-lineartransition", -1);
+	Tcl_ListObjAppendElement(NULL, listObj,
+		Tcl_NewDoubleObj(SvgFraction(attrs[0], 0.0)));
+	Tcl_ListObjAppendElement(NULL, listObj,
+		Tcl_NewDoubleObj(SvgFraction(attrs[1], 0.0)));
+	Tcl_ListObjAppendElement(NULL, listObj,
+		Tcl_NewDoubleObj(SvgFraction(attrs[2], 1.0)));
+	Tcl_ListObjAppendElement(NULL, listObj,
+		Tcl_NewDoubleObj(SvgFraction(attrs[3], 0.0)));
+    } else {
+	cx = SvgFraction(attrs[4], 0.5);
+	cy = SvgFraction(attrs[5], 0.5);
+	objv[n++] = Tcl_NewStringObj("-radialtransition", -1);
+	Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewDoubleObj(cx));
+	Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewDoubleObj(cy));
+	Tcl_ListObjAppendElement(NULL, listObj,
+		Tcl_NewDoubleObj(SvgFraction(attrs[6], 0.5)));
+	Tcl_ListObjAppendElement(NULL, listObj,
+		Tcl_NewDoubleObj(SvgFraction(attrs[7], cx)));
+	Tcl_ListObjAppendElement(NULL, listObj,
+		Tcl_NewDoubleObj(SvgFraction(attrs[8], cy)));
+    }
+    objv[n++] = listObj;
+    value = NULL;
+    for (i = 0; (i < numChain) && (value == NULL); i++) {
+	value = SvgAttr(chain[i], "spreadMethod");
+    }
+    if (value != NULL) {
+	objv[n++] = Tcl_NewStringObj("-method", -1);
+	objv[n++] = Tcl_NewStringObj((strcmp(value, "reflect") == 0)
+		? "reflect" : (strcmp(value, "repeat") == 0) ? "repeat" : "pad",
+		-1);
+    }
+    value = NULL;
+    for (i = 0; (i < numChain) && (value == NULL); i++) {
+	value = SvgAttr(chain[i], "gradientTransform");
+    }
+    if (SvgParseTransform(value, &matrix)) {
+	objv[n++] = Tcl_NewStringObj("-matrix", -1);
+	objv[n++] = PathNewTMatrixObj(&matrix);
+    }
+    for (i = 0; i < n; i++) {
+	if (objv[i] != stopsObj) {
+	    Tcl_IncrRefCount(objv[i]);
+	}
+    }
+
+    /*
+     * A gradient that can't be created leaves the plain color, as if
+     * it were missing.
+     */
+
+    savedObj = Tcl_GetObjResult(interp);
+    Tcl_IncrRefCount(savedObj);
+    if (CanvasGradientObjCmd(interp, infoPtr->canvasPtr, n, objv) == TCL_OK) {
+	paintPtr->gradientObj = Tcl_GetObjResult(interp);
+	Tcl_IncrRefCount(paintPtr->gradientObj);
+    }
+    Tcl_SetObjResult(interp, savedObj);
+    Tcl_DecrRefCount(savedObj);
+    for (i = 0; i < n; i++) {
+	Tcl_DecrRefCount(objv[i]);
+    }
+    return paintPtr;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgPathData --
+ *
+ *	Splits SVG path data, where numbers and commands may be written
+ *	without separators, into the list the path item expects. The
+ *	flags of arcs may even run into each other. As in SVG, the path
+ *	is rendered up to the first error.
+ *
+ * Results:
+ *	A new list object, or NULL if the data is unusable.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static Tcl_Obj *
+SvgPathData(
+    const char *d)
+{
+    Tcl_Obj *listObj;
+    const char *p = d;
+    char cmd = '\0', buffer[2];
+    double v;
+    int arg = 0;
+    Tcl_Size len;
+
+    if (d == NULL) {
+	return NULL;
+    }
+    listObj = Tcl_NewObj();
+    buffer[1] = '\0';
+    for (;;) {
+	while (isspace(UCHAR(*p)) || (*p == ',')) {
+	    p++;
+	}
+	if (*p == '\0') {
+	    break;
+	}
+	if (strchr("MmLlHhVvCcSsQqTtAaZz", *p) != NULL) {
+	    if ((cmd == '\0') && (*p != 'M') && (*p != 'm')) {
+		break;
+	    }
+	    cmd = *p++;
+	    arg = 0;
+	    buffer[0] = cmd;
+	    Tcl_ListObjAppendElement(NULL, listObj,
+		    Tcl_NewStringObj(buffer, -1));
+	    continue;
+	}
+	if (cmd == '\0') {
+	    break;
+	}
+	if (((cmd == 'A') || (cmd == 'a'))
+		&& ((arg % 7 == 3) || (arg % 7 == 4))) {
+	    if ((*p != '0') && (*p != '1')) {
+		break;
+	    }
+	    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewIntObj(*p++ - '0'));
+	    arg++;
+	    continue;
+	}
+	if (!SvgNumber(&p, &v)) {
+	    break;
+	}
+	Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewDoubleObj(v));
+	arg++;
+    }
+    Tcl_ListObjLength(NULL, listObj, &len);
+    if (len < 3) {
+	Tcl_DecrRefCount(listObj);
+	return NULL;
+    }
+    return listObj;
+}
+
+/*
+ * Converts the points attribute of polylines and polygons. A trailing
+ * odd coordinate is dropped.
+ */
+
+static Tcl_Obj *
+SvgPoints(
+    const char *points)
+{
+    Tcl_Obj *listObj;
+    Tcl_Size len;
+    double v;
+
+    if (points == NULL) {
+	return NULL;
+    }
+    listObj = Tcl_NewObj();
+    while (SvgNumber(&points, &v)) {
+	Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewDoubleObj(v));
+    }
+    Tcl_ListObjLength(NULL, listObj, &len);
+    if (len < 4) {
+	Tcl_DecrRefCount(listObj);
+	return NULL;
+    }
+    if (len & 1) {
+	Tcl_ListObjReplace(NULL, listObj, len - 1, 1, 0, NULL);
+    }
+    return listObj;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgAddObj, SvgAddArg --
+ *
+ *	Append arguments for the item to be created next.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	A reference to the objects is kept until the item is created.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgAddObj(
+    TkSvgLoadInfo *infoPtr,
+    Tcl_Obj *objPtr)
+{
+    if (infoPtr->objc >= infoPtr->maxObjc) {
+	infoPtr->maxObjc = 2 * infoPtr->maxObjc + 32;
+	infoPtr->objv = (Tcl_Obj **) ckrealloc((char *) infoPtr->objv,
+		infoPtr->maxObjc * sizeof(Tcl_Obj *));
+    }
+    Tcl_IncrRefCount(objPtr);
+    infoPtr->objv[infoPtr->objc++] = objPtr;
+}
+
+static void
+SvgAddArg(
+    TkSvgLoadInfo *infoPtr,
+    const char *option,
+    Tcl_Obj *valueObj)
+{
+    SvgAddObj(infoPtr, Tcl_NewStringObj(option, -1));
+    SvgAddObj(infoPtr, valueObj);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgAddStyle --
+ *
+ *	Appends the style options of an element. Paint options are only
+ *	given where the element sets them, so that the rest is inherited
+ *	through the groups as in SVG. The opacities, which SVG doesn't
+ *	inherit that way, are applied to each leaf.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Gradients may be created.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgAddStyle(
+    TkSvgLoadInfo *infoPtr,
+    SvgNode *nodePtr,
+    const char **props,
+    SvgState *statePtr,
+    TMatrix *extraPtr,		/* Applied before the transform attribute,
+				 * or NULL. */
+    int flags)
+{
+    Tcl_Obj *objPtr;
+    const char *value;
+    TMatrix matrix;
+    double v;
+    int found;
+
+    if (flags & SVG_STYLE_PAINT) {
+	objPtr = SvgPaintObj(infoPtr, props[SVG_P_FILL], statePtr, 1);
+	if (objPtr != NULL) {
+	    SvgAddArg(infoPtr, "-fill", objPtr);
+	}
+	value = props[SVG_P_FILL_RULE];
+	if ((value != NULL) && (strcmp(value, "inherit") != 0)) {
+	    SvgAddArg(infoPtr, "-fillrule", Tcl_NewStringObj(
+		    (strcmp(value, "evenodd") == 0) ? "evenodd" : "nonzero",
+		    -1));
+	}
+	objPtr = SvgPaintObj(infoPtr, props[SVG_P_STROKE], statePtr, 0);
+	if (objPtr != NULL) {
+	    SvgAddArg(infoPtr, "-stroke", objPtr);
+	}
+	value = props[SVG_P_STROKE_WIDTH];
+	if (value != NULL) {
+	    v = SvgLength(value, -1.0, statePtr->fontSize);
+	    if (v >= 0.0) {
+		SvgAddArg(infoPtr, "-strokewidth", Tcl_NewDoubleObj(v));
+	    }
+	}
+	value = props[SVG_P_STROKE_LINECAP];
+	if ((value != NULL) && (strcmp(value, "inherit") != 0)) {
+	    SvgAddArg(infoPtr, "-strokelinecap", Tcl_NewStringObj(
+		    (strcmp(value, "round") == 0) ? "round"
+		    : (strcmp(value, "square") == 0) ? "projecting" : "butt",
+		    -1));
+	}
+	value = props[SVG_P_STROKE_LINEJOIN];
+	if ((value != NULL) && (strcmp(value, "inherit") != 0)) {
+	    SvgAddArg(infoPtr, "-strokelinejoin", Tcl_NewStringObj(
+		    (strcmp(value, "round") == 0) ? "round"
+		    : (strcmp(value, "bevel") == 0) ? "bevel" : "miter", -1));
+	}
+	value = props[SVG_P_STROKE_MITERLIMIT];
+	if (value != NULL) {
+	    v = SvgFraction(value, 4.0);
+	    SvgAddArg(infoPtr, "-strokemiterlimit",
+		    Tcl_NewDoubleObj((v < 1.0) ? 1.0 : v));
+	}
+	value = props[SVG_P_STROKE_DASHARRAY];
+	if ((value != NULL) && (strcmp(value, "inherit") != 0)) {
+	    Tcl_Obj *dashObj = Tcl_NewObj();
+	    Tcl_Obj **dashv;
+	    Tcl_Size dashc;
+	    double sum = 0.0;
+
+	    /*
+	     * An odd number of values is repeated, as SVG requires.
+	     */
+
+	    while (SvgNumber(&value, &v)) {
+		Tcl_ListObjAppendElement(NULL, dashObj, Tcl_NewDoubleObj(v));
+		sum += v;
+	    }
+	    Tcl_ListObjGetElements(NULL, dashObj, &dashc, &dashv);
+	    if (sum <= 0.0) {
+		Tcl_SetListObj(dashObj, 0, NULL);
+	    } else if (dashc & 1) {
+		Tcl_Obj *copyObj = Tcl_NewListObj(dashc, dashv);
+
+		Tcl_ListObjAppendList(NULL, dashObj, copyObj);
+		Tcl_DecrRefCount(copyObj);
+	    }
+	    SvgAddArg(infoPtr, "-strokedasharray", dashObj);
+	}
+	value = props[SVG_P_STROKE_DASHOFFSET];
+	if (value != NULL) {
+	    v = SvgLength(value, 0.0, statePtr->fontSize);
+	    SvgAddArg(infoPtr, "-strokedashoffset",
+		    Tcl_NewIntObj((int) floor(v + 0.5)));
+	}
+    }
+    if (flags & SVG_STYLE_OPACITY) {
+	v = statePtr->fillOpacity * statePtr->opacity;
+	if (v != 1.0) {
+	    SvgAddArg(infoPtr, "-fillopacity", Tcl_NewDoubleObj(v));
+	}
+	v = statePtr->strokeOpacity * statePtr->opacity;
+	if (v != 1.0) {
+	    SvgAddArg(infoPtr, "-strokeopacity", Tcl_NewDoubleObj(v));
+	}
+	if (statePtr->hidden) {
+	    SvgAddArg(infoPtr, "-state", Tcl_NewStringObj("hidden", -1));
+	}
+    }
+    if (nodePtr != infoPtr->rootPtr) {
+	found = SvgParseTransform(SvgAttr(nodePtr, "transform"), &matrix);
+	if (extraPtr != NULL) {
+	    SvgMulMatrix(&matrix, extraPtr);
+	    found = 1;
+	}
+	if (found) {
+	    SvgAddArg(infoPtr, "-matrix", PathNewTMatrixObj(&matrix));
+	}
+    }
+    if (infoPtr->tagsObj != NULL) {
+	SvgAddArg(infoPtr, "-tags", infoPtr->tagsObj);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgCreate --
+ *
+ *	Creates an item from the arguments collected.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	The arguments are released.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SvgCreate(
+    TkSvgLoadInfo *infoPtr,
+    const char *typeName,
+    Tk_PathItem **itemPtrPtr)
+{
+    int i, result;
+
+    result = TkPathCanvasCreateItem(infoPtr->interp, infoPtr->canvasPtr,
+	    typeName, infoPtr->objc, infoPtr->objv, itemPtrPtr);
+    for (i = 0; i < infoPtr->objc; i++) {
+	Tcl_DecrRefCount(infoPtr->objv[i]);
+    }
+    infoPtr->objc = 0;
+    return result;
+}
+
+static int
+SvgBuildChildren(
+    TkSvgLoadInfo *infoPtr,
+    SvgNode *nodePtr,
+    Tcl_Obj *parentObj,
+    SvgState *statePtr)
+{
+    SvgNode *childPtr;
+
+    for (childPtr = nodePtr->firstChildPtr; childPtr != NULL;
+	    childPtr = childPtr->nextPtr) {
+	if (SvgBuild(infoPtr, childPtr, parentObj, statePtr) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+    }
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgBuild --
+ *
+ *	Creates the item for an element, and for the content of
+ *	container elements.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Items are created.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SvgBuild(
+    TkSvgLoadInfo *infoPtr,
+    SvgNode *nodePtr,
+    Tcl_Obj *parentObj,
+    SvgState *statePtr)
+{
+    const char *props[SVG_P_COUNT];
+    const char *typeName = NULL;
+    Tcl_DString ds, family;
+    Tcl_Obj *objPtr, *groupObj;
+    Tk_PathItem *itemPtr;
+    SvgNode *childPtr, *targetPtr = NULL;
+    SvgState state;
+    TMatrix translate = kPathUnitTMatrix;
+    TMatrix *extraPtr = NULL;
+    double x, y, w, h, rx, ry;
+    int element, result = TCL_OK;
+
+    if (nodePtr->name == NULL) {
+	return TCL_OK;
+    }
+    for (element = 0; svgElementNames[element] != NULL; element++) {
+	if (strcmp(nodePtr->name, svgElementNames[element]) == 0) {
+	    break;
+	}
+    }
+    if ((svgElementNames[element] == NULL) || ((element == SVG_E_SYMBOL)
+	    && (nodePtr != infoPtr->useTargetPtr))) {
+	return TCL_OK;
+    }
+    if (element == SVG_E_USE) {
+	const char *id = SvgHref(nodePtr);
+	Tcl_HashEntry *hPtr = (id == NULL) ? NULL
+		: Tcl_FindHashEntry(&infoPtr->idTable, id);
+
+	if ((hPtr == NULL) || (infoPtr->useDepth >= SVG_MAX_USE_DEPTH)) {
+	    return TCL_OK;
+	}
+	targetPtr = (SvgNode *) Tcl_GetHashValue(hPtr);
+    }
+    if ((infoPtr->useDepth > 0)
+	    && (++infoPtr->numUseNodes > SVG_MAX_USE_NODES)) {
+	Tcl_SetObjResult(infoPtr->interp, Tcl_NewStringObj(
+		"too many SVG elements instantiated by <use>", -1));
+	return TCL_ERROR;
+    }
+
+    Tcl_DStringInit(&ds);
+    Tcl_DStringInit(&family);
+    SvgGetProps(nodePtr, props, &ds);
+    if ((props[SVG_P_DISPLAY] != NULL)
+	    && (strcmp(props[SVG_P_DISPLAY], "none") == 0)) {
+	goto done;
+    }
+    state = *statePtr;
+    SvgUpdateState(props, &state, &family);
+
+    switch ((enum SvgElement) element) {
+    case SVG_E_A:
+    case SVG_E_G:
+    case SVG_E_SVG:
+    case SVG_E_SWITCH:
+    case SVG_E_SYMBOL:
+    case SVG_E_USE:
+	/*
+	 * Groups carry the paint; opacity and visibility are applied to
+	 * the leaves.
+	 */
+
+	if ((element == SVG_E_SVG) || (element == SVG_E_USE)) {
+	    translate.tx = SvgLength(SvgAttr(nodePtr, "x"), 0.0,
+		    state.fontSize);
+	    translate.ty = SvgLength(SvgAttr(nodePtr, "y"), 0.0,
+		    state.fontSize);
+	    extraPtr = &translate;
+	}
+	SvgAddArg(infoPtr, "-parent", parentObj);
+	SvgAddStyle(infoPtr, nodePtr, props, &state, extraPtr,
+		SVG_STYLE_PAINT);
+	if (SvgCreate(infoPtr, "group", &itemPtr) != TCL_OK) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	groupObj = Tcl_NewIntObj(itemPtr->id);
+	Tcl_IncrRefCount(groupObj);
+	if (element == SVG_E_SWITCH) {
+	    /*
+	     * Conditional processing isn't supported: the first element
+	     * is rendered.
+	     */
+
+	    for (childPtr = nodePtr->firstChildPtr; childPtr != NULL;
+		    childPtr = childPtr->nextPtr) {
+		if (childPtr->name != NULL) {
+		    result = SvgBuild(infoPtr, childPtr, groupObj, &state);
+		    break;
+		}
+	    }
+	} else if (element == SVG_E_USE) {
+	    SvgNode *savedPtr = infoPtr->useTargetPtr;
+
+	    infoPtr->useDepth++;
+	    infoPtr->useTargetPtr = targetPtr;
+	    result = SvgBuild(infoPtr, targetPtr, groupObj, &state);
+	    infoPtr->useTargetPtr = savedPtr;
+	    infoPtr->useDepth--;
+	} else {
+	    result = SvgBuildChildren(infoPtr, nodePtr, groupObj, &state);
+	}
+	Tcl_DecrRefCount(groupObj);
+	goto done;
+
+    case SVG_E_PATH:
+	objPtr = SvgPathData(SvgAttr(nodePtr, "d"));
+	if (objPtr == NULL) {
+	    goto done;
+	}
+	SvgAddObj(infoPtr, objPtr);
+	typeName = "path";
+	break;
+
+    case SVG_E_RECT:
+	x = SvgLength(SvgAttr(nodePtr, "x"), 0.0, state.fontSize);
+	y = SvgLength(SvgAttr(nodePtr, "y"), 0.0, state.fontSize);
+	w = SvgLength(SvgAttr(nodePtr, "width"), 0.0, state.fontSize);
+	h = SvgLength(SvgAttr(nodePtr, "height"), 0.0, state.fontSize);
+	if ((w <= 0.0) || (h <= 0.0)) {
+	    goto done;
+	}
+	rx = SvgLength(SvgAttr(nodePtr, "rx"), -1.0, state.fontSize);
+	ry = SvgLength(SvgAttr(nodePtr, "ry"), -1.0, state.fontSize);
+	if (rx < 0.0) {
+	    rx = (ry < 0.0) ? 0.0 : ry;
+	}
+	if (ry < 0.0) {
+	    ry = rx;
+	}
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(x));
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(y));
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(x + w));
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(y + h));
+	if ((rx > 0.0) && (ry > 0.0)) {
+	    SvgAddArg(infoPtr, "-rx",
+		    Tcl_NewDoubleObj((rx > w / 2.0) ? w / 2.0 : rx));
+	    SvgAddArg(infoPtr, "-ry",
+		    Tcl_NewDoubleObj((ry > h / 2.0) ? h / 2.0 : ry));
+	}
+	typeName = "prect";
+	break;
+
+    case SVG_E_CIRCLE:
+    case SVG_E_ELLIPSE:
+	x = SvgLength(SvgAttr(nodePtr, "cx"), 0.0, state.fontSize);
+	y = SvgLength(SvgAttr(nodePtr, "cy"), 0.0, state.fontSize);
+	if (element == SVG_E_CIRCLE) {
+	    rx = ry = SvgLength(SvgAttr(nodePtr, "r"), 0.0, state.fontSize);
+	} else {
+	    rx = SvgLength(SvgAttr(nodePtr, "rx"), 0.0, state.fontSize);
+	    ry = SvgLength(SvgAttr(nodePtr, "ry"), 0.0, state.fontSize);
+	}
+	if ((rx <= 0.0) || (ry <= 0.0)) {
+	    goto done;
+	}
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(x));
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(y));
+	SvgAddArg(infoPtr, "-rx", Tcl_NewDoubleObj(rx));
+	if (element == SVG_E_ELLIPSE) {
+	    SvgAddArg(infoPtr, "-ry", Tcl_NewDoubleObj(ry));
+	    typeName = "ellipse";
+	} else {
+	    typeName = "circle";
+	}
+	break;
+
+    case SVG_E_LINE:
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(
+		SvgLength(SvgAttr(nodePtr, "x1"), 0.0, state.fontSize)));
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(
+		SvgLength(SvgAttr(nodePtr, "y1"), 0.0, state.fontSize)));
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(
+		SvgLength(SvgAttr(nodePtr, "x2"), 0.0, state.fontSize)));
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(
+		SvgLength(SvgAttr(nodePtr, "y2"), 0.0, state.fontSize)));
+	typeName = "pline";
+	break;
+
+    case SVG_E_POLYLINE:
+    case SVG_E_POLYGON:
+	objPtr = SvgPoints(SvgAttr(nodePtr, "points"));
+	if (objPtr == NULL) {
+	    goto done;
+	}
+	SvgAddObj(infoPtr, objPtr);
+	typeName = (element == SVG_E_POLYLINE) ? "polyline" : "ppolygon";
+	break;
+
+    case SVG_E_TEXT: {
+	Tcl_DString text;
+	const char *xValue = SvgAttr(nodePtr, "x");
+	const char *yValue = SvgAttr(nodePtr, "y");
+
+	/*
+	 * Text is collected into a single item; a position given only on
+	 * the first tspan is used for the whole text.
+	 */
+
+	for (childPtr = nodePtr->firstChildPtr; childPtr != NULL;
+		childPtr = childPtr->nextPtr) {
+	    if ((childPtr->name != NULL)
+		    && (strcmp(childPtr->name, "tspan") == 0)) {
+		if (xValue == NULL) {
+		    xValue = SvgAttr(childPtr, "x");
+		}
+		if (yValue == NULL) {
+		    yValue = SvgAttr(childPtr, "y");
+		}
+		break;
+	    }
+	}
+	Tcl_DStringInit(&text);
+	SvgTextContent(nodePtr, &text);
+	if (Tcl_DStringLength(&text) == 0) {
+	    Tcl_DStringFree(&text);
+	    goto done;
+	}
+	x = SvgLength(xValue, 0.0, state.fontSize);
+	y = SvgLength(yValue, 0.0, state.fontSize);
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(x));
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(y));
+	SvgAddArg(infoPtr, "-text", Tcl_NewStringObj(Tcl_DStringValue(&text),
+		Tcl_DStringLength(&text)));
+	Tcl_DStringFree(&text);
+	SvgAddArg(infoPtr, "-fontfamily",
+		Tcl_NewStringObj(state.fontFamily, -1));
+	SvgAddArg(infoPtr, "-fontsize", Tcl_NewDoubleObj(state.fontSize));
+	SvgAddArg(infoPtr, "-fontweight",
+		Tcl_NewStringObj(state.bold ? "bold" : "normal", -1));
+	SvgAddArg(infoPtr, "-fontslant",
+		Tcl_NewStringObj(state.fontSlant, -1));
+	SvgAddArg(infoPtr, "-textanchor",
+		Tcl_NewStringObj(state.textAnchor, -1));
+	typeName = "ptext";
+	break;
+    }
+
+    case SVG_E_IMAGE:
+	w = SvgLength(SvgAttr(nodePtr, "width"), 0.0, state.fontSize);
+	h = SvgLength(SvgAttr(nodePtr, "height"), 0.0, state.fontSize);
+	if ((w <= 0.0) || (h <= 0.0) || state.hidden) {
+	    goto done;
+	}
+	objPtr = SvgImage(infoPtr, nodePtr);
+	if (objPtr == NULL) {
+	    goto done;
+	}
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(
+		SvgLength(SvgAttr(nodePtr, "x"), 0.0, state.fontSize)));
+	SvgAddObj(infoPtr, Tcl_NewDoubleObj(
+		SvgLength(SvgAttr(nodePtr, "y"), 0.0, state.fontSize)));
+	SvgAddArg(infoPtr, "-image", objPtr);
+	Tcl_DecrRefCount(objPtr);
+	SvgAddArg(infoPtr, "-width", Tcl_NewDoubleObj(w));
+	SvgAddArg(infoPtr, "-height", Tcl_NewDoubleObj(h));
+	SvgAddArg(infoPtr, "-parent", parentObj);
+	if (state.opacity != 1.0) {
+	    SvgAddArg(infoPtr, "-fillopacity",
+		    Tcl_NewDoubleObj(state.opacity));
+	}
+	SvgAddStyle(infoPtr, nodePtr, props, &state, NULL, 0);
+	if (SvgCreate(infoPtr, "pimage", &itemPtr) != TCL_OK) {
+	    result = TCL_ERROR;
+	}
+	goto done;
+    }
+
+    SvgAddArg(infoPtr, "-parent", parentObj);
+    SvgAddStyle(infoPtr, nodePtr, props, &state, NULL,
+	    SVG_STYLE_PAINT | SVG_STYLE_OPACITY);
+    if (SvgCreate(infoPtr, typeName, &itemPtr) != TCL_OK) {
+	result = TCL_ERROR;
+    }
+
+  done:
+    Tcl_DStringFree(&ds);
+    Tcl_DStringFree(&family);
+    return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgImage --
+ *
+ *	Creates a photo image for an <image> element, either from a
+ *	base64 encoded data URI or from a file relative to the document.
+ *
+ * Results:
+ *	The name of the image with a reference held for the caller, or
+ *	NULL if it can't be created. Unreadable images are skipped, like
+ *	a browser would do.
+ *
+ * Side effects:
+ *	A photo image is created. It belongs to the application, just as
+ *	images given to pimage items otherwise do.
+ *
+ *--------------------------------------------------------------
+ */
+
+static Tcl_Obj *
+SvgImage(
+    TkSvgLoadInfo *infoPtr,
+    SvgNode *nodePtr)
+{
+    Tcl_Interp *interp = infoPtr->interp;
+    Tcl_Obj *objv[5], *resultObj = NULL, *savedObj, *hrefObj;
+    const char *href = SvgAttr(nodePtr, "xlink:href");
+    const char *p;
+    int i;
+
+    if (href == NULL) {
+	href = SvgAttr(nodePtr, "href");
+    }
+    if ((href == NULL) || (*href == '\0') || (*href == '#')) {
+	return NULL;
+    }
+    if (strncmp(href, "data:", 5) == 0) {
+	p = strchr(href, ',');
+	if ((p == NULL) || (strstr(href, ";base64,") != p - 7)) {
+	    return NULL;
+	}
+	objv[3] = Tcl_NewStringObj("-data", -1);
+	objv[4] = Tcl_NewStringObj(p + 1, -1);
+    } else {
+	if ((infoPtr->dirObj == NULL) || (strstr(href, "://") != NULL)) {
+	    return NULL;
+	}
+	hrefObj = Tcl_NewStringObj(href, -1);
+	Tcl_IncrRefCount(hrefObj);
+	objv[3] = Tcl_NewStringObj("-file", -1);
+	objv[4] = Tcl_FSJoinToPath(infoPtr->dirObj, 1, &hrefObj);
+	Tcl_DecrRefCount(hrefObj);
+    }
+    objv[0] = Tcl_NewStringObj("image", -1);
+    objv[1] = Tcl_NewStringObj("create", -1);
+    objv[2] = Tcl_NewStringObj("photo", -1);
+    for (i = 0; i < 5; i++) {
+	Tcl_IncrRefCount(objv[i]);
+    }
+    savedObj = Tcl_GetObjResult(interp);
+    Tcl_IncrRefCount(savedObj);
+    if (Tcl_EvalObjv(interp, 5, objv, TCL_EVAL_GLOBAL) == TCL_OK) {
+	resultObj = Tcl_GetObjResult(interp);
+	Tcl_IncrRefCount(resultObj);
+    }
+    Tcl_SetObjResult(interp, savedObj);
+    Tcl_DecrRefCount(savedObj);
+    for (i = 0; i < 5; i++) {
+	Tcl_DecrRefCount(objv[i]);
+    }
+    return resultObj;
+}
+
+/*
+ * Collects the character data of a text element and its tspans,
+ * collapsing white space as for xml:space="default".
+ */
+
+static void
+SvgTextContent(
+    SvgNode *nodePtr,
+    Tcl_DString *dsPtr)
+{
+    SvgNode *childPtr;
+    const char *p;
+    int len;
+
+    for (childPtr = nodePtr->firstChildPtr; childPtr != NULL;
+	    childPtr = childPtr->nextPtr) {
+	if (childPtr->name != NULL) {
+	    if (strcmp(childPtr->name, "tspan") == 0) {
+		SvgTextContent(childPtr, dsPtr);
+	    }
+	    continue;
+	}
+	for (p = childPtr->text; *p != '\0'; p++) {
+	    len = Tcl_DStringLength(dsPtr);
+	    if (isspace(UCHAR(*p))) {
+		if ((len > 0) && (Tcl_DStringValue(dsPtr)[len-1] != ' ')) {
+		    Tcl_DStringAppend(dsPtr, " ", 1);
+		}
+	    } else {
+		Tcl_DStringAppend(dsPtr, p, 1);
+	    }
+	}
+    }
+    if (strcmp(nodePtr->name, "text") == 0) {
+	len = Tcl_DStringLength(dsPtr);
+	if ((len > 0) && (Tcl_DStringValue(dsPtr)[len-1] == ' ')) {
+	    Tcl_DStringSetLength(dsPtr, len - 1);
+	}
+    }
+}
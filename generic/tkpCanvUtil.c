@@ -460,11 +460,20 @@ TkPathCanvasInheritStyle(Tk_PathItem *itemPtr, long flags)
     /*
      * Merge the parents style with the actual items style.
      * The order of these two merges decides which take precedence.
+     * Lightweight items have only their named style.
      */
-    itemExPtr = (Tk_PathItemEx *) itemPtr;
-    TkPathStyleMergeStyles(&itemExPtr->style, &style, flags);
-    if (itemExPtr->styleInst != NULL) {
-	TkPathStyleMergeStyles(itemExPtr->styleInst->masterPtr, &style, flags);
+    if (TkPathItemIsLite(itemPtr)) {
+	Tk_PathItemLite *itemLitePtr = (Tk_PathItemLite *) itemPtr;
+
+	if (itemLitePtr->styleInst != NULL) {
+	    TkPathStyleMergeStyles(itemLitePtr->styleInst->masterPtr, &style, flags);
+	}
+    } else {
+	itemExPtr = (Tk_PathItemEx *) itemPtr;
+	TkPathStyleMergeStyles(&itemExPtr->style, &style, flags);
+	if (itemExPtr->styleInst != NULL) {
+	    TkPathStyleMergeStyles(itemExPtr->styleInst->masterPtr, &style, flags);
+	}
     }
     if (style.matrixPtr != NULL) {
 	anyMatrix = 1;
@@ -566,6 +575,37 @@ TkPathCanvasState(Tk_PathCanvas canvas)
     return ((TkPathCanvas *)canvas)->canvas_state;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkPathCanvasItemState --
+ *
+ *	Finds the state an item is in when it doesn't set one itself:
+ *	the -state of the nearest ancestor group that sets one, else the
+ *	state of the canvas.
+ *
+ * Results:
+ *	The inherited state of the item.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tk_PathState
+TkPathCanvasItemState(Tk_PathCanvas canvas, Tk_PathItem *itemPtr)
+{
+    Tk_PathItem *walkPtr;
+
+    for (walkPtr = itemPtr; walkPtr != NULL; walkPtr = walkPtr->parentPtr) {
+	if (walkPtr->state != TK_PATHSTATE_NULL) {
+	    return walkPtr->state;
+	}
+    }
+    return ((TkPathCanvas *)canvas)->canvas_state;
+}
+
 Tk_PathItem *
 TkPathCanvasCurrentItem(Tk_PathCanvas canvas)
 {
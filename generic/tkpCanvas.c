@@ -19,6 +19,7 @@
 #define TK_PATH_NO_DOUBLE_BUFFERING
 #endif
 
+#include <float.h>
 #include "default.h"
 #include "tkInt.h"
 #include "tkIntPath.h"
@@ -80,6 +81,54 @@ typedef struct TagSearch {
 #define SEARCH_TYPE_EXPR	4	/* Compound search */
 #define SEARCH_TYPE_ROOT	5	/* Looking for the root item */
 
+/*
+ * On Windows the X11 emulation used by the tk::canvas items can't draw
+ * into the drawable while a path context holds it. Such items are
+ * therefore collected and drawn after the path items they don't overlap,
+ * so that a single path context serves most of the redraw.
+ */
+
+#if defined(_WIN32) && !defined(PLATFORM_SDL)
+#define TKP_SEPARATE_LEGACY_CONTEXT
+#endif
+
+#define DISPLAY_BATCH_STATIC_SIZE 32
+
+/*
+ * The structure defined below holds the state while drawing all items of
+ * a redraw. Used by DisplayBatchBegin, DisplayBatchItem, DisplayBatchEnd.
+ */
+
+typedef struct DisplayBatch {
+    TkPathCanvas *canvasPtr;	/* The canvas being drawn. */
+    Drawable drawable;		/* Where to draw. */
+    int x, y, width, height;	/* Area passed on to each displayProc. */
+#ifdef TKP_SEPARATE_LEGACY_CONTEXT
+    Tk_PathItem **pending;	/* Legacy items not yet drawn, in order. */
+    int numPending;		/* Number of items in pending. */
+    int maxPending;		/* Space allocated for pending. */
+    int x1, y1, x2, y2;		/* Union of the pending items bboxes. */
+    Tk_PathItem *staticPending[DISPLAY_BATCH_STATIC_SIZE];
+				/* Used for pending to begin with. */
+#endif
+} DisplayBatch;
+
+/*
+ * Opaque items found on top of a redraw, see DisplayFindCovers. Items
+ * below them that they hide completely are not drawn.
+ */
+
+#define DISPLAY_MAX_COVERS 8
+#define DISPLAY_MIN_COVER 16	/* Smaller items don't hide enough to be
+				 * worth checking. */
+
+typedef struct DisplayCover {
+    int order;			/* Index of the item in display list
+				 * order. */
+    int x1, y1, x2, y2;		/* Pixels hidden by the item within the
+				 * redraw area; x2 and y2 are excluded. */
+} DisplayCover;
+
 #define PATH_DEF_STATE "normal"
 
 /* These MUST be kept in sync with enums! X.h */
@@ -115,6 +164,9 @@ static Tk_OptionSpec optionSpecs[] = {
     {TK_OPTION_DOUBLE, "-closeenough", "closeEnough", "CloseEnough",
 	DEF_CANVAS_CLOSE_ENOUGH, -1, offsetof(TkPathCanvas, closeEnough),
 	0, 0, 0},
+    {TK_OPTION_BOOLEAN, "-coalescemotion", "coalesceMotion", "CoalesceMotion",
+	"0", -1, offsetof(TkPathCanvas, coalesceMotion),
+	0, 0, 0},
     {TK_OPTION_BOOLEAN, "-confine", "confine", "Confine",
 	DEF_CANVAS_CONFINE, -1, offsetof(TkPathCanvas, confine),
 	0, 0, 0},
@@ -240,8 +292,12 @@ static void		CanvasBindProc(ClientData clientData,
 static void		CanvasBlinkProc(ClientData clientData);
 static void		CanvasCmdDeletedProc(ClientData clientData);
 static void		CanvasDoEvent(TkPathCanvas *canvasPtr, XEvent *eventPtr);
+static void		CanvasFlushMotion(TkPathCanvas *canvasPtr);
+static void		CanvasMotionProc(ClientData clientData);
 static void		CanvasEventProc(ClientData clientData,
 			    XEvent *eventPtr);
+static void		CanvasEventuallyRedraw(TkPathCanvas *canvasPtr,
+			    int x1, int y1, int x2, int y2);
 static Tcl_Size		CanvasFetchSelection(ClientData clientData, Tcl_Size offset,
 			    char *buffer, Tcl_Size maxBytes);
 static Tk_PathItem *	CanvasFindClosest(TkPathCanvas *canvasPtr,
@@ -266,6 +322,29 @@ static int		DrawCanvas(Tcl_Interp *interp, ClientData clientData,
 			    Tk_PhotoHandle photoHandle, int subsample,
 			    int zoom);
 static void		DisplayCanvas(ClientData clientData);
+static void		DisplayBatchBegin(TkPathCanvas *canvasPtr,
+			    DisplayBatch *batchPtr, Drawable drawable,
+			    int x, int y, int width, int height);
+static void		DisplayBatchEnd(DisplayBatch *batchPtr);
+static void		DisplayBatchItem(DisplayBatch *batchPtr,
+			    Tk_PathItem *itemPtr);
+static void		DisplayItem(DisplayBatch *batchPtr,
+			    Tk_PathItem *itemPtr);
+static Tk_PathItem *	DisplayIteratorNext(TkPathCanvas *canvasPtr,
+			    Tk_PathItem *itemPtr, Tk_PathItem *groupPtr);
+static int		DisplayItemInRedraw(TkPathCanvas *canvasPtr,
+			    Tk_PathItem *itemPtr, int screenX1, int screenY1,
+			    int screenX2, int screenY2);
+static int		DisplayFindCovers(TkPathCanvas *canvasPtr,
+			    int screenX1, int screenY1, int screenX2,
+			    int screenY2, DisplayCover *covers);
+static int		DisplayItemCovered(DisplayCover *covers,
+			    int numCovers, int order, Tk_PathItem *itemPtr,
+			    int screenX1, int screenY1, int screenX2,
+			    int screenY2);
+#ifdef TKP_SEPARATE_LEGACY_CONTEXT
+static void		DisplayBatchFlush(DisplayBatch *batchPtr);
+#endif
 static void		DoItem(Tcl_Interp *interp,
 			    Tk_PathItem *itemPtr, Tk_Uid tag);
 static void		EventuallyRedrawItem(Tk_PathCanvas canvas,
@@ -283,7 +362,6 @@ static int		ItemCreate(Tcl_Interp *interp, TkPathCanvas *canvasPtr,
 				Tk_PathItemType *typePtr, int isRoot, Tk_PathItem **itemPtrPtr,
 				int objc, Tcl_Obj *const objv[]);
 static int		ItemGetNumTags(Tk_PathItem *itemPtr);
-static void		SetAncestorsDirtyBbox(Tk_PathItem *itemPtr);
 
 static void		DebugGetItemInfo(Tk_PathItem *itemPtr, char *s);
 static int		FindItems(Tcl_Interp *interp, TkPathCanvas *canvasPtr,
@@ -295,6 +373,8 @@ static int		FindArea(Tcl_Interp *interp, TkPathCanvas *canvasPtr,
 static double		GridAlign(double coord, double spacing);
 static const char**	TkGetStringsFromObjs(int objc, Tcl_Obj *const *objv);
 static void		InitCanvas(void);
+static int		PickCoversRect(TkPathCanvas *canvasPtr,
+			    Tk_PathItem *itemPtr, double rect[4]);
 static void		PickCurrentItem(TkPathCanvas *canvasPtr, XEvent *eventPtr);
 static Tcl_Obj *	ScrollFractions(int screen1,
 			    int screen2, int object1, int object2);
@@ -484,12 +564,30 @@ Tk_PathCanvasObjCmd(
     canvasPtr->nextId = 1;	    /* id = 0 reserved for root item */
 #ifndef TKP_NO_POSTSCRIPT
     canvasPtr->psInfo = NULL;
+    Tcl_InitHashTable(&canvasPtr->psCache, TCL_ONE_WORD_KEYS);
+    canvasPtr->psCacheY2 = 0;
+    canvasPtr->psCacheColorLevel = 0;
 #endif
     canvasPtr->canvas_state = TK_PATHSTATE_NORMAL;
     canvasPtr->tsoffsetPtr = NULL;
     canvasPtr->styleUid = 0;
     canvasPtr->gradientUid = 0;
     canvasPtr->bindTagExprs = NULL;
+    canvasPtr->bindExprEpoch = 1;
+    canvasPtr->matchItemPtr = NULL;
+    canvasPtr->matchPtr = NULL;
+    canvasPtr->numMatches = 0;
+    canvasPtr->matchEpoch = 0;
+    canvasPtr->coalesceMotion = 0;
+    canvasPtr->numPicks = 0;
+    canvasPtr->numPicksSaved = 0;
+    canvasPtr->sceneGeneration = 1;
+    canvasPtr->pickGeneration = 0;
+    canvasPtr->pickItemPtr = NULL;
+    canvasPtr->numPickHits = 0;
+    canvasPtr->numItemsCovered = 0;
+    canvasPtr->numLayersRendered = 0;
+    canvasPtr->numPixelsRedrawn = 0;
 
     Tcl_InitHashTable(&canvasPtr->idTable, TCL_ONE_WORD_KEYS);
     Tcl_InitHashTable(&canvasPtr->styleTable, TCL_STRING_KEYS);
@@ -580,11 +678,11 @@ CanvasWidgetCmd(
 	"gradient",	"image",	"imove",
 	"icursor",	"index",	"insert",
 	"itemcget",	"itemconfigure","itempdf",	"lastchild",
-	"lower",	"move",		"nextsibling",	"parent",
-	"prevsibling",	"postscript",	"raise",
-	"rchars",	"scale",
-	"scan",		"select",	"style",	"type",
-	"types",	"xview",	"yview",
+	"loadsvg",	"lower",	"move",		"nextsibling",
+	"parent",	"pdf",		"prevsibling",	"postscript",
+	"raise",	"rchars",	"scale",
+	"scan",		"select",	"stats",	"style",
+	"svg",		"type",		"types",	"xview",	"yview",
 #if 1
 	"debugtree",
 #endif
@@ -600,11 +698,11 @@ CanvasWidgetCmd(
 	CANV_GRADIENT,	 CANV_IMAGE,	    CANV_IMOVE,
 	CANV_ICURSOR,	 CANV_INDEX,	    CANV_INSERT,
 	CANV_ITEMCGET,	 CANV_ITEMCONFIGURE,CANV_ITEMPDF,	CANV_LASTCHILD,
-	CANV_LOWER,	 CANV_MOVE,	    CANV_NEXTSIBLING,	CANV_PARENT,
-	CANV_PREVSIBLING,CANV_POSTSCRIPT,   CANV_RAISE,
-	CANV_RCHARS,	 CANV_SCALE,
-	CANV_SCAN,	 CANV_SELECT,	    CANV_STYLE,		CANV_TYPE,
-	CANV_TYPES,	 CANV_XVIEW,	    CANV_YVIEW,
+	CANV_LOADSVG,	 CANV_LOWER,	    CANV_MOVE,		CANV_NEXTSIBLING,
+	CANV_PARENT,	 CANV_PDF,	    CANV_PREVSIBLING,	CANV_POSTSCRIPT,
+	CANV_RAISE,	 CANV_RCHARS,	    CANV_SCALE,
+	CANV_SCAN,	 CANV_SELECT,	    CANV_STATS,		CANV_STYLE,
+	CANV_SVG,	 CANV_TYPE,	 CANV_TYPES,	    CANV_XVIEW,		CANV_YVIEW,
 #if 1
 	CANV_DEBUGTREE,
 #endif
@@ -800,6 +898,7 @@ CanvasWidgetCmd(
 
 		    *lastPtr = searchPtr->expr;
 		    searchPtr->expr->next = NULL;
+		    canvasPtr->bindExprEpoch++;
 
 		    /*
 		     * Flag in TagSearch that expr has changed ownership so
@@ -1310,6 +1409,7 @@ CanvasWidgetCmd(
 		    if (ptagsPtr->tagPtr[i] == tag) {
 			ptagsPtr->tagPtr[i] = ptagsPtr->tagPtr[ptagsPtr->numTags-1];
 			ptagsPtr->numTags--;
+			canvasPtr->matchItemPtr = NULL;
 		    }
 		}
 	    }
@@ -1555,6 +1655,9 @@ CanvasWidgetCmd(
 		result = (*itemPtr->typePtr->configProc)(interp,
 			(Tk_PathCanvas) canvasPtr, itemPtr, objc-3, objv+3,
 			TK_CONFIG_ARGV_ONLY);
+		if (itemPtr == canvasPtr->matchItemPtr) {
+		    canvasPtr->matchItemPtr = NULL;
+		}
 		EventuallyRedrawItem((Tk_PathCanvas) canvasPtr, itemPtr);
 		canvasPtr->flags |= REPICK_NEEDED;
 	    }
@@ -1601,6 +1704,10 @@ CanvasWidgetCmd(
 	}
 	break;
     }
+    case CANV_LOADSVG: {
+	result = TkpCanvLoadSvgCmd(canvasPtr, interp, objc, objv);
+	break;
+    }
     case CANV_LOWER: {
 	Tk_PathItem *itemPtr;
 
@@ -1703,6 +1810,10 @@ CanvasWidgetCmd(
 	}
 	break;
     }
+    case CANV_PDF: {
+	result = TkpCanvPdfCmd(canvasPtr, interp, objc, objv);
+	break;
+    }
     case CANV_POSTSCRIPT: {
 #ifdef TKP_NO_POSTSCRIPT
 	Tcl_AppendResult(interp, "no postscript support", NULL);
@@ -2010,6 +2121,46 @@ CanvasWidgetCmd(
 	result = CanvasStyleObjCmd(interp, canvasPtr, objc, objv);
 	break;
     }
+    case CANV_STATS: {
+	Tcl_Obj *listObj;
+
+	if (objc != 2) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	listObj = Tcl_NewListObj(0, NULL);
+	Tcl_ListObjAppendElement(interp, listObj,
+		Tcl_NewStringObj("picks", -1));
+	Tcl_ListObjAppendElement(interp, listObj,
+		Tcl_NewLongObj(canvasPtr->numPicks));
+	Tcl_ListObjAppendElement(interp, listObj,
+		Tcl_NewStringObj("pickssaved", -1));
+	Tcl_ListObjAppendElement(interp, listObj,
+		Tcl_NewLongObj(canvasPtr->numPicksSaved));
+	Tcl_ListObjAppendElement(interp, listObj,
+		Tcl_NewStringObj("pickhits", -1));
+	Tcl_ListObjAppendElement(interp, listObj,
+		Tcl_NewLongObj(canvasPtr->numPickHits));
+	Tcl_ListObjAppendElement(interp, listObj,
+		Tcl_NewStringObj("covered", -1));
+	Tcl_ListObjAppendElement(interp, listObj,
+		Tcl_NewLongObj(canvasPtr->numItemsCovered));
+	Tcl_ListObjAppendElement(interp, listObj,
+		Tcl_NewStringObj("layers", -1));
+	Tcl_ListObjAppendElement(interp, listObj,
+		Tcl_NewLongObj(canvasPtr->numLayersRendered));
+	Tcl_ListObjAppendElement(interp, listObj,
+		Tcl_NewStringObj("redrawn", -1));
+	Tcl_ListObjAppendElement(interp, listObj,
+		Tcl_NewLongObj(canvasPtr->numPixelsRedrawn));
+	Tcl_SetObjResult(interp, listObj);
+	break;
+    }
+    case CANV_SVG: {
+	result = TkpCanvSvgCmd(canvasPtr, interp, objc, objv);
+	break;
+    }
     case CANV_TYPE: {
 	if (objc != 3) {
 	    Tcl_WrongNumArgs(interp, 2, objv, "tag");
@@ -2237,6 +2388,10 @@ DestroyCanvas(
      */
 
     Tcl_DeleteHashTable(&canvasPtr->idTable);
+#ifndef TKP_NO_POSTSCRIPT
+    TkPathCanvasPsFlush(canvasPtr);
+    Tcl_DeleteHashTable(&canvasPtr->psCache);
+#endif
 
     /* @@@ TODO: tkwin = NULL! */
     PathStylesFree(canvasPtr->tkwin, &canvasPtr->styleTable);
@@ -2254,6 +2409,9 @@ DestroyCanvas(
 	TagSearchExprDestroy(expr);
 	expr = next;
     }
+    if (canvasPtr->matchPtr != NULL) {
+	ckfree((char *) canvasPtr->matchPtr);
+    }
     Tcl_DeleteTimerHandler(canvasPtr->insertBlinkHandler);
     if (canvasPtr->bindingTable != NULL) {
 	Tk_DeleteBindingTable(canvasPtr->bindingTable);
@@ -2297,6 +2455,7 @@ ConfigureCanvas(
     GC newGC;
     Tk_SavedOptions savedOptions;
     Tcl_Obj *errorResult = NULL;
+    Tk_PathItem *itemPtr;
     int error;
 
     /*
@@ -2445,6 +2604,21 @@ ConfigureCanvas(
 
     CanvasSetOrigin(canvasPtr, canvasPtr->xOrigin, canvasPtr->yOrigin);
     canvasPtr->flags |= UPDATE_SCROLLBARS|REDRAW_BORDERS;
+#ifndef TKP_NO_POSTSCRIPT
+    TkPathCanvasPsFlush(canvasPtr);
+#endif
+
+    /*
+     * Items may look different now, e.g. with another -state, so group
+     * layers must be rendered again.
+     */
+
+    for (itemPtr = canvasPtr->rootItemPtr; itemPtr != NULL;
+	    itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
+	if (itemPtr->typePtr == &tkpGroupType) {
+	    TkPathCanvasSetGroupDirtyBbox(itemPtr);
+	}
+    }
     Tk_PathCanvasEventuallyRedraw((Tk_PathCanvas) canvasPtr,
 	    canvasPtr->xOrigin, canvasPtr->yOrigin,
 	    canvasPtr->xOrigin + Tk_Width(canvasPtr->tkwin),
@@ -2497,6 +2671,9 @@ PathCanvasWorldChanged(
 	}
     }
     canvasPtr->flags |= REPICK_NEEDED;
+#ifndef TKP_NO_POSTSCRIPT
+    TkPathCanvasPsFlush(canvasPtr);
+#endif
     Tk_PathCanvasEventuallyRedraw((Tk_PathCanvas) canvasPtr,
 	    canvasPtr->xOrigin, canvasPtr->yOrigin,
 	    canvasPtr->xOrigin + Tk_Width(canvasPtr->tkwin),
@@ -2568,6 +2745,520 @@ DecomposeMaskToShiftAndBits(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayBatchBegin --
+ *
+ *	Prepares for drawing the items of a redraw into drawable.
+ *	A single path context is used for all path items of the redraw.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May create the path context of the canvas.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DisplayBatchBegin(
+    TkPathCanvas *canvasPtr,
+    DisplayBatch *batchPtr,
+    Drawable drawable,
+    int x, int y, int width, int height)
+{
+    batchPtr->canvasPtr = canvasPtr;
+    batchPtr->drawable = drawable;
+    batchPtr->x = x;
+    batchPtr->y = y;
+    batchPtr->width = width;
+    batchPtr->height = height;
+#ifdef TKP_SEPARATE_LEGACY_CONTEXT
+    batchPtr->pending = batchPtr->staticPending;
+    batchPtr->numPending = 0;
+    batchPtr->maxPending = DISPLAY_BATCH_STATIC_SIZE;
+
+    /*
+     * The context is created when the first path item is drawn.
+     */
+    canvasPtr->context = NULL;
+#else
+    canvasPtr->context = TkPathInit(canvasPtr->tkwin, drawable);
+#endif
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayItem --
+ *
+ *	Draws a single item using the path context if it is a path item.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Item drawn.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DisplayItem(
+    DisplayBatch *batchPtr,
+    Tk_PathItem *itemPtr)
+{
+    TkPathCanvas *canvasPtr = batchPtr->canvasPtr;
+
+    if (itemPtr->typePtr->isPathType) {
+#ifdef TKP_SEPARATE_LEGACY_CONTEXT
+	if (canvasPtr->context == NULL) {
+	    canvasPtr->context = TkPathInit(canvasPtr->tkwin,
+		    batchPtr->drawable);
+	} else {
+	    TkPathResetTMatrix(canvasPtr->context);
+	}
+#else
+	TkPathResetTMatrix(canvasPtr->context);
+#endif
+    }
+    (*itemPtr->typePtr->displayProc)((Tk_PathCanvas) canvasPtr, itemPtr,
+	    canvasPtr->display, batchPtr->drawable, batchPtr->x, batchPtr->y,
+	    batchPtr->width, batchPtr->height);
+#ifdef MAC_OSX_TK
+    if (itemPtr->typePtr->isPathType) {
+	TkPathRestoreState(canvasPtr->context);
+    }
+#endif
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayBatchItem --
+ *
+ *	Draws an item of the redraw, which must be given in display list
+ *	order. Where the path context can't be shared with the legacy
+ *	items these are held back as long as no path item overlaps them,
+ *	and are then drawn in one go. This keeps the stacking order as
+ *	seen on screen but avoids creating a new path context each time
+ *	a legacy item follows a path item.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Item drawn now or later.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DisplayBatchItem(
+    DisplayBatch *batchPtr,
+    Tk_PathItem *itemPtr)
+{
+#ifdef TKP_SEPARATE_LEGACY_CONTEXT
+    if (!itemPtr->typePtr->isPathType) {
+	if (batchPtr->numPending == batchPtr->maxPending) {
+	    Tk_PathItem **newPending;
+
+	    newPending = (Tk_PathItem **) ckalloc((unsigned)
+		    (2 * batchPtr->maxPending * sizeof(Tk_PathItem *)));
+	    memcpy(newPending, batchPtr->pending,
+		    batchPtr->numPending * sizeof(Tk_PathItem *));
+	    if (batchPtr->pending != batchPtr->staticPending) {
+		ckfree((char *) batchPtr->pending);
+	    }
+	    batchPtr->pending = newPending;
+	    batchPtr->maxPending *= 2;
+	}
+	if (batchPtr->numPending == 0) {
+	    batchPtr->x1 = itemPtr->x1;
+	    batchPtr->y1 = itemPtr->y1;
+	    batchPtr->x2 = itemPtr->x2;
+	    batchPtr->y2 = itemPtr->y2;
+	} else {
+	    batchPtr->x1 = MIN(batchPtr->x1, itemPtr->x1);
+	    batchPtr->y1 = MIN(batchPtr->y1, itemPtr->y1);
+	    batchPtr->x2 = MAX(batchPtr->x2, itemPtr->x2);
+	    batchPtr->y2 = MAX(batchPtr->y2, itemPtr->y2);
+	}
+	batchPtr->pending[batchPtr->numPending++] = itemPtr;
+	return;
+    }
+    if ((batchPtr->numPending > 0)
+	    && (itemPtr->x1 < batchPtr->x2) && (itemPtr->x2 > batchPtr->x1)
+	    && (itemPtr->y1 < batchPtr->y2) && (itemPtr->y2 > batchPtr->y1)) {
+	DisplayBatchFlush(batchPtr);
+    }
+#endif
+    DisplayItem(batchPtr, itemPtr);
+}
+
+#ifdef TKP_SEPARATE_LEGACY_CONTEXT
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayBatchFlush --
+ *
+ *	Draws all held back legacy items, which requires the path context
+ *	to be freed first.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Items drawn, path context freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DisplayBatchFlush(
+    DisplayBatch *batchPtr)
+{
+    TkPathCanvas *canvasPtr = batchPtr->canvasPtr;
+    int i;
+
+    if (canvasPtr->context != NULL) {
+	TkPathFree(canvasPtr->context);
+	canvasPtr->context = NULL;
+    }
+    for (i = 0; i < batchPtr->numPending; i++) {
+	DisplayItem(batchPtr, batchPtr->pending[i]);
+    }
+    batchPtr->numPending = 0;
+}
+#endif
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayBatchEnd --
+ *
+ *	Draws any held back items and frees the path context.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Items drawn, memory freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DisplayBatchEnd(
+    DisplayBatch *batchPtr)
+{
+    TkPathCanvas *canvasPtr = batchPtr->canvasPtr;
+
+#ifdef TKP_SEPARATE_LEGACY_CONTEXT
+    if (batchPtr->numPending > 0) {
+	DisplayBatchFlush(batchPtr);
+    }
+    if (batchPtr->pending != batchPtr->staticPending) {
+	ckfree((char *) batchPtr->pending);
+    }
+#endif
+    if (canvasPtr->context != NULL) {
+	TkPathFree(canvasPtr->context);
+	canvasPtr->context = NULL;
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayIteratorNext --
+ *
+ *	Obtains the next item to draw in display list order. This is
+ *	TkPathCanvasItemIteratorNext except that the descendants of groups
+ *	drawn from a layer are left out, see TkPathCanvasGroupLayer, and
+ *	that the iteration may be limited to the descendants of a group.
+ *	As that brings the bbox of a layered group up to date, it must be
+ *	called before the bbox of the item is used.
+ *
+ * Results:
+ *	Tk_PathItem pointer, or NULL at the end.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static Tk_PathItem *
+DisplayIteratorNext(
+    TkPathCanvas *canvasPtr,
+    Tk_PathItem *itemPtr,
+    Tk_PathItem *groupPtr)	/* Group the iteration is limited to, or
+				 * NULL for all items. */
+{
+    if ((itemPtr->firstChildPtr != NULL)
+	    && !TkPathCanvasGroupLayer((Tk_PathCanvas) canvasPtr, itemPtr)) {
+	return itemPtr->firstChildPtr;
+    }
+    while (itemPtr->nextPtr == NULL) {
+	itemPtr = itemPtr->parentPtr;
+	if ((itemPtr == NULL) || (itemPtr == groupPtr)) {
+	    return NULL;
+	}
+    }
+    return itemPtr->nextPtr;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayItemInRedraw --
+ *
+ *	Decides whether an item takes part in a redraw of the given area.
+ *	It must intersect the area, or intersect the full redraw area if
+ *	its type requests that it be redrawn always (e.g. so subwindows can
+ *	be unmapped when they move off-screen), and it must not be hidden.
+ *
+ * Results:
+ *	1 if the item needs to be displayed, else 0.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+DisplayItemInRedraw(
+    TkPathCanvas *canvasPtr,
+    Tk_PathItem *itemPtr,
+    int screenX1, int screenY1,	/* The area drawn, in canvas coordinates. */
+    int screenX2, int screenY2)
+{
+    if ((itemPtr->x1 >= screenX2)
+	    || (itemPtr->y1 >= screenY2)
+	    || (itemPtr->x2 < screenX1)
+	    || (itemPtr->y2 < screenY1)) {
+	if (!(itemPtr->typePtr->alwaysRedraw & 1)
+		|| (itemPtr->x1 >= canvasPtr->redrawX2)
+		|| (itemPtr->y1 >= canvasPtr->redrawY2)
+		|| (itemPtr->x2 < canvasPtr->redrawX1)
+		|| (itemPtr->y2 < canvasPtr->redrawY1)) {
+	    return 0;
+	}
+    }
+    if (itemPtr->state == TK_PATHSTATE_HIDDEN ||
+	    (itemPtr->state == TK_PATHSTATE_NULL &&
+	     canvasPtr->canvas_state == TK_PATHSTATE_HIDDEN)) {
+	return 0;
+    }
+    return 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayFindCovers --
+ *
+ *	Collects the items of a redraw that paint an opaque, axis aligned
+ *	rectangle: prect items with a solid fill and pimage items with an
+ *	opaque photo, see TkPathPrectOpaqueArea and TkPathPimageOpaqueArea.
+ *	Their area is rounded inwards to whole pixels, since antialiased
+ *	edges are not opaque. Items that cover less than DISPLAY_MIN_COVER
+ *	pixels in either direction are not considered, and of more than
+ *	DISPLAY_MAX_COVERS the largest ones are kept.
+ *
+ * Results:
+ *	The number of covers stored in covers.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+DisplayFindCovers(
+    TkPathCanvas *canvasPtr,
+    int screenX1, int screenY1,	/* The area drawn, in canvas coordinates. */
+    int screenX2, int screenY2,
+    DisplayCover *covers)	/* Array of DISPLAY_MAX_COVERS to fill in. */
+{
+    Tk_PathItem *itemPtr, *nextPtr;
+    DisplayCover cover;
+    TMatrix m;
+    double r[4], x1, y1, x2, y2;
+    int order, numCovers = 0, i, smallest, opaque;
+
+    for (itemPtr = canvasPtr->rootItemPtr, order = 0; itemPtr != NULL;
+	    itemPtr = nextPtr, order++) {
+	nextPtr = DisplayIteratorNext(canvasPtr, itemPtr, NULL);
+	if (((itemPtr->typePtr != &tkpPrectType)
+		    && (itemPtr->typePtr != &tkpPimageType))
+		|| (MIN(itemPtr->x2, screenX2) - MAX(itemPtr->x1, screenX1)
+		    < DISPLAY_MIN_COVER)
+		|| (MIN(itemPtr->y2, screenY2) - MAX(itemPtr->y1, screenY1)
+		    < DISPLAY_MIN_COVER)
+		|| !DisplayItemInRedraw(canvasPtr, itemPtr,
+		    screenX1, screenY1, screenX2, screenY2)) {
+	    continue;
+	}
+	if (itemPtr->typePtr == &tkpPrectType) {
+	    opaque = TkPathPrectOpaqueArea(itemPtr, r, &m);
+	} else {
+	    opaque = TkPathPimageOpaqueArea(itemPtr, r, &m);
+	}
+
+	/*
+	 * Only scaling and translation keep the rectangle axis aligned.
+	 */
+
+	if (!opaque || (m.b != 0.0) || (m.c != 0.0)
+		|| (m.a <= 0.0) || (m.d <= 0.0)) {
+	    continue;
+	}
+	x1 = MAX(ceil(m.a * r[0] + m.tx), screenX1);
+	y1 = MAX(ceil(m.d * r[1] + m.ty), screenY1);
+	x2 = MIN(floor(m.a * r[2] + m.tx), screenX2);
+	y2 = MIN(floor(m.d * r[3] + m.ty), screenY2);
+	if ((x1 >= x2) || (y1 >= y2)) {
+	    continue;
+	}
+	cover.order = order;
+	cover.x1 = (int) x1;
+	cover.y1 = (int) y1;
+	cover.x2 = (int) x2;
+	cover.y2 = (int) y2;
+	if (numCovers < DISPLAY_MAX_COVERS) {
+	    covers[numCovers++] = cover;
+	    continue;
+	}
+	smallest = 0;
+	for (i = 1; i < numCovers; i++) {
+	    if ((double) (covers[i].x2 - covers[i].x1)
+		    * (covers[i].y2 - covers[i].y1)
+		    < (double) (covers[smallest].x2 - covers[smallest].x1)
+		    * (covers[smallest].y2 - covers[smallest].y1)) {
+		smallest = i;
+	    }
+	}
+	if ((x2 - x1) * (y2 - y1)
+		> (double) (covers[smallest].x2 - covers[smallest].x1)
+		* (covers[smallest].y2 - covers[smallest].y1)) {
+	    covers[smallest] = cover;
+	}
+    }
+    return numCovers;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayItemCovered --
+ *
+ *	Checks whether the part of an item inside the redraw area is hidden
+ *	by one of the covers above it.
+ *
+ * Results:
+ *	1 if the item needs not be drawn, else 0.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+DisplayItemCovered(
+    DisplayCover *covers,
+    int numCovers,
+    int order,			/* Index of the item in display list
+				 * order. */
+    Tk_PathItem *itemPtr,
+    int screenX1, int screenY1,	/* The area drawn, in canvas coordinates. */
+    int screenX2, int screenY2)
+{
+    int i, x1, y1, x2, y2;
+
+    /*
+     * The bbox counts x2 and y2 as inside.
+     */
+
+    x1 = MAX(itemPtr->x1, screenX1);
+    y1 = MAX(itemPtr->y1, screenY1);
+    x2 = MIN(itemPtr->x2 + 1, screenX2);
+    y2 = MIN(itemPtr->y2 + 1, screenY2);
+    for (i = 0; i < numCovers; i++) {
+	if ((covers[i].order > order)
+		&& (covers[i].x1 <= x1) && (covers[i].y1 <= y1)
+		&& (covers[i].x2 >= x2) && (covers[i].y2 >= y2)) {
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkPathCanvasDisplayGroupItems --
+ *
+ *	Draws the descendants of a group that lie in the given area, in
+ *	display list order, into a path context whose top left pixel is
+ *	at x, y in canvas coordinates. This is how a group renders its
+ *	layer, see TkPathCanvasGroupLayer. If ctx is NULL they are drawn
+ *	into the context of the canvas instead, and x, y, width and height
+ *	only give the area. Only path items can be drawn this way.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Items drawn.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkPathCanvasDisplayGroupItems(
+    Tk_PathCanvas canvas,
+    Tk_PathItem *groupPtr,
+    TkPathContext ctx,
+    int x, int y,		/* The area drawn, in canvas coordinates. */
+    int width, int height)
+{
+    TkPathCanvas *canvasPtr = (TkPathCanvas *) canvas;
+    TkPathContext oldContext = canvasPtr->context;
+    int oldXOrigin = canvasPtr->drawableXOrigin;
+    int oldYOrigin = canvasPtr->drawableYOrigin;
+    Tk_PathItem *itemPtr, *nextPtr;
+
+    if (ctx != NULL) {
+	canvasPtr->context = ctx;
+	canvasPtr->drawableXOrigin = x;
+	canvasPtr->drawableYOrigin = y;
+    }
+    for (itemPtr = groupPtr->firstChildPtr; itemPtr != NULL;
+	    itemPtr = nextPtr) {
+	nextPtr = DisplayIteratorNext(canvasPtr, itemPtr, groupPtr);
+	if (!DisplayItemInRedraw(canvasPtr, itemPtr,
+		x, y, x + width, y + height)) {
+	    continue;
+	}
+	TkPathResetTMatrix(canvasPtr->context);
+	(*itemPtr->typePtr->displayProc)(canvas, itemPtr, canvasPtr->display,
+		None, x, y, width, height);
+#ifdef MAC_OSX_TK
+	TkPathRestoreState(canvasPtr->context);
+#endif
+    }
+    canvasPtr->context = oldContext;
+    canvasPtr->drawableXOrigin = oldXOrigin;
+    canvasPtr->drawableYOrigin = oldYOrigin;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -2616,7 +3307,8 @@ DrawCanvas(
     Display *displayPtr;
     Tk_PhotoImageBlock blockPtr = { NULL, 0, 0, 0, 0, { 0, 0, 0, 0 } };
     Window window = None;
-    Tk_PathItem *itemPtr;
+    Tk_PathItem *itemPtr, *nextPtr;
+    DisplayBatch batch;
     Pixmap pixmap = None;
     XImage *ximagePtr = NULL;
     Visual *visualPtr;
@@ -2759,13 +3451,11 @@ DrawCanvas(
 
     canvasPtr->drawableXOrigin = pixmapX1;
     canvasPtr->drawableYOrigin = pixmapY1;
-#if defined(_WIN32) && !defined(PLATFORM_SDL)
-    canvasPtr->context = NULL;
-#else
-    canvasPtr->context = TkPathInit(tkwin, pixmap);
-#endif
+    DisplayBatchBegin(canvasPtr, &batch, pixmap, pixmapX1, pixmapY1,
+	    pmWidth, pmHeight);
     for (itemPtr = canvasPtr->rootItemPtr; itemPtr != NULL;
-	    itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
+	    itemPtr = nextPtr) {
+	nextPtr = DisplayIteratorNext(canvasPtr, itemPtr, NULL);
 	if ((itemPtr->x1 >= pixmapX2) || (itemPtr->y1 >= pixmapY2) ||
 		(itemPtr->x2 < pixmapX1) || (itemPtr->y2 < pixmapY1)) {
 	    if (!(itemPtr->typePtr->alwaysRedraw & 1)) {
@@ -2775,37 +3465,11 @@ DrawCanvas(
 	if ((itemPtr->state == TK_PATHSTATE_HIDDEN) ||
 		((itemPtr->state == TK_PATHSTATE_NULL) &&
 		    (canvasPtr->canvas_state == TK_PATHSTATE_HIDDEN))) {
-	    continue;
-	}
-#if defined(_WIN32) && !defined(PLATFORM_SDL)
-	if (itemPtr->typePtr->isPathType) {
-	    if (canvasPtr->context == NULL) {
-		canvasPtr->context = TkPathInit(tkwin, pixmap);
-	    } else {
-		TkPathResetTMatrix(canvasPtr->context);
-	    }
-	} else if (canvasPtr->context != NULL) {
-	    TkPathFree(canvasPtr->context);
-	    canvasPtr->context = NULL;
-	}
-#else
-	if (itemPtr->typePtr->isPathType) {
-	    TkPathResetTMatrix(canvasPtr->context);
-	}
-#endif
-	(*itemPtr->typePtr->displayProc)((Tk_PathCanvas) canvasPtr, itemPtr,
-		canvasPtr->display, pixmap, pixmapX1, pixmapY1,
-		pmWidth, pmHeight);
-#ifdef MAC_OSX_TK
-	if (itemPtr->typePtr->isPathType) {
-	    TkPathRestoreState(canvasPtr->context);
+	    continue;
 	}
-#endif
-    }
-    if (canvasPtr->context != NULL) {
-	TkPathFree(canvasPtr->context);
-	canvasPtr->context = NULL;
+	DisplayBatchItem(&batch, itemPtr);
     }
+    DisplayBatchEnd(&batch);
 
     /*
      * Copy the Pixmap into an ZPixmap format XImage so we can copy it across
@@ -3133,10 +3797,12 @@ DisplayCanvas(
 {
     TkPathCanvas *canvasPtr = (TkPathCanvas *) clientData;
     Tk_Window tkwin = canvasPtr->tkwin;
-    Tk_PathItem *itemPtr;
+    Tk_PathItem *itemPtr, *nextPtr;
+    DisplayBatch batch;
+    DisplayCover covers[DISPLAY_MAX_COVERS];
     Pixmap pixmap;
     int screenX1, screenX2, screenY1, screenY2, width, height;
-    int flags;
+    int flags, numCovers, order, i;
 
     if (canvasPtr->flags & CANVAS_DELETED) {
 	return;
@@ -3166,7 +3832,18 @@ DisplayCanvas(
     while (canvasPtr->flags & REPICK_NEEDED) {
 	Tcl_Preserve((ClientData) canvasPtr);
 	canvasPtr->flags &= ~REPICK_NEEDED;
-	PickCurrentItem(canvasPtr, &canvasPtr->pickEvent);
+	if (canvasPtr->flags & MOTION_PENDING) {
+	    /*
+	     * A coalesced motion event is waiting: picking at its position
+	     * now makes the pick at the old position redundant.
+	     */
+
+	    Tcl_CancelIdleCall(CanvasMotionProc, (ClientData) canvasPtr);
+	    canvasPtr->numPicksSaved++;
+	    CanvasFlushMotion(canvasPtr);
+	} else {
+	    PickCurrentItem(canvasPtr, &canvasPtr->pickEvent);
+	}
 	flags = canvasPtr->flags;
 	Tcl_Release((ClientData) canvasPtr);
 	if (flags & CANVAS_DELETED) {
@@ -3218,6 +3895,7 @@ DisplayCanvas(
 
 	width = screenX2 - screenX1;
 	height = screenY2 - screenY1;
+	canvasPtr->numPixelsRedrawn += (long) width * height;
 
 #ifndef TK_PATH_NO_DOUBLE_BUFFERING
 	/*
@@ -3290,75 +3968,50 @@ DisplayCanvas(
 #endif /* TK_PATH_NO_DOUBLE_BUFFERING */
 
 	/*
-	 * Clear the area to be redrawn.
+	 * Find the opaque items that hide others, and clear the area to be
+	 * redrawn unless one of them fills it.
 	 */
 
-	XFillRectangle(Tk_Display(tkwin), pixmap, canvasPtr->pixmapGC,
-		screenX1 - canvasPtr->drawableXOrigin,
-		screenY1 - canvasPtr->drawableYOrigin, (unsigned int) width,
-		(unsigned int) height);
+	numCovers = DisplayFindCovers(canvasPtr, screenX1, screenY1,
+		screenX2, screenY2, covers);
+	for (i = 0; i < numCovers; i++) {
+	    if ((covers[i].x1 == screenX1) && (covers[i].y1 == screenY1)
+		    && (covers[i].x2 == screenX2)
+		    && (covers[i].y2 == screenY2)) {
+		break;
+	    }
+	}
+	if (i == numCovers) {
+	    XFillRectangle(Tk_Display(tkwin), pixmap, canvasPtr->pixmapGC,
+		    screenX1 - canvasPtr->drawableXOrigin,
+		    screenY1 - canvasPtr->drawableYOrigin, (unsigned int) width,
+		    (unsigned int) height);
+	}
 
 	/*
-	 * Scan through the item list, redrawing those items that need it. An
-	 * item must be redrawn if either (a) it intersects the smaller
-	 * on-screen area or (b) it intersects the full canvas area and its
-	 * type requests that it be redrawn always (e.g. so subwindows can be
-	 * unmapped when they move off-screen).
+	 * Scan through the item list, redrawing those items that need it
+	 * and are not hidden by a cover above them. Items that are always
+	 * redrawn are kept, as they may have to unmap a subwindow.
 	 */
 
-#if defined(_WIN32) && !defined(PLATFORM_SDL)
-	canvasPtr->context = NULL;
-#else
-	canvasPtr->context = TkPathInit(tkwin, pixmap);
-#endif
-	for (itemPtr = canvasPtr->rootItemPtr; itemPtr != NULL;
-		itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
-	    if ((itemPtr->x1 >= screenX2)
-		    || (itemPtr->y1 >= screenY2)
-		    || (itemPtr->x2 < screenX1)
-		    || (itemPtr->y2 < screenY1)) {
-		if (!(itemPtr->typePtr->alwaysRedraw & 1)
-			|| (itemPtr->x1 >= canvasPtr->redrawX2)
-			|| (itemPtr->y1 >= canvasPtr->redrawY2)
-			|| (itemPtr->x2 < canvasPtr->redrawX1)
-			|| (itemPtr->y2 < canvasPtr->redrawY1)) {
-		    continue;
-		}
-	    }
-	    if (itemPtr->state == TK_PATHSTATE_HIDDEN ||
-		(itemPtr->state == TK_PATHSTATE_NULL &&
-		 canvasPtr->canvas_state == TK_PATHSTATE_HIDDEN)) {
+	DisplayBatchBegin(canvasPtr, &batch, pixmap, screenX1, screenY1,
+		width, height);
+	for (itemPtr = canvasPtr->rootItemPtr, order = 0; itemPtr != NULL;
+		itemPtr = nextPtr, order++) {
+	    nextPtr = DisplayIteratorNext(canvasPtr, itemPtr, NULL);
+	    if (!DisplayItemInRedraw(canvasPtr, itemPtr,
+		    screenX1, screenY1, screenX2, screenY2)) {
 		continue;
 	    }
-#if defined(_WIN32) && !defined(PLATFORM_SDL)
-	    if (itemPtr->typePtr->isPathType) {
-		if (canvasPtr->context == NULL) {
-		    canvasPtr->context = TkPathInit(tkwin, pixmap);
-		} else {
-		    TkPathResetTMatrix(canvasPtr->context);
-		}
-	    } else if (canvasPtr->context != NULL) {
-		TkPathFree(canvasPtr->context);
-		canvasPtr->context = NULL;
-	    }
-#else
-	    if (itemPtr->typePtr->isPathType) {
-		TkPathResetTMatrix(canvasPtr->context);
-	    }
-#endif
-	    (*itemPtr->typePtr->displayProc)((Tk_PathCanvas) canvasPtr, itemPtr,
-		    canvasPtr->display, pixmap, screenX1, screenY1, width,
-		    height);
-#ifdef MAC_OSX_TK
-	    if (itemPtr->typePtr->isPathType) {
-		TkPathRestoreState(canvasPtr->context);
+	    if ((numCovers > 0) && !(itemPtr->typePtr->alwaysRedraw & 1)
+		    && DisplayItemCovered(covers, numCovers, order, itemPtr,
+			    screenX1, screenY1, screenX2, screenY2)) {
+		canvasPtr->numItemsCovered++;
+		continue;
 	    }
-#endif
-	}
-	if (canvasPtr->context != NULL) {
-	    TkPathFree(canvasPtr->context);
-	    canvasPtr->context = NULL;
+	    DisplayBatchItem(&batch, itemPtr);
 	}
+	DisplayBatchEnd(&batch);
 
 #ifndef TK_PATH_NO_DOUBLE_BUFFERING
 	/*
@@ -3463,7 +4116,7 @@ CanvasEventProc(
 
 	x = eventPtr->xexpose.x + canvasPtr->xOrigin;
 	y = eventPtr->xexpose.y + canvasPtr->yOrigin;
-	Tk_PathCanvasEventuallyRedraw((Tk_PathCanvas) canvasPtr, x, y,
+	CanvasEventuallyRedraw(canvasPtr, x, y,
 		x + eventPtr->xexpose.width,
 		y + eventPtr->xexpose.height);
 	if ((eventPtr->xexpose.x < canvasPtr->inset)
@@ -3482,6 +4135,9 @@ CanvasEventProc(
 	    if (canvasPtr->flags & REDRAW_PENDING) {
 		Tcl_CancelIdleCall(DisplayCanvas, (ClientData) canvasPtr);
 	    }
+	    if (canvasPtr->flags & MOTION_PENDING) {
+		Tcl_CancelIdleCall(CanvasMotionProc, (ClientData) canvasPtr);
+	    }
 	    Tcl_EventuallyFree((ClientData) canvasPtr,
 		    (Tcl_FreeProc *) DestroyCanvas);
 	}
@@ -3494,7 +4150,7 @@ CanvasEventProc(
 	 */
 
 	CanvasSetOrigin(canvasPtr, canvasPtr->xOrigin, canvasPtr->yOrigin);
-	Tk_PathCanvasEventuallyRedraw((Tk_PathCanvas) canvasPtr, canvasPtr->xOrigin,
+	CanvasEventuallyRedraw(canvasPtr, canvasPtr->xOrigin,
 		canvasPtr->yOrigin,
 		canvasPtr->xOrigin + Tk_Width(canvasPtr->tkwin),
 		canvasPtr->yOrigin + Tk_Height(canvasPtr->tkwin));
@@ -3588,6 +4244,63 @@ Tk_PathCanvasEventuallyRedraw(
 				 * Pixels on edge are not redrawn. */
 {
     TkPathCanvas *canvasPtr = (TkPathCanvas *) canvas;
+
+    canvasPtr->sceneGeneration++;
+#ifndef TKP_NO_POSTSCRIPT
+    /*
+     * Items call this when their appearance changes, also off-screen, so
+     * the area is remembered for the Postscript cache before any clipping.
+     */
+
+    if ((canvasPtr->psCache.numEntries > 0) && (x1 < x2) && (y1 < y2)) {
+	if (canvasPtr->flags & PS_DIRTY) {
+	    if (x1 < canvasPtr->psDirtyX1) {
+		canvasPtr->psDirtyX1 = x1;
+	    }
+	    if (y1 < canvasPtr->psDirtyY1) {
+		canvasPtr->psDirtyY1 = y1;
+	    }
+	    if (x2 > canvasPtr->psDirtyX2) {
+		canvasPtr->psDirtyX2 = x2;
+	    }
+	    if (y2 > canvasPtr->psDirtyY2) {
+		canvasPtr->psDirtyY2 = y2;
+	    }
+	} else {
+	    canvasPtr->psDirtyX1 = x1;
+	    canvasPtr->psDirtyY1 = y1;
+	    canvasPtr->psDirtyX2 = x2;
+	    canvasPtr->psDirtyY2 = y2;
+	    canvasPtr->flags |= PS_DIRTY;
+	}
+    }
+#endif
+    CanvasEventuallyRedraw(canvasPtr, x1, y1, x2, y2);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * CanvasEventuallyRedraw --
+ *
+ *	Like Tk_PathCanvasEventuallyRedraw, but for redraws that don't change
+ *	the contents of the canvas, such as exposures and scrolling.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The screen will eventually be refreshed.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+CanvasEventuallyRedraw(
+    TkPathCanvas *canvasPtr,	/* Information about widget. */
+    int x1, int y1,		/* Upper left corner of area to redraw. */
+    int x2, int y2)		/* Lower right corner of area to redraw. */
+{
     Tk_Window tkwin = canvasPtr->tkwin;
 
     if ((canvasPtr->flags & CANVAS_DELETED) || !Tk_IsMapped(tkwin)) {
@@ -3649,9 +4362,20 @@ EventuallyRedrawItem(
 {
     TkPathCanvas *canvasPtr = (TkPathCanvas *) canvas;
 
+    canvasPtr->sceneGeneration++;
     if (itemPtr == NULL || canvasPtr->tkwin == NULL) {
 	return;
     }
+#ifndef TKP_NO_POSTSCRIPT
+    TkPathCanvasPsForget(canvasPtr, itemPtr);
+#endif
+
+    /*
+     * Ancestors must know even if the item is off-screen: their bbox and
+     * layers cover more than the window.
+     */
+
+    SetAncestorsDirtyBbox(itemPtr);
     if ((itemPtr->x1 >= itemPtr->x2) || (itemPtr->y1 >= itemPtr->y2) ||
  	    (itemPtr->x2 < canvasPtr->xOrigin) ||
 	    (itemPtr->y2 < canvasPtr->yOrigin) ||
@@ -3684,7 +4408,6 @@ EventuallyRedrawItem(
 	}
 	itemPtr->redraw_flags |= FORCE_REDRAW;
     }
-    SetAncestorsDirtyBbox(itemPtr);
     if (canvasPtr->flags & DRAW_OFFSCREEN) {
 	return;
     }
@@ -3994,7 +4717,9 @@ CanvasScaleGroup(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int compensate,
  *
  *	Used by items when they need a redisplay for some reason
  *	so that its ancestor groups know that they need to compute
- *	a new bbox when requested.
+ *	a new bbox when requested, and that their layers are out of
+ *	date. Items that schedule their redisplay themselves must call
+ *	it as well.
  *
  * Results:
  *	None.
@@ -4005,7 +4730,7 @@ CanvasScaleGroup(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int compensate,
  *----------------------------------------------------------------------
  */
 
-static void
+void
 SetAncestorsDirtyBbox(Tk_PathItem *itemPtr)
 {
     Tk_PathItem *walkPtr;
@@ -4104,8 +4829,12 @@ InitCanvas(void)
     tkpCircleType.nextPtr = &tkpEllipseType;
     tkpEllipseType.nextPtr = &tkpPimageType;
     tkpPimageType.nextPtr = &tkpPtextType;
-    tkpPtextType.nextPtr = &tkpGroupType;
-    tkpGroupType.nextPtr = NULL;
+    tkpPtextType.nextPtr = &tkpPtilesType;
+    tkpPtilesType.nextPtr = &tkpGroupType;
+    tkpGroupType.nextPtr = &tkpLrectType;
+    tkpLrectType.nextPtr = &tkpLcircleType;
+    tkpLcircleType.nextPtr = &tkpLellipseType;
+    tkpLellipseType.nextPtr = NULL;
 
     Tcl_MutexUnlock(&typeListMutex);
 }
@@ -4189,6 +4918,61 @@ ItemCreate(Tcl_Interp *interp, TkPathCanvas *canvasPtr,
     return TCL_OK;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasCreateItem, TkPathCanvasDeleteItem --
+ *
+ *	Create or delete an item from C code, doing the same as the
+ *	'create' and 'delete' widget commands without going through
+ *	them. Items created this way are redrawn like any other.
+ *
+ * Results:
+ *	TkPathCanvasCreateItem returns a standard Tcl result and the new
+ *	item in itemPtrPtr.
+ *
+ * Side effects:
+ *	Items are created or deleted.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathCanvasCreateItem(Tcl_Interp *interp, TkPathCanvas *canvasPtr,
+	const char *typeName, int objc, Tcl_Obj *const objv[],
+	Tk_PathItem **itemPtrPtr)
+{
+    Tk_PathItemType *typePtr;
+
+    Tcl_MutexLock(&typeListMutex);
+    for (typePtr = typeList; typePtr != NULL; typePtr = typePtr->nextPtr) {
+	if (strcmp(typeName, typePtr->name) == 0) {
+	    break;
+	}
+    }
+    Tcl_MutexUnlock(&typeListMutex);
+    if (typePtr == NULL) {
+	Tcl_AppendResult(interp, "unknown item type \"", typeName, "\"",
+		NULL);
+	return TCL_ERROR;
+    }
+    if (ItemCreate(interp, canvasPtr, typePtr, 0, itemPtrPtr,
+	    objc, objv) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    EventuallyRedrawItem((Tk_PathCanvas) canvasPtr, *itemPtrPtr);
+    canvasPtr->flags |= REPICK_NEEDED;
+    return TCL_OK;
+}
+
+void
+TkPathCanvasDeleteItem(TkPathCanvas *canvasPtr, Tk_PathItem *itemPtr)
+{
+    if (itemPtr->id != 0) {
+	ItemDelete(canvasPtr, itemPtr);
+    }
+}
+
 static Tcl_Obj *
 UnshareObj(Tcl_Obj *objPtr)
 {
@@ -4408,6 +5192,9 @@ ItemDelete(TkPathCanvas *canvasPtr, Tk_PathItem *itemPtr)
     }
 
     EventuallyRedrawItem((Tk_PathCanvas) canvasPtr, itemPtr);
+#ifndef TKP_NO_POSTSCRIPT
+    TkPathCanvasPsForget(canvasPtr, itemPtr);
+#endif
     if (canvasPtr->bindingTable != NULL) {
 	Tk_DeleteAllBindings(canvasPtr->bindingTable,
 			     (ClientData) itemPtr);
@@ -4444,6 +5231,9 @@ ItemDelete(TkPathCanvas *canvasPtr, Tk_PathItem *itemPtr)
 	    || (itemPtr == canvasPtr->hotPrevPtr)) {
 	canvasPtr->hotPtr = NULL;
     }
+    if (itemPtr == canvasPtr->matchItemPtr) {
+	canvasPtr->matchItemPtr = NULL;
+    }
     ckfree((char *) itemPtr);
 }
 
@@ -5564,6 +6354,7 @@ FindItems(
 
     if (newTag != NULL) {
 	uid = Tk_GetUid(Tcl_GetString(newTag));
+	canvasPtr->matchItemPtr = NULL;
     } else {
 	uid = NULL;
     }
@@ -6009,6 +6800,30 @@ CanvasBindProc(
 
     Tcl_Preserve((ClientData) canvasPtr);
 
+    /*
+     * With -coalescemotion, motion events only replace the pending one; the
+     * pick happens once per idle cycle. Any other event first delivers the
+     * pending motion so that bindings still see the events in order.
+     */
+
+    if ((eventPtr->type == MotionNotify) && canvasPtr->coalesceMotion) {
+	if (canvasPtr->flags & MOTION_PENDING) {
+	    canvasPtr->numPicksSaved++;
+	} else {
+	    canvasPtr->flags |= MOTION_PENDING;
+	    Tcl_DoWhenIdle(CanvasMotionProc, (ClientData) canvasPtr);
+	}
+	canvasPtr->motionEvent = *eventPtr;
+	goto done;
+    }
+    if (canvasPtr->flags & MOTION_PENDING) {
+	Tcl_CancelIdleCall(CanvasMotionProc, (ClientData) canvasPtr);
+	CanvasFlushMotion(canvasPtr);
+	if (canvasPtr->flags & CANVAS_DELETED) {
+	    goto done;
+	}
+    }
+
     /*
      * This code below keeps track of the current modifier state in
      * canvasPtr>state. This information is used to defer repicks of the
@@ -6086,6 +6901,74 @@ CanvasBindProc(
   done:
     Tcl_Release((ClientData) canvasPtr);
 }
+
+/*
+ *--------------------------------------------------------------
+ *
+ * CanvasFlushMotion --
+ *
+ *	Deliver the motion event held back by -coalescemotion: pick the
+ *	current item at its position and process its bindings.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Same as for CanvasBindProc. Callers should protect themselves with
+ *	Tcl_Preserve and Tcl_Release.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+CanvasFlushMotion(
+    TkPathCanvas *canvasPtr)	/* Canvas with a pending motion event. */
+{
+    XEvent event;
+
+    /*
+     * Work on a copy: the bindings could enter the event loop and queue
+     * another motion event.
+     */
+
+    event = canvasPtr->motionEvent;
+    canvasPtr->flags &= ~MOTION_PENDING;
+    canvasPtr->state = event.xmotion.state;
+    PickCurrentItem(canvasPtr, &event);
+    if (!(canvasPtr->flags & CANVAS_DELETED)) {
+	CanvasDoEvent(canvasPtr, &event);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * CanvasMotionProc --
+ *
+ *	This idle handler delivers the latest of the motion events that
+ *	arrived since the last idle cycle.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	See CanvasFlushMotion.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+CanvasMotionProc(
+    ClientData clientData)	/* Pointer to canvas structure. */
+{
+    TkPathCanvas *canvasPtr = (TkPathCanvas *) clientData;
+
+    Tcl_Preserve((ClientData) canvasPtr);
+    if (canvasPtr->flags & MOTION_PENDING) {
+	CanvasFlushMotion(canvasPtr);
+    }
+    Tcl_Release((ClientData) canvasPtr);
+}
 
 /*
  *--------------------------------------------------------------
@@ -6250,6 +7133,7 @@ PickCurrentItem(
 		if (ptagsPtr->tagPtr[i] == searchUids->currentUid) {
 		    ptagsPtr->tagPtr[i] = ptagsPtr->tagPtr[ptagsPtr->numTags-1];
 		    ptagsPtr->numTags--;
+		    canvasPtr->matchItemPtr = NULL;
 		    break;
 		}
 	    }
@@ -6286,6 +7170,7 @@ PickCurrentItem(
 	XEvent event;
 
 	DoItem(NULL, canvasPtr->currentItemPtr, searchUids->currentUid);
+	canvasPtr->matchItemPtr = NULL;
 	if ((canvasPtr->currentItemPtr->redraw_flags & TK_ITEM_STATE_DEPENDANT &&
 		prevItemPtr != canvasPtr->currentItemPtr)) {
 	    (*canvasPtr->currentItemPtr->typePtr->configProc)(canvasPtr->interp,
@@ -6301,6 +7186,47 @@ PickCurrentItem(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * PickCoversRect --
+ *
+ *	Checks that an item is hit at every pointer position strictly
+ *	inside a rectangle. Pointer positions are whole pixels in canvas
+ *	coordinates, so testing those points with the pointProc is exact
+ *	whatever the shape of the item; an areaProc only tells whether the
+ *	item overlaps the rectangle or lies within it.
+ *
+ * Results:
+ *	1 if the item is within closeEnough of every such position, else 0.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+PickCoversRect(
+    TkPathCanvas *canvasPtr,	/* Canvas widget to search. */
+    Tk_PathItem *itemPtr,	/* The picked item. */
+    double rect[4])		/* The open rectangle x1, y1, x2, y2. */
+{
+    double point[2];
+
+    for (point[1] = floor(rect[1]) + 1.0; point[1] < rect[3];
+	    point[1] += 1.0) {
+	for (point[0] = floor(rect[0]) + 1.0; point[0] < rect[2];
+		point[0] += 1.0) {
+	    if ((*itemPtr->typePtr->pointProc)((Tk_PathCanvas) canvasPtr,
+		    itemPtr, point) > canvasPtr->closeEnough) {
+		return 0;
+	    }
+	}
+    }
+    return 1;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -6310,12 +7236,20 @@ PickCurrentItem(
  *	"close" to the coordinates. Canvas items that are hidden or disabled
  *	are ignored.
  *
+ *	While searching we also work out a rectangle around (x,y) in which
+ *	the answer stays the same: every item that is not picked must stay
+ *	further away than closeEnough, either because its bbox is far
+ *	enough or by the margin its distance leaves, and the picked item
+ *	must be hit at every pointer position inside the rectangle, see
+ *	PickCoversRect. The answer is kept with that rectangle until the
+ *	scene generation changes.
+ *
  * Results:
  *	The return value is a pointer to the topmost item that is close to
  *	(x,y), or NULL if no item is close.
  *
  * Side effects:
- *	None.
+ *	The pick cache of the canvas is updated.
  *
  *----------------------------------------------------------------------
  */
@@ -6329,11 +7263,30 @@ CanvasFindClosest(
     Tk_PathItem *itemPtr;
     Tk_PathItem *bestPtr;
     int x1, y1, x2, y2;
+    double closeEnough = canvasPtr->closeEnough;
+    double *region = canvasPtr->pickRegion;
+    double dist, gap, rect[4];
+    int axis, i;
+
+    if ((canvasPtr->pickGeneration == canvasPtr->sceneGeneration)
+	    && (coords[0] > region[0]) && (coords[0] < region[2])
+	    && (coords[1] > region[1]) && (coords[1] < region[3])) {
+	canvasPtr->numPickHits++;
+	return canvasPtr->pickItemPtr;
+    }
+    canvasPtr->numPicks++;
 
-    x1 = (int) (coords[0] - canvasPtr->closeEnough);
-    y1 = (int) (coords[1] - canvasPtr->closeEnough);
-    x2 = (int) (coords[0] + canvasPtr->closeEnough);
-    y2 = (int) (coords[1] + canvasPtr->closeEnough);
+    x1 = (int) (coords[0] - closeEnough);
+    y1 = (int) (coords[1] - closeEnough);
+    x2 = (int) (coords[0] + closeEnough);
+    y2 = (int) (coords[1] + closeEnough);
+
+    /*
+     * The region is open: a bound equal to a coordinate excludes it.
+     */
+
+    region[0] = region[1] = -DBL_MAX;
+    region[2] = region[3] = DBL_MAX;
 
     bestPtr = NULL;
     for (itemPtr = canvasPtr->rootItemPtr; itemPtr != NULL;
@@ -6347,13 +7300,85 @@ CanvasFindClosest(
 	}
 	if ((itemPtr->x1 > x2) || (itemPtr->x2 < x1)
 		|| (itemPtr->y1 > y2) || (itemPtr->y2 < y1)) {
+	    /*
+	     * Keep the side of the bbox with the widest gap out of reach.
+	     */
+
+	    axis = 0;
+	    gap = itemPtr->x1 - closeEnough - coords[0];
+	    if (coords[0] - itemPtr->x2 - closeEnough > gap) {
+		axis = 1;
+		gap = coords[0] - itemPtr->x2 - closeEnough;
+	    }
+	    if (itemPtr->y1 - closeEnough - coords[1] > gap) {
+		axis = 2;
+		gap = itemPtr->y1 - closeEnough - coords[1];
+	    }
+	    if (coords[1] - itemPtr->y2 - closeEnough > gap) {
+		axis = 3;
+	    }
+	    switch (axis) {
+	    case 0:
+		region[2] = MIN(region[2], itemPtr->x1 - closeEnough);
+		break;
+	    case 1:
+		region[0] = MAX(region[0], itemPtr->x2 + closeEnough);
+		break;
+	    case 2:
+		region[3] = MIN(region[3], itemPtr->y1 - closeEnough);
+		break;
+	    case 3:
+		region[1] = MAX(region[1], itemPtr->y2 + closeEnough);
+		break;
+	    }
 	    continue;
 	}
-	if ((*itemPtr->typePtr->pointProc)((Tk_PathCanvas) canvasPtr,
-		itemPtr, coords) <= canvasPtr->closeEnough) {
+	dist = (*itemPtr->typePtr->pointProc)((Tk_PathCanvas) canvasPtr,
+		itemPtr, coords);
+	if (dist <= closeEnough) {
 	    bestPtr = itemPtr;
+	} else if (dist < DBL_MAX) {
+	    /*
+	     * A distance changes no faster than the pointer moves; use the
+	     * square inside the circle that keeps the item out of reach.
+	     */
+
+	    gap = (dist - closeEnough) * 0.7071;
+	    region[0] = MAX(region[0], coords[0] - gap);
+	    region[1] = MAX(region[1], coords[1] - gap);
+	    region[2] = MIN(region[2], coords[0] + gap);
+	    region[3] = MIN(region[3], coords[1] + gap);
+	}
+    }
+
+    if (bestPtr != NULL) {
+	/*
+	 * The picked item must be hit everywhere in the region. Try two
+	 * small squares around the point and otherwise fall back to the
+	 * point itself.
+	 */
+
+	for (gap = 4.0; gap >= 2.0; gap /= 2.0) {
+	    rect[0] = MAX(region[0], coords[0] - gap);
+	    rect[1] = MAX(region[1], coords[1] - gap);
+	    rect[2] = MIN(region[2], coords[0] + gap);
+	    rect[3] = MIN(region[3], coords[1] + gap);
+	    if (PickCoversRect(canvasPtr, bestPtr, rect)) {
+		break;
+	    }
+	}
+	if (gap < 2.0) {
+	    rect[0] = coords[0] - 0.5;
+	    rect[1] = coords[1] - 0.5;
+	    rect[2] = coords[0] + 0.5;
+	    rect[3] = coords[1] + 0.5;
+	}
+	for (i = 0; i < 4; i++) {
+	    region[i] = rect[i];
 	}
     }
+    canvasPtr->pickItemPtr = bestPtr;
+    canvasPtr->pickGeneration = canvasPtr->sceneGeneration;
     return bestPtr;
 }
 
@@ -6420,19 +7445,38 @@ CanvasDoEvent(
      */
 
     /*
-     * Flag and count all expressions that match item's tags.
+     * Find all expressions that match item's tags. They are evaluated
+     * only again for another item or when the tags or the expressions
+     * change.
      */
 
-    numExprs = 0;
-    expr = canvasPtr->bindTagExprs;
-    while (expr) {
-	expr->index = 0;
-    	expr->match = TagSearchEvalExpr(expr, itemPtr);
-	if (expr->match) {
+    if ((itemPtr != canvasPtr->matchItemPtr)
+	    || (canvasPtr->matchEpoch != canvasPtr->bindExprEpoch)) {
+	numExprs = 0;
+	for (expr = canvasPtr->bindTagExprs; expr; expr = expr->next) {
 	    numExprs++;
 	}
-	expr = expr->next;
+	if (canvasPtr->matchPtr != NULL) {
+	    ckfree((char *) canvasPtr->matchPtr);
+	    canvasPtr->matchPtr = NULL;
+	}
+	if (numExprs > 0) {
+	    canvasPtr->matchPtr = (Tk_Uid *)
+		    ckalloc((unsigned) (numExprs * sizeof(Tk_Uid)));
+	}
+	numExprs = 0;
+	for (expr = canvasPtr->bindTagExprs; expr; expr = expr->next) {
+	    expr->index = 0;
+	    expr->match = TagSearchEvalExpr(expr, itemPtr);
+	    if (expr->match) {
+		canvasPtr->matchPtr[numExprs++] = expr->uid;
+	    }
+	}
+	canvasPtr->matchItemPtr = itemPtr;
+	canvasPtr->numMatches = numExprs;
+	canvasPtr->matchEpoch = canvasPtr->bindExprEpoch;
     }
+    numExprs = canvasPtr->numMatches;
 
     numObjects = numTags + numExprs + 2;
     if (numObjects <= NUM_STATIC) {
@@ -6454,13 +7498,8 @@ CanvasDoEvent(
      * Copy uids of matching expressions into object array
      */
 
-    i = numTags + 2;
-    expr = canvasPtr->bindTagExprs;
-    while (expr) {
-    	if (expr->match) {
-	    objectPtr[i++] = (int *) expr->uid;
-	}
-	expr = expr->next;
+    for (i = 0; i < numExprs; i++) {
+	objectPtr[numTags + 2 + i] = (ClientData) canvasPtr->matchPtr[i];
     }
 
     /*
@@ -6993,14 +8032,14 @@ CanvasSetOrigin(
      * undisplay themselves.
      */
 
-    Tk_PathCanvasEventuallyRedraw((Tk_PathCanvas) canvasPtr,
+    CanvasEventuallyRedraw(canvasPtr,
 	    canvasPtr->xOrigin, canvasPtr->yOrigin,
 	    canvasPtr->xOrigin + Tk_Width(canvasPtr->tkwin),
 	    canvasPtr->yOrigin + Tk_Height(canvasPtr->tkwin));
     canvasPtr->xOrigin = xOrigin;
     canvasPtr->yOrigin = yOrigin;
     canvasPtr->flags |= UPDATE_SCROLLBARS;
-    Tk_PathCanvasEventuallyRedraw((Tk_PathCanvas) canvasPtr,
+    CanvasEventuallyRedraw(canvasPtr,
 	    canvasPtr->xOrigin, canvasPtr->yOrigin,
 	    canvasPtr->xOrigin + Tk_Width(canvasPtr->tkwin),
 	    canvasPtr->yOrigin + Tk_Height(canvasPtr->tkwin));
@@ -7092,7 +8131,7 @@ Tk_PathCanvasPsColor(
  *
  * Side effects:
  *	The Postscript font name is entered into psInfoPtr->fontTable if it
- *	wasn't already there.
+ *	wasn't already there. The item's fragment is not cached.
  *
  *--------------------------------------------------------------
  */
@@ -7105,6 +8144,7 @@ Tk_PathCanvasPsFont(
     Tk_Font tkfont)		/* Information about font in which text is to
 				 * be printed. */
 {
+    ((TkPathCanvas *) canvas)->flags |= PS_FONT_USED;
     return Tk_PostscriptFont(interp, ((TkPathCanvas *) canvas)->psInfo, tkfont);
 }
 
@@ -7202,37 +8242,6 @@ Tk_PathCanvasPsY(
     return Tk_PostscriptY(y, ((TkPathCanvas *) canvas)->psInfo);
 }
 
-/*
- *--------------------------------------------------------------
- *
- * Tk_PathCanvasPsPath --
- *
- *	Given an array of points for a path, generate Postscript commands to
- *	create the path.
- *
- * Results:
- *	Postscript commands get appended to what's in interp->result.
- *
- * Side effects:
- *	None.
- *
- *--------------------------------------------------------------
- */
-
-void
-Tk_PathCanvasPsPath(
-    Tcl_Interp *interp,		/* Put generated Postscript in this
-				 * interpreter's result field. */
-    Tk_PathCanvas canvas,	/* Canvas on whose behalf Postscript is being
-				 * generated. */
-    double *coordPtr,		/* Pointer to first in array of 2*numPoints
-				 * coordinates giving points for path. */
-    int numPoints)		/* Number of points at *coordPtr. */
-{
-    Tk_PostscriptPath(interp, ((TkPathCanvas *) canvas)->psInfo,
-	    coordPtr, numPoints);
-}
-
 #endif /* TKP_POSTSCRIPT */
 
 #ifdef NOWHERE_USED
@@ -158,6 +158,33 @@ typedef struct TkPathCanvas {
     int state;			/* Last known modifier state. Used to defer
 				 * picking a new current object while buttons
 				 * are down. */
+    int coalesceMotion;		/* Non-zero means MotionNotify events are
+				 * queued in motionEvent and only the latest
+				 * one is picked and delivered at idle time. */
+    XEvent motionEvent;		/* The pending motion event; only valid if
+				 * the MOTION_PENDING flag is set. */
+    long numPicks;		/* Number of times the current item was
+				 * searched for. */
+    long numPicksSaved;		/* Number of picks avoided by coalescing
+				 * motion events. */
+    unsigned long sceneGeneration;
+				/* Incremented whenever an item is created,
+				 * deleted or changed, or the canvas is
+				 * configured. */
+    unsigned long pickGeneration;
+				/* sceneGeneration for which pickItemPtr and
+				 * pickRegion are valid; 0 means never. */
+    double pickRegion[4];	/* Open rectangle, in canvas coordinates,
+				 * within which pickItemPtr is the result of
+				 * CanvasFindClosest. */
+    Tk_PathItem *pickItemPtr;	/* Cached result of CanvasFindClosest. */
+    long numPickHits;		/* Number of picks answered by the cache. */
+    long numItemsCovered;	/* Number of items not drawn as opaque items
+				 * above them hid them. */
+    long numLayersRendered;	/* Number of times a group layer was
+				 * rendered. */
+    long numPixelsRedrawn;	/* Total area of the regions redrawn by
+				 * DisplayCanvas. */
 
     /*
      * Information used for managing scrollbars:
@@ -228,6 +255,12 @@ typedef struct TkPathCanvas {
     Tk_PostscriptInfo psInfo;	/* Pointer to information used for generating
 				 * Postscript for the canvas. NULL means no
 				 * Postscript is currently being generated. */
+    Tcl_HashTable psCache;	/* Postscript fragments of items from earlier
+				 * exports, keyed by item id. */
+    int psCacheY2;		/* Page bottom and color level the cached */
+    int psCacheColorLevel;	/* fragments were generated with. */
+    int psDirtyX1, psDirtyY1;	/* Area of the canvas that changed since */
+    int psDirtyX2, psDirtyY2;	/* the last export; see PS_DIRTY. */
 #endif
     Tcl_HashTable idTable;	/* Table of integer indices. */
 /* @@@ TODO: as pointers instead??? */
@@ -244,6 +277,16 @@ typedef struct TkPathCanvas {
     Tk_TSOffset *tsoffsetPtr;
     TagSearchExpr *bindTagExprs;/* Linked list of tag expressions used in
 				 * bindings. */
+    unsigned long bindExprEpoch;/* Incremented whenever an expression is
+				 * added to bindTagExprs. */
+    Tk_PathItem *matchItemPtr;	/* Item whose tags matchPtr was computed
+				 * for, or NULL after any tags changed. */
+    Tk_Uid *matchPtr;		/* Uids of the binding tag expressions that
+				 * match the tags of matchItemPtr, cached by
+				 * CanvasDoEvent. */
+    int numMatches;		/* Number of uids at *matchPtr. */
+    unsigned long matchEpoch;	/* The bindExprEpoch matchPtr was computed
+				 * for. */
 } TkPathCanvas;
 
 /*
@@ -274,6 +317,13 @@ typedef struct TkPathCanvas {
  *				should be redrawn is not empty.
  * CANVAS_DELETED -		1 means that DestroyNotify was received.
  * DRAW_OFFSCREEN -		1 means drawing is performed in DrawCanvas().
+ * PS_DIRTY -			1 means that psDirtyX1 etc. hold an area
+ *				whose cached Postscript fragments are stale.
+ * PS_FONT_USED -		1 means that an item asked for a Postscript
+ *				font while its fragment was being generated.
+ * MOTION_PENDING -		1 means motionEvent holds a coalesced motion
+ *				event and CanvasMotionProc is scheduled to
+ *				deliver it.
  */
 
 #define REDRAW_PENDING		(1 << 0)
@@ -287,6 +337,9 @@ typedef struct TkPathCanvas {
 #define BBOX_NOT_EMPTY		(1 << 8)
 #define CANVAS_DELETED		(1 << 9)
 #define DRAW_OFFSCREEN		(1 << 10)
+#define PS_DIRTY		(1 << 11)
+#define PS_FONT_USED		(1 << 12)
+#define MOTION_PENDING		(1 << 13)
 
 /*
  * Flag bits for canvas items (redraw_flags):
@@ -309,10 +362,12 @@ typedef struct Tk_PathItemEx  {
     Tk_PathItem header;	    /* Generic stuff that's the same for all
                              * types.  MUST BE FIRST IN STRUCTURE. */
     Tk_PathCanvas canvas;   /* Canvas containing item. */
-    Tk_PathStyle style;	    /* Contains most drawing info. */
     Tcl_Obj *styleObj;	    /* Object with style name. */
     TkPathStyleInst *styleInst;
 			    /* The referenced style instance from styleObj. */
+    Tk_PathStyle style;	    /* Contains most drawing info.
+			     * Must come after the fields shared with
+			     * Tk_PathItemLite. */
 
     /*
      *------------------------------------------------------------------
@@ -324,6 +379,28 @@ typedef struct Tk_PathItemEx  {
      */
 } Tk_PathItemEx;
 
+/*
+ * Lightweight items take all their drawing options from a named style
+ * and have no Tk_PathStyle record of their own. The record is the
+ * leading part of Tk_PathItemEx so that code dealing only with the
+ * parent and style name can handle both. Such item types have
+ * isPathType set to TK_PATH_TYPE_LITE.
+ */
+
+typedef struct Tk_PathItemLite  {
+    Tk_PathItem header;	    /* Generic stuff that's the same for all
+                             * types.  MUST BE FIRST IN STRUCTURE. */
+    Tk_PathCanvas canvas;   /* Canvas containing item. */
+    Tcl_Obj *styleObj;	    /* Object with style name. */
+    TkPathStyleInst *styleInst;
+			    /* The referenced style instance from styleObj. */
+} Tk_PathItemLite;
+
+#define TK_PATH_TYPE_LITE	2
+
+#define TkPathItemIsLite(itemPtr) \
+    ((itemPtr)->typePtr->isPathType == TK_PATH_TYPE_LITE)
+
 
 /*
  * Retrieve TkPathContext from Tk_PathCanvas.
@@ -341,6 +418,21 @@ MODULE_SCOPE int	    TkpCanvPostscriptCmd(TkPathCanvas *canvasPtr,
 				Tcl_Interp *interp,
 				int objc, Tcl_Obj *const objv[]);
 #endif
+MODULE_SCOPE int	    TkpCanvPdfCmd(TkPathCanvas *canvasPtr,
+				Tcl_Interp *interp,
+				int objc, Tcl_Obj *const objv[]);
+MODULE_SCOPE int	    TkpCanvSvgCmd(TkPathCanvas *canvasPtr,
+				Tcl_Interp *interp,
+				int objc, Tcl_Obj *const objv[]);
+MODULE_SCOPE int	    TkpCanvLoadSvgCmd(TkPathCanvas *canvasPtr,
+				Tcl_Interp *interp,
+				int objc, Tcl_Obj *const objv[]);
+MODULE_SCOPE int	    TkPathCanvasCreateItem(Tcl_Interp *interp,
+				TkPathCanvas *canvasPtr, const char *typeName,
+				int objc, Tcl_Obj *const objv[],
+				Tk_PathItem **itemPtrPtr);
+MODULE_SCOPE void	    TkPathCanvasDeleteItem(TkPathCanvas *canvasPtr,
+				Tk_PathItem *itemPtr);
 MODULE_SCOPE int	    TkPathCanvTranslatePath(TkPathCanvas *canvPtr,
 				int numVertex, double *coordPtr, int closed,
 				XPoint *outPtr);
@@ -359,6 +451,8 @@ MODULE_SCOPE void	    TkPathCanvasFreeInheritedStyle(Tk_PathStyle *stylePtr);
 MODULE_SCOPE Tcl_HashTable *TkPathCanvasGradientTable(Tk_PathCanvas canvas);
 MODULE_SCOPE Tcl_HashTable *TkPathCanvasStyleTable(Tk_PathCanvas canvas);
 MODULE_SCOPE Tk_PathState   TkPathCanvasState(Tk_PathCanvas canvas);
+MODULE_SCOPE Tk_PathState   TkPathCanvasItemState(Tk_PathCanvas canvas,
+				Tk_PathItem *itemPtr);
 MODULE_SCOPE Tk_PathItem *  TkPathCanvasCurrentItem(Tk_PathCanvas canvas);
 MODULE_SCOPE void	    TkPathCanvasGroupBbox(Tk_PathCanvas canvas,
 				Tk_PathItem *itemPtr,
@@ -366,14 +460,29 @@ MODULE_SCOPE void	    TkPathCanvasGroupBbox(Tk_PathCanvas canvas,
 MODULE_SCOPE void	    TkPathCanvasUpdateGroupBbox(Tk_PathCanvas canvas,
 				Tk_PathItem *itemPtr);
 MODULE_SCOPE void	    TkPathCanvasSetGroupDirtyBbox(Tk_PathItem *itemPtr);
+MODULE_SCOPE int	    TkPathCanvasGroupLayer(Tk_PathCanvas canvas,
+				Tk_PathItem *itemPtr);
+MODULE_SCOPE void	    TkPathCanvasDisplayGroupItems(Tk_PathCanvas canvas,
+				Tk_PathItem *itemPtr, TkPathContext ctx,
+				int x, int y, int width, int height);
 MODULE_SCOPE Tk_PathItem *  TkPathCanvasItemIteratorNext(Tk_PathItem *itemPtr);
 MODULE_SCOPE Tk_PathItem *  TkPathCanvasItemIteratorPrev(Tk_PathItem *itemPtr);
 MODULE_SCOPE int	    TkPathCanvasItemExConfigure(Tcl_Interp *interp,
 				Tk_PathCanvas canvas,
 				Tk_PathItemEx *itemExPtr, int mask);
 MODULE_SCOPE void	    TkPathCanvasItemDetach(Tk_PathItem *itemPtr);
+MODULE_SCOPE int	    TkPathPrectOpaqueArea(Tk_PathItem *itemPtr,
+				double *rectPtr, TMatrix *matrixPtr);
+MODULE_SCOPE int	    TkPathPimageOpaqueArea(Tk_PathItem *itemPtr,
+				double *rectPtr, TMatrix *matrixPtr);
+#ifndef TKP_NO_POSTSCRIPT
+MODULE_SCOPE void	    TkPathCanvasPsForget(TkPathCanvas *canvasPtr,
+				Tk_PathItem *itemPtr);
+MODULE_SCOPE void	    TkPathCanvasPsFlush(TkPathCanvas *canvasPtr);
+#endif
 MODULE_SCOPE void	    GroupItemConfigured(Tk_PathCanvas canvas,
 				Tk_PathItem *itemPtr, int mask);
+MODULE_SCOPE void	    SetAncestorsDirtyBbox(Tk_PathItem *itemPtr);
 MODULE_SCOPE void	    CanvasTranslateGroup(Tk_PathCanvas canvas,
 				Tk_PathItem *itemPtr, int compensate,
 				double deltaX, double deltaY);
@@ -416,7 +525,11 @@ MODULE_SCOPE Tk_PathItemType tkpCircleType;
 MODULE_SCOPE Tk_PathItemType tkpEllipseType;
 MODULE_SCOPE Tk_PathItemType tkpPimageType;
 MODULE_SCOPE Tk_PathItemType tkpPtextType;
+MODULE_SCOPE Tk_PathItemType tkpPtilesType;
 MODULE_SCOPE Tk_PathItemType tkpGroupType;
+MODULE_SCOPE Tk_PathItemType tkpLrectType;
+MODULE_SCOPE Tk_PathItemType tkpLcircleType;
+MODULE_SCOPE Tk_PathItemType tkpLellipseType;
 
 #endif /* _TKPCANVAS */
 
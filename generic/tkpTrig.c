@@ -527,6 +527,55 @@ TkPathMakeRawCurve(
 }
 
 #ifndef TKP_NO_POSTSCRIPT
+/*
+ *--------------------------------------------------------------
+ *
+ * GetPostscriptBuffer --
+ *
+ *	Returns the interp's result as an unshared object, so that
+ *	Postscript can be appended to it directly.
+ *
+ * Results:
+ *	The result object.
+ *
+ * Side effects:
+ *	A shared result is replaced by a copy.
+ *
+ *--------------------------------------------------------------
+ */
+
+static Tcl_Obj *
+GetPostscriptBuffer(
+    Tcl_Interp *interp)
+{
+    Tcl_Obj *psObj = Tcl_GetObjResult(interp);
+
+    if (Tcl_IsShared(psObj)) {
+	psObj = Tcl_DuplicateObj(psObj);
+	Tcl_SetObjResult(interp, psObj);
+    }
+    return psObj;
+}
+
+/*
+ * Appends a curveto for the control points 2 to 7 of a Bezier segment.
+ */
+
+static void
+PsCurveTo(
+    Tcl_Obj *psObj,
+    Tk_PathCanvas canvas,
+    double *control)
+{
+    TkPathPsNumber(psObj, control[2], " ");
+    TkPathPsNumber(psObj, Tk_PathCanvasPsY(canvas, control[3]), " ");
+    TkPathPsNumber(psObj, control[4], " ");
+    TkPathPsNumber(psObj, Tk_PathCanvasPsY(canvas, control[5]), " ");
+    TkPathPsNumber(psObj, control[6], " ");
+    TkPathPsNumber(psObj, Tk_PathCanvasPsY(canvas, control[7]),
+	    " curveto\n");
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -558,7 +607,7 @@ TkPathMakeBezierPostscript(
     int closed, i;
     int numCoords = numPoints*2;
     double control[8];
-    char buffer[200];
+    Tcl_Obj *psObj = GetPostscriptBuffer(interp);
 
     /*
      * If the curve is a closed one then generate a special spline that spans
@@ -577,19 +626,18 @@ TkPathMakeBezierPostscript(
 	control[5] = 0.833*pointPtr[1] + 0.167*pointPtr[3];
 	control[6] = 0.5*pointPtr[0] + 0.5*pointPtr[2];
 	control[7] = 0.5*pointPtr[1] + 0.5*pointPtr[3];
-	sprintf(buffer, "%.15g %.15g moveto\n%.15g %.15g %.15g %.15g %.15g %.15g curveto\n",
-		control[0], Tk_PathCanvasPsY(canvas, control[1]),
-		control[2], Tk_PathCanvasPsY(canvas, control[3]),
-		control[4], Tk_PathCanvasPsY(canvas, control[5]),
-		control[6], Tk_PathCanvasPsY(canvas, control[7]));
+	TkPathPsNumber(psObj, control[0], " ");
+	TkPathPsNumber(psObj, Tk_PathCanvasPsY(canvas, control[1]),
+		" moveto\n");
+	PsCurveTo(psObj, canvas, control);
     } else {
 	closed = 0;
 	control[6] = pointPtr[0];
 	control[7] = pointPtr[1];
-	sprintf(buffer, "%.15g %.15g moveto\n",
-		control[6], Tk_PathCanvasPsY(canvas, control[7]));
+	TkPathPsNumber(psObj, control[6], " ");
+	TkPathPsNumber(psObj, Tk_PathCanvasPsY(canvas, control[7]),
+		" moveto\n");
     }
-    Tcl_AppendResult(interp, buffer, NULL);
 
     /*
      * Cycle through all the remaining points in the curve, generating a curve
@@ -615,11 +663,7 @@ TkPathMakeBezierPostscript(
 	control[4] = 0.333*control[6] + 0.667*pointPtr[0];
 	control[5] = 0.333*control[7] + 0.667*pointPtr[1];
 
-	sprintf(buffer, "%.15g %.15g %.15g %.15g %.15g %.15g curveto\n",
-		control[2], Tk_PathCanvasPsY(canvas, control[3]),
-		control[4], Tk_PathCanvasPsY(canvas, control[5]),
-		control[6], Tk_PathCanvasPsY(canvas, control[7]));
-	Tcl_AppendResult(interp, buffer, NULL);
+	PsCurveTo(psObj, canvas, control);
     }
 }
 
@@ -655,15 +699,15 @@ TkPathMakeRawCurvePostscript(
 {
     int i;
     double *segPtr;
-    char buffer[200];
+    Tcl_Obj *psObj = GetPostscriptBuffer(interp);
 
     /*
      * Put the first point into the path.
      */
 
-    sprintf(buffer, "%.15g %.15g moveto\n",
-	    pointPtr[0], Tk_PathCanvasPsY(canvas, pointPtr[1]));
-    Tcl_AppendResult(interp, buffer, NULL);
+    TkPathPsNumber(psObj, pointPtr[0], " ");
+    TkPathPsNumber(psObj, Tk_PathCanvasPsY(canvas, pointPtr[1]),
+	    " moveto\n");
 
     /*
      * Loop through all the remaining points in the curve, generating a
@@ -678,19 +722,16 @@ TkPathMakeRawCurvePostscript(
 	     * neighbouring knots, so this segment is just a straight line.
 	     */
 
-	    sprintf(buffer, "%.15g %.15g lineto\n",
-		    segPtr[6], Tk_PathCanvasPsY(canvas, segPtr[7]));
+	    TkPathPsNumber(psObj, segPtr[6], " ");
+	    TkPathPsNumber(psObj, Tk_PathCanvasPsY(canvas, segPtr[7]),
+		    " lineto\n");
 	} else {
 	    /*
 	     * This is a generic Bezier curve segment.
 	     */
 
-	    sprintf(buffer, "%.15g %.15g %.15g %.15g %.15g %.15g curveto\n",
-		    segPtr[2], Tk_PathCanvasPsY(canvas, segPtr[3]),
-		    segPtr[4], Tk_PathCanvasPsY(canvas, segPtr[5]),
-		    segPtr[6], Tk_PathCanvasPsY(canvas, segPtr[7]));
+	    PsCurveTo(psObj, canvas, segPtr);
 	}
-	Tcl_AppendResult(interp, buffer, NULL);
     }
 
     /*
@@ -715,19 +756,16 @@ TkPathMakeRawCurvePostscript(
 	     * Straight line.
 	     */
 
-	    sprintf(buffer, "%.15g %.15g lineto\n",
-		    control[6], Tk_PathCanvasPsY(canvas, control[7]));
+	    TkPathPsNumber(psObj, control[6], " ");
+	    TkPathPsNumber(psObj, Tk_PathCanvasPsY(canvas, control[7]),
+		    " lineto\n");
 	} else {
 	    /*
 	     * Bezier curve segment.
 	     */
 
-	    sprintf(buffer, "%.15g %.15g %.15g %.15g %.15g %.15g curveto\n",
-		    control[2], Tk_PathCanvasPsY(canvas, control[3]),
-		    control[4], Tk_PathCanvasPsY(canvas, control[5]),
-		    control[6], Tk_PathCanvasPsY(canvas, control[7]));
+	    PsCurveTo(psObj, canvas, control);
 	}
-	Tcl_AppendResult(interp, buffer, NULL);
     }
 }
 #endif /* TKP_POSTSCRIPT */
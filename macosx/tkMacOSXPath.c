@@ -363,6 +363,11 @@ PathSetCGContextStyle(CGContextRef c, Tk_PathStyle *style)
     /* Set the line dash patttern in the current graphics state. */
     dashPtr = style->dashPtr;
     if ((dashPtr != NULL) && (dashPtr->number != 0)) {
+#if CGFLOAT_IS_DOUBLE
+	CGContextSetLineDash(c, style->offset,
+		TkPathDashScaled(dashPtr, style->strokeWidth),
+		dashPtr->number);
+#else
         CGFloat *dashes = (CGFloat *)ckalloc(dashPtr->number * sizeof(CGFloat));
         int i;
 
@@ -371,6 +376,7 @@ PathSetCGContextStyle(CGContextRef c, Tk_PathStyle *style)
 	}
 	CGContextSetLineDash(c, style->offset, dashes, dashPtr->number);
 	ckfree((char *)dashes);
+#endif
     }
 
     /* Set the current fill colorspace in the context `c' to `DeviceRGB' and
@@ -739,7 +745,7 @@ void
 TkPathImage(TkPathContext ctx, Tk_Image image, Tk_PhotoHandle photo,
 	    double x, double y, double width0, double height0,
 	    double fillOpacity, XColor *tintColor, double tintAmount,
-	    int interpolation, PathRect *srcRegion)
+	    int interpolation, PathRect *srcRegion, void **customPtr)
 {
     TkPathContext_ *context = (TkPathContext_ *) ctx;
     CGImageRef cgImage;
@@ -957,6 +963,19 @@ TkPathImage(TkPathContext ctx, Tk_Image image, Tk_PhotoHandle photo,
     context->saveCount--;
 }
 
+void
+TkPathImageFree(void *custom)
+{
+    /* Nothing is kept between draws. */
+}
+
+int
+TkPathImageChanged(void *custom, Tk_PhotoHandle photo,
+    int x, int y, int width, int height)
+{
+    return 0;
+}
+
 void
 TkPathClosePath(TkPathContext ctx)
 {
@@ -1328,6 +1347,46 @@ TkPathSurfaceToPhoto(Tcl_Interp *interp, TkPathContext ctx,
     ckfree((char *)pixel);
 }
 
+/*
+ * Draws an offscreen surface as is, with its top left corner at x,y.
+ */
+
+void
+TkPathSurfaceDraw(TkPathContext ctx, TkPathContext surface,
+		  double x, double y, double opacity)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    TkPathContext_ *surfContext = (TkPathContext_ *) surface;
+    CGImageRef cgImage;
+    size_t width, height;
+
+    if ((context->c == NULL) || (surfContext->c == NULL)) {
+	return;
+    }
+    cgImage = CGBitmapContextCreateImage(surfContext->c);
+    if (cgImage == NULL) {
+	return;
+    }
+    width = CGImageGetWidth(cgImage);
+    height = CGImageGetHeight(cgImage);
+    CGContextSaveGState(context->c);
+    context->saveCount++;
+    CGContextSetAlpha(context->c, opacity);
+    CGContextSetInterpolationQuality(context->c, kCGInterpolationNone);
+
+    /*
+     * Flip back to an upright coordinate system since
+     * CGContextDrawImage expect this.
+     */
+    CGContextTranslateCTM(context->c, x, y + height);
+    CGContextScaleCTM(context->c, 1, -1);
+    CGContextDrawImage(context->c, CGRectMake(0.0, 0.0, width, height),
+		       cgImage);
+    CGImageRelease(cgImage);
+    CGContextRestoreGState(context->c);
+    context->saveCount--;
+}
+
 void
 TkPathClipToPath(TkPathContext ctx, int fillRule)
 {
@@ -1656,6 +1715,7 @@ TkPathPaintRadialGradient(TkPathContext ctx, PathRect *bbox,
 int
 TkPathSetup(Tcl_Interp *interp)
 {
+    Tcl_SetVar(interp, "::tkp::backend", "quartz", TCL_GLOBAL_ONLY);
     return TCL_OK;
 }
 
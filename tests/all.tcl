@@ -23,6 +23,11 @@ tcltest::configure \
 
 namespace import ::tcltest::*
 
+# The self contained backend built with --without-cairo, checked
+# pixel by pixel.
+testConstraint tkDraw [expr {[info exists ::tkp::backend]
+	&& $::tkp::backend eq "tk"}]
+
 proc ::tkp_setup {} {
     catch {destroy {*}[winfo children .]}
     pack [::tkp::canvas .c -width 60 -height 40 -bd 0 -highlightthickness 0]
@@ -326,37 +326,225 @@ convertInterpolationToCairoFilter(int interpolation)
     }
 }
 
-void
-TkPathImage(TkPathContext ctx, Tk_Image image, Tk_PhotoHandle photo,
-    double x, double y, double width0, double height0, double fillOpacity,
-    XColor *tintColor, double tintAmount, int interpolation,
-    PathRect *srcRegion)
+/*
+ * A photo converted to a cairo surface, tinted if asked for. Callers of
+ * TkPathImage that can tell when the photo changes keep it between
+ * draws in *customPtr, and release it with TkPathImageFree.
+ *
+ * Cached records also carry a mip pyramid: level n is the photo box
+ * filtered down by 2^n. Levels are built on demand the first time an
+ * image is drawn that small, so the filter only ever looks at about as
+ * many pixels as end up on screen.
+ */
+#define PATH_IMAGE_MIP_LEVELS 16
+
+typedef struct PathImageMipLevel {
+    cairo_surface_t *surface;
+    unsigned char *data;
+    int width;
+    int height;
+} PathImageMipLevel;
+
+typedef struct PathImageCairoRecord {
+    cairo_surface_t *surface;
+    unsigned char *data;
+    Tk_PhotoHandle photo;	/* The photo this was converted from. */
+    int width;
+    int height;
+    int pitch;			/* Of both the photo and data. */
+    XColor tint;		/* Tint color, if tintAmount > 0. */
+    double tintAmount;
+    int numLevels;		/* Mip levels built so far, 0 if none. */
+    PathImageMipLevel levels[PATH_IMAGE_MIP_LEVELS];
+				/* levels[0] is unused: it is the surface
+				 * itself. */
+} PathImageCairoRecord;
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CairoImageConvert --
+ *
+ *	Converts a rectangle of a 4 bytes per pixel photo block into
+ *	cairo's premultiplied, native endian ARGB32, tinting it if asked
+ *	for. 'ptr' has the same pitch as the block.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+CairoImageConvert(Tk_PhotoImageBlock *blockPtr, unsigned char *ptr,
+    int x, int y, int width, int height,
+    XColor *tintColor, double tintAmount)
 {
-    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    unsigned char *srcPtr, *dstPtr;
+    int srcR, srcG, srcB, srcA; /* The source pixel offsets. */
+    int dstR, dstG, dstB, dstA; /* The destination pixel offsets. */
+    int pitch = blockPtr->pitch;
+    int i, j;
+
+    /*
+     * The offset array contains the offsets from the address of a
+     * pixel to the addresses of the bytes containing the red, green,
+     * blue and alpha (transparency) components.
+     *
+     * We need to copy pixel data from the source using the photo offsets
+     * to cairos ARGB format which is in *native* endian order; Switch!
+     */
+    srcR = blockPtr->offset[0];
+    srcG = blockPtr->offset[1];
+    srcB = blockPtr->offset[2];
+    srcA = blockPtr->offset[3];
+    dstR = 1;
+    dstG = 2;
+    dstB = 3;
+    dstA = 0;
+    if (!kEndianess.set) {
+	kEndianess.set = 1;
+    }
+    if (kEndianess.little) {
+	dstR = 3-dstR, dstG = 3-dstG, dstB = 3-dstB, dstA = 3-dstA;
+    }
+
+    if (tintColor && tintAmount > 0.0) {
+#ifdef TINT_INT_CALCULATION
+	/* calculate with integer arithmetic */
+	uint32_t tintR, tintG, tintB, uAmount, uRemain;
+	if (tintAmount > 1.0)
+	    tintAmount = 1.0;
+	uAmount = (uint32_t)(tintAmount * 256.0);
+	uRemain = 256 - uAmount;
+	tintR = Red255FromXColorPtr(tintColor);
+	tintG = Green255FromXColorPtr(tintColor);
+	tintB = Blue255FromXColorPtr(tintColor);
+
+	for (i = y; i < y + height; i++) {
+	    srcPtr = blockPtr->pixelPtr + i*pitch + 4*x;
+	    dstPtr = ptr + i*pitch + 4*x;
+	    for (j = 0; j < width; j++) {
+		/* extract */
+		uint32_t r = *(srcPtr+srcR);
+		uint32_t g = *(srcPtr+srcG);
+		uint32_t b = *(srcPtr+srcB);
+		uint32_t a = *(srcPtr+srcA);
+		/* transform */
+		uint32_t lumAmount = ((r * 6966 + g * 23436 + b * 2366)
+			* uAmount) >> 23;  /* 0-256 */
+
+		r = (uRemain * r + lumAmount * tintR);
+		g = (uRemain * g + lumAmount * tintG);
+		b = (uRemain * b + lumAmount * tintB);
+
+		if (a != 255) {
+		    /* Cairo expects RGB premultiplied by alpha */
+		    r = r * a / 255;
+		    g = g * a / 255;
+		    b = b * a / 255;
+		}
+
+		/* fix range */
+		r = (r>0xFFFF) ? 0xFFFF : r;
+		g = (g>0xFFFF) ? 0xFFFF : g;
+		b = (b>0xFFFF) ? 0xFFFF : b;
+
+		/* and put back */
+		*(dstPtr+dstR) = r >> 8;
+		*(dstPtr+dstG) = g >> 8;
+		*(dstPtr+dstB) = b >> 8;
+		*(dstPtr+dstA) = a;
+		srcPtr += 4;
+		dstPtr += 4;
+	    }
+	}
+#else
+	double tintR, tintG, tintB;
+	if (tintAmount > 1.0)
+	    tintAmount = 1.0;
+	tintR = RedDoubleFromXColorPtr(tintColor);
+	tintG = GreenDoubleFromXColorPtr(tintColor);
+	tintB = BlueDoubleFromXColorPtr(tintColor);
+
+	for (i = y; i < y + height; i++) {
+	    srcPtr = blockPtr->pixelPtr + i*pitch + 4*x;
+	    dstPtr = ptr + i*pitch + 4*x;
+	    for (j = 0; j < width; j++) {
+		/* extract */
+		int r = *(srcPtr+srcR);
+		int g = *(srcPtr+srcG);
+		int b = *(srcPtr+srcB);
+		int a = *(srcPtr+srcA);
+		/* transform */
+		int lum = (int)(0.2126*r + 0.7152*g + 0.0722*b);
+
+		r = (int)((1.0-tintAmount)*r + tintAmount*lum*tintR);
+		g = (int)((1.0-tintAmount)*g + tintAmount*lum*tintG);
+		b = (int)((1.0-tintAmount)*b + tintAmount*lum*tintB);
+
+		if (a != 255) {
+		    /* Cairo expects RGB premultiplied by alpha */
+		    r = r * a / 255;
+		    g = g * a / 255;
+		    b = b * a / 255;
+		}
+
+		/* fix range */
+		r = (r<0) ? 0 : (r>255) ? 255 : r;
+		g = (g<0) ? 0 : (g>255) ? 255 : g;
+		b = (b<0) ? 0 : (b>255) ? 255 : b;
+
+		/* and put back */
+		*(dstPtr+dstR) = r;
+		*(dstPtr+dstG) = g;
+		*(dstPtr+dstB) = b;
+		*(dstPtr+dstA) = a;
+		srcPtr += 4;
+		dstPtr += 4;
+	    }
+	}
+#endif
+    } else {
+	for (i = y; i < y + height; i++) {
+	    srcPtr = blockPtr->pixelPtr + i*pitch + 4*x;
+	    dstPtr = ptr + i*pitch + 4*x;
+	    for (j = 0; j < width; j++) {
+		unsigned int alpha = *(srcPtr+srcA);
+		*(dstPtr+dstA) = alpha;
+		if (alpha == 255) {
+		    *(dstPtr+dstR) = *(srcPtr+srcR);
+		    *(dstPtr+dstG) = *(srcPtr+srcG);
+		    *(dstPtr+dstB) = *(srcPtr+srcB);
+		} else {
+		    /* Cairo expects RGB premultiplied by alpha */
+		    *(dstPtr+dstR) = alpha * *(srcPtr+srcR) / 255;
+		    *(dstPtr+dstG) = alpha * *(srcPtr+srcG) / 255;
+		    *(dstPtr+dstB) = alpha * *(srcPtr+srcB) / 255;
+		}
+		srcPtr += 4;
+		dstPtr += 4;
+	    }
+	}
+    }
+}
+
+static PathImageCairoRecord *
+CairoImageNew(Tk_PhotoHandle photo, XColor *tintColor, double tintAmount)
+{
+    PathImageCairoRecord *recordPtr;
     Tk_PhotoImageBlock block;
-    cairo_surface_t *surface;
     cairo_format_t format;
     unsigned char *data = NULL;
     unsigned char *ptr = NULL;
-    unsigned char *srcPtr, *dstPtr;
-    int srcR, srcG, srcB, srcA; /* The source pixel offsets. */
-    int dstR, dstG, dstB, dstA; /* The destination pixel offsets. */
     int pitch;
     int iwidth, iheight;
-    int i, j;
-    double width, height;
-    cairo_filter_t filter;
 
     /* Return value? */
     Tk_PhotoGetImage(photo, &block);
     iwidth = block.width;
     iheight = block.height;
     if ((iwidth == 0) || (iheight == 0)) {
-	return;
+	return NULL;
     }
     pitch = block.pitch;
-    width = (width0 == 0.0) ? (double) iwidth : width0;
-    height = (height0 == 0.0) ? (double) iheight : height0;
 
     /*
      * @format: the format of pixels in the buffer
@@ -379,166 +567,325 @@ TkPathImage(TkPathContext ctx, Tk_Image image, Tk_PhotoHandle photo,
     if (block.pixelSize == 4) {
 	format = CAIRO_FORMAT_ARGB32;
 
-	/*
-	 * The offset array contains the offsets from the address of a
-	 * pixel to the addresses of the bytes containing the red, green,
-	 * blue and alpha (transparency) components.
-	 *
-	 * We need to copy pixel data from the source using the photo offsets
-	 * to cairos ARGB format which is in *native* endian order; Switch!
-	 */
-	srcR = block.offset[0];
-	srcG = block.offset[1];
-	srcB = block.offset[2];
-	srcA = block.offset[3];
-	dstR = 1;
-	dstG = 2;
-	dstB = 3;
-	dstA = 0;
-	if (!kEndianess.set) {
-	    kEndianess.set = 1;
-	}
-	if (kEndianess.little) {
-	    dstR = 3-dstR, dstG = 3-dstG, dstB = 3-dstB, dstA = 3-dstA;
+	data = (unsigned char *) attemptckalloc(pitch*iheight);
+	if (data == NULL) {
+	    return NULL;
 	}
-
-	data = (unsigned char *) ckalloc(pitch*iheight);
 	ptr = data;
 
-	if (tintColor && tintAmount > 0.0) {
-#ifdef TINT_INT_CALCULATION
-	    /* calculate with integer arithmetic */
-	    uint32_t tintR, tintG, tintB, uAmount, uRemain;
-	    if (tintAmount > 1.0)
-		tintAmount = 1.0;
-	    uAmount = (uint32_t)(tintAmount * 256.0);
-	    uRemain = 256 - uAmount;
-	    tintR = Red255FromXColorPtr(tintColor);
-	    tintG = Green255FromXColorPtr(tintColor);
-	    tintB = Blue255FromXColorPtr(tintColor);
-
-	    for (i = 0; i < iheight; i++) {
-		srcPtr = block.pixelPtr + i*pitch;
-		dstPtr = ptr + i*pitch;
-		for (j = 0; j < iwidth; j++) {
-		    /* extract */
-		    uint32_t r = *(srcPtr+srcR);
-		    uint32_t g = *(srcPtr+srcG);
-		    uint32_t b = *(srcPtr+srcB);
-		    uint32_t a = *(srcPtr+srcA);
-		    /* transform */
-		    uint32_t lumAmount = ((r * 6966 + g * 23436 + b * 2366)
-			    * uAmount) >> 23;  /* 0-256 */
-
-		    r = (uRemain * r + lumAmount * tintR);
-		    g = (uRemain * g + lumAmount * tintG);
-		    b = (uRemain * b + lumAmount * tintB);
-
-		    if (a != 255) {
-			/* Cairo expects RGB premultiplied by alpha */
-			r = r * a / 255;
-			g = g * a / 255;
-			b = b * a / 255;
-		    }
-
-		    /* fix range */
-		    r = (r>0xFFFF) ? 0xFFFF : r;
-		    g = (g>0xFFFF) ? 0xFFFF : g;
-		    b = (b>0xFFFF) ? 0xFFFF : b;
-
-		    /* and put back */
-		    *(dstPtr+dstR) = r >> 8;
-		    *(dstPtr+dstG) = g >> 8;
-		    *(dstPtr+dstB) = b >> 8;
-		    *(dstPtr+dstA) = a;
-		    srcPtr += 4;
-		    dstPtr += 4;
-		}
-	    }
-#else
-	    double tintR, tintG, tintB;
-	    if (tintAmount > 1.0)
-		tintAmount = 1.0;
-	    tintR = RedDoubleFromXColorPtr(tintColor);
-	    tintG = GreenDoubleFromXColorPtr(tintColor);
-	    tintB = BlueDoubleFromXColorPtr(tintColor);
-
-	    for (i = 0; i < iheight; i++) {
-		srcPtr = block.pixelPtr + i*pitch;
-		dstPtr = ptr + i*pitch;
-		for (j = 0; j < iwidth; j++) {
-		    /* extract */
-		    int r = *(srcPtr+srcR);
-		    int g = *(srcPtr+srcG);
-		    int b = *(srcPtr+srcB);
-		    int a = *(srcPtr+srcA);
-		    /* transform */
-		    int lum = (int)(0.2126*r + 0.7152*g + 0.0722*b);
-
-		    r = (int)((1.0-tintAmount)*r + tintAmount*lum*tintR);
-		    g = (int)((1.0-tintAmount)*g + tintAmount*lum*tintG);
-		    b = (int)((1.0-tintAmount)*b + tintAmount*lum*tintB);
-
-		    if (a != 255) {
-			/* Cairo expects RGB premultiplied by alpha */
-			r = r * a / 255;
-			g = g * a / 255;
-			b = b * a / 255;
-		    }
-
-		    /* fix range */
-		    r = (r<0) ? 0 : (r>255) ? 255 : r;
-		    g = (g<0) ? 0 : (g>255) ? 255 : g;
-		    b = (b<0) ? 0 : (b>255) ? 255 : b;
-
-		    /* and put back */
-		    *(dstPtr+dstR) = r;
-		    *(dstPtr+dstG) = g;
-		    *(dstPtr+dstB) = b;
-		    *(dstPtr+dstA) = a;
-		    srcPtr += 4;
-		    dstPtr += 4;
-		}
-	    }
-#endif
-	} else {
-	    for (i = 0; i < iheight; i++) {
-		srcPtr = block.pixelPtr + i*pitch;
-		dstPtr = ptr + i*pitch;
-		for (j = 0; j < iwidth; j++) {
-		    unsigned int alpha = *(srcPtr+srcA);
-		    *(dstPtr+dstA) = alpha;
-		    if (alpha == 255) {
-			*(dstPtr+dstR) = *(srcPtr+srcR);
-			*(dstPtr+dstG) = *(srcPtr+srcG);
-			*(dstPtr+dstB) = *(srcPtr+srcB);
-		    } else {
-			/* Cairo expects RGB premultiplied by alpha */
-			*(dstPtr+dstR) = alpha * *(srcPtr+srcR) / 255;
-			*(dstPtr+dstG) = alpha * *(srcPtr+srcG) / 255;
-			*(dstPtr+dstB) = alpha * *(srcPtr+srcB) / 255;
-		    }
-		    srcPtr += 4;
-		    dstPtr += 4;
-		}
-	    }
-	}
+	CairoImageConvert(&block, data, 0, 0, iwidth, iheight,
+		tintColor, tintAmount);
     } else if (block.pixelSize == 3) {
 	/* Could do something about this? */
 	fprintf(stderr,
 	    "TkPathImage: unaccepted pixel format: 1 pixel is 3 bytes\n");
-	return;
+	return NULL;
     } else {
 	fprintf(stderr,
 	    "TkPathImage: unaccepted pixel format: 1 pixel is %d bytes\n",
 	    block.pixelSize);
-	return;
+	return NULL;
     }
-    surface = cairo_image_surface_create_for_data(ptr, format,
+    recordPtr = (PathImageCairoRecord *)
+	    ckalloc(sizeof(PathImageCairoRecord));
+    recordPtr->surface = cairo_image_surface_create_for_data(ptr, format,
 	    (int) iwidth, (int) iheight, pitch); /* stride */
+    recordPtr->data = data;
+    recordPtr->photo = photo;
+    recordPtr->width = iwidth;
+    recordPtr->height = iheight;
+    recordPtr->pitch = pitch;
+    recordPtr->tintAmount = tintAmount;
+    if (tintAmount > 0.0) {
+	recordPtr->tint = *tintColor;
+    }
+    recordPtr->numLevels = 0;
+    return recordPtr;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CairoImageBoxFilter --
+ *
+ *	Computes the pixels x0 <= x < x1, y0 <= y < y1 of a mip level
+ *	from the level above it, each as the average of the 2x2 pixels it
+ *	covers. Pixels are premultiplied, so averaging the four bytes of
+ *	each pixel independently is exact whatever the byte order.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+CairoImageBoxFilter(cairo_surface_t *srcSurface, int srcWidth, int srcHeight,
+    unsigned char *dst, int stride, int x0, int y0, int x1, int y1)
+{
+    unsigned char *src;
+    int srcStride, x, y, k;
+
+    cairo_surface_flush(srcSurface);
+    src = cairo_image_surface_get_data(srcSurface);
+    srcStride = cairo_image_surface_get_stride(srcSurface);
+    for (y = y0; y < y1; y++) {
+	unsigned char *row0 = src + 2 * y * srcStride;
+	unsigned char *row1 = (2 * y + 1 < srcHeight) ?
+		row0 + srcStride : row0;
+	unsigned char *q = dst + y * stride + 4 * x0;
+
+	for (x = x0; x < x1; x++) {
+	    int xa = 8 * x;
+	    int xb = (2 * x + 1 < srcWidth) ? xa + 4 : xa;
+
+	    for (k = 0; k < 4; k++) {
+		*q++ = (row0[xa + k] + row0[xb + k]
+			+ row1[xa + k] + row1[xb + k] + 2) >> 2;
+	    }
+	}
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CairoImageMipLevel --
+ *
+ *	Returns the surface for mip level 'level' of an image record,
+ *	building it and any missing levels above it from the previous one
+ *	with CairoImageBoxFilter.
+ *
+ * Results:
+ *	The surface of the deepest level up to 'level' that could be made;
+ *	its size is left in widthPtr and heightPtr.
+ *
+ * Side effects:
+ *	Memory for the new levels is kept in the record.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static cairo_surface_t *
+CairoImageMipLevel(PathImageCairoRecord *recordPtr, int level,
+    int *widthPtr, int *heightPtr)
+{
+    PathImageMipLevel *dstPtr;
+    cairo_surface_t *srcSurface;
+    unsigned char *dst;
+    int srcWidth, srcHeight, width, height, stride;
+
+    if (recordPtr->numLevels == 0) {
+	recordPtr->numLevels = 1;
+    }
+    while (recordPtr->numLevels <= level) {
+	if (recordPtr->numLevels == 1) {
+	    srcSurface = recordPtr->surface;
+	    srcWidth = recordPtr->width;
+	    srcHeight = recordPtr->height;
+	} else {
+	    srcSurface = recordPtr->levels[recordPtr->numLevels - 1].surface;
+	    srcWidth = recordPtr->levels[recordPtr->numLevels - 1].width;
+	    srcHeight = recordPtr->levels[recordPtr->numLevels - 1].height;
+	}
+	if ((srcWidth == 1) && (srcHeight == 1)) {
+	    break;
+	}
+	width = (srcWidth + 1) / 2;
+	height = (srcHeight + 1) / 2;
+	stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
+	dst = (unsigned char *) attemptckalloc(stride * height);
+	if (dst == NULL) {
+	    break;
+	}
+	CairoImageBoxFilter(srcSurface, srcWidth, srcHeight, dst, stride,
+		0, 0, width, height);
+	dstPtr = &recordPtr->levels[recordPtr->numLevels];
+	dstPtr->data = dst;
+	dstPtr->width = width;
+	dstPtr->height = height;
+	dstPtr->surface = cairo_image_surface_create_for_data(dst,
+		CAIRO_FORMAT_ARGB32, width, height, stride);
+	recordPtr->numLevels++;
+    }
+    level = (level < recordPtr->numLevels) ? level : recordPtr->numLevels - 1;
+    if (level == 0) {
+	*widthPtr = recordPtr->width;
+	*heightPtr = recordPtr->height;
+	return recordPtr->surface;
+    }
+    *widthPtr = recordPtr->levels[level].width;
+    *heightPtr = recordPtr->levels[level].height;
+    return recordPtr->levels[level].surface;
+}
+
+void
+TkPathImageFree(void *custom)
+{
+    PathImageCairoRecord *recordPtr = (PathImageCairoRecord *) custom;
+
+    if (recordPtr != NULL) {
+	int i;
+
+	for (i = 1; i < recordPtr->numLevels; i++) {
+	    cairo_surface_destroy(recordPtr->levels[i].surface);
+	    ckfree((char *) recordPtr->levels[i].data);
+	}
+	cairo_surface_destroy(recordPtr->surface);
+	ckfree((char *) recordPtr->data);
+	ckfree((char *) recordPtr);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkPathImageChanged --
+ *
+ *	Brings the pixels that TkPathImage kept in 'custom' up to date
+ *	after a rectangle of the photo changed. Only that rectangle is
+ *	converted again, and only the part of each mip level it covers is
+ *	filtered again.
+ *
+ * Results:
+ *	1 if 'custom' is still good, 0 if the caller must free it with
+ *	TkPathImageFree; that is the case when the photo itself or its
+ *	size changed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkPathImageChanged(void *custom, Tk_PhotoHandle photo,
+    int x, int y, int width, int height)
+{
+    PathImageCairoRecord *recordPtr = (PathImageCairoRecord *) custom;
+    Tk_PhotoImageBlock block;
+    int i, x1, y1, srcWidth, srcHeight;
+    cairo_surface_t *srcSurface;
+
+    if ((recordPtr == NULL) || (photo != recordPtr->photo)) {
+	return 0;
+    }
+    Tk_PhotoGetImage(photo, &block);
+    if ((block.pixelSize != 4) || (block.width != recordPtr->width)
+	    || (block.height != recordPtr->height)
+	    || (block.pitch != recordPtr->pitch)) {
+	return 0;
+    }
+    x1 = MIN(x + width, block.width);
+    y1 = MIN(y + height, block.height);
+    x = MAX(x, 0);
+    y = MAX(y, 0);
+    if ((x >= x1) || (y >= y1)) {
+	return 1;
+    }
+    cairo_surface_flush(recordPtr->surface);
+    CairoImageConvert(&block, recordPtr->data, x, y, x1 - x, y1 - y,
+	    &recordPtr->tint, recordPtr->tintAmount);
+    cairo_surface_mark_dirty_rectangle(recordPtr->surface,
+	    x, y, x1 - x, y1 - y);
+
+    srcSurface = recordPtr->surface;
+    srcWidth = recordPtr->width;
+    srcHeight = recordPtr->height;
+    for (i = 1; i < recordPtr->numLevels; i++) {
+	PathImageMipLevel *levelPtr = &recordPtr->levels[i];
+
+	x /= 2;
+	y /= 2;
+	x1 = MIN((x1 + 1) / 2, levelPtr->width);
+	y1 = MIN((y1 + 1) / 2, levelPtr->height);
+	cairo_surface_flush(levelPtr->surface);
+	CairoImageBoxFilter(srcSurface, srcWidth, srcHeight, levelPtr->data,
+		cairo_image_surface_get_stride(levelPtr->surface),
+		x, y, x1, y1);
+	cairo_surface_mark_dirty_rectangle(levelPtr->surface,
+		x, y, x1 - x, y1 - y);
+	srcSurface = levelPtr->surface;
+	srcWidth = levelPtr->width;
+	srcHeight = levelPtr->height;
+    }
+    return 1;
+}
+
+void
+TkPathImage(TkPathContext ctx, Tk_Image image, Tk_PhotoHandle photo,
+    double x, double y, double width0, double height0, double fillOpacity,
+    XColor *tintColor, double tintAmount, int interpolation,
+    PathRect *srcRegion, void **customPtr)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    PathImageCairoRecord *recordPtr;
+    cairo_surface_t *surface;
+    int iwidth, iheight, lwidth, lheight;
+    double width, height;
+    cairo_filter_t filter;
+
+    if ((tintColor == NULL) || (tintAmount <= 0.0)) {
+	tintAmount = 0.0;
+    }
+    recordPtr = (customPtr != NULL) ?
+	    (PathImageCairoRecord *) *customPtr : NULL;
+    if ((recordPtr != NULL) && ((recordPtr->tintAmount != tintAmount)
+	    || ((tintAmount > 0.0)
+	    && ((recordPtr->tint.red != tintColor->red)
+	    || (recordPtr->tint.green != tintColor->green)
+	    || (recordPtr->tint.blue != tintColor->blue))))) {
+	TkPathImageFree(recordPtr);
+	recordPtr = NULL;
+	*customPtr = NULL;
+    }
+    if (recordPtr == NULL) {
+	recordPtr = CairoImageNew(photo, tintColor, tintAmount);
+	if (recordPtr == NULL) {
+	    return;
+	}
+	if (customPtr != NULL) {
+	    *customPtr = recordPtr;
+	}
+    }
+    surface = recordPtr->surface;
+    iwidth = recordPtr->width;
+    iheight = recordPtr->height;
+    width = (width0 == 0.0) ? (double) iwidth : width0;
+    height = (height0 == 0.0) ? (double) iheight : height0;
+    lwidth = iwidth;
+    lheight = iheight;
+
+    /*
+     * Drawn at half size or less, use the mip level that leaves between
+     * one and two texels per device pixel. Only cached records get one;
+     * building the pyramid for a single draw would not pay off.
+     */
+    if (customPtr != NULL) {
+	cairo_matrix_t ctm;
+	double srcWidth, srcHeight, scale, yscale;
+	int level;
+
+	srcWidth = srcRegion ? srcRegion->x2 - srcRegion->x1 : iwidth;
+	srcHeight = srcRegion ? srcRegion->y2 - srcRegion->y1 : iheight;
+	cairo_get_matrix(context->c, &ctm);
+	scale = hypot(ctm.xx, ctm.yx);
+	yscale = hypot(ctm.xy, ctm.yy);
+	if ((srcWidth > 0.0) && (width0 != 0.0)) {
+	    scale *= width0 / srcWidth;
+	}
+	if ((srcHeight > 0.0) && (height0 != 0.0)) {
+	    yscale *= height0 / srcHeight;
+	}
+	if (yscale > scale) {
+	    scale = yscale;
+	}
+	for (level = 0; (scale > 0.0) && (scale <= 0.5)
+		&& (level < PATH_IMAGE_MIP_LEVELS - 1); level++) {
+	    scale *= 2.0;
+	}
+	if (level > 0) {
+	    surface = CairoImageMipLevel(recordPtr, level, &lwidth, &lheight);
+	}
+    }
 
     filter = convertInterpolationToCairoFilter(interpolation);
-    if (width == (double)iwidth && height == (double)iheight && !srcRegion) {
+    if (width == (double)iwidth && height == (double)iheight && !srcRegion
+	    && (surface == recordPtr->surface)) {
 	cairo_set_source_surface(context->c, surface, x, y);
 	cairo_pattern_set_filter(cairo_get_source(context->c), filter);
 	cairo_paint_with_alpha(context->c, fillOpacity);
@@ -563,7 +910,8 @@ TkPathImage(TkPathContext ctx, Tk_Image image, Tk_PhotoHandle photo,
 
 	cairo_translate(context->c, (x-xoffs), (y-yoffs));
 
-	cairo_matrix_init_scale(&matrix, 1.0/xscale, 1.0/yscale);
+	cairo_matrix_init_scale(&matrix, lwidth/(xscale*iwidth),
+		lheight/(yscale*iheight));
 	cairo_pattern_set_matrix(pattern, &matrix);
 
 	cairo_set_source(context->c, pattern);
@@ -576,15 +924,14 @@ TkPathImage(TkPathContext ctx, Tk_Image image, Tk_PhotoHandle photo,
     } else {
 	cairo_save(context->c);
 	cairo_translate(context->c, x, y);
-	cairo_scale(context->c, width/iwidth, height/iheight);
+	cairo_scale(context->c, width/lwidth, height/lheight);
 	cairo_set_source_surface(context->c, surface, 0, 0);
 	cairo_pattern_set_filter(cairo_get_source(context->c), filter);
 	cairo_paint_with_alpha(context->c, fillOpacity);
 	cairo_restore(context->c);
     }
-    cairo_surface_destroy(surface);
-    if (data) {
-	ckfree((char *)data);
+    if (customPtr == NULL) {
+	TkPathImageFree(recordPtr);
     }
 }
 
@@ -908,6 +1255,26 @@ TkPathSurfaceToPhoto(Tcl_Interp *interp, TkPathContext ctx,
     ckfree((char *) pixel);
 }
 
+/*
+ * Draws an offscreen surface as is, with its top left corner at x,y.
+ */
+
+void
+TkPathSurfaceDraw(TkPathContext ctx, TkPathContext surface,
+    double x, double y, double opacity)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    TkPathContext_ *surfContext = (TkPathContext_ *) surface;
+
+    cairo_surface_flush(surfContext->surface);
+    cairo_save(context->c);
+    cairo_set_source_surface(context->c, surfContext->surface, x, y);
+    cairo_pattern_set_filter(cairo_get_source(context->c),
+	    CAIRO_FILTER_NEAREST);
+    cairo_paint_with_alpha(context->c, opacity);
+    cairo_restore(context->c);
+}
+
 void
 TkPathClipToPath(TkPathContext ctx, int fillRule)
 {
@@ -963,14 +1330,9 @@ TkPathPrepareForStroke(TkPathContext ctx, Tk_PathStyle *style)
 
     dashPtr = style->dashPtr;
     if ((dashPtr != NULL) && (dashPtr->number != 0)) {
-	int i;
-	double *dashes = (double *) ckalloc(dashPtr->number * sizeof(double));
-
-	for (i = 0; i < dashPtr->number; i++) {
-	    dashes[i] = dashPtr->array[i] * style->strokeWidth;
-	}
-	cairo_set_dash(context->c, dashes, dashPtr->number, style->offset);
-	ckfree((char *) dashes);
+	cairo_set_dash(context->c,
+		TkPathDashScaled(dashPtr, style->strokeWidth),
+		dashPtr->number, style->offset);
     } else {
 	cairo_set_dash(context->c, NULL, 0, 0);
     }
@@ -1203,6 +1565,7 @@ TkPathPaintRadialGradient(TkPathContext ctx, PathRect *bbox,
 int
 TkPathSetup(Tcl_Interp *interp)
 {
+    Tcl_SetVar(interp, "::tkp::backend", "cairo", TCL_GLOBAL_ONLY);
     return TCL_OK;
 }
 
@@ -79,6 +79,8 @@ class PathC {
                    float height, double fillOpacity,
                    XColor *tintColor, double tintAmount, int interpolation,
                    PathRect *srcRegion);
+    void DrawSurface(void *data, int width, int height, int bytesPerRow,
+                     float x, float y, double opacity);
     void DrawString(Tk_PathStyle *style, Tk_PathTextStyle *textStylePtr,
                     float x, float y, int fillOverStroke, char *utf8);
     void CloseFigure(void);
@@ -443,6 +445,34 @@ PathC::DrawImage(Tk_PhotoHandle photo, float x, float y,
     }
 }
 
+/*
+ * Draws the premultiplied BGRA pixels of an offscreen surface.
+ */
+
+inline void
+PathC::DrawSurface(void *data, int width, int height, int bytesPerRow,
+                   float x, float y, double opacity)
+{
+    ImageAttributes imageAttrs;
+
+    if (opacity < 1.0) {
+        ColorMatrix colorMatrix = {
+            1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+            0.0f, 0.0f, 0.0f, (float) opacity, 0.0f,
+            0.0f, 0.0f, 0.0f, 0.0f, 1.0f
+        };
+        imageAttrs.SetColorMatrix(&colorMatrix, ColorMatrixFlagsDefault,
+                                  ColorAdjustTypeBitmap);
+    }
+    mGraphics->SetInterpolationMode(InterpolationModeNearestNeighbor);
+    Bitmap bitmap(width, height, bytesPerRow, PixelFormat32bppPARGB,
+                  (BYTE *) data);
+    mGraphics->DrawImage(&bitmap, RectF(x, y, (REAL) width, (REAL) height),
+            0.0f, 0.0f, (REAL) width, (REAL) height, UnitPixel, &imageAttrs);
+}
+
 inline int
 canvasTextStyle2GdiPlusTextStyle(Tk_PathTextStyle *textStylePtr)
 {
@@ -951,6 +981,7 @@ TkPathSetup(Tcl_Interp *interp)
         sGdiplusStarted = 1;
     }
     Tcl_MutexUnlock(&sGdiplusMutex);
+    Tcl_SetVar(interp, "::tkp::backend", "gdiplus", TCL_GLOBAL_ONLY);
     return TCL_OK;
 }
 
@@ -1172,7 +1203,7 @@ void
 TkPathImage(TkPathContext ctx, Tk_Image image, Tk_PhotoHandle photo,
             double x, double y, double width, double height,
             double fillOpacity, XColor *tintColor, double tintAmount,
-            int interpolation, PathRect *srcRegion)
+            int interpolation, PathRect *srcRegion, void **customPtr)
 {
     TkPathContext_ *context = (TkPathContext_ *) ctx;
     context->c->DrawImage(photo, (float) x, (float) y,
@@ -1181,6 +1212,19 @@ TkPathImage(TkPathContext ctx, Tk_Image image, Tk_PhotoHandle photo,
                           interpolation, srcRegion);
 }
 
+void
+TkPathImageFree(void *custom)
+{
+    /* Empty. */
+}
+
+int
+TkPathImageChanged(void *custom, Tk_PhotoHandle photo,
+    int x, int y, int width, int height)
+{
+    return 0;
+}
+
 void
 TkPathClosePath(TkPathContext ctx)
 {
@@ -1394,6 +1438,23 @@ TkPathFree(TkPathContext ctx)
     ckfree((char *) context);
 }
 
+void
+TkPathSurfaceDraw(TkPathContext ctx, TkPathContext surface,
+                  double x, double y, double opacity)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ctx;
+    TkPathContext_ *surfContext = (TkPathContext_ *) surface;
+    PathSurfaceGDIpRecord *record = surfContext->surface;
+
+    if (record == NULL) {
+        return;
+    }
+    surfContext->c->Flush();
+    context->c->DrawSurface(record->data, record->width, record->height,
+                            record->bytesPerRow, (float) x, (float) y,
+                            opacity);
+}
+
 void
 TkPathClipToPath(TkPathContext ctx, int fillRule)
 {